@@ -4,6 +4,10 @@
 #include <widgets/OBSBasic.hpp>
 
 #include <obs-frontend-api.h>
+#include <util/platform.h>
+#include <util/profiler.hpp>
+
+#include <algorithm>
 
 Multiview::Multiview()
 {
@@ -19,6 +23,8 @@ Multiview::~Multiview()
 	}
 
 	obs_enter_graphics();
+	for (gs_texrender_t *texrender : sceneTextures)
+		gs_texrender_destroy(texrender);
 	gs_vertexbuffer_destroy(actionSafeMargin);
 	gs_vertexbuffer_destroy(graphicsSafeMargin);
 	gs_vertexbuffer_destroy(fourByThreeSafeMargin);
@@ -64,11 +70,28 @@ static OBSSource CreateLabel(const char *name, size_t h)
 	return txtSource.Get();
 }
 
-void Multiview::Update(MultiviewLayout multiviewLayout, bool drawLabel, bool drawSafeArea)
+void Multiview::LogSceneRenderTimes()
+{
+	for (size_t i = 0; i < multiviewScenes.size() && i < sceneRenderTimes.size(); i++) {
+		OBSSource src = OBSGetStrongRef(multiviewScenes[i]);
+		if (!src)
+			continue;
+
+		blog(LOG_DEBUG, "Multiview scene '%s': %.3f ms per frame", obs_source_get_name(src),
+		     double(sceneRenderTimes[i]) / 1000000.0);
+	}
+}
+
+void Multiview::Update(MultiviewLayout multiviewLayout, bool drawLabel, bool drawSafeArea, uint32_t sceneInterval)
 {
 	this->multiviewLayout = multiviewLayout;
 	this->drawLabel = drawLabel;
 	this->drawSafeArea = drawSafeArea;
+	this->sceneInterval = sceneInterval ? sceneInterval : 1;
+
+	// Log the cost of each cell before the layout changes, so the
+	// refresh interval can be tuned against it
+	LogSceneRenderTimes();
 
 	multiviewScenes.clear();
 	multiviewLabels.clear();
@@ -85,6 +108,10 @@ void Multiview::Update(MultiviewLayout multiviewLayout, bool drawLabel, bool dra
 	struct obs_frontend_source_list scenes = {};
 	obs_frontend_get_scenes(&scenes);
 
+	// The render callback indexes the per-scene vectors up to maxSrcs, so
+	// the new count is only published once they have been resized
+	size_t newMaxSrcs;
+
 	multiviewLabels.emplace_back(CreateLabel(Str("StudioMode.Preview"), h / 2));
 	multiviewLabels.emplace_back(CreateLabel(Str("StudioMode.Program"), h / 2));
 
@@ -93,39 +120,39 @@ void Multiview::Update(MultiviewLayout multiviewLayout, bool drawLabel, bool dra
 		pvwprgCX = fw / 2;
 		pvwprgCY = fh / 2;
 
-		maxSrcs = 18;
+		newMaxSrcs = 18;
 		break;
 	case MultiviewLayout::HORIZONTAL_TOP_24_SCENES:
 		pvwprgCX = fw / 3;
 		pvwprgCY = fh / 3;
 
-		maxSrcs = 24;
+		newMaxSrcs = 24;
 		break;
 	case MultiviewLayout::SCENES_ONLY_4_SCENES:
 		pvwprgCX = fw / 2;
 		pvwprgCY = fh / 2;
-		maxSrcs = 4;
+		newMaxSrcs = 4;
 		break;
 	case MultiviewLayout::SCENES_ONLY_9_SCENES:
 		pvwprgCX = fw / 3;
 		pvwprgCY = fh / 3;
-		maxSrcs = 9;
+		newMaxSrcs = 9;
 		break;
 	case MultiviewLayout::SCENES_ONLY_16_SCENES:
 		pvwprgCX = fw / 4;
 		pvwprgCY = fh / 4;
-		maxSrcs = 16;
+		newMaxSrcs = 16;
 		break;
 	case MultiviewLayout::SCENES_ONLY_25_SCENES:
 		pvwprgCX = fw / 5;
 		pvwprgCY = fh / 5;
-		maxSrcs = 25;
+		newMaxSrcs = 25;
 		break;
 	default:
 		pvwprgCX = fw / 2;
 		pvwprgCY = fh / 2;
 
-		maxSrcs = 8;
+		newMaxSrcs = 8;
 	}
 
 	ppiCX = pvwprgCX - thicknessx2;
@@ -155,9 +182,9 @@ void Multiview::Update(MultiviewLayout multiviewLayout, bool drawLabel, bool dra
 	siScaleX = (scenesCX - thicknessx2) / fw;
 	siScaleY = (scenesCY - thicknessx2) / fh;
 
-	numSrcs = 0;
+	size_t newNumSrcs = 0;
 	size_t i = 0;
-	while (i < scenes.sources.num && numSrcs < maxSrcs) {
+	while (i < scenes.sources.num && newNumSrcs < newMaxSrcs) {
 		obs_source_t *src = scenes.sources.array[i++];
 		OBSDataAutoRelease data = obs_source_get_private_settings(src);
 
@@ -166,7 +193,7 @@ void Multiview::Update(MultiviewLayout multiviewLayout, bool drawLabel, bool dra
 			continue;
 
 		// We have a displayable source.
-		numSrcs++;
+		newNumSrcs++;
 
 		multiviewScenes.emplace_back(OBSGetWeakRef(src));
 		obs_source_inc_showing(src);
@@ -175,6 +202,110 @@ void Multiview::Update(MultiviewLayout multiviewLayout, bool drawLabel, bool dra
 	}
 
 	obs_frontend_source_list_free(&scenes);
+
+	obs_enter_graphics();
+	for (gs_texrender_t *texrender : sceneTextures)
+		gs_texrender_destroy(texrender);
+	sceneTextures.assign(newMaxSrcs, nullptr);
+	sceneRenderTimes.assign(newMaxSrcs, 0);
+	maxSrcs = newMaxSrcs;
+	numSrcs = newNumSrcs;
+	obs_leave_graphics();
+}
+
+uint64_t Multiview::GetSceneRenderTime(size_t idx) const
+{
+	return idx < sceneRenderTimes.size() ? sceneRenderTimes[idx] : 0;
+}
+
+void Multiview::RenderScene(size_t idx, obs_source_t *src, bool live, bool program, int x, int y, float scale)
+{
+	if (idx >= sceneTextures.size() || idx >= sceneRenderTimes.size())
+		return;
+
+	const uint64_t start = os_gettime_ns();
+
+	if (live || sceneInterval <= 1) {
+		ProfileScope("Multiview::RenderScene");
+
+		gs_matrix_push();
+		gs_matrix_translate3f(siX, siY, 0.0f);
+		gs_matrix_scale3f(siScaleX, siScaleY, 1.0f);
+		startRegion(int(x + siX * scale), int(y + siY * scale), int(siCX * scale), int(siCY * scale), siX,
+			    siX + siCX, siY, siY + siCY);
+		if (program)
+			obs_render_main_texture();
+		else
+			obs_source_video_render(src);
+		endRegion();
+		gs_matrix_pop();
+	} else {
+		const uint32_t texCX = std::max(uint32_t(siCX * scale), 1U);
+		const uint32_t texCY = std::max(uint32_t(siCY * scale), 1U);
+		const enum gs_color_space space = gs_get_color_space();
+		const enum gs_color_format format = gs_get_format_from_space(space);
+
+		gs_texrender_t *&texrender = sceneTextures[idx];
+		if (texrender && gs_texrender_get_format(texrender) != format) {
+			gs_texrender_destroy(texrender);
+			texrender = nullptr;
+		}
+		if (!texrender)
+			texrender = gs_texrender_create(format, GS_ZS_NONE);
+
+		gs_texture_t *tex = gs_texrender_get_texture(texrender);
+		bool refresh = !tex || gs_texture_get_width(tex) != texCX || gs_texture_get_height(tex) != texCY;
+
+		// Spread the inactive scenes over the frames of an interval
+		// instead of refreshing all of them on the same frame
+		refresh = refresh || ((frameCount + idx) % sceneInterval) == 0;
+
+		if (refresh) {
+			ProfileScope("Multiview::RenderScene");
+
+			gs_texrender_reset(texrender);
+			if (gs_texrender_begin_with_color_space(texrender, texCX, texCY, space)) {
+				vec4 zero;
+				vec4_zero(&zero);
+
+				gs_clear(GS_CLEAR_COLOR, &zero, 0.0f, 0);
+				gs_ortho(0.0f, fw, 0.0f, fh, -100.0f, 100.0f);
+
+				gs_blend_state_push();
+				gs_blend_function(GS_BLEND_ONE, GS_BLEND_INVSRCALPHA);
+				obs_source_video_render(src);
+				gs_blend_state_pop();
+
+				gs_texrender_end(texrender);
+			}
+
+			tex = gs_texrender_get_texture(texrender);
+		}
+
+		if (tex) {
+			gs_effect_t *effect = obs_get_base_effect(OBS_EFFECT_DEFAULT);
+			gs_eparam_t *image = gs_effect_get_param_by_name(effect, "image");
+
+			const bool previous = gs_framebuffer_srgb_enabled();
+			gs_enable_framebuffer_srgb(true);
+			gs_effect_set_texture_srgb(image, tex);
+
+			gs_blend_state_push();
+			gs_blend_function(GS_BLEND_ONE, GS_BLEND_INVSRCALPHA);
+
+			gs_matrix_push();
+			gs_matrix_translate3f(siX, siY, 0.0f);
+			while (gs_effect_loop(effect, "Draw"))
+				gs_draw_sprite(tex, 0, (uint32_t)siCX, (uint32_t)siCY);
+			gs_matrix_pop();
+
+			gs_blend_state_pop();
+			gs_enable_framebuffer_srgb(previous);
+		}
+	}
+
+	const uint64_t elapsed = os_gettime_ns() - start;
+	sceneRenderTimes[idx] = (sceneRenderTimes[idx] * 15 + elapsed) / 16;
 }
 
 static inline uint32_t labelOffset(MultiviewLayout multiviewLayout, obs_source_t *label, uint32_t cx)
@@ -220,6 +351,8 @@ void Multiview::Render(uint32_t cx, uint32_t cy)
 
 	GetScaleAndCenterPos(targetCX, targetCY, cx, cy, x, y, scale);
 
+	frameCount++;
+
 	OBSSource previewSrc = main->GetCurrentSceneSource();
 	OBSSource programSrc = main->GetProgramSource();
 	bool studioMode = main->IsPreviewProgramMode();
@@ -410,14 +543,12 @@ void Multiview::Render(uint32_t cx, uint32_t cy)
 
 		/* ----------- */
 
-		// Render the source
-		gs_matrix_push();
-		gs_matrix_translate3f(siX, siY, 0.0f);
-		gs_matrix_scale3f(siScaleX, siScaleY, 1.0f);
-		setRegion(siX, siY, siCX, siCY);
-		obs_source_video_render(src);
-		endRegion();
-		gs_matrix_pop();
+		// Render the source.  The program scene is drawn from the
+		// main texture.  The preview scene is drawn live, it is
+		// already rendered for the preview this frame, so the render
+		// cache of the scene serves it.
+		bool program = src == programSrc || (!studioMode && src == previewSrc);
+		RenderScene(i, src, program || src == previewSrc, program, x, y, scale);
 
 		/* ----------- */
 
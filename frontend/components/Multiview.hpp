@@ -21,14 +21,20 @@ class Multiview {
 public:
 	Multiview();
 	~Multiview();
-	void Update(MultiviewLayout multiviewLayout, bool drawLabel, bool drawSafeArea);
+	void Update(MultiviewLayout multiviewLayout, bool drawLabel, bool drawSafeArea, uint32_t sceneInterval);
 	void Render(uint32_t cx, uint32_t cy);
 	OBSSource GetSourceByPosition(int x, int y);
+	uint64_t GetSceneRenderTime(size_t idx) const;
 
 private:
+	void RenderScene(size_t idx, obs_source_t *src, bool live, bool program, int x, int y, float scale);
+	void LogSceneRenderTimes();
+
 	bool drawLabel, drawSafeArea;
 	MultiviewLayout multiviewLayout;
 	size_t maxSrcs, numSrcs;
+	uint32_t sceneInterval = 1;
+	uint64_t frameCount = 0;
 	gs_vertbuffer_t *actionSafeMargin = nullptr;
 	gs_vertbuffer_t *graphicsSafeMargin = nullptr;
 	gs_vertbuffer_t *fourByThreeSafeMargin = nullptr;
@@ -39,6 +45,11 @@ private:
 	std::vector<OBSWeakSource> multiviewScenes;
 	std::vector<OBSSource> multiviewLabels;
 
+	// Cell resolution textures of scenes that are not rendered every frame
+	std::vector<gs_texrender_t *> sceneTextures;
+	// Smoothed CPU time spent on each scene cell per frame, in ns
+	std::vector<uint64_t> sceneRenderTimes;
+
 	// Multiview position helpers
 	float thickness = 6;
 	float offset, thicknessx2 = thickness * 2, pvwprgCX, pvwprgCY, sourceX, sourceY, labelX, labelY, scenesCX,
@@ -366,6 +366,7 @@ OBSBasicSettings::OBSBasicSettings(QWidget *parent)
 	HookWidget(ui->multiviewDrawNames,   CHECK_CHANGED,  GENERAL_CHANGED);
 	HookWidget(ui->multiviewDrawAreas,   CHECK_CHANGED,  GENERAL_CHANGED);
 	HookWidget(ui->multiviewLayout,      COMBO_CHANGED,  GENERAL_CHANGED);
+	HookWidget(ui->multiviewSceneInterval,COMBO_CHANGED,GENERAL_CHANGED);
 	HookWidget(ui->theme, 		     COMBO_CHANGED,  APPEAR_CHANGED);
 	HookWidget(ui->themeVariant,	     COMBO_CHANGED,  APPEAR_CHANGED);
 	HookWidget(ui->service,              COMBO_CHANGED,  STREAM1_CHANGED);
@@ -1365,6 +1366,15 @@ void OBSBasicSettings::LoadGeneralSettings()
 	ui->multiviewLayout->setCurrentIndex(ui->multiviewLayout->findData(
 		QVariant::fromValue(config_get_int(App()->GetUserConfig(), "BasicWindow", "MultiviewLayout"))));
 
+	ui->multiviewSceneInterval->addItem(QTStr("Basic.Settings.General.MultiviewSceneInterval.EveryFrame"), 1);
+	ui->multiviewSceneInterval->addItem(QTStr("Basic.Settings.General.MultiviewSceneInterval.Every2"), 2);
+	ui->multiviewSceneInterval->addItem(QTStr("Basic.Settings.General.MultiviewSceneInterval.Every4"), 4);
+	ui->multiviewSceneInterval->addItem(QTStr("Basic.Settings.General.MultiviewSceneInterval.Every8"), 8);
+
+	int sceneIntervalIdx = ui->multiviewSceneInterval->findData(
+		QVariant::fromValue(config_get_int(App()->GetUserConfig(), "BasicWindow", "MultiviewSceneInterval")));
+	ui->multiviewSceneInterval->setCurrentIndex(sceneIntervalIdx == -1 ? 0 : sceneIntervalIdx);
+
 	prevLangIndex = ui->language->currentIndex();
 
 	if (obs_video_active())
@@ -3084,6 +3094,12 @@ void OBSBasicSettings::SaveGeneralSettings()
 		multiviewChanged = true;
 	}
 
+	if (WidgetChanged(ui->multiviewSceneInterval)) {
+		config_set_int(App()->GetUserConfig(), "BasicWindow", "MultiviewSceneInterval",
+			       ui->multiviewSceneInterval->currentData().toInt());
+		multiviewChanged = true;
+	}
+
 	if (multiviewChanged)
 		OBSProjector::UpdateMultiviewProjectors();
 }
@@ -870,6 +870,8 @@ bool AdvancedOutput::StartReplayBuffer()
 		obs_data_set_bool(settings, "allow_spaces", !noSpace);
 		obs_data_set_int(settings, "max_time_sec", rbTime);
 		obs_data_set_int(settings, "max_size_mb", usesBitrate ? 0 : rbSize);
+		obs_data_set_bool(settings, "use_disk_buffer",
+				  config_get_bool(main->Config(), "Output", "ReplayBufferOnDisk"));
 
 		obs_output_update(replayBuffer, settings);
 	}
@@ -310,11 +310,14 @@ void OBSProjector::UpdateMultiview()
 
 	bool drawSafeArea = config_get_bool(App()->GetUserConfig(), "BasicWindow", "MultiviewDrawAreas");
 
+	uint32_t sceneInterval =
+		(uint32_t)config_get_int(App()->GetUserConfig(), "BasicWindow", "MultiviewSceneInterval");
+
 	mouseSwitching = config_get_bool(App()->GetUserConfig(), "BasicWindow", "MultiviewMouseSwitch");
 
 	transitionOnDoubleClick = config_get_bool(App()->GetUserConfig(), "BasicWindow", "TransitionOnDoubleClick");
 
-	multiview->Update(multiviewLayout, drawLabel, drawSafeArea);
+	multiview->Update(multiviewLayout, drawLabel, drawSafeArea, sceneInterval);
 }
 
 void OBSProjector::UpdateProjectorTitle(QString name)
@@ -59,14 +59,6 @@ void VolControl::OBSVolumeChanged(void *data, float db)
 	QMetaObject::invokeMethod(volControl, "VolumeChanged");
 }
 
-void VolControl::OBSVolumeLevel(void *data, const float magnitude[MAX_AUDIO_CHANNELS],
-				const float peak[MAX_AUDIO_CHANNELS], const float inputPeak[MAX_AUDIO_CHANNELS])
-{
-	VolControl *volControl = static_cast<VolControl *>(data);
-
-	volControl->volMeter->setLevels(magnitude, peak, inputPeak);
-}
-
 void VolControl::OBSVolumeMuted(void *data, calldata_t *calldata)
 {
 	VolControl *volControl = static_cast<VolControl *>(data);
@@ -356,7 +348,6 @@ VolControl::VolControl(OBSSource source_, bool showConfig, bool vertical)
 	volMeter->muted = muted || unassigned;
 	mute->setAccessibleName(QTStr("VolControl.Mute").arg(sourceName));
 	obs_fader_add_callback(obs_fader, OBSVolumeChanged, this);
-	obs_volmeter_add_callback(obs_volmeter, OBSVolumeLevel, this);
 
 	sigs.emplace_back(obs_source_get_signal_handler(source), "mute", OBSVolumeMuted, this);
 	sigs.emplace_back(obs_source_get_signal_handler(source), "audio_mixers", OBSMixersOrMonitoringChanged, this);
@@ -381,7 +372,6 @@ void VolControl::EnableSlider(bool enable)
 VolControl::~VolControl()
 {
 	obs_fader_remove_callback(obs_fader, OBSVolumeChanged, this);
-	obs_volmeter_remove_callback(obs_volmeter, OBSVolumeLevel, this);
 
 	sigs.clear();
 
@@ -459,6 +459,25 @@ void VolumeMeter::setLevels(const float magnitude[MAX_AUDIO_CHANNELS], const flo
 	calculateBallistics(ts);
 }
 
+// Levels are read from the volume meter on the UI thread when redrawing,
+// rather than pushed from the audio thread for every meter.
+void VolumeMeter::pollLevels()
+{
+	uint32_t sequence = obs_volmeter_get_levels_sequence(obs_volmeter);
+	if (sequence == levelsSequence)
+		return;
+
+	float magnitude[MAX_AUDIO_CHANNELS];
+	float peak[MAX_AUDIO_CHANNELS];
+	float inputPeak[MAX_AUDIO_CHANNELS];
+
+	if (!obs_volmeter_get_levels(obs_volmeter, magnitude, peak, inputPeak))
+		return;
+
+	levelsSequence = sequence;
+	setLevels(magnitude, peak, inputPeak);
+}
+
 inline void VolumeMeter::resetLevels()
 {
 	currentLastUpdateTime = 0;
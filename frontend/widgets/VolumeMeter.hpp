@@ -67,6 +67,7 @@ class VolumeMeter : public QWidget {
 
 private:
 	obs_volmeter_t *obs_volmeter;
+	uint32_t levelsSequence = 0;
 	static std::weak_ptr<VolumeMeterTimer> updateTimer;
 	std::shared_ptr<VolumeMeterTimer> updateTimerRef;
 
@@ -153,6 +154,7 @@ public:
 
 	void setLevels(const float magnitude[MAX_AUDIO_CHANNELS], const float peak[MAX_AUDIO_CHANNELS],
 		       const float inputPeak[MAX_AUDIO_CHANNELS]);
+	void pollLevels();
 	QRect getBarRect() const;
 	bool needLayoutChange();
 
@@ -0,0 +1,485 @@
+/******************************************************************************
+    Copyright (C) 2026 by OBS Project contributors
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+******************************************************************************/
+
+#include <sys/stat.h>
+#include <util/darray.h>
+#include <util/dstr.h>
+#include <util/platform.h>
+#include <util/serializer.h>
+#include <util/file-serializer.h>
+#include "gl-subsystem.h"
+
+/*
+ * On-disk shader cache.
+ *
+ * Two kinds of records are kept in the cache directory, both keyed by a hash
+ * of the driver identification string and the transpiled GLSL:
+ *
+ *   <key>.glsl    - a shader that has been compiled successfully before.  When
+ *                   present, compilation of the shader object is deferred
+ *                   until a program actually needs it (which may be never if
+ *                   the program binary is also cached).
+ *   <key>.glprog  - a linked program binary retrieved with glGetProgramBinary.
+ *
+ * Every record stores the full GLSL it was built from, so a hash collision or
+ * a stale file can never produce the wrong program.  Any record that fails to
+ * validate or load is removed and the shader/program is compiled normally.
+ *
+ * The driver identification string is also stored in a "driver" file.  When
+ * it changes, every record is removed, since none of them can be used by the
+ * new driver.  Otherwise the oldest records are removed whenever the cache
+ * is opened with more than SHADER_CACHE_MAX_SIZE bytes or
+ * SHADER_CACHE_MAX_ENTRIES records in it.
+ */
+
+#define SHADER_CACHE_VERSION 1
+#define SHADER_RECORD_MAGIC 0x4353474F  /* "OGSC" */
+#define PROGRAM_RECORD_MAGIC 0x4350474F /* "OGPC" */
+
+/* sanity limit for anything read back from disk */
+#define MAX_RECORD_SIZE (64 * 1024 * 1024)
+
+#define SHADER_CACHE_MAX_SIZE (256 * 1024 * 1024)
+#define SHADER_CACHE_MAX_ENTRIES 4096
+
+static inline uint64_t hash_data(uint64_t hash, const void *data, size_t size)
+{
+	const uint8_t *bytes = data;
+
+	/* FNV-1a */
+	for (size_t i = 0; i < size; i++) {
+		hash ^= bytes[i];
+		hash *= 0x100000001B3ULL;
+	}
+
+	return hash;
+}
+
+static inline uint64_t hash_str(uint64_t hash, const char *str)
+{
+	return hash_data(hash, str, str ? strlen(str) + 1 : 0);
+}
+
+static void get_record_path(struct dstr *path, gs_device_t *device, uint64_t key, const char *ext)
+{
+	dstr_printf(path, "%s/%016llx.%s", device->shader_cache_path, (unsigned long long)key, ext);
+}
+
+static inline bool read_val(struct serializer *s, void *val, size_t size)
+{
+	return s_read(s, val, size) == size;
+}
+
+static char *read_str(struct serializer *s, uint32_t len)
+{
+	char *str;
+
+	if (len > MAX_RECORD_SIZE)
+		return NULL;
+
+	str = bmalloc(len + 1);
+	if (s_read(s, str, len) != len) {
+		bfree(str);
+		return NULL;
+	}
+
+	str[len] = 0;
+	return str;
+}
+
+static bool read_matching_str(struct serializer *s, uint32_t len, const char *expected)
+{
+	char *str = read_str(s, len);
+	bool match = str && strcmp(str, expected) == 0;
+	bfree(str);
+	return match;
+}
+
+static inline void write_str(struct serializer *s, const char *str, uint32_t len)
+{
+	s_write(s, str, len);
+}
+
+static inline void cat_driver_str(struct dstr *id, GLenum name)
+{
+	const char *str = (const char *)glGetString(name);
+	dstr_cat(id, str ? str : "");
+	dstr_cat_ch(id, '\n');
+}
+
+void gl_shader_cache_init(gs_device_t *device)
+{
+	uint64_t hash = 0xCBF29CE484222325ULL;
+	struct dstr id = {0};
+	GLint formats = 0;
+
+	dstr_printf(&id, "version %d\n", SHADER_CACHE_VERSION);
+	cat_driver_str(&id, GL_VENDOR);
+	cat_driver_str(&id, GL_RENDERER);
+	cat_driver_str(&id, GL_VERSION);
+	cat_driver_str(&id, GL_SHADING_LANGUAGE_VERSION);
+
+	hash = hash_str(hash, (const char *)glGetString(GL_VENDOR));
+	hash = hash_str(hash, (const char *)glGetString(GL_RENDERER));
+	hash = hash_str(hash, (const char *)glGetString(GL_VERSION));
+	hash = hash_str(hash, (const char *)glGetString(GL_SHADING_LANGUAGE_VERSION));
+	device->driver_hash = hash;
+	device->driver_id = id.array;
+
+	if (GLAD_GL_VERSION_4_1 || GLAD_GL_ARB_get_program_binary) {
+		glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+		gl_success("glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS)");
+	}
+
+	device->program_binaries = formats > 0;
+}
+
+void gl_shader_cache_free(gs_device_t *device)
+{
+	bfree(device->shader_cache_path);
+	bfree(device->driver_id);
+	device->shader_cache_path = NULL;
+	device->driver_id = NULL;
+}
+
+struct cache_record {
+	char *path;
+	int64_t size;
+	time_t mtime;
+};
+
+static inline bool is_record_file(const char *name)
+{
+	const char *ext = strrchr(name, '.');
+	return ext && (strcmp(ext, ".glsl") == 0 || strcmp(ext, ".glprog") == 0 || strcmp(ext, ".tmp") == 0);
+}
+
+static int cmp_record_age(const void *a, const void *b)
+{
+	const struct cache_record *ra = a;
+	const struct cache_record *rb = b;
+	return (ra->mtime > rb->mtime) - (ra->mtime < rb->mtime);
+}
+
+/* removes every record if the driver changed, otherwise the oldest records
+ * until the cache fits within its budget */
+static void prune_shader_cache(gs_device_t *device, const char *path)
+{
+	DARRAY(struct cache_record) records;
+	struct dstr id_path = {0};
+	struct dstr file = {0};
+	int64_t total_size = 0;
+	size_t removed = 0;
+	os_dir_t *dir;
+
+	if (!device->driver_id)
+		return;
+
+	dstr_printf(&id_path, "%s/driver", path);
+
+	char *stored_id = os_quick_read_utf8_file(id_path.array);
+	bool driver_changed = !stored_id || strcmp(stored_id, device->driver_id) != 0;
+	bfree(stored_id);
+
+	dir = os_opendir(path);
+	if (!dir) {
+		dstr_free(&id_path);
+		return;
+	}
+
+	da_init(records);
+
+	struct os_dirent *ent;
+	while ((ent = os_readdir(dir)) != NULL) {
+		struct cache_record record;
+		struct stat st;
+
+		if (ent->directory || !is_record_file(ent->d_name))
+			continue;
+
+		dstr_printf(&file, "%s/%s", path, ent->d_name);
+
+		if (driver_changed || os_stat(file.array, &st) != 0) {
+			removed += os_unlink(file.array) == 0;
+			continue;
+		}
+
+		record.path = bstrdup(file.array);
+		record.size = (int64_t)st.st_size;
+		record.mtime = st.st_mtime;
+		total_size += record.size;
+		da_push_back(records, &record);
+	}
+
+	os_closedir(dir);
+
+	qsort(records.array, records.num, sizeof(struct cache_record), cmp_record_age);
+
+	size_t count = records.num;
+	for (size_t i = 0; i < records.num; i++) {
+		struct cache_record *record = &records.array[i];
+
+		if (total_size > SHADER_CACHE_MAX_SIZE || count > SHADER_CACHE_MAX_ENTRIES) {
+			if (os_unlink(record->path) == 0)
+				removed++;
+			total_size -= record->size;
+			count--;
+		}
+
+		bfree(record->path);
+	}
+
+	da_free(records);
+
+	if (driver_changed)
+		os_quick_write_utf8_file_safe(id_path.array, device->driver_id, strlen(device->driver_id), false,
+					      "tmp", NULL);
+
+	if (removed)
+		blog(LOG_INFO, "Shader cache: removed %zu %s records", removed, driver_changed ? "stale" : "old");
+
+	dstr_free(&file);
+	dstr_free(&id_path);
+}
+
+void device_set_shader_cache_path(gs_device_t *device, const char *path)
+{
+	bfree(device->shader_cache_path);
+	device->shader_cache_path = NULL;
+
+	if (!path || !*path)
+		return;
+
+	if (os_mkdirs(path) == MKDIR_ERROR) {
+		blog(LOG_WARNING, "Failed to create shader cache directory '%s', shader cache disabled", path);
+		return;
+	}
+
+	prune_shader_cache(device, path);
+	device->shader_cache_path = bstrdup(path);
+
+	blog(LOG_INFO, "Shader cache: %s (program binaries %s)", path,
+	     device->program_binaries ? "supported" : "not supported");
+}
+
+static inline uint64_t shader_key(gs_device_t *device, enum gs_shader_type type, const char *glsl)
+{
+	uint64_t hash = device->driver_hash;
+	hash = hash_data(hash, &type, sizeof(type));
+	return hash_str(hash, glsl);
+}
+
+bool gl_shader_cache_has_shader(gs_device_t *device, enum gs_shader_type type, const char *glsl)
+{
+	struct serializer s;
+	struct dstr path = {0};
+	uint32_t magic, version, stored_type, len;
+	uint64_t driver_hash;
+	bool found = false;
+
+	if (!device->shader_cache_path)
+		return false;
+
+	get_record_path(&path, device, shader_key(device, type, glsl), "glsl");
+
+	if (!os_file_exists(path.array) || !file_input_serializer_init(&s, path.array)) {
+		dstr_free(&path);
+		return false;
+	}
+
+	if (read_val(&s, &magic, sizeof(magic)) && magic == SHADER_RECORD_MAGIC &&
+	    read_val(&s, &version, sizeof(version)) && version == SHADER_CACHE_VERSION &&
+	    read_val(&s, &driver_hash, sizeof(driver_hash)) && driver_hash == device->driver_hash &&
+	    read_val(&s, &stored_type, sizeof(stored_type)) && stored_type == (uint32_t)type &&
+	    read_val(&s, &len, sizeof(len)))
+		found = read_matching_str(&s, len, glsl);
+
+	file_input_serializer_free(&s);
+
+	if (!found)
+		os_unlink(path.array);
+
+	dstr_free(&path);
+	return found;
+}
+
+void gl_shader_cache_add_shader(gs_device_t *device, enum gs_shader_type type, const char *glsl)
+{
+	struct serializer s;
+	struct dstr path = {0};
+	uint32_t magic = SHADER_RECORD_MAGIC;
+	uint32_t version = SHADER_CACHE_VERSION;
+	uint32_t stored_type = (uint32_t)type;
+	uint32_t len = (uint32_t)strlen(glsl);
+
+	if (!device->shader_cache_path)
+		return;
+
+	get_record_path(&path, device, shader_key(device, type, glsl), "glsl");
+
+	if (file_output_serializer_init_safe(&s, path.array, "tmp")) {
+		s_write(&s, &magic, sizeof(magic));
+		s_write(&s, &version, sizeof(version));
+		s_write(&s, &device->driver_hash, sizeof(device->driver_hash));
+		s_write(&s, &stored_type, sizeof(stored_type));
+		s_write(&s, &len, sizeof(len));
+		write_str(&s, glsl, len);
+		file_output_serializer_free(&s);
+	}
+
+	dstr_free(&path);
+}
+
+static inline uint64_t program_key(struct gs_program *program)
+{
+	uint64_t hash = program->device->driver_hash;
+	hash = hash_str(hash, program->vertex_shader->gl_source);
+	return hash_str(hash, program->pixel_shader->gl_source);
+}
+
+static inline bool program_cacheable(struct gs_program *program)
+{
+	gs_device_t *device = program->device;
+	return device->shader_cache_path && device->program_binaries && program->vertex_shader->gl_source &&
+	       program->pixel_shader->gl_source;
+}
+
+bool gl_shader_cache_load_program(struct gs_program *program)
+{
+	struct serializer s;
+	struct dstr path = {0};
+	uint32_t magic, version, format, vs_len, ps_len, bin_len;
+	uint64_t driver_hash;
+	void *binary = NULL;
+	bool binary_loaded = false;
+	GLint linked = GL_FALSE;
+
+	if (!program_cacheable(program))
+		return false;
+
+	get_record_path(&path, program->device, program_key(program), "glprog");
+
+	if (!os_file_exists(path.array) || !file_input_serializer_init(&s, path.array)) {
+		dstr_free(&path);
+		return false;
+	}
+
+	if (read_val(&s, &magic, sizeof(magic)) && magic == PROGRAM_RECORD_MAGIC &&
+	    read_val(&s, &version, sizeof(version)) && version == SHADER_CACHE_VERSION &&
+	    read_val(&s, &driver_hash, sizeof(driver_hash)) && driver_hash == program->device->driver_hash &&
+	    read_val(&s, &format, sizeof(format)) && read_val(&s, &vs_len, sizeof(vs_len)) &&
+	    read_val(&s, &ps_len, sizeof(ps_len)) && read_val(&s, &bin_len, sizeof(bin_len)) &&
+	    read_matching_str(&s, vs_len, program->vertex_shader->gl_source) &&
+	    read_matching_str(&s, ps_len, program->pixel_shader->gl_source) && bin_len &&
+	    bin_len <= MAX_RECORD_SIZE) {
+		binary = bmalloc(bin_len);
+		if (s_read(&s, binary, bin_len) != bin_len) {
+			bfree(binary);
+			binary = NULL;
+		}
+	}
+
+	file_input_serializer_free(&s);
+
+	if (binary) {
+		glProgramBinary(program->obj, (GLenum)format, binary, (GLsizei)bin_len);
+		binary_loaded = true;
+		if (gl_success("glProgramBinary")) {
+			glGetProgramiv(program->obj, GL_LINK_STATUS, &linked);
+			gl_success("glGetProgramiv");
+		}
+
+		bfree(binary);
+	}
+
+	if (linked != GL_TRUE) {
+		blog(LOG_DEBUG, "Discarding stale shader cache entry '%s'", path.array);
+		os_unlink(path.array);
+
+		/* recreate the program object if it was handed a binary so the
+		 * regular link starts from a clean state */
+		if (binary_loaded) {
+			glDeleteProgram(program->obj);
+			gl_success("glDeleteProgram");
+
+			program->obj = glCreateProgram();
+			gl_success("glCreateProgram");
+		}
+	}
+
+	dstr_free(&path);
+	return linked == GL_TRUE;
+}
+
+void gl_shader_cache_prepare_program(struct gs_program *program)
+{
+	if (!program_cacheable(program))
+		return;
+
+	glProgramParameteri(program->obj, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+	gl_success("glProgramParameteri");
+}
+
+void gl_shader_cache_add_program(struct gs_program *program)
+{
+	struct serializer s;
+	struct dstr path = {0};
+	uint32_t magic = PROGRAM_RECORD_MAGIC;
+	uint32_t version = SHADER_CACHE_VERSION;
+	uint32_t vs_len, ps_len, bin_len;
+	GLint size = 0;
+	GLsizei written = 0;
+	GLenum format = 0;
+	void *binary;
+
+	if (!program_cacheable(program))
+		return;
+
+	glGetProgramiv(program->obj, GL_PROGRAM_BINARY_LENGTH, &size);
+	if (!gl_success("glGetProgramiv(GL_PROGRAM_BINARY_LENGTH)") || size <= 0 || size > MAX_RECORD_SIZE)
+		return;
+
+	binary = bmalloc(size);
+	glGetProgramBinary(program->obj, size, &written, &format, binary);
+	if (!gl_success("glGetProgramBinary") || written <= 0) {
+		bfree(binary);
+		return;
+	}
+
+	vs_len = (uint32_t)strlen(program->vertex_shader->gl_source);
+	ps_len = (uint32_t)strlen(program->pixel_shader->gl_source);
+	bin_len = (uint32_t)written;
+
+	get_record_path(&path, program->device, program_key(program), "glprog");
+
+	if (file_output_serializer_init_safe(&s, path.array, "tmp")) {
+		s_write(&s, &magic, sizeof(magic));
+		s_write(&s, &version, sizeof(version));
+		s_write(&s, &program->device->driver_hash, sizeof(program->device->driver_hash));
+		s_write(&s, &format, sizeof(format));
+		s_write(&s, &vs_len, sizeof(vs_len));
+		s_write(&s, &ps_len, sizeof(ps_len));
+		s_write(&s, &bin_len, sizeof(bin_len));
+		write_str(&s, program->vertex_shader->gl_source, vs_len);
+		write_str(&s, program->pixel_shader->gl_source, ps_len);
+		s_write(&s, binary, bin_len);
+		file_output_serializer_free(&s);
+	}
+
+	dstr_free(&path);
+	bfree(binary);
+}
@@ -174,8 +174,7 @@ static inline bool gl_process_attribs(struct gs_shader *shader, struct gl_shader
 	return true;
 }
 
-static bool gl_shader_init(struct gs_shader *shader, struct gl_shader_parser *glsp, const char *file,
-			   char **error_string)
+static bool gl_shader_compile(struct gs_shader *shader, const char *gl_string, const char *file, char **error_string)
 {
 	GLenum type = convert_shader_type(shader->type);
 	int compiled = 0;
@@ -185,7 +184,7 @@ static bool gl_shader_init(struct gs_shader *shader, struct gl_shader_parser *gl
 	if (!gl_success("glCreateShader") || !shader->obj)
 		return false;
 
-	glShaderSource(shader->obj, 1, (const GLchar **)&glsp->gl_string.array, 0);
+	glShaderSource(shader->obj, 1, (const GLchar **)&gl_string, 0);
 	if (!gl_success("glShaderSource"))
 		return false;
 
@@ -197,7 +196,7 @@ static bool gl_shader_init(struct gs_shader *shader, struct gl_shader_parser *gl
 	blog(LOG_DEBUG, "+++++++++++++++++++++++++++++++++++");
 	blog(LOG_DEBUG, "  GL shader string for: %s", file);
 	blog(LOG_DEBUG, "-----------------------------------");
-	blog(LOG_DEBUG, "%s", glsp->gl_string.array);
+	blog(LOG_DEBUG, "%s", gl_string);
 	blog(LOG_DEBUG, "+++++++++++++++++++++++++++++++++++");
 #endif
 
@@ -223,6 +222,39 @@ static bool gl_shader_init(struct gs_shader *shader, struct gl_shader_parser *gl
 	}
 
 	gl_get_shader_info(shader->obj, file, error_string);
+	return success;
+}
+
+/* compiles a shader whose compilation was deferred by the shader cache */
+static bool gl_shader_ensure_compiled(struct gs_shader *shader)
+{
+	if (shader->obj)
+		return true;
+	if (!shader->gl_source)
+		return false;
+
+	return gl_shader_compile(shader, shader->gl_source, "(cached shader)", NULL);
+}
+
+static bool gl_shader_init(struct gs_shader *shader, struct gl_shader_parser *glsp, const char *file,
+			   char **error_string)
+{
+	gs_device_t *device = shader->device;
+	bool success = true;
+
+	if (device->shader_cache_path) {
+		shader->gl_source = bstrdup(glsp->gl_string.array);
+
+		/* if this exact shader has compiled before on this driver,
+		 * defer compiling it until a program actually needs it */
+		if (!gl_shader_cache_has_shader(device, shader->type, shader->gl_source)) {
+			success = gl_shader_compile(shader, shader->gl_source, file, error_string);
+			if (success)
+				gl_shader_cache_add_shader(device, shader->type, shader->gl_source);
+		}
+	} else {
+		success = gl_shader_compile(shader, glsp->gl_string.array, file, error_string);
+	}
 
 	if (success)
 		success = gl_add_params(shader, glsp);
@@ -322,6 +354,7 @@ void gs_shader_destroy(gs_shader_t *shader)
 		gl_success("glDeleteShader");
 	}
 
+	bfree(shader->gl_source);
 	da_free(shader->samplers);
 	da_free(shader->params);
 	da_free(shader->attribs);
@@ -598,27 +631,23 @@ static inline bool assign_program_params(struct gs_program *program)
 	return true;
 }
 
-struct gs_program *gs_program_create(struct gs_device *device)
+static bool gl_program_link(struct gs_program *program)
 {
-	struct gs_program *program = bzalloc(sizeof(*program));
 	int linked = false;
 
-	program->device = device;
-	program->vertex_shader = device->cur_vertex_shader;
-	program->pixel_shader = device->cur_pixel_shader;
-
-	program->obj = glCreateProgram();
-	if (!gl_success("glCreateProgram"))
-		goto error_detach_neither;
+	if (!gl_shader_ensure_compiled(program->vertex_shader) || !gl_shader_ensure_compiled(program->pixel_shader))
+		return false;
 
 	glAttachShader(program->obj, program->vertex_shader->obj);
 	if (!gl_success("glAttachShader (vertex)"))
-		goto error_detach_neither;
+		return false;
 
 	glAttachShader(program->obj, program->pixel_shader->obj);
 	if (!gl_success("glAttachShader (pixel)"))
 		goto error_detach_vertex;
 
+	gl_shader_cache_prepare_program(program);
+
 	glLinkProgram(program->obj);
 	if (!gl_success("glLinkProgram"))
 		goto error;
@@ -632,24 +661,14 @@ struct gs_program *gs_program_create(struct gs_device *device)
 		goto error;
 	}
 
-	if (!assign_program_attribs(program))
-		goto error;
-	if (!assign_program_params(program))
-		goto error;
-
 	glDetachShader(program->obj, program->vertex_shader->obj);
 	gl_success("glDetachShader (vertex)");
 
 	glDetachShader(program->obj, program->pixel_shader->obj);
 	gl_success("glDetachShader (pixel)");
 
-	program->next = device->first_program;
-	program->prev_next = &device->first_program;
-	device->first_program = program;
-	if (program->next)
-		program->next->prev_next = &program->next;
-
-	return program;
+	gl_shader_cache_add_program(program);
+	return true;
 
 error:
 	glDetachShader(program->obj, program->pixel_shader->obj);
@@ -658,8 +677,38 @@ error:
 error_detach_vertex:
 	glDetachShader(program->obj, program->vertex_shader->obj);
 	gl_success("glDetachShader (vertex)");
+	return false;
+}
+
+struct gs_program *gs_program_create(struct gs_device *device)
+{
+	struct gs_program *program = bzalloc(sizeof(*program));
+
+	program->device = device;
+	program->vertex_shader = device->cur_vertex_shader;
+	program->pixel_shader = device->cur_pixel_shader;
+
+	program->obj = glCreateProgram();
+	if (!gl_success("glCreateProgram"))
+		goto error;
+
+	if (!gl_shader_cache_load_program(program) && !gl_program_link(program))
+		goto error;
+
+	if (!assign_program_attribs(program))
+		goto error;
+	if (!assign_program_params(program))
+		goto error;
 
-error_detach_neither:
+	program->next = device->first_program;
+	program->prev_next = &device->first_program;
+	device->first_program = program;
+	if (program->next)
+		program->next->prev_next = &program->next;
+
+	return program;
+
+error:
 	gs_program_destroy(program);
 	return NULL;
 }
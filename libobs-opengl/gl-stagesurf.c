@@ -17,9 +17,36 @@
 
 #include "gl-subsystem.h"
 
+static inline GLsizeiptr get_pack_buffer_size(const struct gs_stage_surface *surf)
+{
+	GLsizeiptr size = surf->width * surf->bytes_per_pixel;
+	size = (size + 3) & 0xFFFFFFFC; /* align width to 4-byte boundary */
+	return size * surf->height;
+}
+
+/* Persistently maps the pack buffer so that reading back a frame only needs
+ * to wait on its fence instead of a glMapBuffer call that implicitly
+ * synchronizes with the GPU every frame. */
+static bool create_persistent_pack_buffer(struct gs_stage_surface *surf, GLsizeiptr size)
+{
+	const GLbitfield flags = GL_MAP_READ_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+
+	glBufferStorage(GL_PIXEL_PACK_BUFFER, size, NULL, flags | GL_CLIENT_STORAGE_BIT);
+	if (!gl_success("glBufferStorage"))
+		return false;
+
+	surf->persistent_data = glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, size, flags);
+	if (!gl_success("glMapBufferRange") || !surf->persistent_data) {
+		surf->persistent_data = NULL;
+		return false;
+	}
+
+	return true;
+}
+
 static bool create_pixel_pack_buffer(struct gs_stage_surface *surf)
 {
-	GLsizeiptr size;
+	GLsizeiptr size = get_pack_buffer_size(surf);
 	bool success = true;
 
 	if (!gl_gen_buffers(1, &surf->pack_buffer))
@@ -28,20 +55,49 @@ static bool create_pixel_pack_buffer(struct gs_stage_surface *surf)
 	if (!gl_bind_buffer(GL_PIXEL_PACK_BUFFER, surf->pack_buffer))
 		return false;
 
-	size = surf->width * surf->bytes_per_pixel;
-	size = (size + 3) & 0xFFFFFFFC; /* align width to 4-byte boundary */
-	size *= surf->height;
+	if (GLAD_GL_VERSION_4_4 || GLAD_GL_ARB_buffer_storage) {
+		if (create_persistent_pack_buffer(surf, size))
+			goto done;
+
+		/* buffer storage is immutable, start over with a new buffer */
+		gl_bind_buffer(GL_PIXEL_PACK_BUFFER, 0);
+		gl_delete_buffers(1, &surf->pack_buffer);
+
+		if (!gl_gen_buffers(1, &surf->pack_buffer))
+			return false;
+		if (!gl_bind_buffer(GL_PIXEL_PACK_BUFFER, surf->pack_buffer))
+			return false;
+	}
 
 	glBufferData(GL_PIXEL_PACK_BUFFER, size, 0, GL_DYNAMIC_READ);
 	if (!gl_success("glBufferData"))
 		success = false;
 
+done:
 	if (!gl_bind_buffer(GL_PIXEL_PACK_BUFFER, 0))
 		success = false;
 
 	return success;
 }
 
+static inline void stagesurf_delete_sync(struct gs_stage_surface *surf)
+{
+	if (surf->sync) {
+		glDeleteSync(surf->sync);
+		gl_success("glDeleteSync");
+		surf->sync = NULL;
+	}
+}
+
+static inline void stagesurf_insert_sync(struct gs_stage_surface *surf)
+{
+	stagesurf_delete_sync(surf);
+
+	surf->sync = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+	if (!gl_success("glFenceSync"))
+		surf->sync = NULL;
+}
+
 gs_stagesurf_t *device_stagesurface_create(gs_device_t *device, uint32_t width, uint32_t height,
 					   enum gs_color_format color_format)
 {
@@ -68,6 +124,8 @@ gs_stagesurf_t *device_stagesurface_create(gs_device_t *device, uint32_t width,
 void gs_stagesurface_destroy(gs_stagesurf_t *stagesurf)
 {
 	if (stagesurf) {
+		stagesurf_delete_sync(stagesurf);
+
 		if (stagesurf->pack_buffer)
 			gl_delete_buffers(1, &stagesurf->pack_buffer);
 
@@ -138,6 +196,7 @@ void device_stage_texture(gs_device_t *device, gs_stagesurf_t *dst, gs_texture_t
 	if (!gl_success("glReadPixels"))
 		goto failed_unbind_all;
 
+	stagesurf_insert_sync(dst);
 	success = true;
 
 failed_unbind_all:
@@ -170,6 +229,8 @@ void device_stage_texture(gs_device_t *device, gs_stagesurf_t *dst, gs_texture_t
 	if (!gl_success("glGetTexImage"))
 		goto failed;
 
+	stagesurf_insert_sync(dst);
+
 	gl_bind_texture(GL_TEXTURE_2D, 0);
 	gl_bind_buffer(GL_PIXEL_PACK_BUFFER, 0);
 	return;
@@ -199,8 +260,53 @@ enum gs_color_format gs_stagesurface_get_color_format(const gs_stagesurf_t *stag
 	return stagesurf->format;
 }
 
+bool gs_stagesurface_ready(gs_stagesurf_t *stagesurf)
+{
+	GLenum status;
+
+	if (!stagesurf->sync)
+		return true;
+
+	status = glClientWaitSync(stagesurf->sync, GL_SYNC_FLUSH_COMMANDS_BIT, 0);
+	if (!gl_success("glClientWaitSync"))
+		return true;
+
+	return status != GL_TIMEOUT_EXPIRED;
+}
+
+/* 100ms per wait so a lost context can't hang the graphics thread forever */
+#define STAGESURF_WAIT_TIMEOUT_NS 100000000ULL
+#define STAGESURF_WAIT_ATTEMPTS 10
+
+static void stagesurf_wait(struct gs_stage_surface *surf)
+{
+	GLenum status = GL_TIMEOUT_EXPIRED;
+
+	if (!surf->sync)
+		return;
+
+	for (int i = 0; i < STAGESURF_WAIT_ATTEMPTS && status == GL_TIMEOUT_EXPIRED; i++) {
+		status = glClientWaitSync(surf->sync, GL_SYNC_FLUSH_COMMANDS_BIT, STAGESURF_WAIT_TIMEOUT_NS);
+		if (!gl_success("glClientWaitSync"))
+			break;
+	}
+
+	if (status == GL_TIMEOUT_EXPIRED)
+		blog(LOG_WARNING, "stagesurf_wait (GL): timed out waiting for readback");
+
+	stagesurf_delete_sync(surf);
+}
+
 bool gs_stagesurface_map(gs_stagesurf_t *stagesurf, uint8_t **data, uint32_t *linesize)
 {
+	stagesurf_wait(stagesurf);
+
+	if (stagesurf->persistent_data) {
+		*data = stagesurf->persistent_data;
+		*linesize = stagesurf->bytes_per_pixel * stagesurf->width;
+		return true;
+	}
+
 	if (!gl_bind_buffer(GL_PIXEL_PACK_BUFFER, stagesurf->pack_buffer))
 		goto fail;
 
@@ -220,6 +326,9 @@ fail:
 
 void gs_stagesurface_unmap(gs_stagesurf_t *stagesurf)
 {
+	if (stagesurf->persistent_data)
+		return;
+
 	if (!gl_bind_buffer(GL_PIXEL_PACK_BUFFER, stagesurf->pack_buffer))
 		return;
 
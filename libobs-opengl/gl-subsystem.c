@@ -247,6 +247,8 @@ int device_create(gs_device_t **p_device, uint32_t adapter)
 	gl_enable(GL_CULL_FACE);
 	gl_gen_vertex_arrays(1, &device->empty_vao);
 
+	gl_shader_cache_init(device);
+
 	struct gs_sampler_info raw_load_info;
 	raw_load_info.filter = GS_FILTER_POINT;
 	raw_load_info.address_u = GS_ADDRESS_BORDER;
@@ -288,6 +290,7 @@ void device_destroy(gs_device_t *device)
 		gl_delete_vertex_arrays(1, &device->empty_vao);
 
 		da_free(device->proj_stack);
+		gl_shader_cache_free(device);
 		gl_platform_destroy(device->plat);
 		bfree(device);
 	}
@@ -472,6 +472,9 @@ struct gs_shader {
 	enum gs_shader_type type;
 	GLuint obj;
 
+	/* transpiled GLSL, only retained when the shader cache is enabled */
+	char *gl_source;
+
 	struct gs_shader_param *viewproj;
 	struct gs_shader_param *world;
 
@@ -502,6 +505,14 @@ extern struct gs_program *gs_program_create(struct gs_device *device);
 extern void gs_program_destroy(struct gs_program *program);
 extern void program_update_params(struct gs_program *shader);
 
+extern void gl_shader_cache_init(gs_device_t *device);
+extern void gl_shader_cache_free(gs_device_t *device);
+extern bool gl_shader_cache_has_shader(gs_device_t *device, enum gs_shader_type type, const char *glsl);
+extern void gl_shader_cache_add_shader(gs_device_t *device, enum gs_shader_type type, const char *glsl);
+extern bool gl_shader_cache_load_program(struct gs_program *program);
+extern void gl_shader_cache_prepare_program(struct gs_program *program);
+extern void gl_shader_cache_add_program(struct gs_program *program);
+
 struct gs_vertex_buffer {
 	GLuint vao;
 	GLuint vertex_buffer;
@@ -588,6 +599,12 @@ struct gs_stage_surface {
 	GLint gl_internal_format;
 	GLenum gl_type;
 	GLuint pack_buffer;
+
+	/* signaled once the last copy into pack_buffer has completed */
+	GLsync sync;
+
+	/* set when the buffer is persistently mapped (ARB_buffer_storage) */
+	uint8_t *persistent_data;
 };
 
 struct gs_zstencil_buffer {
@@ -646,6 +663,11 @@ struct gs_device {
 
 	struct gs_program *first_program;
 
+	char *shader_cache_path;
+	char *driver_id;
+	uint64_t driver_hash;
+	bool program_binaries;
+
 	enum gs_cull_mode cur_cull_mode;
 	struct gs_rect cur_viewport;
 
@@ -1,11 +1,21 @@
 #include "obs-internal.h"
 #include "pulseaudio-wrapper.h"
 
-#define PULSE_DATA(voidptr) struct audio_monitor *data = voidptr;
 #define blog(level, msg, ...) blog(level, "pulse-am: " msg, ##__VA_ARGS__)
 
-struct audio_monitor {
-	obs_source_t *source;
+/* All monitored sources are mixed into a single bus at the OBS sample rate
+ * and layout, which is then resampled once and played back through a single
+ * PulseAudio stream. */
+
+/* a source that has not sent any audio for this long is no longer waited on
+ * before mixing, so that paused or inactive sources do not stall the bus */
+#define MONITOR_STALE_NS 100000000ULL
+
+/* maximum amount of audio a source may have queued before it is mixed
+ * anyway, limits the latency caused by sources that drift apart */
+#define MONITOR_MAX_BUFFER_NS 200000000ULL
+
+struct monitor_output {
 	pa_stream *stream;
 	char *device;
 	pa_buffer_attr attr;
@@ -18,13 +28,40 @@ struct audio_monitor {
 	uint_fast32_t packets;
 	uint_fast64_t frames;
 
-	struct deque new_data;
 	audio_resampler_t *resampler;
+};
+
+struct monitor_bus {
+	struct monitor_output out;
+	char *device_id;
+	long refs;
+
+	size_t channels;
+	uint32_t samples_per_sec;
+
+	DARRAY(struct audio_monitor *) inputs;
+	DARRAY(float) mix[MAX_AUDIO_CHANNELS];
+	DARRAY(float) scratch;
+	struct deque new_data;
+
+	pthread_mutex_t mutex;
+};
+
+struct audio_monitor {
+	obs_source_t *source;
+	struct monitor_bus *bus;
+
+	struct deque buffer[MAX_AUDIO_CHANNELS];
+	uint64_t last_data_ns;
 
 	bool ignore;
-	pthread_mutex_t playback_mutex;
 };
 
+/* the bus is created with the first monitor and destroyed with the last one,
+ * its reference count is protected by monitor_bus_mutex */
+static struct monitor_bus *monitor_bus = NULL;
+static pthread_mutex_t monitor_bus_mutex = PTHREAD_MUTEX_INITIALIZER;
+
 static enum speaker_layout pulseaudio_channels_to_obs_speakers(uint_fast32_t channels)
 {
 	switch (channels) {
@@ -120,153 +157,165 @@ static pa_channel_map pulseaudio_channel_map(enum speaker_layout layout)
 	return ret;
 }
 
-static void process_byte(void *p, size_t frames, size_t channels, float vol)
-{
-	register uint8_t *cur = (uint8_t *)p;
-	register uint8_t *end = cur + frames * channels;
-
-	for (; cur < end; cur++)
-		*cur = ((int)*cur - 128) * vol + 128;
-}
-
-static void process_s16(void *p, size_t frames, size_t channels, float vol)
+static void do_stream_write(struct monitor_bus *bus)
 {
-	register int16_t *cur = (int16_t *)p;
-	register int16_t *end = cur + frames * channels;
-
-	while (cur < end)
-		*(cur++) *= vol;
-}
-
-static void process_s32(void *p, size_t frames, size_t channels, float vol)
-{
-	register int32_t *cur = (int32_t *)p;
-	register int32_t *end = cur + frames * channels;
-
-	while (cur < end)
-		*(cur++) *= vol;
-}
-
-static void process_float(void *p, size_t frames, size_t channels, float vol)
-{
-	register float *cur = (float *)p;
-	register float *end = cur + frames * channels;
-
-	while (cur < end)
-		*(cur++) *= vol;
-}
-
-void process_volume(const struct audio_monitor *monitor, float vol, uint8_t *const *resample_data,
-		    uint32_t resample_frames)
-{
-	switch (monitor->format) {
-	case PA_SAMPLE_U8:
-		process_byte(resample_data[0], resample_frames, monitor->channels, vol);
-		break;
-	case PA_SAMPLE_S16LE:
-		process_s16(resample_data[0], resample_frames, monitor->channels, vol);
-		break;
-	case PA_SAMPLE_S32LE:
-		process_s32(resample_data[0], resample_frames, monitor->channels, vol);
-		break;
-	case PA_SAMPLE_FLOAT32LE:
-		process_float(resample_data[0], resample_frames, monitor->channels, vol);
-		break;
-	default:
-		// just ignore
-		break;
-	}
-}
-
-static void do_stream_write(void *param)
-{
-	PULSE_DATA(param);
+	struct monitor_output *out = &bus->out;
 	uint8_t *buffer = NULL;
 
 	pulseaudio_lock();
-	pthread_mutex_lock(&data->playback_mutex);
+	pthread_mutex_lock(&bus->mutex);
 
 	// If we have grown a large buffer internally, grow the pulse buffer to match so we can write our data out.
-	if (data->new_data.size > data->attr.tlength * 2) {
-		data->attr.fragsize = (uint32_t)-1;
-		data->attr.maxlength = (uint32_t)-1;
-		data->attr.prebuf = (uint32_t)-1;
-		data->attr.minreq = (uint32_t)-1;
-		data->attr.tlength = data->new_data.size;
-		pa_stream_set_buffer_attr(data->stream, &data->attr, NULL, NULL);
+	if (bus->new_data.size > out->attr.tlength * 2) {
+		out->attr.fragsize = (uint32_t)-1;
+		out->attr.maxlength = (uint32_t)-1;
+		out->attr.prebuf = (uint32_t)-1;
+		out->attr.minreq = (uint32_t)-1;
+		out->attr.tlength = bus->new_data.size;
+		pa_stream_set_buffer_attr(out->stream, &out->attr, NULL, NULL);
 	}
 
 	// Buffer up enough data before we start playing.
-	if (pa_stream_is_corked(data->stream)) {
-		if (data->new_data.size >= data->attr.tlength) {
-			pa_stream_cork(data->stream, 0, NULL, NULL);
+	if (pa_stream_is_corked(out->stream)) {
+		if (bus->new_data.size >= out->attr.tlength) {
+			pa_stream_cork(out->stream, 0, NULL, NULL);
 		} else {
 			goto finish;
 		}
 	}
 
-	while (data->new_data.size > 0) {
-		size_t bytesToFill = data->new_data.size;
-		if (pa_stream_begin_write(data->stream, (void **)&buffer, &bytesToFill))
+	while (bus->new_data.size > 0) {
+		size_t bytesToFill = bus->new_data.size;
+		if (pa_stream_begin_write(out->stream, (void **)&buffer, &bytesToFill))
 			goto finish;
 
 		// PA may request we submit more or less data than we have.
 		// Wait for more data if we cannot perform a full write.
-		if (bytesToFill > data->new_data.size) {
-			pa_stream_cancel_write(data->stream);
+		if (bytesToFill > bus->new_data.size) {
+			pa_stream_cancel_write(out->stream);
 			goto finish;
 		}
 
-		deque_pop_front(&data->new_data, buffer, bytesToFill);
+		deque_pop_front(&bus->new_data, buffer, bytesToFill);
 
-		pa_stream_write(data->stream, buffer, bytesToFill, NULL, 0LL, PA_SEEK_RELATIVE);
+		pa_stream_write(out->stream, buffer, bytesToFill, NULL, 0LL, PA_SEEK_RELATIVE);
 	}
 
 finish:
-	pthread_mutex_unlock(&data->playback_mutex);
+	pthread_mutex_unlock(&bus->mutex);
 	pulseaudio_unlock();
 }
 
-static void on_audio_playback(void *param, obs_source_t *source, const struct audio_data *audio_data, bool muted)
+static inline size_t monitor_buffered_frames(const struct audio_monitor *monitor)
 {
-	struct audio_monitor *monitor = param;
-	float vol = source->user_volume;
-	size_t bytes;
+	return monitor->buffer[0].size / sizeof(float);
+}
+
+/* Mixes as much audio as every source that is currently sending audio has
+ * queued up, then resamples the mix once for the output stream.  Must be
+ * called with the bus mutex held. */
+static void monitor_bus_mix(struct monitor_bus *bus)
+{
+	struct monitor_output *out = &bus->out;
+	uint64_t now = os_gettime_ns();
+	size_t max_buffer = (size_t)util_mul_div64(MONITOR_MAX_BUFFER_NS, bus->samples_per_sec, 1000000000ULL);
+	size_t frames = SIZE_MAX;
+	size_t max_frames = 0;
+
+	for (size_t i = 0; i < bus->inputs.num; i++) {
+		struct audio_monitor *monitor = bus->inputs.array[i];
+		size_t buffered = monitor_buffered_frames(monitor);
+		bool stale = now - monitor->last_data_ns > MONITOR_STALE_NS;
+
+		if (buffered > max_frames)
+			max_frames = buffered;
+		if (!stale && buffered < frames)
+			frames = buffered;
+	}
+
+	if (frames == SIZE_MAX)
+		frames = max_frames;
+	if (max_frames > frames + max_buffer)
+		frames = max_frames - max_buffer;
+	if (!frames)
+		return;
+
+	for (size_t ch = 0; ch < bus->channels; ch++) {
+		da_resize(bus->mix[ch], frames);
+		memset(bus->mix[ch].array, 0, frames * sizeof(float));
+	}
+
+	da_resize(bus->scratch, frames);
+
+	for (size_t i = 0; i < bus->inputs.num; i++) {
+		struct audio_monitor *monitor = bus->inputs.array[i];
+		size_t count = monitor_buffered_frames(monitor);
+
+		if (count > frames)
+			count = frames;
+
+		for (size_t ch = 0; ch < bus->channels; ch++) {
+			float *mix = bus->mix[ch].array;
+			float *in = bus->scratch.array;
+
+			deque_pop_front(&monitor->buffer[ch], in, count * sizeof(float));
 
+			for (size_t j = 0; j < count; j++)
+				mix[j] += in[j];
+		}
+	}
+
+	const uint8_t *mix_data[MAX_AV_PLANES] = {0};
 	uint8_t *resample_data[MAX_AV_PLANES];
 	uint32_t resample_frames;
 	uint64_t ts_offset;
-	bool success;
 
-	if (pthread_mutex_trylock(&monitor->playback_mutex) != 0)
+	for (size_t ch = 0; ch < bus->channels; ch++)
+		mix_data[ch] = (const uint8_t *)bus->mix[ch].array;
+
+	if (!audio_resampler_resample(out->resampler, resample_data, &resample_frames, &ts_offset, mix_data,
+				      (uint32_t)frames))
 		return;
 
+	deque_push_back(&bus->new_data, resample_data[0], out->bytes_per_frame * resample_frames);
+	out->packets++;
+	out->frames += resample_frames;
+}
+
+static void on_audio_playback(void *param, obs_source_t *source, const struct audio_data *audio_data, bool muted)
+{
+	struct audio_monitor *monitor = param;
+	struct monitor_bus *bus = monitor->bus;
+	float vol = source->user_volume;
+	size_t frames = audio_data->frames;
+
 	if (os_atomic_load_long(&source->activate_refs) == 0)
-		goto unlock;
+		return;
+
+	pthread_mutex_lock(&bus->mutex);
 
-	success = audio_resampler_resample(monitor->resampler, resample_data, &resample_frames, &ts_offset,
-					   (const uint8_t *const *)audio_data->data, (uint32_t)audio_data->frames);
+	for (size_t ch = 0; ch < bus->channels; ch++) {
+		const float *in = (const float *)audio_data->data[ch];
 
-	if (!success)
-		goto unlock;
+		if (muted || !in) {
+			deque_push_back_zero(&monitor->buffer[ch], frames * sizeof(float));
 
-	bytes = monitor->bytes_per_frame * resample_frames;
+		} else if (close_float(vol, 1.0f, EPSILON)) {
+			deque_push_back(&monitor->buffer[ch], in, frames * sizeof(float));
 
-	if (muted) {
-		memset(resample_data[0], 0, bytes);
-	} else {
-		if (!close_float(vol, 1.0f, EPSILON)) {
-			process_volume(monitor, vol, resample_data, resample_frames);
+		} else {
+			da_resize(bus->scratch, frames);
+			for (size_t i = 0; i < frames; i++)
+				bus->scratch.array[i] = in[i] * vol;
+			deque_push_back(&monitor->buffer[ch], bus->scratch.array, frames * sizeof(float));
 		}
 	}
 
-	deque_push_back(&monitor->new_data, resample_data[0], bytes);
-	monitor->packets++;
-	monitor->frames += resample_frames;
+	monitor->last_data_ns = os_gettime_ns();
+	monitor_bus_mix(bus);
 
-unlock:
-	pthread_mutex_unlock(&monitor->playback_mutex);
-	do_stream_write(param);
+	pthread_mutex_unlock(&bus->mutex);
+	do_stream_write(bus);
 }
 
 static void pulseaudio_server_info(pa_context *c, const pa_server_info *i, void *userdata)
@@ -282,10 +331,10 @@ static void pulseaudio_server_info(pa_context *c, const pa_server_info *i, void
 static void pulseaudio_sink_info(pa_context *c, const pa_sink_info *i, int eol, void *userdata)
 {
 	UNUSED_PARAMETER(c);
-	PULSE_DATA(userdata);
+	struct monitor_output *out = userdata;
 	// An error occurred
 	if (eol < 0) {
-		data->format = PA_SAMPLE_INVALID;
+		out->format = PA_SAMPLE_INVALID;
 		goto skip;
 	}
 	// Terminating call for multi instance callbacks
@@ -315,90 +364,67 @@ static void pulseaudio_sink_info(pa_context *c, const pa_sink_info *i, int eol,
 		     i->sample_spec.channels, channels);
 	}
 
-	data->format = format;
-	data->samples_per_sec = i->sample_spec.rate;
-	data->channels = channels;
+	out->format = format;
+	out->samples_per_sec = i->sample_spec.rate;
+	out->channels = channels;
 skip:
 	pulseaudio_signal(0);
 }
 
-static void pulseaudio_stop_playback(struct audio_monitor *monitor)
+static void pulseaudio_stop_playback(struct monitor_output *out)
 {
-	if (monitor->stream) {
+	if (out->stream) {
 		/* Stop the stream */
 		pulseaudio_lock();
-		pa_stream_disconnect(monitor->stream);
+		pa_stream_disconnect(out->stream);
 		pulseaudio_unlock();
 
 		/* Remove the callbacks, to ensure we no longer try to do anything
 		 * with this stream object */
-		pulseaudio_write_callback(monitor->stream, NULL, NULL);
+		pulseaudio_write_callback(out->stream, NULL, NULL);
 
 		/* Unreference the stream and drop it. PA will free it when it can. */
 		pulseaudio_lock();
-		pa_stream_unref(monitor->stream);
+		pa_stream_unref(out->stream);
 		pulseaudio_unlock();
-		monitor->stream = NULL;
+		out->stream = NULL;
 	}
 
-	blog(LOG_INFO, "Stopped Monitoring in '%s'", monitor->device);
-	blog(LOG_INFO, "Got %" PRIuFAST32 " packets with %" PRIuFAST64 " frames", monitor->packets, monitor->frames);
+	blog(LOG_INFO, "Stopped Monitoring in '%s'", out->device);
+	blog(LOG_INFO, "Got %" PRIuFAST32 " packets with %" PRIuFAST64 " frames", out->packets, out->frames);
 
-	monitor->packets = 0;
-	monitor->frames = 0;
+	out->packets = 0;
+	out->frames = 0;
 }
 
-static bool audio_monitor_init(struct audio_monitor *monitor, obs_source_t *source)
+static bool monitor_output_open(struct monitor_output *out, const char *id)
 {
-	pthread_mutex_init_value(&monitor->playback_mutex);
-
-	monitor->source = source;
-
-	const char *id = obs->audio.monitoring_device_id;
-	if (!id)
-		return false;
-
-	if (source->info.output_flags & OBS_SOURCE_DO_NOT_SELF_MONITOR) {
-		obs_data_t *s = obs_source_get_settings(source);
-		const char *s_dev_id = obs_data_get_string(s, "device_id");
-		bool match = devices_match(s_dev_id, id);
-		obs_data_release(s);
-
-		if (match) {
-			monitor->ignore = true;
-			blog(LOG_INFO, "Prevented feedback-loop in '%s'", s_dev_id);
-			return true;
-		}
-	}
-
-	pulseaudio_init();
-
 	if (strcmp(id, "default") == 0)
-		get_default_id(&monitor->device);
+		get_default_id(&out->device);
 	else
-		monitor->device = bstrdup(id);
+		out->device = bstrdup(id);
 
-	if (!monitor->device)
+	if (!out->device)
 		return false;
 
-	if (pulseaudio_get_server_info(pulseaudio_server_info, (void *)monitor) < 0) {
+	if (pulseaudio_get_server_info(pulseaudio_server_info, (void *)out) < 0) {
 		blog(LOG_ERROR, "Unable to get server info !");
 		return false;
 	}
 
-	if (pulseaudio_get_sink_info(pulseaudio_sink_info, monitor->device, (void *)monitor) < 0) {
+	if (pulseaudio_get_sink_info(pulseaudio_sink_info, out->device, (void *)out) < 0) {
 		blog(LOG_ERROR, "Unable to get sink info !");
 		return false;
 	}
-	if (monitor->format == PA_SAMPLE_INVALID) {
+	if (out->format == PA_SAMPLE_INVALID) {
 		blog(LOG_ERROR, "An error occurred while getting the source info!");
 		return false;
 	}
 
 	pa_sample_spec spec;
-	spec.format = monitor->format;
-	spec.rate = (uint32_t)monitor->samples_per_sec;
-	spec.channels = monitor->channels;
+	spec.format = out->format;
+	spec.rate = (uint32_t)out->samples_per_sec;
+	spec.channels = out->channels;
 
 	if (!pa_sample_spec_valid(&spec)) {
 		blog(LOG_ERROR, "Sample spec is not valid");
@@ -410,70 +436,205 @@ static bool audio_monitor_init(struct audio_monitor *monitor, obs_source_t *sour
 	struct resample_info from = {.samples_per_sec = info->samples_per_sec,
 				     .speakers = info->speakers,
 				     .format = AUDIO_FORMAT_FLOAT_PLANAR};
-	struct resample_info to = {.samples_per_sec = (uint32_t)monitor->samples_per_sec,
-				   .speakers = pulseaudio_channels_to_obs_speakers(monitor->channels),
-				   .format = pulseaudio_to_obs_audio_format(monitor->format)};
+	struct resample_info to = {.samples_per_sec = (uint32_t)out->samples_per_sec,
+				   .speakers = pulseaudio_channels_to_obs_speakers(out->channels),
+				   .format = pulseaudio_to_obs_audio_format(out->format)};
 
-	monitor->resampler = audio_resampler_create(&to, &from);
-	if (!monitor->resampler) {
+	out->resampler = audio_resampler_create(&to, &from);
+	if (!out->resampler) {
 		blog(LOG_WARNING, "%s: %s", __FUNCTION__, "Failed to create resampler");
 		return false;
 	}
 
-	monitor->speakers = pulseaudio_channels_to_obs_speakers(spec.channels);
-	monitor->bytes_per_frame = pa_frame_size(&spec);
+	out->speakers = pulseaudio_channels_to_obs_speakers(spec.channels);
+	out->bytes_per_frame = pa_frame_size(&spec);
 
-	pa_channel_map channel_map = pulseaudio_channel_map(monitor->speakers);
+	pa_channel_map channel_map = pulseaudio_channel_map(out->speakers);
 
-	monitor->stream = pulseaudio_stream_new(obs_source_get_name(monitor->source), &spec, &channel_map);
-	if (!monitor->stream) {
+	out->stream = pulseaudio_stream_new("Monitoring", &spec, &channel_map);
+	if (!out->stream) {
 		blog(LOG_ERROR, "Unable to create stream");
 		return false;
 	}
 
-	monitor->attr.fragsize = (uint32_t)-1;
-	monitor->attr.maxlength = (uint32_t)-1;
-	monitor->attr.minreq = (uint32_t)-1;
-	monitor->attr.prebuf = (uint32_t)-1;
-	monitor->attr.tlength = pa_usec_to_bytes(25000, &spec);
+	out->attr.fragsize = (uint32_t)-1;
+	out->attr.maxlength = (uint32_t)-1;
+	out->attr.minreq = (uint32_t)-1;
+	out->attr.prebuf = (uint32_t)-1;
+	out->attr.tlength = pa_usec_to_bytes(25000, &spec);
 
 	pa_stream_flags_t flags = PA_STREAM_INTERPOLATE_TIMING | PA_STREAM_AUTO_TIMING_UPDATE | PA_STREAM_START_CORKED;
 
-	int_fast32_t ret = pulseaudio_connect_playback(monitor->stream, monitor->device, &monitor->attr, flags);
+	int_fast32_t ret = pulseaudio_connect_playback(out->stream, out->device, &out->attr, flags);
 	if (ret < 0) {
-		pulseaudio_stop_playback(monitor);
+		pulseaudio_stop_playback(out);
 		blog(LOG_ERROR, "Unable to connect to stream");
 		return false;
 	}
 
-	blog(LOG_INFO, "Started Monitoring in '%s'", monitor->device);
+	blog(LOG_INFO, "Started Monitoring in '%s'", out->device);
 	return true;
 }
 
+static void monitor_output_close(struct monitor_output *out)
+{
+	if (out->stream)
+		pulseaudio_stop_playback(out);
+
+	audio_resampler_destroy(out->resampler);
+	bfree(out->device);
+	memset(out, 0, sizeof(*out));
+}
+
+/* Moves the bus to another device while keeping its inputs attached.  The
+ * new stream is fully set up before it is swapped in, so sources keep
+ * mixing into the old one in the meantime. */
+static bool monitor_bus_reconnect(struct monitor_bus *bus, const char *id)
+{
+	struct monitor_output out = {0};
+	struct monitor_output old;
+
+	if (!monitor_output_open(&out, id)) {
+		monitor_output_close(&out);
+		return false;
+	}
+
+	pthread_mutex_lock(&bus->mutex);
+	old = bus->out;
+	bus->out = out;
+	/* queued data is in the format of the old stream */
+	deque_free(&bus->new_data);
+	pthread_mutex_unlock(&bus->mutex);
+
+	monitor_output_close(&old);
+
+	bfree(bus->device_id);
+	bus->device_id = bstrdup(id);
+	return true;
+}
+
+/* Must be called with monitor_bus_mutex held. */
+static struct monitor_bus *monitor_bus_acquire(const char *id)
+{
+	struct monitor_bus *bus = monitor_bus;
+
+	if (bus) {
+		if (strcmp(bus->device_id, id) != 0 && !monitor_bus_reconnect(bus, id))
+			return NULL;
+
+		bus->refs++;
+		return bus;
+	}
+
+	bus = bzalloc(sizeof(*bus));
+
+	pulseaudio_init();
+
+	if (!monitor_output_open(&bus->out, id)) {
+		monitor_output_close(&bus->out);
+		pulseaudio_unref();
+		bfree(bus);
+		return NULL;
+	}
+
+	const struct audio_output_info *info = audio_output_get_info(obs->audio.audio);
+
+	bus->device_id = bstrdup(id);
+	bus->channels = get_audio_channels(info->speakers);
+	bus->samples_per_sec = info->samples_per_sec;
+	bus->refs = 1;
+	pthread_mutex_init(&bus->mutex, NULL);
+
+	monitor_bus = bus;
+	return bus;
+}
+
+/* Must be called with monitor_bus_mutex held. */
+static void monitor_bus_release(struct monitor_bus *bus)
+{
+	if (--bus->refs > 0)
+		return;
+
+	monitor_bus = NULL;
+
+	monitor_output_close(&bus->out);
+	pulseaudio_unref();
+
+	for (size_t ch = 0; ch < MAX_AUDIO_CHANNELS; ch++)
+		da_free(bus->mix[ch]);
+	da_free(bus->scratch);
+	da_free(bus->inputs);
+	deque_free(&bus->new_data);
+
+	pthread_mutex_destroy(&bus->mutex);
+	bfree(bus->device_id);
+	bfree(bus);
+}
+
+static bool audio_monitor_init(struct audio_monitor *monitor, obs_source_t *source)
+{
+	monitor->source = source;
+
+	const char *id = obs->audio.monitoring_device_id;
+	if (!id)
+		return false;
+
+	if (source->info.output_flags & OBS_SOURCE_DO_NOT_SELF_MONITOR) {
+		obs_data_t *s = obs_source_get_settings(source);
+		const char *s_dev_id = obs_data_get_string(s, "device_id");
+		bool match = devices_match(s_dev_id, id);
+		obs_data_release(s);
+
+		if (match) {
+			monitor->ignore = true;
+			blog(LOG_INFO, "Prevented feedback-loop in '%s'", s_dev_id);
+			return true;
+		}
+	}
+
+	pthread_mutex_lock(&monitor_bus_mutex);
+	monitor->bus = monitor_bus_acquire(id);
+	pthread_mutex_unlock(&monitor_bus_mutex);
+
+	return monitor->bus != NULL;
+}
+
 static void audio_monitor_init_final(struct audio_monitor *monitor)
 {
+	struct monitor_bus *bus = monitor->bus;
+
 	if (monitor->ignore)
 		return;
 
+	pthread_mutex_lock(&bus->mutex);
+	da_push_back(bus->inputs, &monitor);
+	pthread_mutex_unlock(&bus->mutex);
+
 	obs_source_add_audio_capture_callback(monitor->source, on_audio_playback, monitor);
 }
 
 static inline void audio_monitor_free(struct audio_monitor *monitor)
 {
-	if (monitor->ignore)
+	struct monitor_bus *bus = monitor->bus;
+
+	if (monitor->ignore || !bus)
 		return;
 
 	if (monitor->source)
 		obs_source_remove_audio_capture_callback(monitor->source, on_audio_playback, monitor);
 
-	audio_resampler_destroy(monitor->resampler);
-	deque_free(&monitor->new_data);
+	pthread_mutex_lock(&bus->mutex);
+	da_erase_item(bus->inputs, &monitor);
+	pthread_mutex_unlock(&bus->mutex);
 
-	if (monitor->stream)
-		pulseaudio_stop_playback(monitor);
-	pulseaudio_unref();
+	for (size_t ch = 0; ch < MAX_AUDIO_CHANNELS; ch++)
+		deque_free(&monitor->buffer[ch]);
 
-	bfree(monitor->device);
+	pthread_mutex_lock(&monitor_bus_mutex);
+	monitor_bus_release(bus);
+	pthread_mutex_unlock(&monitor_bus_mutex);
+
+	monitor->bus = NULL;
 }
 
 struct audio_monitor *audio_monitor_create(obs_source_t *source)
@@ -501,18 +662,11 @@ fail:
 void audio_monitor_reset(struct audio_monitor *monitor)
 {
 	struct audio_monitor new_monitor = {0};
-	bool success;
 	audio_monitor_free(monitor);
 
-	pthread_mutex_lock(&monitor->playback_mutex);
-	success = audio_monitor_init(&new_monitor, monitor->source);
-	pthread_mutex_unlock(&monitor->playback_mutex);
-
-	if (success) {
+	if (audio_monitor_init(&new_monitor, monitor->source)) {
 		*monitor = new_monitor;
 		audio_monitor_init_final(monitor);
-	} else {
-		audio_monitor_free(&new_monitor);
 	}
 }
 
@@ -146,6 +146,7 @@ bool load_graphics_imports(struct gs_exports *exports, void *module, const char
 	GRAPHICS_IMPORT(gs_stagesurface_get_color_format);
 	GRAPHICS_IMPORT(gs_stagesurface_map);
 	GRAPHICS_IMPORT(gs_stagesurface_unmap);
+	GRAPHICS_IMPORT_OPTIONAL(gs_stagesurface_ready);
 
 	GRAPHICS_IMPORT(gs_zstencil_destroy);
 
@@ -204,6 +205,8 @@ bool load_graphics_imports(struct gs_exports *exports, void *module, const char
 
 	GRAPHICS_IMPORT_OPTIONAL(gs_get_adapter_count);
 
+	GRAPHICS_IMPORT_OPTIONAL(device_set_shader_cache_path);
+
 	/* OSX/Cocoa specific functions */
 #ifdef __APPLE__
 	GRAPHICS_IMPORT(device_shared_texture_available);
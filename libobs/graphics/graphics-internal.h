@@ -150,6 +150,7 @@ struct gs_exports {
 	enum gs_color_format (*gs_stagesurface_get_color_format)(const gs_stagesurf_t *stagesurf);
 	bool (*gs_stagesurface_map)(gs_stagesurf_t *stagesurf, uint8_t **data, uint32_t *linesize);
 	void (*gs_stagesurface_unmap)(gs_stagesurf_t *stagesurf);
+	bool (*gs_stagesurface_ready)(gs_stagesurf_t *stagesurf);
 
 	void (*gs_zstencil_destroy)(gs_zstencil_t *zstencil);
 
@@ -210,6 +211,8 @@ struct gs_exports {
 
 	uint32_t (*gs_get_adapter_count)(void);
 
+	void (*device_set_shader_cache_path)(gs_device_t *device, const char *path);
+
 #ifdef __APPLE__
 	/* OSX/Cocoa specific functions */
 	gs_texture_t *(*device_texture_create_from_iosurface)(gs_device_t *dev, void *iosurf);
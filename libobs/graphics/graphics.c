@@ -2568,6 +2568,18 @@ void gs_stagesurface_unmap(gs_stagesurf_t *stagesurf)
 	graphics->exports.gs_stagesurface_unmap(stagesurf);
 }
 
+bool gs_stagesurface_ready(gs_stagesurf_t *stagesurf)
+{
+	graphics_t *graphics = thread_graphics;
+
+	if (!gs_valid_p("gs_stagesurface_ready", stagesurf))
+		return false;
+	if (!graphics->exports.gs_stagesurface_ready)
+		return true;
+
+	return graphics->exports.gs_stagesurface_ready(stagesurf);
+}
+
 void gs_zstencil_destroy(gs_zstencil_t *zstencil)
 {
 	if (!gs_valid("gs_zstencil_destroy"))
@@ -2906,6 +2918,16 @@ bool gs_texture_create_p010(gs_texture_t **tex_y, gs_texture_t **tex_uv, uint32_
 	return true;
 }
 
+void gs_set_shader_cache_path(const char *path)
+{
+	if (!gs_valid("gs_set_shader_cache_path"))
+		return;
+	if (!thread_graphics->exports.device_set_shader_cache_path)
+		return;
+
+	thread_graphics->exports.device_set_shader_cache_path(thread_graphics->device, path);
+}
+
 uint32_t gs_get_adapter_count(void)
 {
 	if (!gs_valid("gs_get_adapter_count"))
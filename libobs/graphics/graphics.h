@@ -506,6 +506,13 @@ EXPORT int gs_get_device_type(void);
 EXPORT uint32_t gs_get_adapter_count(void);
 EXPORT void gs_enum_adapters(bool (*callback)(void *param, const char *name, uint32_t id), void *param);
 
+/**
+ * Sets the directory used to cache compiled shaders and programs across
+ * sessions.  Must be called before creating effects to be useful.  Passing
+ * NULL disables the cache.  Not all graphics modules support caching.
+ */
+EXPORT void gs_set_shader_cache_path(const char *path);
+
 EXPORT int gs_create(graphics_t **graphics, const char *module, uint32_t adapter);
 EXPORT void gs_destroy(graphics_t *graphics);
 
@@ -753,6 +760,13 @@ EXPORT enum gs_color_format gs_stagesurface_get_color_format(const gs_stagesurf_
 EXPORT bool gs_stagesurface_map(gs_stagesurf_t *stagesurf, uint8_t **data, uint32_t *linesize);
 EXPORT void gs_stagesurface_unmap(gs_stagesurf_t *stagesurf);
 
+/**
+ * Returns whether the last copy into the staging surface has completed, i.e.
+ * whether gs_stagesurface_map can be called without stalling.  Does not
+ * block.  Always returns true if the renderer cannot tell.
+ */
+EXPORT bool gs_stagesurface_ready(gs_stagesurf_t *stagesurf);
+
 EXPORT void gs_zstencil_destroy(gs_zstencil_t *zstencil);
 
 EXPORT void gs_samplerstate_destroy(gs_samplerstate_t *samplerstate);
@@ -23,9 +23,17 @@
 
 #define blog(level, format, ...) blog(level, "%s: " format, __FUNCTION__, __VA_ARGS__)
 
+static int image_memory_tag(void)
+{
+	static int tag = -1;
+	if (tag < 0)
+		tag = bmem_get_tag("image-files");
+	return tag;
+}
+
 static void *bi_def_bitmap_create(int width, int height)
 {
-	return bmalloc((size_t)4 * width * height);
+	return bmalloc_tagged((size_t)4 * width * height, image_memory_tag());
 }
 
 static void bi_def_bitmap_set_opaque(void *bitmap, bool opaque)
@@ -66,7 +74,7 @@ static inline void *alloc_mem(gs_image_file_t *image, uint64_t *mem_usage, size_
 
 	if (mem_usage)
 		*mem_usage += size;
-	return bzalloc(size);
+	return bzalloc_tagged(size, image_memory_tag());
 }
 
 static bool init_animated_gif(gs_image_file_t *image, const char *path, uint64_t *mem_usage,
@@ -199,8 +207,10 @@ static void gs_image_file_init_internal(gs_image_file_t *image, const char *file
 		}
 	}
 
+	int prev_tag = bmem_set_thread_tag(image_memory_tag());
 	image->texture_data =
 		gs_create_texture_file_data3(file, alpha_mode, &image->format, &image->cx, &image->cy, space);
+	bmem_set_thread_tag(prev_tag);
 
 	if (mem_usage) {
 		*mem_usage += image->cx * image->cy * gs_get_format_bpp(image->format) / 8;
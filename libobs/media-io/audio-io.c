@@ -129,7 +129,7 @@ static inline void do_audio_output(struct audio_output *audio, size_t mix_idx, u
 	pthread_mutex_unlock(&audio->input_mutex);
 }
 
-static inline void clamp_audio_output(struct audio_output *audio, size_t bytes)
+static inline void clamp_audio_output(struct audio_output *audio, uint32_t active_mixes, size_t bytes)
 {
 	size_t float_size = bytes / sizeof(float);
 
@@ -137,7 +137,7 @@ static inline void clamp_audio_output(struct audio_output *audio, size_t bytes)
 		struct audio_mix *mix = &audio->mixes[mix_idx];
 
 		/* do not process mixing if a specific mix is inactive */
-		if (!mix->inputs.num)
+		if ((active_mixes & (1 << mix_idx)) == 0)
 			continue;
 
 		for (size_t plane = 0; plane < audio->planes; plane++) {
@@ -179,11 +179,13 @@ static void input_and_output(struct audio_output *audio, uint64_t audio_time, ui
 	}
 	pthread_mutex_unlock(&audio->input_mutex);
 
-	/* clear mix buffers */
+	/* clear mix buffers, inactive mixes are left alone since nothing
+	 * renders into or reads from them this tick */
 	for (size_t mix_idx = 0; mix_idx < MAX_AUDIO_MIXES; mix_idx++) {
 		struct audio_mix *mix = &audio->mixes[mix_idx];
 
-		memset(mix->buffer, 0, sizeof(mix->buffer));
+		if ((active_mixes & (1 << mix_idx)) != 0)
+			memset(mix->buffer, 0, sizeof(mix->buffer));
 
 		for (size_t i = 0; i < audio->planes; i++)
 			data[mix_idx].data[i] = mix->buffer[i];
@@ -195,11 +197,14 @@ static void input_and_output(struct audio_output *audio, uint64_t audio_time, ui
 		return;
 
 	/* clamps audio data to -1.0..1.0 */
-	clamp_audio_output(audio, bytes);
+	clamp_audio_output(audio, active_mixes, bytes);
 
-	/* output */
-	for (size_t i = 0; i < MAX_AUDIO_MIXES; i++)
-		do_audio_output(audio, i, new_ts, AUDIO_OUTPUT_FRAMES);
+	/* output, inputs connected since the mixers were fetched get their
+	 * first data on the next tick */
+	for (size_t i = 0; i < MAX_AUDIO_MIXES; i++) {
+		if ((active_mixes & (1 << i)) != 0)
+			do_audio_output(audio, i, new_ts, AUDIO_OUTPUT_FRAMES);
+	}
 }
 
 static void *audio_thread(void *param)
@@ -17,6 +17,8 @@
 
 #include "format-conversion.h"
 
+#include <string.h>
+
 #include "../util/sse-intrin.h"
 
 /* ...surprisingly, if I don't use a macro to force inlining, it causes the
@@ -286,3 +288,169 @@ void decompress_422(const uint8_t *input, uint32_t in_linesize, uint32_t start_y
 		}
 	}
 }
+
+/* ------------------------------------------------------------------------- */
+/* same size layout conversions and half size downscaling, used by the video
+ * scaler.  start_y and end_y are rows of the output. */
+
+void convert_nv12_to_i420(const uint8_t *const input[], const uint32_t in_linesize[], uint32_t width,
+			  uint32_t start_y, uint32_t end_y, uint8_t *output[], const uint32_t out_linesize[])
+{
+	const __m128i lo_mask = _mm_set1_epi16(0x00FF);
+	uint32_t width_d2 = (width + 1) / 2;
+	uint32_t y;
+
+	for (y = start_y; y < end_y; y++)
+		memcpy(output[0] + y * out_linesize[0], input[0] + y * in_linesize[0], width);
+
+	for (y = start_y / 2; y < (end_y + 1) / 2; y++) {
+		const uint8_t *chroma = input[1] + y * in_linesize[1];
+		uint8_t *u = output[1] + y * out_linesize[1];
+		uint8_t *v = output[2] + y * out_linesize[2];
+		uint32_t x = 0;
+
+		for (; x + 16 <= width_d2; x += 16) {
+			__m128i uv0 = _mm_loadu_si128((const __m128i *)(chroma + x * 2));
+			__m128i uv1 = _mm_loadu_si128((const __m128i *)(chroma + x * 2 + 16));
+
+			__m128i u_val = _mm_packus_epi16(_mm_and_si128(uv0, lo_mask), _mm_and_si128(uv1, lo_mask));
+			__m128i v_val = _mm_packus_epi16(_mm_srli_epi16(uv0, 8), _mm_srli_epi16(uv1, 8));
+
+			_mm_storeu_si128((__m128i *)(u + x), u_val);
+			_mm_storeu_si128((__m128i *)(v + x), v_val);
+		}
+
+		for (; x < width_d2; x++) {
+			u[x] = chroma[x * 2];
+			v[x] = chroma[x * 2 + 1];
+		}
+	}
+}
+
+void convert_i420_to_nv12(const uint8_t *const input[], const uint32_t in_linesize[], uint32_t width,
+			  uint32_t start_y, uint32_t end_y, uint8_t *output[], const uint32_t out_linesize[])
+{
+	uint32_t width_d2 = (width + 1) / 2;
+	uint32_t y;
+
+	for (y = start_y; y < end_y; y++)
+		memcpy(output[0] + y * out_linesize[0], input[0] + y * in_linesize[0], width);
+
+	for (y = start_y / 2; y < (end_y + 1) / 2; y++) {
+		const uint8_t *u = input[1] + y * in_linesize[1];
+		const uint8_t *v = input[2] + y * in_linesize[2];
+		uint8_t *chroma = output[1] + y * out_linesize[1];
+		uint32_t x = 0;
+
+		for (; x + 16 <= width_d2; x += 16) {
+			__m128i u_val = _mm_loadu_si128((const __m128i *)(u + x));
+			__m128i v_val = _mm_loadu_si128((const __m128i *)(v + x));
+
+			_mm_storeu_si128((__m128i *)(chroma + x * 2), _mm_unpacklo_epi8(u_val, v_val));
+			_mm_storeu_si128((__m128i *)(chroma + x * 2 + 16), _mm_unpackhi_epi8(u_val, v_val));
+		}
+
+		for (; x < width_d2; x++) {
+			chroma[x * 2] = u[x];
+			chroma[x * 2 + 1] = v[x];
+		}
+	}
+}
+
+/* swaps the bytes selected by lo_mask with the bytes 16 bits above them in
+ * every 32 bit word, 0x000000FF swaps R and B of RGBA/BGRA, 0x0000FF00 swaps
+ * U and V of YUY2/YVYU */
+void swap_packed_bytes(const uint8_t *input, uint32_t in_linesize, uint32_t width, uint32_t start_y, uint32_t end_y,
+		       uint8_t *output, uint32_t out_linesize, uint32_t lo_mask)
+{
+	const uint32_t keep_mask = ~(lo_mask | (lo_mask << 16));
+	const __m128i keep = _mm_set1_epi32((int)keep_mask);
+	const __m128i lo = _mm_set1_epi32((int)lo_mask);
+	uint32_t words = width / 4;
+
+	for (uint32_t y = start_y; y < end_y; y++) {
+		const uint32_t *in = (const uint32_t *)(input + y * in_linesize);
+		uint32_t *out = (uint32_t *)(output + y * out_linesize);
+		uint32_t x = 0;
+
+		for (; x + 4 <= words; x += 4) {
+			__m128i val = _mm_loadu_si128((const __m128i *)(in + x));
+			__m128i res = _mm_or_si128(_mm_and_si128(val, keep),
+						   _mm_or_si128(_mm_slli_epi32(_mm_and_si128(val, lo), 16),
+								_mm_and_si128(_mm_srli_epi32(val, 16), lo)));
+			_mm_storeu_si128((__m128i *)(out + x), res);
+		}
+
+		for (; x < words; x++) {
+			uint32_t val = in[x];
+			out[x] = (val & keep_mask) | ((val & lo_mask) << 16) | ((val >> 16) & lo_mask);
+		}
+	}
+}
+
+/* converts between YUY2 and UYVY */
+void swap_packed_pairs(const uint8_t *input, uint32_t in_linesize, uint32_t width, uint32_t start_y, uint32_t end_y,
+		       uint8_t *output, uint32_t out_linesize)
+{
+	uint32_t pairs = width / 2;
+
+	for (uint32_t y = start_y; y < end_y; y++) {
+		const uint16_t *in = (const uint16_t *)(input + y * in_linesize);
+		uint16_t *out = (uint16_t *)(output + y * out_linesize);
+		uint32_t x = 0;
+
+		for (; x + 8 <= pairs; x += 8) {
+			__m128i val = _mm_loadu_si128((const __m128i *)(in + x));
+			val = _mm_or_si128(_mm_slli_epi16(val, 8), _mm_srli_epi16(val, 8));
+			_mm_storeu_si128((__m128i *)(out + x), val);
+		}
+
+		for (; x < pairs; x++)
+			out[x] = (uint16_t)((in[x] << 8) | (in[x] >> 8));
+	}
+}
+
+/* averages 2x2 blocks of samples, step is 2 for interleaved chroma and 1
+ * otherwise.  width is the number of bytes per output row. */
+void downscale_half(const uint8_t *input, uint32_t in_linesize, uint32_t width, uint32_t step, uint32_t start_y,
+		    uint32_t end_y, uint8_t *output, uint32_t out_linesize)
+{
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i round = _mm_set1_epi16(2);
+	const __m128i lo_mask = _mm_set1_epi32(0x0000FFFF);
+
+	for (uint32_t y = start_y; y < end_y; y++) {
+		const uint8_t *row0 = input + y * 2 * in_linesize;
+		const uint8_t *row1 = row0 + in_linesize;
+		uint8_t *out = output + y * out_linesize;
+		uint32_t x = 0;
+
+		for (; x + 8 <= width; x += 8) {
+			__m128i line0 = _mm_loadu_si128((const __m128i *)(row0 + x * 2));
+			__m128i line1 = _mm_loadu_si128((const __m128i *)(row1 + x * 2));
+			__m128i lo = _mm_add_epi16(_mm_unpacklo_epi8(line0, zero), _mm_unpacklo_epi8(line1, zero));
+			__m128i hi = _mm_add_epi16(_mm_unpackhi_epi8(line0, zero), _mm_unpackhi_epi8(line1, zero));
+			__m128i sum;
+
+			if (step == 1) {
+				lo = _mm_and_si128(_mm_add_epi16(lo, _mm_srli_epi32(lo, 16)), lo_mask);
+				hi = _mm_and_si128(_mm_add_epi16(hi, _mm_srli_epi32(hi, 16)), lo_mask);
+				sum = _mm_packs_epi32(lo, hi);
+			} else {
+				lo = _mm_add_epi16(lo, _mm_srli_epi64(lo, 32));
+				hi = _mm_add_epi16(hi, _mm_srli_epi64(hi, 32));
+				lo = _mm_shuffle_epi32(lo, _MM_SHUFFLE(3, 1, 2, 0));
+				hi = _mm_shuffle_epi32(hi, _MM_SHUFFLE(3, 1, 2, 0));
+				sum = _mm_unpacklo_epi64(lo, hi);
+			}
+
+			sum = _mm_srli_epi16(_mm_add_epi16(sum, round), 2);
+			_mm_storel_epi64((__m128i *)(out + x), _mm_packus_epi16(sum, sum));
+		}
+
+		for (; x < width; x++) {
+			uint32_t pos = (x / step) * step * 2 + x % step;
+			out[x] = (uint8_t)((row0[pos] + row0[pos + step] + row1[pos] + row1[pos + step] + 2) >> 2);
+		}
+	}
+}
@@ -45,6 +45,26 @@ EXPORT void decompress_420(const uint8_t *const input[], const uint32_t in_lines
 EXPORT void decompress_422(const uint8_t *input, uint32_t in_linesize, uint32_t start_y, uint32_t end_y,
 			   uint8_t *output, uint32_t out_linesize, bool leading_lum);
 
+/*
+ * Functions for layout conversions and half size downscaling of 8-bit
+ * formats, start_y and end_y are rows of the output
+ */
+
+EXPORT void convert_nv12_to_i420(const uint8_t *const input[], const uint32_t in_linesize[], uint32_t width,
+				 uint32_t start_y, uint32_t end_y, uint8_t *output[], const uint32_t out_linesize[]);
+
+EXPORT void convert_i420_to_nv12(const uint8_t *const input[], const uint32_t in_linesize[], uint32_t width,
+				 uint32_t start_y, uint32_t end_y, uint8_t *output[], const uint32_t out_linesize[]);
+
+EXPORT void swap_packed_bytes(const uint8_t *input, uint32_t in_linesize, uint32_t width, uint32_t start_y,
+			      uint32_t end_y, uint8_t *output, uint32_t out_linesize, uint32_t lo_mask);
+
+EXPORT void swap_packed_pairs(const uint8_t *input, uint32_t in_linesize, uint32_t width, uint32_t start_y,
+			      uint32_t end_y, uint8_t *output, uint32_t out_linesize);
+
+EXPORT void downscale_half(const uint8_t *input, uint32_t in_linesize, uint32_t width, uint32_t step,
+			   uint32_t start_y, uint32_t end_y, uint8_t *output, uint32_t out_linesize);
+
 #ifdef __cplusplus
 }
 #endif
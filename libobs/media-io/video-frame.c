@@ -15,6 +15,10 @@
     along with this program.  If not, see <http://www.gnu.org/licenses/>.
 ******************************************************************************/
 #include <assert.h>
+#include "../util/darray.h"
+#include "../util/platform.h"
+#include "../util/threading.h"
+#include "../util/uthash.h"
 #include "video-frame.h"
 
 #define HALF(size) ((size + 1) / 2)
@@ -187,21 +191,16 @@ void video_frame_get_plane_heights(uint32_t heights[MAX_AV_PLANES], enum video_f
 	}
 }
 
-void video_frame_init(struct video_frame *frame, enum video_format format, uint32_t width, uint32_t height)
+static size_t get_frame_layout(uint32_t linesizes[MAX_AV_PLANES], size_t offsets[MAX_AV_PLANES],
+			       enum video_format format, uint32_t width, uint32_t height)
 {
 	size_t size = 0;
-	uint32_t linesizes[MAX_AV_PLANES];
 	uint32_t heights[MAX_AV_PLANES];
-	size_t offsets[MAX_AV_PLANES];
 	int alignment = base_get_alignment();
 
-	if (!frame)
-		return;
-
-	memset(frame, 0, sizeof(struct video_frame));
-	memset(linesizes, 0, sizeof(linesizes));
+	memset(linesizes, 0, sizeof(uint32_t) * MAX_AV_PLANES);
 	memset(heights, 0, sizeof(heights));
-	memset(offsets, 0, sizeof(offsets));
+	memset(offsets, 0, sizeof(size_t) * MAX_AV_PLANES);
 
 	/* determine linesizes for each plane */
 	video_frame_get_linesizes(linesizes, format, width);
@@ -219,19 +218,277 @@ void video_frame_init(struct video_frame *frame, enum video_format format, uint3
 		offsets[i] = size;
 	}
 
-	/* allocate memory */
-	frame->data[0] = bmalloc(size);
+	return size;
+}
+
+static void set_frame_planes(struct video_frame *frame, uint8_t *data, const uint32_t linesizes[MAX_AV_PLANES],
+			     const size_t offsets[MAX_AV_PLANES])
+{
+	frame->data[0] = data;
 	frame->linesize[0] = linesizes[0];
 
 	/* apply plane data pointers according to offsets */
 	for (uint32_t i = 1; i < MAX_AV_PLANES; i++) {
-		if (!linesizes[i] || !heights[i])
+		if (!linesizes[i] || !offsets[i])
 			continue;
 		frame->data[i] = frame->data[0] + offsets[i - 1];
 		frame->linesize[i] = linesizes[i];
 	}
 }
 
+/* frames are counted towards the tag of the allocating thread if it has one,
+ * so that e.g. filters keeping frames around show up by themselves */
+static int frame_memory_tag(void)
+{
+	static int tag = -1;
+	int thread_tag = bmem_get_thread_tag();
+
+	if (thread_tag != BMEM_TAG_NONE)
+		return thread_tag;
+	if (tag < 0)
+		tag = bmem_get_tag("video-frames");
+	return tag;
+}
+
+void video_frame_init(struct video_frame *frame, enum video_format format, uint32_t width, uint32_t height)
+{
+	uint32_t linesizes[MAX_AV_PLANES];
+	size_t offsets[MAX_AV_PLANES];
+	size_t size;
+
+	if (!frame)
+		return;
+
+	memset(frame, 0, sizeof(struct video_frame));
+
+	size = get_frame_layout(linesizes, offsets, format, width, height);
+	set_frame_planes(frame, bmalloc_tagged(size, frame_memory_tag()), linesizes, offsets);
+}
+
+/* ------------------------------------------------------------------------- */
+/* Frame buffer pool
+ *
+ * Buffers are plain bmalloc allocations of the exact size a frame layout
+ * needs, so anything that ends up with a pooled buffer can still bfree it,
+ * but it then stays counted as active until its address is handed out again.
+ * Code that swaps buffers between frames should therefore allocate its own
+ * frames from the pool and release every frame through it.  Every buffer
+ * handed out is tracked by its address; a buffer that comes back with a
+ * different size than it was allocated with was freed and reallocated behind
+ * the pool's back, so it is dropped instead of reused. */
+
+/* unused buffers are freed after this long */
+#define POOL_IDLE_TIME_NS 10000000000ULL
+#define POOL_TRIM_INTERVAL_NS 1000000000ULL
+/* limit for the memory held by unused buffers */
+#define POOL_MAX_IDLE_BYTES ((size_t)512 * 1024 * 1024)
+
+struct pool_buffer {
+	uint8_t *data;
+	size_t size;
+	uint64_t release_time;
+	bool in_use;
+	UT_hash_handle hh;
+};
+
+static pthread_mutex_t pool_mutex = PTHREAD_MUTEX_INITIALIZER;
+static struct pool_buffer *pool_buffers = NULL;
+static DARRAY(struct pool_buffer *) pool_idle; /* oldest first */
+static struct video_frame_pool_stats pool_stats = {0};
+static uint64_t pool_last_trim = 0;
+static int pool_memory_tag = -1;
+
+static void pool_buffer_free(struct pool_buffer *buf)
+{
+	HASH_DEL(pool_buffers, buf);
+	pool_stats.frees++;
+	if (buf->in_use) {
+		pool_stats.active_buffers--;
+		pool_stats.active_bytes -= buf->size;
+	} else {
+		pool_stats.idle_buffers--;
+		pool_stats.idle_bytes -= buf->size;
+	}
+	bfree(buf->data);
+	bfree(buf);
+}
+
+static void pool_trim(uint64_t now)
+{
+	while (pool_idle.num) {
+		struct pool_buffer *buf = pool_idle.array[0];
+		if (now - buf->release_time < POOL_IDLE_TIME_NS)
+			break;
+
+		da_erase(pool_idle, 0);
+		pool_buffer_free(buf);
+	}
+
+	pool_last_trim = now;
+}
+
+static uint8_t *pool_acquire(size_t size)
+{
+	struct pool_buffer *buf = NULL;
+	uint8_t *data;
+
+	pthread_mutex_lock(&pool_mutex);
+
+	/* prefer the most recently used buffer, it's most likely still cached */
+	for (size_t i = pool_idle.num; i > 0; i--) {
+		if (pool_idle.array[i - 1]->size == size) {
+			buf = pool_idle.array[i - 1];
+			da_erase(pool_idle, i - 1);
+			break;
+		}
+	}
+
+	if (buf) {
+		buf->in_use = true;
+		pool_stats.reuses++;
+		pool_stats.idle_buffers--;
+		pool_stats.idle_bytes -= size;
+		pool_stats.active_buffers++;
+		pool_stats.active_bytes += size;
+		pthread_mutex_unlock(&pool_mutex);
+		return buf->data;
+	}
+
+	if (pool_memory_tag < 0)
+		pool_memory_tag = bmem_get_tag("video-frame-pool");
+
+	pthread_mutex_unlock(&pool_mutex);
+
+	data = bmalloc_tagged(size, pool_memory_tag);
+	buf = bzalloc(sizeof(*buf));
+	buf->data = data;
+	buf->size = size;
+	buf->in_use = true;
+
+	pthread_mutex_lock(&pool_mutex);
+
+	/* the address can only be known already if a pooled buffer was freed
+	 * with bfree, in which case the old entry is stale */
+	struct pool_buffer *stale;
+	HASH_FIND_PTR(pool_buffers, &data, stale);
+	if (stale) {
+		HASH_DEL(pool_buffers, stale);
+		pool_stats.active_buffers--;
+		pool_stats.active_bytes -= stale->size;
+		bfree(stale);
+	}
+
+	HASH_ADD_PTR(pool_buffers, data, buf);
+	pool_stats.allocations++;
+	pool_stats.active_buffers++;
+	pool_stats.active_bytes += size;
+
+	pthread_mutex_unlock(&pool_mutex);
+	return data;
+}
+
+static void pool_release(uint8_t *data, size_t size)
+{
+	struct pool_buffer *buf;
+	uint64_t now = os_gettime_ns();
+
+	pthread_mutex_lock(&pool_mutex);
+
+	HASH_FIND_PTR(pool_buffers, &data, buf);
+	if (!buf || !buf->in_use || buf->size != size) {
+		if (buf && buf->in_use) {
+			HASH_DEL(pool_buffers, buf);
+			pool_stats.active_buffers--;
+			pool_stats.active_bytes -= buf->size;
+			bfree(buf);
+		}
+		pthread_mutex_unlock(&pool_mutex);
+		bfree(data);
+		return;
+	}
+
+	if (pool_stats.idle_bytes + size > POOL_MAX_IDLE_BYTES) {
+		pool_buffer_free(buf);
+	} else {
+		buf->in_use = false;
+		buf->release_time = now;
+		da_push_back(pool_idle, &buf);
+		pool_stats.active_buffers--;
+		pool_stats.active_bytes -= size;
+		pool_stats.idle_buffers++;
+		pool_stats.idle_bytes += size;
+	}
+
+	if (now - pool_last_trim >= POOL_TRIM_INTERVAL_NS)
+		pool_trim(now);
+
+	pthread_mutex_unlock(&pool_mutex);
+}
+
+void video_frame_init_pooled(struct video_frame *frame, enum video_format format, uint32_t width, uint32_t height)
+{
+	uint32_t linesizes[MAX_AV_PLANES];
+	size_t offsets[MAX_AV_PLANES];
+	size_t size;
+
+	if (!frame)
+		return;
+
+	memset(frame, 0, sizeof(struct video_frame));
+
+	size = get_frame_layout(linesizes, offsets, format, width, height);
+	set_frame_planes(frame, pool_acquire(size), linesizes, offsets);
+}
+
+void video_frame_free_pooled(struct video_frame *frame, enum video_format format, uint32_t width, uint32_t height)
+{
+	uint32_t linesizes[MAX_AV_PLANES];
+	size_t offsets[MAX_AV_PLANES];
+
+	if (!frame)
+		return;
+
+	if (frame->data[0])
+		pool_release(frame->data[0], get_frame_layout(linesizes, offsets, format, width, height));
+	memset(frame, 0, sizeof(struct video_frame));
+}
+
+void video_frame_pool_trim(bool all)
+{
+	pthread_mutex_lock(&pool_mutex);
+
+	if (all) {
+		struct pool_buffer *buf, *tmp;
+
+		for (size_t i = 0; i < pool_idle.num; i++)
+			pool_buffer_free(pool_idle.array[i]);
+		da_free(pool_idle);
+
+		/* buffers still in use are no longer tracked and will simply
+		 * be freed when they're released */
+		HASH_ITER (hh, pool_buffers, buf, tmp) {
+			HASH_DEL(pool_buffers, buf);
+			bfree(buf);
+		}
+		pool_stats.active_buffers = 0;
+		pool_stats.active_bytes = 0;
+	} else {
+		pool_trim(os_gettime_ns());
+	}
+
+	pthread_mutex_unlock(&pool_mutex);
+}
+
+void video_frame_pool_get_stats(struct video_frame_pool_stats *stats)
+{
+	if (!stats)
+		return;
+
+	pthread_mutex_lock(&pool_mutex);
+	*stats = pool_stats;
+	pthread_mutex_unlock(&pool_mutex);
+}
+
 void video_frame_copy(struct video_frame *dst, const struct video_frame *src, enum video_format format, uint32_t cy)
 {
 	uint32_t heights[MAX_AV_PLANES];
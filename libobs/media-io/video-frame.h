@@ -56,6 +56,32 @@ static inline void video_frame_destroy(struct video_frame *frame)
 	}
 }
 
+/* Pooled frame buffers, meant for frames that are allocated and released
+ * continuously.  The buffer layout is the same as with video_frame_init, and
+ * the format and size passed to video_frame_free_pooled must match the ones
+ * the frame was initialized with.  Buffers should always be released with
+ * video_frame_free_pooled, also when they were swapped into other frames,
+ * otherwise the pool keeps counting them as in use.  Unused buffers are freed
+ * after a while. */
+struct video_frame_pool_stats {
+	uint64_t allocations; /* buffers allocated by the pool */
+	uint64_t reuses;      /* requests served with an unused buffer */
+	uint64_t frees;       /* buffers freed by the pool */
+	size_t active_buffers;
+	size_t active_bytes;
+	size_t idle_buffers;
+	size_t idle_bytes;
+};
+
+EXPORT void video_frame_init_pooled(struct video_frame *frame, enum video_format format, uint32_t width,
+				    uint32_t height);
+EXPORT void video_frame_free_pooled(struct video_frame *frame, enum video_format format, uint32_t width,
+				    uint32_t height);
+
+/* frees unused buffers that have been idle for too long, or all of them */
+EXPORT void video_frame_pool_trim(bool all);
+EXPORT void video_frame_pool_get_stats(struct video_frame_pool_stats *stats);
+
 EXPORT void video_frame_copy(struct video_frame *dst, const struct video_frame *src, enum video_format format,
 			     uint32_t height);
 
@@ -56,6 +56,16 @@ struct video_input {
 	uint32_t frame_rate_divisor;
 	uint32_t frame_rate_divisor_counter;
 
+	// inputs are kept sorted from the largest to the smallest size so
+	// that a rendition ladder can cascade: an input is scaled from the
+	// already scaled frame of a larger input with the same format when
+	// there is one (source_idx), instead of from the full output frame.
+	// inputs with the exact same conversion share the scaled frame.
+	size_t source_idx;
+	video_scaler_t *source_scaler;
+	struct video_data output;
+	bool output_valid;
+
 	void (*callback)(void *param, struct video_data *frame);
 	void *param;
 };
@@ -63,8 +73,10 @@ struct video_input {
 static inline void video_input_free(struct video_input *input)
 {
 	for (size_t i = 0; i < MAX_CONVERT_BUFFERS; i++)
-		video_frame_free(&input->frame[i]);
+		video_frame_free_pooled(&input->frame[i], input->conversion.format, input->conversion.width,
+					input->conversion.height);
 	video_scaler_destroy(input->scaler);
+	video_scaler_destroy(input->source_scaler);
 }
 
 struct video_output {
@@ -95,11 +107,11 @@ struct video_output {
 
 /* ------------------------------------------------------------------------- */
 
-static inline bool scale_video_output(struct video_input *input, struct video_data *data)
+static inline bool scale_video_output(struct video_input *input, video_scaler_t *scaler, struct video_data *data)
 {
 	bool success = true;
 
-	if (input->scaler) {
+	if (scaler) {
 		struct video_frame *frame;
 
 		if (++input->cur_frame == MAX_CONVERT_BUFFERS)
@@ -107,8 +119,8 @@ static inline bool scale_video_output(struct video_input *input, struct video_da
 
 		frame = &input->frame[input->cur_frame];
 
-		success = video_scaler_scale(input->scaler, frame->data, frame->linesize,
-					     (const uint8_t *const *)data->data, data->linesize);
+		success = video_scaler_scale(scaler, frame->data, frame->linesize, (const uint8_t *const *)data->data,
+					     data->linesize);
 
 		if (success) {
 			for (size_t i = 0; i < MAX_AV_PLANES; i++) {
@@ -123,6 +135,26 @@ static inline bool scale_video_output(struct video_input *input, struct video_da
 	return success;
 }
 
+static inline bool scale_video_input(struct video_output *video, struct video_input *input, struct video_data *data)
+{
+	if (input->source_idx != DARRAY_INVALID) {
+		struct video_input *source = video->inputs.array + input->source_idx;
+
+		/* the source may have skipped this frame due to its frame
+		 * rate divisor, in which case scale from the full frame */
+		if (source->output_valid) {
+			for (size_t i = 0; i < MAX_AV_PLANES; i++) {
+				data->data[i] = source->output.data[i];
+				data->linesize[i] = source->output.linesize[i];
+			}
+
+			return scale_video_output(input, input->source_scaler, data);
+		}
+	}
+
+	return scale_video_output(input, input->scaler, data);
+}
+
 static inline bool video_output_cur_frame(struct video_output *video)
 {
 	struct cached_frame_info *frame_info;
@@ -145,6 +177,8 @@ static inline bool video_output_cur_frame(struct video_output *video)
 		struct video_input *input = video->inputs.array + i;
 		struct video_data frame = frame_info->frame;
 
+		input->output_valid = false;
+
 		// an explicit counter is used instead of remainder calculation
 		// to allow multiple encoders started at the same time to start on
 		// the same frame
@@ -155,8 +189,11 @@ static inline bool video_output_cur_frame(struct video_output *video)
 		if (skip)
 			continue;
 
-		if (scale_video_output(input, &frame))
+		if (scale_video_input(video, input, &frame)) {
+			input->output = frame;
+			input->output_valid = true;
 			input->callback(input->param, &frame);
+		}
 	}
 
 	pthread_mutex_unlock(&video->input_mutex);
@@ -230,7 +267,7 @@ static inline void init_cache(struct video_output *video)
 		struct video_frame *frame;
 		frame = (struct video_frame *)&video->cache[i];
 
-		video_frame_init(frame, video->info.format, video->info.width, video->info.height);
+		video_frame_init_pooled(frame, video->info.format, video->info.width, video->info.height);
 	}
 
 	video->available_frames = video->info.cache_size;
@@ -289,7 +326,8 @@ void video_output_close(video_t *video)
 	da_free(video->inputs);
 
 	for (size_t i = 0; i < video->info.cache_size; i++)
-		video_frame_free((struct video_frame *)&video->cache[i]);
+		video_frame_free_pooled((struct video_frame *)&video->cache[i], video->info.format, video->info.width,
+					video->info.height);
 
 	pthread_mutex_unlock(&video->input_mutex);
 	os_sem_destroy(video->update_semaphore);
@@ -362,13 +400,76 @@ static inline bool video_input_init(struct video_input *input, struct video_outp
 		}
 
 		for (size_t i = 0; i < MAX_CONVERT_BUFFERS; i++)
-			video_frame_init(&input->frame[i], input->conversion.format, input->conversion.width,
-					 input->conversion.height);
+			video_frame_init_pooled(&input->frame[i], input->conversion.format, input->conversion.width,
+						input->conversion.height);
 	}
 
 	return true;
 }
 
+static inline uint64_t input_area(const struct video_input *input)
+{
+	return (uint64_t)input->conversion.width * (uint64_t)input->conversion.height;
+}
+
+static inline bool can_cascade(const struct video_input *source, const struct video_input *input)
+{
+	return source->scaler && source->conversion.format == input->conversion.format &&
+	       match_range(source->conversion.range, input->conversion.range) &&
+	       match_space(source->conversion.colorspace, input->conversion.colorspace) &&
+	       source->conversion.width >= input->conversion.width &&
+	       source->conversion.height >= input->conversion.height;
+}
+
+/* links every scaled input to the smallest larger input it can be scaled
+ * from.  inputs are sorted by size, so sources always come first. */
+static void update_input_sources(struct video_output *video)
+{
+	for (size_t i = 0; i < video->inputs.num; i++) {
+		struct video_input *input = video->inputs.array + i;
+		size_t best = DARRAY_INVALID;
+
+		video_scaler_destroy(input->source_scaler);
+		input->source_scaler = NULL;
+		input->source_idx = DARRAY_INVALID;
+
+		if (!input->scaler)
+			continue;
+
+		for (size_t j = 0; j < i; j++) {
+			struct video_input *source = video->inputs.array + j;
+			if (!can_cascade(source, input))
+				continue;
+			if (best == DARRAY_INVALID || input_area(source) < input_area(video->inputs.array + best))
+				best = j;
+		}
+
+		if (best == DARRAY_INVALID)
+			continue;
+
+		struct video_input *source = video->inputs.array + best;
+		if (source->conversion.width != input->conversion.width ||
+		    source->conversion.height != input->conversion.height) {
+			int ret = video_scaler_create(&input->source_scaler, &input->conversion, &source->conversion,
+						      VIDEO_SCALE_FAST_BILINEAR);
+			if (ret != VIDEO_SCALER_SUCCESS)
+				continue;
+		}
+
+		input->source_idx = best;
+	}
+}
+
+static inline size_t get_input_insert_idx(const struct video_output *video, const struct video_input *input)
+{
+	for (size_t i = 0; i < video->inputs.num; i++) {
+		if (input_area(video->inputs.array + i) < input_area(input))
+			return i;
+	}
+
+	return video->inputs.num;
+}
+
 static inline void reset_frames(video_t *video)
 {
 	os_atomic_set_long(&video->skipped_frames, 0);
@@ -439,7 +540,8 @@ bool video_output_connect2(video_t *video, const struct video_scale_info *conver
 				}
 				os_atomic_set_bool(&video->raw_active, true);
 			}
-			da_push_back(video->inputs, &input);
+			da_insert(video->inputs, get_input_insert_idx(video, &input), &input);
+			update_input_sources(video);
 		}
 	}
 
@@ -480,6 +582,7 @@ bool video_output_disconnect2(video_t *video, void (*callback)(void *param, stru
 	if (idx != DARRAY_INVALID) {
 		video_input_free(video->inputs.array + idx);
 		da_erase(video->inputs, idx);
+		update_input_sources(video);
 
 		if (video->inputs.num == 0) {
 			os_atomic_set_bool(&video->raw_active, false);
@@ -16,18 +16,67 @@
 ******************************************************************************/
 
 #include "../util/bmem.h"
+#include "../util/platform.h"
+#include "../util/threading.h"
+#include "format-conversion.h"
 #include "video-scaler.h"
 
 #include <libavutil/imgutils.h>
 #include <libavutil/opt.h>
 #include <libswscale/swscale.h>
 
-struct video_scaler {
+#define MAX_BANDS 4
+#define MIN_BAND_PIXELS (640 * 360)
+#define BAND_ALIGN 8
+
+/* conversions that are done without swscale */
+enum fast_path {
+	FAST_PATH_NONE,
+	FAST_PATH_COPY,
+	FAST_PATH_NV12_TO_I420,
+	FAST_PATH_I420_TO_NV12,
+	FAST_PATH_SWAP_RB,
+	FAST_PATH_SWAP_UV,
+	FAST_PATH_SWAP_PAIRS,
+	FAST_PATH_HALF_NV12,
+	FAST_PATH_HALF_I420,
+};
+
+/* the frame is split into bands of output rows that are processed in
+ * parallel.  swscale is only split when no vertical resampling is needed,
+ * each band then has its own context. */
+struct scaler_band {
 	struct SwsContext *swscale;
+	uint32_t start_y;
+	uint32_t end_y;
+};
+
+struct video_scaler {
+	enum fast_path fast_path;
+	uint32_t width;
 	int src_height;
+	int src_shifts[4];
+	int dst_shifts[4];
 	int dst_heights[4];
+	int dst_row_bytes[4];
 	uint8_t *dst_pointers[4];
 	int dst_linesizes[4];
+
+	struct scaler_band bands[MAX_BANDS];
+	size_t band_count;
+
+	pthread_t threads[MAX_BANDS - 1];
+	size_t thread_count;
+	os_sem_t *work_sem;
+	os_sem_t *done_sem;
+	volatile long next_band;
+	volatile bool stop;
+	volatile bool failed;
+
+	const uint8_t *const *input;
+	const uint32_t *in_linesize;
+	uint8_t *const *output;
+	const uint32_t *out_linesize;
 };
 
 static inline enum AVPixelFormat get_ffmpeg_video_format(enum video_format format)
@@ -140,8 +189,90 @@ static inline int get_ffmpeg_range_type(enum video_range_type type)
 
 #define FIXED_1_0 (1 << 16)
 
-int video_scaler_create(video_scaler_t **scaler_out, const struct video_scale_info *dst,
-			const struct video_scale_info *src, enum video_scale_type type)
+static inline bool is_half_size(const struct video_scale_info *dst, const struct video_scale_info *src)
+{
+	return src->width == dst->width * 2 && src->height == dst->height * 2 && (dst->width % 2) == 0 &&
+	       (dst->height % 2) == 0;
+}
+
+static enum fast_path get_fast_path(const struct video_scale_info *dst, const struct video_scale_info *src,
+				    enum video_scale_type type)
+{
+	enum video_format src_format = src->format == VIDEO_FORMAT_BGRX ? VIDEO_FORMAT_BGRA : src->format;
+	enum video_format dst_format = dst->format == VIDEO_FORMAT_BGRX ? VIDEO_FORMAT_BGRA : dst->format;
+	bool same_size = src->width == dst->width && src->height == dst->height;
+	/* none of these convert between color spaces, but swscale converts
+	 * between ranges */
+	if (get_ffmpeg_range_type(src->range) != get_ffmpeg_range_type(dst->range))
+		return FAST_PATH_NONE;
+
+	/* a 2x2 box filter is what bilinear filtering results in at exactly
+	 * half size, other filters are left to swscale */
+	if (is_half_size(dst, src) && src_format == dst_format &&
+	    (type == VIDEO_SCALE_DEFAULT || type == VIDEO_SCALE_FAST_BILINEAR || type == VIDEO_SCALE_BILINEAR)) {
+		if (src_format == VIDEO_FORMAT_NV12)
+			return FAST_PATH_HALF_NV12;
+		if (src_format == VIDEO_FORMAT_I420)
+			return FAST_PATH_HALF_I420;
+		return FAST_PATH_NONE;
+	}
+
+	if (!same_size || (src->width % 2) != 0 || (src->height % 2) != 0)
+		return FAST_PATH_NONE;
+
+	if (src_format == dst_format) {
+		switch (src_format) {
+		case VIDEO_FORMAT_I420:
+		case VIDEO_FORMAT_NV12:
+		case VIDEO_FORMAT_I422:
+		case VIDEO_FORMAT_I444:
+		case VIDEO_FORMAT_YUY2:
+		case VIDEO_FORMAT_UYVY:
+		case VIDEO_FORMAT_YVYU:
+		case VIDEO_FORMAT_RGBA:
+		case VIDEO_FORMAT_BGRA:
+		case VIDEO_FORMAT_Y800:
+		case VIDEO_FORMAT_BGR3:
+			return FAST_PATH_COPY;
+		default:
+			return FAST_PATH_NONE;
+		}
+	}
+
+	if (src_format == VIDEO_FORMAT_NV12 && dst_format == VIDEO_FORMAT_I420)
+		return FAST_PATH_NV12_TO_I420;
+	if (src_format == VIDEO_FORMAT_I420 && dst_format == VIDEO_FORMAT_NV12)
+		return FAST_PATH_I420_TO_NV12;
+	if ((src_format == VIDEO_FORMAT_RGBA && dst_format == VIDEO_FORMAT_BGRA) ||
+	    (src_format == VIDEO_FORMAT_BGRA && dst_format == VIDEO_FORMAT_RGBA))
+		return FAST_PATH_SWAP_RB;
+	if ((src_format == VIDEO_FORMAT_YUY2 && dst_format == VIDEO_FORMAT_YVYU) ||
+	    (src_format == VIDEO_FORMAT_YVYU && dst_format == VIDEO_FORMAT_YUY2))
+		return FAST_PATH_SWAP_UV;
+	if ((src_format == VIDEO_FORMAT_YUY2 && dst_format == VIDEO_FORMAT_UYVY) ||
+	    (src_format == VIDEO_FORMAT_UYVY && dst_format == VIDEO_FORMAT_YUY2))
+		return FAST_PATH_SWAP_PAIRS;
+
+	return FAST_PATH_NONE;
+}
+
+static void get_plane_shifts(enum AVPixelFormat format, int shifts[4])
+{
+	const AVPixFmtDescriptor *desc = av_pix_fmt_desc_get(format);
+
+	for (size_t i = 0; i < 4; i++)
+		shifts[i] = 0;
+
+	/* planes 1 and 2 are chroma, alpha is stored at full size */
+	for (size_t i = 0; i < desc->nb_components; i++) {
+		int plane = desc->comp[i].plane;
+		if (plane == 1 || plane == 2)
+			shifts[plane] = desc->log2_chroma_h;
+	}
+}
+
+static struct SwsContext *create_swscale(const struct video_scale_info *dst, const struct video_scale_info *src,
+					 enum video_scale_type type, int src_height, int dst_height)
 {
 	enum AVPixelFormat format_src = get_ffmpeg_video_format(src->format);
 	enum AVPixelFormat format_dst = get_ffmpeg_video_format(dst->format);
@@ -150,6 +281,78 @@ int video_scaler_create(video_scaler_t **scaler_out, const struct video_scale_in
 	const int *coeff_dst = get_ffmpeg_coeffs(dst->colorspace);
 	int range_src = get_ffmpeg_range_type(src->range);
 	int range_dst = get_ffmpeg_range_type(dst->range);
+	struct SwsContext *swscale;
+	int ret;
+
+	swscale = sws_alloc_context();
+	if (!swscale) {
+		blog(LOG_ERROR, "video_scaler_create: Could not create "
+				"swscale");
+		return NULL;
+	}
+
+	av_opt_set_int(swscale, "sws_flags", scale_type, 0);
+	av_opt_set_int(swscale, "srcw", src->width, 0);
+	av_opt_set_int(swscale, "srch", src_height, 0);
+	av_opt_set_int(swscale, "dstw", dst->width, 0);
+	av_opt_set_int(swscale, "dsth", dst_height, 0);
+	av_opt_set_int(swscale, "src_format", format_src, 0);
+	av_opt_set_int(swscale, "dst_format", format_dst, 0);
+	av_opt_set_int(swscale, "src_range", range_src, 0);
+	av_opt_set_int(swscale, "dst_range", range_dst, 0);
+	if (sws_init_context(swscale, NULL, NULL) < 0) {
+		blog(LOG_ERROR, "video_scaler_create: sws_init_context failed");
+		sws_freeContext(swscale);
+		return NULL;
+	}
+
+	ret = sws_setColorspaceDetails(swscale, coeff_src, range_src, coeff_dst, range_dst, 0, FIXED_1_0, FIXED_1_0);
+	if (ret < 0) {
+		blog(LOG_DEBUG, "video_scaler_create: "
+				"sws_setColorspaceDetails failed, ignoring");
+	}
+
+	return swscale;
+}
+
+static size_t get_band_count(const struct video_scale_info *dst, bool can_split)
+{
+	uint64_t pixels = (uint64_t)dst->width * dst->height;
+	size_t count = (size_t)os_get_logical_cores() / 2;
+
+	if (!can_split || pixels < MIN_BAND_PIXELS * 2)
+		return 1;
+
+	if (count > pixels / MIN_BAND_PIXELS)
+		count = (size_t)(pixels / MIN_BAND_PIXELS);
+	if (count > dst->height / BAND_ALIGN)
+		count = dst->height / BAND_ALIGN;
+	if (count > MAX_BANDS)
+		count = MAX_BANDS;
+	return count ? count : 1;
+}
+
+static void *scaler_thread(void *data);
+
+static bool start_threads(struct video_scaler *scaler)
+{
+	if (os_sem_init(&scaler->work_sem, 0) != 0 || os_sem_init(&scaler->done_sem, 0) != 0)
+		return false;
+
+	for (size_t i = 0; i < scaler->band_count - 1; i++) {
+		if (pthread_create(&scaler->threads[i], NULL, scaler_thread, scaler) != 0)
+			return false;
+		scaler->thread_count++;
+	}
+
+	return true;
+}
+
+int video_scaler_create(video_scaler_t **scaler_out, const struct video_scale_info *dst,
+			const struct video_scale_info *src, enum video_scale_type type)
+{
+	enum AVPixelFormat format_src = get_ffmpeg_video_format(src->format);
+	enum AVPixelFormat format_dst = get_ffmpeg_video_format(dst->format);
 	struct video_scaler *scaler;
 	int ret;
 
@@ -160,8 +363,13 @@ int video_scaler_create(video_scaler_t **scaler_out, const struct video_scale_in
 		return VIDEO_SCALER_BAD_CONVERSION;
 
 	scaler = bzalloc(sizeof(struct video_scaler));
+	scaler->fast_path = get_fast_path(dst, src, type);
+	scaler->width = dst->width;
 	scaler->src_height = src->height;
 
+	get_plane_shifts(format_src, scaler->src_shifts);
+	get_plane_shifts(format_dst, scaler->dst_shifts);
+
 	const AVPixFmtDescriptor *desc = av_pix_fmt_desc_get(format_dst);
 	bool has_plane[4] = {0};
 	for (size_t i = 0; i < 4; i++)
@@ -169,44 +377,51 @@ int video_scaler_create(video_scaler_t **scaler_out, const struct video_scale_in
 
 	scaler->dst_heights[0] = dst->height;
 	for (size_t i = 1; i < 4; ++i) {
-		if (has_plane[i]) {
-			const int s = (i == 1 || i == 2) ? desc->log2_chroma_h : 0;
-			scaler->dst_heights[i] = dst->height >> s;
-		}
+		if (has_plane[i])
+			scaler->dst_heights[i] = dst->height >> scaler->dst_shifts[i];
 	}
 
-	ret = av_image_alloc(scaler->dst_pointers, scaler->dst_linesizes, dst->width, dst->height, format_dst, 32);
+	ret = av_image_fill_linesizes(scaler->dst_row_bytes, format_dst, dst->width);
 	if (ret < 0) {
-		blog(LOG_WARNING, "video_scaler_create: av_image_alloc failed: %d", ret);
+		blog(LOG_WARNING, "video_scaler_create: av_image_fill_linesizes failed: %d", ret);
 		goto fail;
 	}
 
-	scaler->swscale = sws_alloc_context();
-	if (!scaler->swscale) {
-		blog(LOG_ERROR, "video_scaler_create: Could not create "
-				"swscale");
-		goto fail;
+	/* swscale output can only be split into bands when rows map 1:1 */
+	bool can_split = scaler->fast_path != FAST_PATH_NONE ||
+			 (src->height == dst->height && scaler->src_shifts[1] == scaler->dst_shifts[1]);
+
+	scaler->band_count = get_band_count(dst, can_split);
+
+	uint32_t band_height = dst->height / (uint32_t)scaler->band_count / BAND_ALIGN * BAND_ALIGN;
+	for (size_t i = 0; i < scaler->band_count; i++) {
+		struct scaler_band *band = &scaler->bands[i];
+		band->start_y = (uint32_t)i * band_height;
+		band->end_y = i == scaler->band_count - 1 ? dst->height : band->start_y + band_height;
 	}
 
-	av_opt_set_int(scaler->swscale, "sws_flags", scale_type, 0);
-	av_opt_set_int(scaler->swscale, "srcw", src->width, 0);
-	av_opt_set_int(scaler->swscale, "srch", src->height, 0);
-	av_opt_set_int(scaler->swscale, "dstw", dst->width, 0);
-	av_opt_set_int(scaler->swscale, "dsth", dst->height, 0);
-	av_opt_set_int(scaler->swscale, "src_format", format_src, 0);
-	av_opt_set_int(scaler->swscale, "dst_format", format_dst, 0);
-	av_opt_set_int(scaler->swscale, "src_range", range_src, 0);
-	av_opt_set_int(scaler->swscale, "dst_range", range_dst, 0);
-	if (sws_init_context(scaler->swscale, NULL, NULL) < 0) {
-		blog(LOG_ERROR, "video_scaler_create: sws_init_context failed");
-		goto fail;
+	if (scaler->fast_path == FAST_PATH_NONE) {
+		ret = av_image_alloc(scaler->dst_pointers, scaler->dst_linesizes, dst->width, dst->height, format_dst,
+				     32);
+		if (ret < 0) {
+			blog(LOG_WARNING, "video_scaler_create: av_image_alloc failed: %d", ret);
+			goto fail;
+		}
+
+		for (size_t i = 0; i < scaler->band_count; i++) {
+			struct scaler_band *band = &scaler->bands[i];
+			int dst_height = (int)(band->end_y - band->start_y);
+			int src_height = scaler->band_count == 1 ? (int)src->height : dst_height;
+
+			band->swscale = create_swscale(dst, src, type, src_height, dst_height);
+			if (!band->swscale)
+				goto fail;
+		}
 	}
 
-	ret = sws_setColorspaceDetails(scaler->swscale, coeff_src, range_src, coeff_dst, range_dst, 0, FIXED_1_0,
-				       FIXED_1_0);
-	if (ret < 0) {
-		blog(LOG_DEBUG, "video_scaler_create: "
-				"sws_setColorspaceDetails failed, ignoring");
+	if (scaler->band_count > 1 && !start_threads(scaler)) {
+		blog(LOG_WARNING, "video_scaler_create: Failed to start threads");
+		goto fail;
 	}
 
 	*scaler_out = scaler;
@@ -220,7 +435,17 @@ fail:
 void video_scaler_destroy(video_scaler_t *scaler)
 {
 	if (scaler) {
-		sws_freeContext(scaler->swscale);
+		os_atomic_set_bool(&scaler->stop, true);
+		for (size_t i = 0; i < scaler->thread_count; i++)
+			os_sem_post(scaler->work_sem);
+		for (size_t i = 0; i < scaler->thread_count; i++)
+			pthread_join(scaler->threads[i], NULL);
+
+		os_sem_destroy(scaler->work_sem);
+		os_sem_destroy(scaler->done_sem);
+
+		for (size_t i = 0; i < scaler->band_count; i++)
+			sws_freeContext(scaler->bands[i].swscale);
 
 		if (scaler->dst_pointers[0])
 			av_freep(scaler->dst_pointers);
@@ -229,14 +454,104 @@ void video_scaler_destroy(video_scaler_t *scaler)
 	}
 }
 
-bool video_scaler_scale(video_scaler_t *scaler, uint8_t *output[], const uint32_t out_linesize[],
-			const uint8_t *const input[], const uint32_t in_linesize[])
+static void copy_rows(uint8_t *dst, size_t dst_linesize, const uint8_t *src, size_t src_linesize, size_t row_bytes,
+		      size_t start_y, size_t end_y)
 {
-	if (!scaler)
-		return false;
+	dst += start_y * dst_linesize;
+	src += start_y * src_linesize;
+
+	if (src_linesize == dst_linesize) {
+		memcpy(dst, src, src_linesize * (end_y - start_y));
+		return;
+	}
+
+	if (row_bytes > dst_linesize)
+		row_bytes = dst_linesize;
+
+	for (size_t y = start_y; y < end_y; y++) {
+		memcpy(dst, src, row_bytes);
+		dst += dst_linesize;
+		src += src_linesize;
+	}
+}
+
+static inline uint32_t plane_end(const struct video_scaler *scaler, const struct scaler_band *band, size_t plane)
+{
+	bool last = band == &scaler->bands[scaler->band_count - 1];
+	return last ? (uint32_t)scaler->dst_heights[plane] : band->end_y >> scaler->dst_shifts[plane];
+}
+
+static void scale_fast(struct video_scaler *scaler, const struct scaler_band *band)
+{
+	const uint8_t *const *input = scaler->input;
+	const uint32_t *in_linesize = scaler->in_linesize;
+	uint8_t *const *output = scaler->output;
+	const uint32_t *out_linesize = scaler->out_linesize;
+	uint32_t start_y = band->start_y;
+	uint32_t end_y = band->end_y;
+
+	switch (scaler->fast_path) {
+	case FAST_PATH_COPY:
+		for (size_t i = 0; i < 4 && scaler->dst_row_bytes[i]; i++) {
+			copy_rows(output[i], out_linesize[i], input[i], in_linesize[i], scaler->dst_row_bytes[i],
+				  start_y >> scaler->dst_shifts[i], plane_end(scaler, band, i));
+		}
+		break;
+	case FAST_PATH_NV12_TO_I420:
+		convert_nv12_to_i420(input, in_linesize, scaler->width, start_y, end_y, (uint8_t **)output,
+				     out_linesize);
+		break;
+	case FAST_PATH_I420_TO_NV12:
+		convert_i420_to_nv12(input, in_linesize, scaler->width, start_y, end_y, (uint8_t **)output,
+				     out_linesize);
+		break;
+	case FAST_PATH_SWAP_RB:
+		swap_packed_bytes(input[0], in_linesize[0], scaler->dst_row_bytes[0], start_y, end_y, output[0],
+				  out_linesize[0], 0x000000FF);
+		break;
+	case FAST_PATH_SWAP_UV:
+		swap_packed_bytes(input[0], in_linesize[0], scaler->dst_row_bytes[0], start_y, end_y, output[0],
+				  out_linesize[0], 0x0000FF00);
+		break;
+	case FAST_PATH_SWAP_PAIRS:
+		swap_packed_pairs(input[0], in_linesize[0], scaler->dst_row_bytes[0], start_y, end_y, output[0],
+				  out_linesize[0]);
+		break;
+	case FAST_PATH_HALF_NV12:
+		downscale_half(input[0], in_linesize[0], scaler->dst_row_bytes[0], 1, start_y, end_y, output[0],
+			       out_linesize[0]);
+		downscale_half(input[1], in_linesize[1], scaler->dst_row_bytes[1], 2, start_y / 2,
+			       plane_end(scaler, band, 1), output[1], out_linesize[1]);
+		break;
+	case FAST_PATH_HALF_I420:
+		for (size_t i = 0; i < 3; i++) {
+			downscale_half(input[i], in_linesize[i], scaler->dst_row_bytes[i], 1,
+				       start_y >> scaler->dst_shifts[i], plane_end(scaler, band, i), output[i],
+				       out_linesize[i]);
+		}
+		break;
+	case FAST_PATH_NONE:
+		break;
+	}
+}
+
+static bool scale_swscale(struct video_scaler *scaler, const struct scaler_band *band)
+{
+	const uint8_t *input[4] = {0};
+	uint8_t *scaled[4] = {0};
+	int src_y = scaler->band_count == 1 ? 0 : (int)band->start_y;
+	int src_height = scaler->band_count == 1 ? scaler->src_height : (int)(band->end_y - band->start_y);
+
+	for (size_t i = 0; i < 4; i++) {
+		if (scaler->input[i])
+			input[i] = scaler->input[i] + (size_t)(src_y >> scaler->src_shifts[i]) * scaler->in_linesize[i];
+		if (scaler->dst_pointers[i])
+			scaled[i] = scaler->dst_pointers[i] +
+				    (size_t)(band->start_y >> scaler->dst_shifts[i]) * scaler->dst_linesizes[i];
+	}
 
-	int ret = sws_scale(scaler->swscale, input, (const int *)in_linesize, 0, scaler->src_height,
-			    scaler->dst_pointers, scaler->dst_linesizes);
+	int ret = sws_scale(band->swscale, input, (const int *)scaler->in_linesize, 0, src_height, scaled,
+			    scaler->dst_linesizes);
 	if (ret <= 0) {
 		blog(LOG_ERROR, "video_scaler_scale: sws_scale failed: %d", ret);
 		return false;
@@ -246,25 +561,63 @@ bool video_scaler_scale(video_scaler_t *scaler, uint8_t *output[], const uint32_
 		if (!scaler->dst_pointers[plane])
 			continue;
 
-		const size_t scaled_linesize = scaler->dst_linesizes[plane];
-		const size_t plane_linesize = out_linesize[plane];
-		uint8_t *dst = output[plane];
-		const uint8_t *src = scaler->dst_pointers[plane];
-		const size_t height = scaler->dst_heights[plane];
-		if (scaled_linesize == plane_linesize) {
-			memcpy(dst, src, scaled_linesize * height);
-		} else {
-			size_t linesize = scaled_linesize;
-			if (linesize > plane_linesize)
-				linesize = plane_linesize;
-
-			for (size_t y = 0; y < height; y++) {
-				memcpy(dst, src, linesize);
-				dst += plane_linesize;
-				src += scaled_linesize;
-			}
-		}
+		copy_rows(scaler->output[plane], scaler->out_linesize[plane], scaler->dst_pointers[plane],
+			  scaler->dst_linesizes[plane], scaler->dst_linesizes[plane],
+			  band->start_y >> scaler->dst_shifts[plane], plane_end(scaler, band, plane));
 	}
 
 	return true;
 }
+
+static void scale_bands(struct video_scaler *scaler)
+{
+	long band;
+
+	while ((band = os_atomic_inc_long(&scaler->next_band) - 1) < (long)scaler->band_count) {
+		if (scaler->fast_path != FAST_PATH_NONE)
+			scale_fast(scaler, &scaler->bands[band]);
+		else if (!scale_swscale(scaler, &scaler->bands[band]))
+			os_atomic_set_bool(&scaler->failed, true);
+	}
+}
+
+static void *scaler_thread(void *data)
+{
+	struct video_scaler *scaler = data;
+
+	os_set_thread_name("video-scaler");
+
+	while (os_sem_wait(scaler->work_sem) == 0) {
+		if (os_atomic_load_bool(&scaler->stop))
+			break;
+
+		scale_bands(scaler);
+		os_sem_post(scaler->done_sem);
+	}
+
+	return NULL;
+}
+
+bool video_scaler_scale(video_scaler_t *scaler, uint8_t *output[], const uint32_t out_linesize[],
+			const uint8_t *const input[], const uint32_t in_linesize[])
+{
+	if (!scaler)
+		return false;
+
+	scaler->input = input;
+	scaler->in_linesize = in_linesize;
+	scaler->output = output;
+	scaler->out_linesize = out_linesize;
+	scaler->failed = false;
+	os_atomic_set_long(&scaler->next_band, 0);
+
+	for (size_t i = 0; i < scaler->thread_count; i++)
+		os_sem_post(scaler->work_sem);
+
+	scale_bands(scaler);
+
+	for (size_t i = 0; i < scaler->thread_count; i++)
+		os_sem_wait(scaler->done_sem);
+
+	return !scaler->failed;
+}
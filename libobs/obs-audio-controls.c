@@ -61,6 +61,12 @@ struct meter_cb {
 	void *param;
 };
 
+struct volmeter_levels {
+	float magnitude[MAX_AUDIO_CHANNELS];
+	float peak[MAX_AUDIO_CHANNELS];
+	float input_peak[MAX_AUDIO_CHANNELS];
+};
+
 struct obs_volmeter {
 	pthread_mutex_t mutex;
 	obs_source_t *source;
@@ -71,13 +77,43 @@ struct obs_volmeter {
 	DARRAY(struct meter_cb) callbacks;
 
 	enum obs_peak_meter_type peak_meter_type;
-	unsigned int update_ms;
 	float prev_samples[MAX_AUDIO_CHANNELS][4];
 
-	float magnitude[MAX_AUDIO_CHANNELS];
+	/* accumulated since the levels were last published */
 	float peak[MAX_AUDIO_CHANNELS];
+	float power[MAX_AUDIO_CHANNELS];
+	size_t frames;
+	float mul;
+
+	/* published levels, double buffered so readers never block the
+	 * audio thread; levels[levels_seq & 1] is the current one */
+	struct volmeter_levels levels[2];
+	volatile long levels_seq;
+};
+
+struct volmeter_service_cb {
+	obs_volmeter_service_updated_t callback;
+	void *param;
 };
 
+/* All volume meters are published together from the audio thread at a fixed
+ * rate rather than once per source per audio tick. */
+#define VOLMETER_DEFAULT_RATE 30
+
+static pthread_mutex_t volmeter_service_mutex = PTHREAD_MUTEX_INITIALIZER;
+static DARRAY(struct obs_volmeter *) volmeter_service_meters;
+static DARRAY(struct volmeter_service_cb) volmeter_service_callbacks;
+static uint64_t volmeter_service_interval_ns = 1000000000ULL / VOLMETER_DEFAULT_RATE;
+static uint64_t volmeter_service_last_ts = 0;
+
+/* meter and service callbacks are called from copies of the lists without
+ * holding the service mutex, so they can create and destroy meters; the
+ * dispatch mutex lets removal wait for a running dispatch */
+static pthread_mutex_t volmeter_service_dispatch_mutex = PTHREAD_MUTEX_INITIALIZER;
+static DARRAY(struct obs_volmeter *) volmeter_service_dispatch_meters;
+static DARRAY(struct volmeter_service_cb) volmeter_service_dispatch;
+static THREAD_LOCAL bool volmeter_service_dispatching = false;
+
 static float cubic_def_to_db(const float def)
 {
 	if (def == 1.0f)
@@ -425,7 +461,7 @@ static void volmeter_process_peak(obs_volmeter_t *volmeter, const struct audio_d
 			printf("Audio plane %i is not aligned %p skipping "
 			       "peak volume measurement.\n",
 			       plane_nr, samples);
-			volmeter->peak[channel_nr] = 1.0;
+			volmeter->peak[channel_nr] = 1.0f;
 			channel_nr++;
 			continue;
 		}
@@ -448,15 +484,34 @@ static void volmeter_process_peak(obs_volmeter_t *volmeter, const struct audio_d
 
 		volmeter_process_peak_last_samples(volmeter, channel_nr, samples, nr_samples);
 
-		volmeter->peak[channel_nr] = peak;
+		if (peak > volmeter->peak[channel_nr])
+			volmeter->peak[channel_nr] = peak;
 
 		channel_nr++;
 	}
+}
+
+/* Sum of squares of the samples, used for the magnitude.
+ */
+static float get_power(const float *samples, size_t nr_samples)
+{
+	__m128 sum4 = _mm_setzero_ps();
+	size_t i = 0;
 
-	/* Clear the peak of the channels that have not been handled. */
-	for (; channel_nr < MAX_AUDIO_CHANNELS; channel_nr++) {
-		volmeter->peak[channel_nr] = 0.0;
+	if (((uintptr_t)samples & 0xf) == 0) {
+		for (; (i + 3) < nr_samples; i += 4) {
+			__m128 work = _mm_load_ps(&samples[i]);
+			sum4 = _mm_add_ps(sum4, _mm_mul_ps(work, work));
+		}
 	}
+
+	float sum4_mem[4];
+	_mm_storeu_ps(sum4_mem, sum4);
+	float sum = sum4_mem[0] + sum4_mem[1] + sum4_mem[2] + sum4_mem[3];
+
+	for (; i < nr_samples; i++)
+		sum += samples[i] * samples[i];
+	return sum;
 }
 
 static void volmeter_process_magnitude(obs_volmeter_t *volmeter, const struct audio_data *data, int nr_channels)
@@ -470,12 +525,7 @@ static void volmeter_process_magnitude(obs_volmeter_t *volmeter, const struct au
 			continue;
 		}
 
-		float sum = 0.0;
-		for (size_t i = 0; i < nr_samples; i++) {
-			float sample = samples[i];
-			sum += sample * sample;
-		}
-		volmeter->magnitude[channel_nr] = sqrtf(sum / nr_samples);
+		volmeter->power[channel_nr] += get_power(samples, nr_samples);
 
 		channel_nr++;
 	}
@@ -487,35 +537,128 @@ static void volmeter_process_audio_data(obs_volmeter_t *volmeter, const struct a
 
 	volmeter_process_peak(volmeter, data, nr_channels);
 	volmeter_process_magnitude(volmeter, data, nr_channels);
+	volmeter->frames += data->frames;
 }
 
 static void volmeter_source_data_received(void *vptr, obs_source_t *source, const struct audio_data *data, bool muted)
 {
 	struct obs_volmeter *volmeter = (struct obs_volmeter *)vptr;
-	float mul;
+
+	pthread_mutex_lock(&volmeter->mutex);
+
+	volmeter_process_audio_data(volmeter, data);
+
+	// Remember the volume level set by the user, it is applied to the
+	// levels when they are published.
+	volmeter->mul = muted && !obs_source_muted(source) ? 0.0f : db_to_mul(volmeter->cur_db);
+
+	pthread_mutex_unlock(&volmeter->mutex);
+}
+
+/* returns false if there was nothing to publish */
+static bool volmeter_publish(struct obs_volmeter *volmeter)
+{
 	float magnitude[MAX_AUDIO_CHANNELS];
 	float peak[MAX_AUDIO_CHANNELS];
 	float input_peak[MAX_AUDIO_CHANNELS];
 
 	pthread_mutex_lock(&volmeter->mutex);
 
-	volmeter_process_audio_data(volmeter, data);
+	/* nothing received, leave it to the consumer to detect idle meters */
+	if (!volmeter->frames) {
+		pthread_mutex_unlock(&volmeter->mutex);
+		return false;
+	}
 
 	// Adjust magnitude/peak based on the volume level set by the user.
 	// And convert to dB.
-	mul = muted && !obs_source_muted(source) ? 0.0f : db_to_mul(volmeter->cur_db);
 	for (int channel_nr = 0; channel_nr < MAX_AUDIO_CHANNELS; channel_nr++) {
-		magnitude[channel_nr] = mul_to_db(volmeter->magnitude[channel_nr] * mul);
-		peak[channel_nr] = mul_to_db(volmeter->peak[channel_nr] * mul);
+		float rms = sqrtf(volmeter->power[channel_nr] / (float)volmeter->frames);
+
+		magnitude[channel_nr] = mul_to_db(rms * volmeter->mul);
+		peak[channel_nr] = mul_to_db(volmeter->peak[channel_nr] * volmeter->mul);
 
 		/* The input-peak is NOT adjusted with volume, so that the user
 		 * can check the input-gain. */
 		input_peak[channel_nr] = mul_to_db(volmeter->peak[channel_nr]);
+
+		volmeter->peak[channel_nr] = 0.0f;
+		volmeter->power[channel_nr] = 0.0f;
 	}
 
+	volmeter->frames = 0;
+
 	pthread_mutex_unlock(&volmeter->mutex);
 
-	signal_levels_updated(volmeter, magnitude, peak, input_peak);
+	/* only ever written from the audio thread, write the buffer readers are
+	 * not looking at and then flip */
+	long seq = volmeter->levels_seq + 1;
+	struct volmeter_levels *levels = &volmeter->levels[seq & 1];
+
+	memcpy(levels->magnitude, magnitude, sizeof(magnitude));
+	memcpy(levels->peak, peak, sizeof(peak));
+	memcpy(levels->input_peak, input_peak, sizeof(input_peak));
+	os_atomic_set_long(&volmeter->levels_seq, seq);
+	return true;
+}
+
+void obs_volmeter_service_tick(uint64_t ts)
+{
+	/* callbacks may take the service mutex, so it always nests inside the
+	 * dispatch mutex */
+	pthread_mutex_lock(&volmeter_service_dispatch_mutex);
+	pthread_mutex_lock(&volmeter_service_mutex);
+
+	if (ts - volmeter_service_last_ts < volmeter_service_interval_ns) {
+		pthread_mutex_unlock(&volmeter_service_mutex);
+		pthread_mutex_unlock(&volmeter_service_dispatch_mutex);
+		return;
+	}
+
+	/* advance by whole intervals so the rate doesn't drift with the audio
+	 * tick period, but don't try to catch up after falling behind */
+	volmeter_service_last_ts += volmeter_service_interval_ns;
+	if (ts - volmeter_service_last_ts >= volmeter_service_interval_ns)
+		volmeter_service_last_ts = ts;
+
+	da_resize(volmeter_service_dispatch_meters, 0);
+	for (size_t i = 0; i < volmeter_service_meters.num; i++) {
+		struct obs_volmeter *volmeter = volmeter_service_meters.array[i];
+		if (volmeter_publish(volmeter))
+			da_push_back(volmeter_service_dispatch_meters, &volmeter);
+	}
+
+	da_copy(volmeter_service_dispatch, volmeter_service_callbacks);
+	pthread_mutex_unlock(&volmeter_service_mutex);
+
+	volmeter_service_dispatching = true;
+
+	/* levels are only written by this thread, so they can be read from
+	 * the snapshot directly; destroyed meters are set to NULL */
+	for (size_t i = 0; i < volmeter_service_dispatch_meters.num; i++) {
+		struct obs_volmeter *volmeter = volmeter_service_dispatch_meters.array[i];
+		if (!volmeter)
+			continue;
+
+		const struct volmeter_levels *levels = &volmeter->levels[volmeter->levels_seq & 1];
+		signal_levels_updated(volmeter, levels->magnitude, levels->peak, levels->input_peak);
+	}
+
+	for (size_t i = volmeter_service_dispatch.num; i > 0; i--) {
+		struct volmeter_service_cb cb = volmeter_service_dispatch.array[i - 1];
+		cb.callback(cb.param);
+	}
+	volmeter_service_dispatching = false;
+
+	pthread_mutex_unlock(&volmeter_service_dispatch_mutex);
+}
+
+void obs_volmeter_service_free(void)
+{
+	pthread_mutex_lock(&volmeter_service_dispatch_mutex);
+	da_free(volmeter_service_dispatch_meters);
+	da_free(volmeter_service_dispatch);
+	pthread_mutex_unlock(&volmeter_service_dispatch_mutex);
 }
 
 obs_fader_t *obs_fader_create(enum obs_fader_type type)
@@ -743,6 +886,10 @@ obs_volmeter_t *obs_volmeter_create(enum obs_fader_type type)
 
 	volmeter->type = type;
 
+	pthread_mutex_lock(&volmeter_service_mutex);
+	da_push_back(volmeter_service_meters, &volmeter);
+	pthread_mutex_unlock(&volmeter_service_mutex);
+
 	return volmeter;
 fail:
 	obs_volmeter_destroy(volmeter);
@@ -754,6 +901,22 @@ void obs_volmeter_destroy(obs_volmeter_t *volmeter)
 	if (!volmeter)
 		return;
 
+	pthread_mutex_lock(&volmeter_service_mutex);
+	da_erase_item(volmeter_service_meters, &volmeter);
+	pthread_mutex_unlock(&volmeter_service_mutex);
+
+	/* when destroyed from within a callback, the running dispatch must
+	 * skip it, otherwise wait for a dispatch that may still signal it */
+	if (volmeter_service_dispatching) {
+		for (size_t i = 0; i < volmeter_service_dispatch_meters.num; i++) {
+			if (volmeter_service_dispatch_meters.array[i] == volmeter)
+				volmeter_service_dispatch_meters.array[i] = NULL;
+		}
+	} else {
+		pthread_mutex_lock(&volmeter_service_dispatch_mutex);
+		pthread_mutex_unlock(&volmeter_service_dispatch_mutex);
+	}
+
 	obs_volmeter_detach_source(volmeter);
 	da_free(volmeter->callbacks);
 	pthread_mutex_destroy(&volmeter->callback_mutex);
@@ -862,6 +1025,72 @@ void obs_volmeter_remove_callback(obs_volmeter_t *volmeter, obs_volmeter_updated
 	pthread_mutex_unlock(&volmeter->callback_mutex);
 }
 
+uint32_t obs_volmeter_get_levels_sequence(obs_volmeter_t *volmeter)
+{
+	if (!obs_ptr_valid(volmeter, "obs_volmeter_get_levels_sequence"))
+		return 0;
+
+	return (uint32_t)os_atomic_load_long(&volmeter->levels_seq);
+}
+
+bool obs_volmeter_get_levels(obs_volmeter_t *volmeter, float magnitude[MAX_AUDIO_CHANNELS],
+			     float peak[MAX_AUDIO_CHANNELS], float input_peak[MAX_AUDIO_CHANNELS])
+{
+	long seq;
+
+	if (!obs_ptr_valid(volmeter, "obs_volmeter_get_levels"))
+		return false;
+
+	/* retry if the buffer was flipped while copying */
+	do {
+		seq = os_atomic_load_long(&volmeter->levels_seq);
+		if (!seq)
+			return false;
+
+		const struct volmeter_levels *levels = &volmeter->levels[seq & 1];
+		memcpy(magnitude, levels->magnitude, sizeof(levels->magnitude));
+		memcpy(peak, levels->peak, sizeof(levels->peak));
+		memcpy(input_peak, levels->input_peak, sizeof(levels->input_peak));
+	} while (os_atomic_load_long(&volmeter->levels_seq) != seq);
+
+	return true;
+}
+
+void obs_volmeter_service_set_rate(uint32_t updates_per_sec)
+{
+	if (!updates_per_sec)
+		updates_per_sec = VOLMETER_DEFAULT_RATE;
+
+	pthread_mutex_lock(&volmeter_service_mutex);
+	volmeter_service_interval_ns = 1000000000ULL / updates_per_sec;
+	pthread_mutex_unlock(&volmeter_service_mutex);
+}
+
+void obs_volmeter_service_add_callback(obs_volmeter_service_updated_t callback, void *param)
+{
+	struct volmeter_service_cb cb = {callback, param};
+
+	pthread_mutex_lock(&volmeter_service_mutex);
+	da_push_back(volmeter_service_callbacks, &cb);
+	pthread_mutex_unlock(&volmeter_service_mutex);
+}
+
+void obs_volmeter_service_remove_callback(obs_volmeter_service_updated_t callback, void *param)
+{
+	struct volmeter_service_cb cb = {callback, param};
+
+	pthread_mutex_lock(&volmeter_service_mutex);
+	da_erase_item(volmeter_service_callbacks, &cb);
+	pthread_mutex_unlock(&volmeter_service_mutex);
+
+	/* wait for a dispatch that may still call it, unless removed from
+	 * within a callback */
+	if (!volmeter_service_dispatching) {
+		pthread_mutex_lock(&volmeter_service_dispatch_mutex);
+		pthread_mutex_unlock(&volmeter_service_dispatch_mutex);
+	}
+}
+
 float obs_mul_to_db(float mul)
 {
 	return mul_to_db(mul);
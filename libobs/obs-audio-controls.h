@@ -238,6 +238,52 @@ typedef void (*obs_volmeter_updated_t)(void *param, const float magnitude[MAX_AU
 EXPORT void obs_volmeter_add_callback(obs_volmeter_t *volmeter, obs_volmeter_updated_t callback, void *param);
 EXPORT void obs_volmeter_remove_callback(obs_volmeter_t *volmeter, obs_volmeter_updated_t callback, void *param);
 
+/**
+ * @brief Get the most recently published levels of a volume meter
+ * @param volmeter pointer to the volume meter object
+ * @return false if no levels have been published yet
+ *
+ * Levels of all volume meters are published together by the audio thread at
+ * the rate set with obs_volmeter_service_set_rate(), after which the callbacks
+ * of each volume meter are called.  This function never blocks, so it can be
+ * used to poll levels from a UI thread instead of using callbacks.
+ */
+EXPORT bool obs_volmeter_get_levels(obs_volmeter_t *volmeter, float magnitude[MAX_AUDIO_CHANNELS],
+				    float peak[MAX_AUDIO_CHANNELS], float input_peak[MAX_AUDIO_CHANNELS]);
+
+/**
+ * @brief Get a number that changes each time levels are published
+ * @param volmeter pointer to the volume meter object
+ * @return 0 if no levels have been published yet
+ *
+ * Lets a poller tell new levels apart from levels it has already read, for
+ * example to detect that a source stopped sending audio.
+ */
+EXPORT uint32_t obs_volmeter_get_levels_sequence(obs_volmeter_t *volmeter);
+
+/**
+ * @brief Set how many times per second volume meter levels are published
+ * @param updates_per_sec updates per second, 0 for the default of 30
+ */
+EXPORT void obs_volmeter_service_set_rate(uint32_t updates_per_sec);
+
+typedef void (*obs_volmeter_service_updated_t)(void *param);
+
+/**
+ * @brief Add a callback that is called once after the levels of all volume
+ * meters have been published, from the audio thread
+ */
+EXPORT void obs_volmeter_service_add_callback(obs_volmeter_service_updated_t callback, void *param);
+
+/**
+ * @brief Remove a callback added with obs_volmeter_service_add_callback()
+ *
+ * Waits for an update that is calling the callbacks to finish, so param can
+ * be freed afterwards.  When called from within a callback, it only stops
+ * the callback from being called on later updates.
+ */
+EXPORT void obs_volmeter_service_remove_callback(obs_volmeter_service_updated_t callback, void *param);
+
 EXPORT float obs_mul_to_db(float mul);
 EXPORT float obs_db_to_mul(float db);
 
@@ -45,8 +45,8 @@ static inline size_t convert_time_to_frames(size_t sample_rate, uint64_t t)
 	return (size_t)util_mul_div64(t, sample_rate, 1000000000ULL);
 }
 
-static inline void mix_audio(struct audio_output_data *mixes, obs_source_t *source, size_t channels, size_t sample_rate,
-			     struct ts_info *ts)
+static inline void mix_audio(struct audio_output_data *mixes, obs_source_t *source, uint32_t mixers, size_t channels,
+			     size_t sample_rate, struct ts_info *ts)
 {
 	size_t total_floats = AUDIO_OUTPUT_FRAMES;
 	size_t start_point = 0;
@@ -63,6 +63,10 @@ static inline void mix_audio(struct audio_output_data *mixes, obs_source_t *sour
 	}
 
 	for (size_t mix_idx = 0; mix_idx < MAX_AUDIO_MIXES; mix_idx++) {
+		/* mixes without outputs are neither cleared nor rendered */
+		if ((mixers & (1 << mix_idx)) == 0)
+			continue;
+
 		for (size_t ch = 0; ch < channels; ch++) {
 			register float *mix = mixes[mix_idx].data[ch];
 			register float *aud = source->audio_output_buf[mix_idx][ch];
@@ -523,6 +527,7 @@ bool audio_callback(void *param, uint64_t start_ts_in, uint64_t end_ts_in, uint6
 
 	source = data->first_audio_source;
 	while (source) {
+		obs_source_process_audio_input(source);
 		push_audio_tree(NULL, source, audio);
 		source = (struct obs_source *)source->next_audio_source;
 	}
@@ -551,9 +556,7 @@ bool audio_callback(void *param, uint64_t start_ts_in, uint64_t end_ts_in, uint6
 				assert(false);
 #endif
 			} else {
-				pthread_mutex_lock(&source->audio_buf_mutex);
 				bool rerender = ignore_audio(source, channels, sample_rate, ts.start);
-				pthread_mutex_unlock(&source->audio_buf_mutex);
 
 				/* if we (potentially) recovered, re-render */
 				if (rerender)
@@ -587,12 +590,8 @@ bool audio_callback(void *param, uint64_t start_ts_in, uint64_t end_ts_in, uint6
 			if (source->audio_pending)
 				continue;
 
-			pthread_mutex_lock(&source->audio_buf_mutex);
-
 			if (source->audio_output_buf[0][0] && source->audio_ts)
-				mix_audio(mixes, source, channels, sample_rate, &ts);
-
-			pthread_mutex_unlock(&source->audio_buf_mutex);
+				mix_audio(mixes, source, mixers, channels, sample_rate, &ts);
 		}
 	}
 
@@ -602,10 +601,7 @@ bool audio_callback(void *param, uint64_t start_ts_in, uint64_t end_ts_in, uint6
 
 	source = data->first_audio_source;
 	while (source) {
-		pthread_mutex_lock(&source->audio_buf_mutex);
 		discard_audio(audio, source, channels, sample_rate, &ts);
-		pthread_mutex_unlock(&source->audio_buf_mutex);
-
 		source = (struct obs_source *)source->next_audio_source;
 	}
 
@@ -615,6 +611,10 @@ bool audio_callback(void *param, uint64_t start_ts_in, uint64_t end_ts_in, uint6
 	/* release audio sources */
 	release_audio_sources(audio);
 
+	/* ------------------------------------------------ */
+	/* publish volume meter levels */
+	obs_volmeter_service_tick(os_gettime_ns());
+
 	deque_pop_front(&audio->buffered_timestamps, NULL, sizeof(ts));
 
 	*out_ts = ts.start;
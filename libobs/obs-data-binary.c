@@ -0,0 +1,751 @@
+/******************************************************************************
+    Copyright (C) 2026 by OBS Project contributors
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+******************************************************************************/
+
+#include "util/bmem.h"
+#include "util/darray.h"
+#include "util/platform.h"
+#include "util/uthash.h"
+#include "util/array-serializer.h"
+#include "obs-data.h"
+
+/*
+ * Binary snapshot layout, all values little endian:
+ *
+ *   header:  "OBSB", u32 version, u32 key table offset, u32 key count
+ *   root:    object
+ *   keys:    key count * (u32 length, bytes)
+ *
+ *   object:  u32 body size, u32 member count,
+ *            member count * (u32 key index, u8 type, value)
+ *   array:   u32 body size, u32 object count, object count * object
+ *
+ *   values:  string = u32 length, bytes
+ *            int    = i64
+ *            double = f64
+ *            bool   = u8
+ *
+ * Body sizes allow whole objects and arrays to be skipped without decoding
+ * them, which is what lets a snapshot only materialize the parts that are
+ * actually requested.
+ */
+
+#define BINARY_MAGIC "OBSB"
+#define BINARY_VERSION 1
+#define BINARY_HEADER_SIZE 16
+#define BINARY_MAX_DEPTH 2048
+
+enum binary_type {
+	BINARY_STRING = 1,
+	BINARY_INT,
+	BINARY_DOUBLE,
+	BINARY_BOOL,
+	BINARY_OBJECT,
+	BINARY_ARRAY,
+};
+
+/* ------------------------------------------------------------------------- */
+/* Writer */
+
+struct key_index {
+	const char *name;
+	uint32_t idx;
+	UT_hash_handle hh;
+};
+
+struct binary_writer {
+	struct serializer s;
+	struct array_output_data out;
+	struct key_index *keys;
+	DARRAY(const char *) key_list;
+};
+
+static uint32_t writer_key(struct binary_writer *w, const char *name)
+{
+	struct key_index *key;
+
+	HASH_FIND_STR(w->keys, name, key);
+	if (key)
+		return key->idx;
+
+	key = bmalloc(sizeof(struct key_index));
+	key->name = name;
+	key->idx = (uint32_t)w->key_list.num;
+	HASH_ADD_KEYPTR(hh, w->keys, name, strlen(name), key);
+	da_push_back(w->key_list, &name);
+
+	return key->idx;
+}
+
+static inline size_t writer_begin_size(struct binary_writer *w)
+{
+	size_t pos = w->out.bytes.num;
+	s_wl32(&w->s, 0);
+	return pos;
+}
+
+static inline void writer_patch_u32(struct binary_writer *w, size_t pos, uint32_t val)
+{
+	uint8_t *dst = w->out.bytes.array + pos;
+
+	dst[0] = (uint8_t)val;
+	dst[1] = (uint8_t)(val >> 8);
+	dst[2] = (uint8_t)(val >> 16);
+	dst[3] = (uint8_t)(val >> 24);
+}
+
+static inline void writer_end_size(struct binary_writer *w, size_t pos)
+{
+	writer_patch_u32(w, pos, (uint32_t)(w->out.bytes.num - pos - 4));
+}
+
+static void write_object(struct binary_writer *w, obs_data_t *data);
+
+static void write_array(struct binary_writer *w, obs_data_array_t *array)
+{
+	size_t count = obs_data_array_count(array);
+	size_t size_pos = writer_begin_size(w);
+
+	s_wl32(&w->s, (uint32_t)count);
+
+	for (size_t i = 0; i < count; i++) {
+		obs_data_t *obj = obs_data_array_item(array, i);
+		write_object(w, obj);
+		obs_data_release(obj);
+	}
+
+	writer_end_size(w, size_pos);
+}
+
+static void write_item(struct binary_writer *w, obs_data_item_t *item)
+{
+	switch (obs_data_item_gettype(item)) {
+	case OBS_DATA_STRING: {
+		const char *str = obs_data_item_get_string(item);
+		size_t len = strlen(str);
+
+		s_w8(&w->s, BINARY_STRING);
+		s_wl32(&w->s, (uint32_t)len);
+		s_write(&w->s, str, len);
+		break;
+	}
+
+	case OBS_DATA_NUMBER:
+		if (obs_data_item_numtype(item) == OBS_DATA_NUM_INT) {
+			s_w8(&w->s, BINARY_INT);
+			s_wl64(&w->s, (uint64_t)obs_data_item_get_int(item));
+		} else {
+			s_w8(&w->s, BINARY_DOUBLE);
+			s_wld(&w->s, obs_data_item_get_double(item));
+		}
+		break;
+
+	case OBS_DATA_BOOLEAN:
+		s_w8(&w->s, BINARY_BOOL);
+		s_w8(&w->s, obs_data_item_get_bool(item) ? 1 : 0);
+		break;
+
+	case OBS_DATA_OBJECT: {
+		obs_data_t *obj = obs_data_item_get_obj(item);
+		s_w8(&w->s, BINARY_OBJECT);
+		write_object(w, obj);
+		obs_data_release(obj);
+		break;
+	}
+
+	case OBS_DATA_ARRAY: {
+		obs_data_array_t *array = obs_data_item_get_array(item);
+		s_w8(&w->s, BINARY_ARRAY);
+		write_array(w, array);
+		obs_data_array_release(array);
+		break;
+	}
+
+	case OBS_DATA_NULL:
+		break;
+	}
+}
+
+static void write_object(struct binary_writer *w, obs_data_t *data)
+{
+	size_t size_pos = writer_begin_size(w);
+	size_t count_pos = writer_begin_size(w);
+	uint32_t count = 0;
+
+	for (obs_data_item_t *item = obs_data_first(data); item; obs_data_item_next(&item)) {
+		/* same as json, only user values are stored */
+		if (!obs_data_item_has_user_value(item) || obs_data_item_gettype(item) == OBS_DATA_NULL)
+			continue;
+
+		s_wl32(&w->s, writer_key(w, obs_data_item_get_name(item)));
+		write_item(w, item);
+		count++;
+	}
+
+	writer_patch_u32(w, count_pos, count);
+	writer_end_size(w, size_pos);
+}
+
+void *obs_data_get_binary(obs_data_t *data, size_t *size)
+{
+	struct binary_writer w = {0};
+	struct key_index *key, *tmp;
+	size_t offset_pos;
+	size_t count_pos;
+
+	if (!data || !size)
+		return NULL;
+
+	array_output_serializer_init(&w.s, &w.out);
+
+	s_write(&w.s, BINARY_MAGIC, 4);
+	s_wl32(&w.s, BINARY_VERSION);
+	offset_pos = writer_begin_size(&w);
+	count_pos = writer_begin_size(&w);
+
+	write_object(&w, data);
+
+	writer_patch_u32(&w, offset_pos, (uint32_t)w.out.bytes.num);
+	writer_patch_u32(&w, count_pos, (uint32_t)w.key_list.num);
+
+	for (size_t i = 0; i < w.key_list.num; i++) {
+		const char *name = w.key_list.array[i];
+		size_t len = strlen(name);
+
+		s_wl32(&w.s, (uint32_t)len);
+		s_write(&w.s, name, len);
+	}
+
+	HASH_ITER (hh, w.keys, key, tmp) {
+		HASH_DEL(w.keys, key);
+		bfree(key);
+	}
+	da_free(w.key_list);
+
+	*size = w.out.bytes.num;
+	return w.out.bytes.array;
+}
+
+bool obs_data_save_binary_safe(obs_data_t *data, const char *file, const char *temp_ext, const char *backup_ext)
+{
+	size_t size;
+	void *buf = obs_data_get_binary(data, &size);
+	bool success = false;
+
+	if (buf) {
+		/* writes raw bytes, no byte order marker */
+		success = os_quick_write_utf8_file_safe(file, buf, size, false, temp_ext, backup_ext);
+		bfree(buf);
+	}
+
+	return success;
+}
+
+/* ------------------------------------------------------------------------- */
+/* Reader */
+
+struct binary_reader {
+	const uint8_t *data;
+	size_t size;
+	DARRAY(char *) keys;
+};
+
+struct cursor {
+	const uint8_t *pos;
+	const uint8_t *end;
+};
+
+static inline bool read_u8(struct cursor *c, uint8_t *val)
+{
+	if (c->end - c->pos < 1)
+		return false;
+
+	*val = *c->pos++;
+	return true;
+}
+
+static inline bool read_u32(struct cursor *c, uint32_t *val)
+{
+	if (c->end - c->pos < 4)
+		return false;
+
+	*val = (uint32_t)c->pos[0] | ((uint32_t)c->pos[1] << 8) | ((uint32_t)c->pos[2] << 16) |
+	       ((uint32_t)c->pos[3] << 24);
+	c->pos += 4;
+	return true;
+}
+
+static inline bool read_u64(struct cursor *c, uint64_t *val)
+{
+	uint32_t low, high;
+
+	if (!read_u32(c, &low) || !read_u32(c, &high))
+		return false;
+
+	*val = (uint64_t)low | ((uint64_t)high << 32);
+	return true;
+}
+
+/* strings are not terminated in the buffer, and the key table ends it, so
+ * bstrdup_n (which copies len + 1 bytes) would read past the end */
+static char *read_str_copy(const uint8_t *pos, uint32_t len)
+{
+	char *str = bmalloc((size_t)len + 1);
+	memcpy(str, pos, len);
+	str[len] = 0;
+	return str;
+}
+
+/* splits off a sized body (object or array) from the cursor */
+static inline bool read_body(struct cursor *c, struct cursor *body)
+{
+	uint32_t size;
+
+	if (!read_u32(c, &size) || (size_t)(c->end - c->pos) < size)
+		return false;
+
+	body->pos = c->pos;
+	body->end = c->pos + size;
+	c->pos += size;
+	return true;
+}
+
+static bool skip_value(struct cursor *c, uint8_t type)
+{
+	struct cursor body;
+	uint32_t len;
+
+	switch (type) {
+	case BINARY_STRING:
+		if (!read_u32(c, &len) || (size_t)(c->end - c->pos) < len)
+			return false;
+		c->pos += len;
+		return true;
+	case BINARY_INT:
+	case BINARY_DOUBLE:
+		if (c->end - c->pos < 8)
+			return false;
+		c->pos += 8;
+		return true;
+	case BINARY_BOOL:
+		if (c->end - c->pos < 1)
+			return false;
+		c->pos++;
+		return true;
+	case BINARY_OBJECT:
+	case BINARY_ARRAY:
+		return read_body(c, &body);
+	}
+
+	return false;
+}
+
+static bool read_object_body(struct binary_reader *r, struct cursor *body, obs_data_t *data, int depth);
+
+static bool read_object(struct binary_reader *r, struct cursor *c, obs_data_t *data, int depth)
+{
+	struct cursor body;
+	return read_body(c, &body) && read_object_body(r, &body, data, depth);
+}
+
+static bool read_array(struct binary_reader *r, struct cursor *c, obs_data_array_t *array, int depth)
+{
+	struct cursor body;
+	uint32_t count;
+
+	if (!read_body(c, &body) || !read_u32(&body, &count))
+		return false;
+
+	for (uint32_t i = 0; i < count; i++) {
+		obs_data_t *obj = obs_data_create();
+		bool success = read_object(r, &body, obj, depth + 1);
+
+		if (success)
+			obs_data_array_push_back(array, obj);
+		obs_data_release(obj);
+
+		if (!success)
+			return false;
+	}
+
+	return true;
+}
+
+static bool read_value(struct binary_reader *r, struct cursor *c, obs_data_t *data, const char *name, uint8_t type,
+		       int depth)
+{
+	switch (type) {
+	case BINARY_STRING: {
+		uint32_t len;
+		char *str;
+
+		if (!read_u32(c, &len) || (size_t)(c->end - c->pos) < len)
+			return false;
+
+		str = read_str_copy(c->pos, len);
+		obs_data_set_string(data, name, str);
+		bfree(str);
+
+		c->pos += len;
+		return true;
+	}
+
+	case BINARY_INT: {
+		uint64_t val;
+		if (!read_u64(c, &val))
+			return false;
+		obs_data_set_int(data, name, (long long)val);
+		return true;
+	}
+
+	case BINARY_DOUBLE: {
+		uint64_t bits;
+		double val;
+
+		if (!read_u64(c, &bits))
+			return false;
+
+		memcpy(&val, &bits, sizeof(val));
+		obs_data_set_double(data, name, val);
+		return true;
+	}
+
+	case BINARY_BOOL: {
+		uint8_t val;
+		if (!read_u8(c, &val))
+			return false;
+		obs_data_set_bool(data, name, val != 0);
+		return true;
+	}
+
+	case BINARY_OBJECT: {
+		obs_data_t *obj = obs_data_create();
+		bool success = read_object(r, c, obj, depth + 1);
+
+		if (success)
+			obs_data_set_obj(data, name, obj);
+		obs_data_release(obj);
+		return success;
+	}
+
+	case BINARY_ARRAY: {
+		obs_data_array_t *array = obs_data_array_create();
+		bool success = read_array(r, c, array, depth + 1);
+
+		if (success)
+			obs_data_set_array(data, name, array);
+		obs_data_array_release(array);
+		return success;
+	}
+	}
+
+	return false;
+}
+
+static inline bool read_member(struct binary_reader *r, struct cursor *c, const char **name, uint8_t *type)
+{
+	uint32_t key;
+
+	if (!read_u32(c, &key) || !read_u8(c, type) || key >= r->keys.num)
+		return false;
+
+	*name = r->keys.array[key];
+	return true;
+}
+
+static bool read_object_body(struct binary_reader *r, struct cursor *body, obs_data_t *data, int depth)
+{
+	uint32_t count;
+
+	if (depth > BINARY_MAX_DEPTH || !read_u32(body, &count))
+		return false;
+
+	for (uint32_t i = 0; i < count; i++) {
+		const char *name;
+		uint8_t type;
+
+		if (!read_member(r, body, &name, &type))
+			return false;
+		if (!read_value(r, body, data, name, type, depth))
+			return false;
+	}
+
+	return true;
+}
+
+static bool binary_reader_init(struct binary_reader *r, const void *data, size_t size, struct cursor *root)
+{
+	struct cursor header = {data, (const uint8_t *)data + size};
+	struct cursor keys;
+	uint32_t version, offset, count;
+
+	memset(r, 0, sizeof(*r));
+	r->data = data;
+	r->size = size;
+
+	if (!data || size < BINARY_HEADER_SIZE || memcmp(data, BINARY_MAGIC, 4) != 0)
+		return false;
+
+	header.pos += 4;
+	read_u32(&header, &version);
+	read_u32(&header, &offset);
+	read_u32(&header, &count);
+
+	if (version != BINARY_VERSION || offset < BINARY_HEADER_SIZE || offset > size)
+		return false;
+
+	keys.pos = r->data + offset;
+	keys.end = r->data + size;
+
+	for (uint32_t i = 0; i < count; i++) {
+		uint32_t len;
+		char *name;
+
+		if (!read_u32(&keys, &len) || (size_t)(keys.end - keys.pos) < len)
+			return false;
+
+		name = read_str_copy(keys.pos, len);
+		da_push_back(r->keys, &name);
+		keys.pos += len;
+	}
+
+	root->pos = header.pos;
+	root->end = r->data + offset;
+	return true;
+}
+
+static void binary_reader_free(struct binary_reader *r)
+{
+	for (size_t i = 0; i < r->keys.num; i++)
+		bfree(r->keys.array[i]);
+	da_free(r->keys);
+}
+
+obs_data_t *obs_data_create_from_binary(const void *buf, size_t size)
+{
+	struct binary_reader r;
+	struct cursor root;
+	obs_data_t *data = NULL;
+
+	if (binary_reader_init(&r, buf, size, &root)) {
+		data = obs_data_create();
+
+		if (!read_object(&r, &root, data, 0)) {
+			obs_data_release(data);
+			data = NULL;
+		}
+	}
+
+	if (!data)
+		blog(LOG_ERROR, "obs-data-binary.c: [obs_data_create_from_binary] "
+				"Invalid or corrupt binary data");
+
+	binary_reader_free(&r);
+	return data;
+}
+
+obs_data_t *obs_data_create_from_binary_file(const char *file)
+{
+	os_mmap_t *map = os_mmap_open(file, 0, false);
+	obs_data_t *data = NULL;
+
+	if (map) {
+		data = obs_data_create_from_binary(os_mmap_get_data(map), os_mmap_get_size(map));
+		os_mmap_close(map);
+	}
+
+	return data;
+}
+
+/* ------------------------------------------------------------------------- */
+/* Snapshots, lazily materialized from a memory mapped file */
+
+struct obs_data_snapshot {
+	os_mmap_t *map;
+	struct binary_reader reader;
+	struct cursor root;
+};
+
+obs_data_snapshot_t *obs_data_snapshot_open(const char *file)
+{
+	struct obs_data_snapshot *snapshot;
+	struct cursor root;
+	os_mmap_t *map;
+
+	map = os_mmap_open(file, 0, false);
+	if (!map)
+		return NULL;
+
+	snapshot = bzalloc(sizeof(struct obs_data_snapshot));
+	snapshot->map = map;
+
+	if (!binary_reader_init(&snapshot->reader, os_mmap_get_data(map), os_mmap_get_size(map), &root) ||
+	    !read_body(&root, &snapshot->root)) {
+		blog(LOG_ERROR, "obs-data-binary.c: [obs_data_snapshot_open] "
+				"Invalid or corrupt snapshot '%s'",
+		     file);
+		obs_data_snapshot_close(snapshot);
+		return NULL;
+	}
+
+	return snapshot;
+}
+
+void obs_data_snapshot_close(obs_data_snapshot_t *snapshot)
+{
+	if (!snapshot)
+		return;
+
+	binary_reader_free(&snapshot->reader);
+	os_mmap_close(snapshot->map);
+	bfree(snapshot);
+}
+
+/* finds a member of an object body without decoding any other member,
+ * leaves the cursor at the start of its value */
+static bool find_member(struct binary_reader *r, struct cursor body, const char *name, uint8_t *type,
+			struct cursor *value)
+{
+	uint32_t count;
+
+	if (!read_u32(&body, &count))
+		return false;
+
+	for (uint32_t i = 0; i < count; i++) {
+		const char *member;
+
+		if (!read_member(r, &body, &member, type))
+			return false;
+
+		if (strcmp(member, name) == 0) {
+			*value = body;
+			return true;
+		}
+
+		if (!skip_value(&body, *type))
+			return false;
+	}
+
+	return false;
+}
+
+static bool find_top_level(obs_data_snapshot_t *snapshot, const char *name, uint8_t expected, struct cursor *value)
+{
+	uint8_t type;
+
+	if (!snapshot || !name)
+		return false;
+	if (!find_member(&snapshot->reader, snapshot->root, name, &type, value))
+		return false;
+
+	return type == expected;
+}
+
+obs_data_t *obs_data_snapshot_get_obj(obs_data_snapshot_t *snapshot, const char *name)
+{
+	struct cursor value;
+	obs_data_t *data;
+
+	if (!find_top_level(snapshot, name, BINARY_OBJECT, &value))
+		return NULL;
+
+	data = obs_data_create();
+	if (!read_object(&snapshot->reader, &value, data, 1)) {
+		obs_data_release(data);
+		data = NULL;
+	}
+
+	return data;
+}
+
+static bool find_array(obs_data_snapshot_t *snapshot, const char *name, struct cursor *body, uint32_t *count)
+{
+	struct cursor value;
+
+	return find_top_level(snapshot, name, BINARY_ARRAY, &value) && read_body(&value, body) &&
+	       read_u32(body, count);
+}
+
+size_t obs_data_snapshot_array_count(obs_data_snapshot_t *snapshot, const char *name)
+{
+	struct cursor body;
+	uint32_t count;
+
+	return find_array(snapshot, name, &body, &count) ? count : 0;
+}
+
+obs_data_t *obs_data_snapshot_array_item(obs_data_snapshot_t *snapshot, const char *name, size_t idx)
+{
+	struct cursor body, item;
+	uint32_t count;
+	obs_data_t *data;
+
+	if (!find_array(snapshot, name, &body, &count) || idx >= count)
+		return NULL;
+
+	for (size_t i = 0; i < idx; i++) {
+		if (!read_body(&body, &item))
+			return NULL;
+	}
+
+	data = obs_data_create();
+	if (!read_object(&snapshot->reader, &body, data, 2)) {
+		obs_data_release(data);
+		data = NULL;
+	}
+
+	return data;
+}
+
+static bool string_equals(struct cursor value, const char *str)
+{
+	uint32_t len;
+
+	if (!read_u32(&value, &len) || (size_t)(value.end - value.pos) < len)
+		return false;
+
+	return strlen(str) == len && memcmp(value.pos, str, len) == 0;
+}
+
+obs_data_t *obs_data_snapshot_array_find(obs_data_snapshot_t *snapshot, const char *name, const char *key,
+					 const char *value)
+{
+	struct cursor body, item, member;
+	uint32_t count;
+	uint8_t type;
+
+	if (!key || !value || !find_array(snapshot, name, &body, &count))
+		return NULL;
+
+	for (uint32_t i = 0; i < count; i++) {
+		if (!read_body(&body, &item))
+			return NULL;
+
+		if (find_member(&snapshot->reader, item, key, &type, &member) && type == BINARY_STRING &&
+		    string_equals(member, value)) {
+			obs_data_t *data = obs_data_create();
+
+			if (!read_object_body(&snapshot->reader, &item, data, 2)) {
+				obs_data_release(data);
+				data = NULL;
+			}
+
+			return data;
+		}
+	}
+
+	return NULL;
+}
@@ -0,0 +1,955 @@
+/******************************************************************************
+    Copyright (C) 2026 by OBS Project contributors
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+******************************************************************************/
+
+#include <errno.h>
+#include <locale.h>
+#include <math.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "util/bmem.h"
+#include "util/platform.h"
+#include "util/uthash.h"
+#include "obs-data-json.h"
+
+/* same limit jansson uses */
+#define JSON_MAX_DEPTH 2048
+
+#define KEY_BLOCK_SIZE 4096
+#define KEY_TABLE_MIN_SIZE 256
+
+/* ------------------------------------------------------------------------- */
+/* Key interning arena
+ *
+ * A key has to stay valid while its value is parsed, which may recurse into
+ * child objects, and scene collections repeat the same few key names
+ * thousands of times.  Keys are therefore interned once per parse into large
+ * blocks rather than being allocated one by one. */
+
+struct key_block {
+	struct key_block *next;
+	char *data;
+	size_t used;
+	size_t size;
+};
+
+struct key_entry {
+	uint32_t hash;
+	uint32_t len;
+	const char *str;
+};
+
+struct key_arena {
+	struct key_block *blocks;
+	struct key_entry *table;
+	size_t table_size;
+	size_t count;
+};
+
+static inline uint32_t key_hash(const char *str, size_t len)
+{
+	uint32_t hash = 2166136261u;
+
+	for (size_t i = 0; i < len; i++) {
+		hash ^= (uint8_t)str[i];
+		hash *= 16777619u;
+	}
+
+	return hash;
+}
+
+static const char *key_arena_store(struct key_arena *arena, const char *str, size_t len)
+{
+	struct key_block *block = arena->blocks;
+	char *dst;
+
+	if (!block || block->size - block->used < len + 1) {
+		size_t size = len + 1 > KEY_BLOCK_SIZE ? len + 1 : KEY_BLOCK_SIZE;
+
+		block = bmalloc(sizeof(struct key_block) + size);
+		block->data = (char *)block + sizeof(struct key_block);
+		block->used = 0;
+		block->size = size;
+		block->next = arena->blocks;
+		arena->blocks = block;
+	}
+
+	dst = block->data + block->used;
+	memcpy(dst, str, len);
+	dst[len] = 0;
+
+	block->used += len + 1;
+	return dst;
+}
+
+static void key_arena_grow(struct key_arena *arena)
+{
+	size_t new_size = arena->table_size ? arena->table_size * 2 : KEY_TABLE_MIN_SIZE;
+	struct key_entry *table = bzalloc(new_size * sizeof(struct key_entry));
+
+	for (size_t i = 0; i < arena->table_size; i++) {
+		struct key_entry *entry = &arena->table[i];
+		size_t idx;
+
+		if (!entry->str)
+			continue;
+
+		idx = entry->hash & (new_size - 1);
+		while (table[idx].str)
+			idx = (idx + 1) & (new_size - 1);
+
+		table[idx] = *entry;
+	}
+
+	bfree(arena->table);
+	arena->table = table;
+	arena->table_size = new_size;
+}
+
+static const char *key_arena_intern(struct key_arena *arena, const char *str, size_t len)
+{
+	struct key_entry *entry;
+	uint32_t hash;
+	size_t mask;
+	size_t idx;
+
+	if ((arena->count + 1) * 4 > arena->table_size * 3)
+		key_arena_grow(arena);
+
+	hash = key_hash(str, len);
+	mask = arena->table_size - 1;
+	idx = hash & mask;
+
+	while (arena->table[idx].str) {
+		entry = &arena->table[idx];
+		if (entry->hash == hash && entry->len == len && memcmp(entry->str, str, len) == 0)
+			return entry->str;
+
+		idx = (idx + 1) & mask;
+	}
+
+	entry = &arena->table[idx];
+	entry->hash = hash;
+	entry->len = (uint32_t)len;
+	entry->str = key_arena_store(arena, str, len);
+	arena->count++;
+
+	return entry->str;
+}
+
+static void key_arena_free(struct key_arena *arena)
+{
+	struct key_block *block = arena->blocks;
+
+	while (block) {
+		struct key_block *next = block->next;
+		bfree(block);
+		block = next;
+	}
+
+	bfree(arena->table);
+}
+
+/* ------------------------------------------------------------------------- */
+/* UTF-8 helpers */
+
+/* returns the length of the valid UTF-8 sequence at str, or 0 if invalid */
+static size_t utf8_sequence_len(const char *str)
+{
+	const uint8_t *s = (const uint8_t *)str;
+	uint32_t value;
+	size_t count;
+
+	if (s[0] < 0x80) {
+		return 1;
+	} else if (s[0] >= 0xC2 && s[0] <= 0xDF) {
+		count = 2;
+		value = s[0] & 0x1F;
+	} else if (s[0] >= 0xE0 && s[0] <= 0xEF) {
+		count = 3;
+		value = s[0] & 0x0F;
+	} else if (s[0] >= 0xF0 && s[0] <= 0xF4) {
+		count = 4;
+		value = s[0] & 0x07;
+	} else {
+		return 0;
+	}
+
+	/* also stops at the null terminator */
+	for (size_t i = 1; i < count; i++) {
+		if ((s[i] & 0xC0) != 0x80)
+			return 0;
+		value = (value << 6) | (s[i] & 0x3F);
+	}
+
+	if (value > 0x10FFFF || (value >= 0xD800 && value <= 0xDFFF))
+		return 0;
+	if ((count == 3 && value < 0x800) || (count == 4 && value < 0x10000))
+		return 0;
+
+	return count;
+}
+
+static bool utf8_valid(const char *str)
+{
+	while (*str) {
+		size_t len = utf8_sequence_len(str);
+		if (!len)
+			return false;
+		str += len;
+	}
+
+	return true;
+}
+
+static void dstr_cat_utf8(struct dstr *str, uint32_t cp)
+{
+	char buf[4];
+	size_t len;
+
+	if (cp < 0x80) {
+		buf[0] = (char)cp;
+		len = 1;
+	} else if (cp < 0x800) {
+		buf[0] = (char)(0xC0 | (cp >> 6));
+		buf[1] = (char)(0x80 | (cp & 0x3F));
+		len = 2;
+	} else if (cp < 0x10000) {
+		buf[0] = (char)(0xE0 | (cp >> 12));
+		buf[1] = (char)(0x80 | ((cp >> 6) & 0x3F));
+		buf[2] = (char)(0x80 | (cp & 0x3F));
+		len = 3;
+	} else {
+		buf[0] = (char)(0xF0 | (cp >> 18));
+		buf[1] = (char)(0x80 | ((cp >> 12) & 0x3F));
+		buf[2] = (char)(0x80 | ((cp >> 6) & 0x3F));
+		buf[3] = (char)(0x80 | (cp & 0x3F));
+		len = 4;
+	}
+
+	dstr_ncat(str, buf, len);
+}
+
+/* ------------------------------------------------------------------------- */
+/* Reader */
+
+/* keys are interned, so equal keys share the same pointer */
+struct seen_key {
+	const char *key;
+	struct seen_key *next_free;
+	UT_hash_handle hh;
+};
+
+struct json_reader {
+	const char *pos;
+	int line;
+	int depth;
+	bool failed;
+
+	struct dstr str;
+	struct dstr num;
+	struct key_arena keys;
+
+	/* entries of finished objects, reused for the next object */
+	struct seen_key *free_seen;
+	struct obs_data_json_error *error;
+};
+
+static bool json_error(struct json_reader *r, const char *format, ...)
+{
+	va_list args;
+
+	if (r->failed)
+		return false;
+
+	va_start(args, format);
+	vsnprintf(r->error->text, sizeof(r->error->text), format, args);
+	va_end(args);
+
+	r->error->line = r->line;
+	r->failed = true;
+	return false;
+}
+
+static inline void skip_whitespace(struct json_reader *r)
+{
+	for (;;) {
+		char ch = *r->pos;
+
+		if (ch == '\n')
+			r->line++;
+		else if (ch != ' ' && ch != '\t' && ch != '\r')
+			return;
+
+		r->pos++;
+	}
+}
+
+static inline const char *reader_str(struct json_reader *r)
+{
+	return r->str.array ? r->str.array : "";
+}
+
+static bool parse_hex4(const char *str, uint32_t *value)
+{
+	uint32_t val = 0;
+
+	for (size_t i = 0; i < 4; i++) {
+		char ch = str[i];
+
+		val <<= 4;
+		if (ch >= '0' && ch <= '9')
+			val |= (uint32_t)(ch - '0');
+		else if (ch >= 'a' && ch <= 'f')
+			val |= (uint32_t)(ch - 'a' + 10);
+		else if (ch >= 'A' && ch <= 'F')
+			val |= (uint32_t)(ch - 'A' + 10);
+		else
+			return false;
+	}
+
+	*value = val;
+	return true;
+}
+
+static bool read_unicode_escape(struct json_reader *r, const char **p_str, struct dstr *out)
+{
+	const char *p = *p_str;
+	uint32_t cp;
+	uint32_t low;
+
+	if (!parse_hex4(p, &cp))
+		return json_error(r, "invalid escape");
+	p += 4;
+
+	if (cp >= 0xD800 && cp <= 0xDBFF) {
+		if (p[0] != '\\' || p[1] != 'u' || !parse_hex4(p + 2, &low) || low < 0xDC00 || low > 0xDFFF)
+			return json_error(r, "invalid Unicode '\\u%04X'", cp);
+
+		cp = 0x10000 + ((cp - 0xD800) << 10) + (low - 0xDC00);
+		p += 6;
+
+	} else if (cp >= 0xDC00 && cp <= 0xDFFF) {
+		return json_error(r, "invalid Unicode '\\u%04X'", cp);
+
+	} else if (cp == 0) {
+		return json_error(r, "\\u0000 is not allowed");
+	}
+
+	dstr_cat_utf8(out, cp);
+	*p_str = p;
+	return true;
+}
+
+static bool read_string(struct json_reader *r, struct dstr *out)
+{
+	const char *p = r->pos + 1;
+
+	if (out->array) {
+		out->array[0] = 0;
+		out->len = 0;
+	}
+
+	for (;;) {
+		const char *run = p;
+
+		for (;;) {
+			uint8_t ch = (uint8_t)*p;
+			size_t len;
+
+			if (ch == '"' || ch == '\\' || ch < 0x20)
+				break;
+			if (ch < 0x80) {
+				p++;
+				continue;
+			}
+
+			len = utf8_sequence_len(p);
+			if (!len)
+				return json_error(r, "invalid UTF-8 in string");
+			p += len;
+		}
+
+		dstr_ncat(out, run, p - run);
+
+		if (*p == '"')
+			break;
+		if (!*p)
+			return json_error(r, "premature end of input");
+		if (*p != '\\')
+			return json_error(r, "control character 0x%x in string", (unsigned)*p);
+
+		switch (*++p) {
+		case '"':
+		case '\\':
+		case '/':
+			dstr_cat_ch(out, *p++);
+			break;
+		case 'b':
+			dstr_cat_ch(out, '\b');
+			p++;
+			break;
+		case 'f':
+			dstr_cat_ch(out, '\f');
+			p++;
+			break;
+		case 'n':
+			dstr_cat_ch(out, '\n');
+			p++;
+			break;
+		case 'r':
+			dstr_cat_ch(out, '\r');
+			p++;
+			break;
+		case 't':
+			dstr_cat_ch(out, '\t');
+			p++;
+			break;
+		case 'u':
+			p++;
+			if (!read_unicode_escape(r, &p, out))
+				return false;
+			break;
+		default:
+			return json_error(r, "invalid escape");
+		}
+	}
+
+	r->pos = p + 1;
+	return true;
+}
+
+static inline bool is_digit(char ch)
+{
+	return ch >= '0' && ch <= '9';
+}
+
+static bool read_number(struct json_reader *r, obs_data_t *data, const char *key)
+{
+	const char *start = r->pos;
+	const char *p = start;
+	const char *point;
+	bool real = false;
+	char *end;
+
+	if (*p == '-')
+		p++;
+
+	if (*p == '0') {
+		p++;
+		if (is_digit(*p))
+			return json_error(r, "invalid token");
+	} else if (is_digit(*p)) {
+		while (is_digit(*p))
+			p++;
+	} else {
+		return json_error(r, "invalid token");
+	}
+
+	if (*p == '.') {
+		p++;
+		if (!is_digit(*p))
+			return json_error(r, "invalid token");
+		while (is_digit(*p))
+			p++;
+		real = true;
+	}
+
+	if (*p == 'e' || *p == 'E') {
+		p++;
+		if (*p == '+' || *p == '-')
+			p++;
+		if (!is_digit(*p))
+			return json_error(r, "invalid token");
+		while (is_digit(*p))
+			p++;
+		real = true;
+	}
+
+	r->pos = p;
+
+	if (!real) {
+		long long val;
+
+		/* the grammar was validated above, so strtoll stops at p */
+		errno = 0;
+		val = strtoll(start, &end, 10);
+		if (errno == ERANGE)
+			return json_error(r, val < 0 ? "too big negative integer" : "too big integer");
+		if (end != p)
+			return json_error(r, "invalid token");
+
+		if (data)
+			obs_data_set_int(data, key, val);
+		return true;
+	}
+
+	/* strtod honors the locale's decimal point, so the number is copied
+	 * to convert it.  The copy is sized to the number rather than a fixed
+	 * buffer, as JSON puts no limit on the number of digits. */
+	dstr_ncopy(&r->num, start, p - start);
+
+	point = localeconv()->decimal_point;
+	if (*point != '.') {
+		char *dot = strchr(r->num.array, '.');
+		if (dot)
+			*dot = *point;
+	}
+
+	double val = strtod(r->num.array, &end);
+	if (end != r->num.array + r->num.len)
+		return json_error(r, "invalid token");
+	if (isinf(val))
+		return json_error(r, "real number overflow");
+
+	if (data)
+		obs_data_set_double(data, key, val);
+	return true;
+}
+
+static inline bool read_literal(struct json_reader *r, const char *literal, size_t len)
+{
+	if (strncmp(r->pos, literal, len) != 0)
+		return json_error(r, "invalid token");
+
+	r->pos += len;
+	return true;
+}
+
+static bool read_object(struct json_reader *r, obs_data_t *data);
+static bool read_array(struct json_reader *r, obs_data_array_t *array);
+
+/* reads a value into data under key, or validates and discards it if data
+ * is NULL */
+static bool read_value(struct json_reader *r, obs_data_t *data, const char *key)
+{
+	switch (*r->pos) {
+	case '{': {
+		obs_data_t *obj = data ? obs_data_create() : NULL;
+		bool success = read_object(r, obj);
+
+		if (success && obj)
+			obs_data_set_obj(data, key, obj);
+		obs_data_release(obj);
+		return success;
+	}
+	case '[': {
+		obs_data_array_t *array = data ? obs_data_array_create() : NULL;
+		bool success = read_array(r, array);
+
+		if (success && array)
+			obs_data_set_array(data, key, array);
+		obs_data_array_release(array);
+		return success;
+	}
+	case '"':
+		if (!read_string(r, &r->str))
+			return false;
+		if (data)
+			obs_data_set_string(data, key, reader_str(r));
+		return true;
+	case 't':
+		if (!read_literal(r, "true", 4))
+			return false;
+		if (data)
+			obs_data_set_bool(data, key, true);
+		return true;
+	case 'f':
+		if (!read_literal(r, "false", 5))
+			return false;
+		if (data)
+			obs_data_set_bool(data, key, false);
+		return true;
+	case 'n':
+		return read_literal(r, "null", 4);
+	case 0:
+		return json_error(r, "premature end of input");
+	default:
+		return read_number(r, data, key);
+	}
+}
+
+static bool add_seen_key(struct json_reader *r, struct seen_key **seen, const char *key)
+{
+	struct seen_key *entry;
+
+	HASH_FIND_PTR(*seen, &key, entry);
+	if (entry)
+		return false;
+
+	entry = r->free_seen;
+	if (entry)
+		r->free_seen = entry->next_free;
+	else
+		entry = bmalloc(sizeof(*entry));
+
+	entry->key = key;
+	HASH_ADD_PTR(*seen, key, entry);
+	return true;
+}
+
+static void release_seen_keys(struct json_reader *r, struct seen_key **seen)
+{
+	struct seen_key *entry, *temp;
+
+	HASH_ITER (hh, *seen, entry, temp) {
+		entry->next_free = r->free_seen;
+		r->free_seen = entry;
+	}
+
+	HASH_CLEAR(hh, *seen);
+}
+
+static bool read_object_items(struct json_reader *r, obs_data_t *data, struct seen_key **seen)
+{
+	for (;;) {
+		const char *key;
+
+		if (*r->pos != '"')
+			return json_error(r, "string or '}' expected");
+		if (!read_string(r, &r->str))
+			return false;
+
+		key = key_arena_intern(&r->keys, reader_str(r), r->str.len);
+		/* obs_data drops nulls, so duplicates have to be tracked
+		 * separately from what was actually set */
+		if (!add_seen_key(r, seen, key))
+			return json_error(r, "duplicate object key");
+
+		skip_whitespace(r);
+		if (*r->pos != ':')
+			return json_error(r, "':' expected");
+
+		r->pos++;
+		skip_whitespace(r);
+
+		if (!read_value(r, data, key))
+			return false;
+
+		skip_whitespace(r);
+		if (*r->pos == '}')
+			return true;
+		if (*r->pos != ',')
+			return json_error(r, "'}' expected");
+
+		r->pos++;
+		skip_whitespace(r);
+	}
+}
+
+static bool read_object(struct json_reader *r, obs_data_t *data)
+{
+	if (++r->depth > JSON_MAX_DEPTH)
+		return json_error(r, "maximum parsing depth reached");
+
+	r->pos++;
+	skip_whitespace(r);
+
+	if (*r->pos != '}') {
+		struct seen_key *seen = NULL;
+		bool success = read_object_items(r, data, &seen);
+
+		release_seen_keys(r, &seen);
+		if (!success)
+			return false;
+	}
+
+	r->pos++;
+	r->depth--;
+	return true;
+}
+
+static bool read_array(struct json_reader *r, obs_data_array_t *array)
+{
+	if (++r->depth > JSON_MAX_DEPTH)
+		return json_error(r, "maximum parsing depth reached");
+
+	r->pos++;
+	skip_whitespace(r);
+
+	if (*r->pos != ']') {
+		for (;;) {
+			if (*r->pos == '{') {
+				obs_data_t *obj = array ? obs_data_create() : NULL;
+				bool success = read_object(r, obj);
+
+				if (success && obj)
+					obs_data_array_push_back(array, obj);
+				obs_data_release(obj);
+
+				if (!success)
+					return false;
+
+			} else if (!read_value(r, NULL, NULL)) {
+				/* arrays can only hold objects, anything else is
+				 * validated and skipped */
+				return false;
+			}
+
+			skip_whitespace(r);
+			if (*r->pos == ']')
+				break;
+			if (*r->pos != ',')
+				return json_error(r, "']' expected");
+
+			r->pos++;
+			skip_whitespace(r);
+		}
+	}
+
+	r->pos++;
+	r->depth--;
+	return true;
+}
+
+bool obs_data_json_read(obs_data_t *data, const char *json, struct obs_data_json_error *error)
+{
+	struct json_reader r = {0};
+	bool success;
+
+	r.pos = json;
+	r.line = 1;
+	r.error = error;
+
+	if (!json)
+		return json_error(&r, "wrong arguments");
+
+	skip_whitespace(&r);
+
+	if (*r.pos == '{') {
+		success = read_object(&r, data);
+	} else if (*r.pos == '[') {
+		/* a root array has nothing to map to, but is still valid */
+		success = read_array(&r, NULL);
+	} else {
+		success = json_error(&r, "'[' or '{' expected");
+	}
+
+	if (success) {
+		skip_whitespace(&r);
+		if (*r.pos)
+			success = json_error(&r, "end of file expected");
+	}
+
+	dstr_free(&r.str);
+	dstr_free(&r.num);
+	while (r.free_seen) {
+		struct seen_key *next = r.free_seen->next_free;
+		bfree(r.free_seen);
+		r.free_seen = next;
+	}
+
+	key_arena_free(&r.keys);
+	return success;
+}
+
+/* ------------------------------------------------------------------------- */
+/* Writer */
+
+struct json_writer {
+	struct dstr *out;
+	bool pretty;
+	bool with_defaults;
+};
+
+static void write_indent(struct json_writer *w, int depth)
+{
+	static const char spaces[] = "                                ";
+	size_t count = (size_t)depth * 4;
+
+	if (!w->pretty)
+		return;
+
+	dstr_cat_ch(w->out, '\n');
+
+	while (count) {
+		size_t len = count < sizeof(spaces) - 1 ? count : sizeof(spaces) - 1;
+		dstr_ncat(w->out, spaces, len);
+		count -= len;
+	}
+}
+
+static void write_string(struct dstr *out, const char *str)
+{
+	const char *run = str;
+	char buf[8];
+
+	dstr_cat_ch(out, '"');
+
+	for (; *str; str++) {
+		uint8_t ch = (uint8_t)*str;
+
+		if (ch >= 0x20 && ch != '"' && ch != '\\')
+			continue;
+
+		dstr_ncat(out, run, str - run);
+		run = str + 1;
+
+		switch (ch) {
+		case '"':
+			dstr_ncat(out, "\\\"", 2);
+			break;
+		case '\\':
+			dstr_ncat(out, "\\\\", 2);
+			break;
+		case '\b':
+			dstr_ncat(out, "\\b", 2);
+			break;
+		case '\f':
+			dstr_ncat(out, "\\f", 2);
+			break;
+		case '\n':
+			dstr_ncat(out, "\\n", 2);
+			break;
+		case '\r':
+			dstr_ncat(out, "\\r", 2);
+			break;
+		case '\t':
+			dstr_ncat(out, "\\t", 2);
+			break;
+		default:
+			snprintf(buf, sizeof(buf), "\\u%04X", ch);
+			dstr_cat(out, buf);
+		}
+	}
+
+	dstr_ncat(out, run, str - run);
+	dstr_cat_ch(out, '"');
+}
+
+/* jansson silently dropped values it could not represent, keep doing the
+ * same so the output doesn't change */
+static bool item_writable(obs_data_item_t *item)
+{
+	switch (obs_data_item_gettype(item)) {
+	case OBS_DATA_NULL:
+		return false;
+	case OBS_DATA_STRING:
+		return utf8_valid(obs_data_item_get_string(item));
+	case OBS_DATA_NUMBER:
+		return obs_data_item_numtype(item) == OBS_DATA_NUM_INT || isfinite(obs_data_item_get_double(item));
+	default:
+		return true;
+	}
+}
+
+static void write_object(struct json_writer *w, obs_data_t *data, int depth);
+
+static void write_array(struct json_writer *w, obs_data_array_t *array, int depth)
+{
+	size_t count = obs_data_array_count(array);
+
+	dstr_cat_ch(w->out, '[');
+
+	for (size_t i = 0; i < count; i++) {
+		obs_data_t *obj = obs_data_array_item(array, i);
+
+		if (i)
+			dstr_cat_ch(w->out, ',');
+		write_indent(w, depth + 1);
+		write_object(w, obj, depth + 1);
+
+		obs_data_release(obj);
+	}
+
+	if (count)
+		write_indent(w, depth);
+	dstr_cat_ch(w->out, ']');
+}
+
+static void write_item(struct json_writer *w, obs_data_item_t *item, int depth)
+{
+	char buf[64];
+	int len;
+
+	switch (obs_data_item_gettype(item)) {
+	case OBS_DATA_STRING:
+		write_string(w->out, obs_data_item_get_string(item));
+		break;
+
+	case OBS_DATA_NUMBER:
+		/* os_dtostr may leave trailing bytes after shortening the
+		 * exponent, only the returned length is valid */
+		if (obs_data_item_numtype(item) == OBS_DATA_NUM_INT)
+			len = snprintf(buf, sizeof(buf), "%lld", obs_data_item_get_int(item));
+		else
+			len = os_dtostr(obs_data_item_get_double(item), buf, sizeof(buf));
+
+		if (len > 0)
+			dstr_ncat(w->out, buf, (size_t)len);
+		else
+			dstr_cat(w->out, "0.0");
+		break;
+
+	case OBS_DATA_BOOLEAN:
+		dstr_cat(w->out, obs_data_item_get_bool(item) ? "true" : "false");
+		break;
+
+	case OBS_DATA_OBJECT: {
+		obs_data_t *obj = obs_data_item_get_obj(item);
+		write_object(w, obj, depth);
+		obs_data_release(obj);
+		break;
+	}
+
+	case OBS_DATA_ARRAY: {
+		obs_data_array_t *array = obs_data_item_get_array(item);
+		write_array(w, array, depth);
+		obs_data_array_release(array);
+		break;
+	}
+
+	case OBS_DATA_NULL:
+		break;
+	}
+}
+
+static void write_object(struct json_writer *w, obs_data_t *data, int depth)
+{
+	obs_data_item_t *item = obs_data_first(data);
+	size_t count = 0;
+
+	dstr_cat_ch(w->out, '{');
+
+	for (; item; obs_data_item_next(&item)) {
+		const char *name = obs_data_item_get_name(item);
+
+		if (!w->with_defaults && !obs_data_item_has_user_value(item))
+			continue;
+		if (!utf8_valid(name) || !item_writable(item))
+			continue;
+
+		if (count++)
+			dstr_cat_ch(w->out, ',');
+		write_indent(w, depth + 1);
+
+		write_string(w->out, name);
+		dstr_cat(w->out, w->pretty ? ": " : ":");
+		write_item(w, item, depth + 1);
+	}
+
+	if (count)
+		write_indent(w, depth);
+	dstr_cat_ch(w->out, '}');
+}
+
+void obs_data_json_write(struct dstr *out, obs_data_t *data, bool pretty, bool with_defaults)
+{
+	struct json_writer w = {out, pretty, with_defaults};
+	write_object(&w, data, 0);
+}
@@ -0,0 +1,40 @@
+/******************************************************************************
+    Copyright (C) 2026 by OBS Project contributors
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+******************************************************************************/
+
+#pragma once
+
+#include "util/dstr.h"
+#include "obs-data.h"
+
+/*
+ * Streaming JSON reader/writer for obs_data.  Items are created directly
+ * while parsing and written directly from the item hash when serializing,
+ * without building an intermediate JSON document tree.  Output is kept
+ * byte-compatible with what jansson produced for the same data.
+ */
+
+struct obs_data_json_error {
+	int line;
+	char text[160];
+};
+
+/* Parses a JSON object into data.  On failure, returns false and fills out
+ * error, data may have been partially filled. */
+extern bool obs_data_json_read(obs_data_t *data, const char *json, struct obs_data_json_error *error);
+
+/* Appends the JSON representation of data to out */
+extern void obs_data_json_write(struct dstr *out, obs_data_t *data, bool pretty, bool with_defaults);
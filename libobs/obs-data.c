@@ -26,8 +26,7 @@
 #include "graphics/vec4.h"
 #include "graphics/quat.h"
 #include "obs-data.h"
-
-#include <jansson.h>
+#include "obs-data-json.h"
 
 struct obs_data_item {
 	volatile long ref;
@@ -440,151 +439,6 @@ static inline void obs_data_item_set_autoselect_data(struct obs_data_item **p_it
 
 /* ------------------------------------------------------------------------- */
 
-static void obs_data_add_json_item(obs_data_t *data, const char *key, json_t *json);
-
-static inline void obs_data_add_json_object_data(obs_data_t *data, json_t *jobj)
-{
-	const char *item_key;
-	json_t *jitem;
-
-	json_object_foreach (jobj, item_key, jitem) {
-		obs_data_add_json_item(data, item_key, jitem);
-	}
-}
-
-static inline void obs_data_add_json_object(obs_data_t *data, const char *key, json_t *jobj)
-{
-	obs_data_t *sub_obj = obs_data_create();
-
-	obs_data_add_json_object_data(sub_obj, jobj);
-	obs_data_set_obj(data, key, sub_obj);
-	obs_data_release(sub_obj);
-}
-
-static void obs_data_add_json_array(obs_data_t *data, const char *key, json_t *jarray)
-{
-	obs_data_array_t *array = obs_data_array_create();
-	size_t idx;
-	json_t *jitem;
-
-	json_array_foreach (jarray, idx, jitem) {
-		obs_data_t *item;
-
-		if (!json_is_object(jitem))
-			continue;
-
-		item = obs_data_create();
-		obs_data_add_json_object_data(item, jitem);
-		obs_data_array_push_back(array, item);
-		obs_data_release(item);
-	}
-
-	obs_data_set_array(data, key, array);
-	obs_data_array_release(array);
-}
-
-static void obs_data_add_json_item(obs_data_t *data, const char *key, json_t *json)
-{
-	if (json_is_object(json))
-		obs_data_add_json_object(data, key, json);
-	else if (json_is_array(json))
-		obs_data_add_json_array(data, key, json);
-	else if (json_is_string(json))
-		obs_data_set_string(data, key, json_string_value(json));
-	else if (json_is_integer(json))
-		obs_data_set_int(data, key, json_integer_value(json));
-	else if (json_is_real(json))
-		obs_data_set_double(data, key, json_real_value(json));
-	else if (json_is_true(json))
-		obs_data_set_bool(data, key, true);
-	else if (json_is_false(json))
-		obs_data_set_bool(data, key, false);
-}
-
-/* ------------------------------------------------------------------------- */
-
-static inline void set_json_string(json_t *json, const char *name, obs_data_item_t *item)
-{
-	const char *val = obs_data_item_get_string(item);
-	json_object_set_new(json, name, json_string(val));
-}
-
-static inline void set_json_number(json_t *json, const char *name, obs_data_item_t *item)
-{
-	enum obs_data_number_type type = obs_data_item_numtype(item);
-
-	if (type == OBS_DATA_NUM_INT) {
-		long long val = obs_data_item_get_int(item);
-		json_object_set_new(json, name, json_integer(val));
-	} else {
-		double val = obs_data_item_get_double(item);
-		json_object_set_new(json, name, json_real(val));
-	}
-}
-
-static inline void set_json_bool(json_t *json, const char *name, obs_data_item_t *item)
-{
-	bool val = obs_data_item_get_bool(item);
-	json_object_set_new(json, name, val ? json_true() : json_false());
-}
-
-static json_t *obs_data_to_json(obs_data_t *data, bool with_defaults);
-
-static inline void set_json_obj(json_t *json, const char *name, obs_data_item_t *item, bool with_defaults)
-{
-	obs_data_t *obj = obs_data_item_get_obj(item);
-	json_object_set_new(json, name, obs_data_to_json(obj, with_defaults));
-	obs_data_release(obj);
-}
-
-static inline void set_json_array(json_t *json, const char *name, obs_data_item_t *item, bool with_defaults)
-{
-	json_t *jarray = json_array();
-	obs_data_array_t *array = obs_data_item_get_array(item);
-	size_t count = obs_data_array_count(array);
-
-	for (size_t idx = 0; idx < count; idx++) {
-		obs_data_t *sub_item = obs_data_array_item(array, idx);
-		json_t *jitem = obs_data_to_json(sub_item, with_defaults);
-		json_array_append_new(jarray, jitem);
-		obs_data_release(sub_item);
-	}
-
-	json_object_set_new(json, name, jarray);
-	obs_data_array_release(array);
-}
-
-static json_t *obs_data_to_json(obs_data_t *data, bool with_defaults)
-{
-	json_t *json = json_object();
-
-	obs_data_item_t *item = NULL;
-	obs_data_item_t *temp = NULL;
-
-	HASH_ITER (hh, data->items, item, temp) {
-		enum obs_data_type type = obs_data_item_gettype(item);
-		const char *name = get_item_name(item);
-
-		if (!with_defaults && !obs_data_item_has_user_value(item))
-			continue;
-
-		if (type == OBS_DATA_STRING)
-			set_json_string(json, name, item);
-		else if (type == OBS_DATA_NUMBER)
-			set_json_number(json, name, item);
-		else if (type == OBS_DATA_BOOLEAN)
-			set_json_bool(json, name, item);
-		else if (type == OBS_DATA_OBJECT)
-			set_json_obj(json, name, item, with_defaults);
-		else if (type == OBS_DATA_ARRAY)
-			set_json_array(json, name, item, with_defaults);
-	}
-
-	return json;
-}
-
-/* ------------------------------------------------------------------------- */
-
 obs_data_t *obs_data_create()
 {
 	struct obs_data *data = bzalloc(sizeof(struct obs_data));
@@ -596,14 +450,9 @@ obs_data_t *obs_data_create()
 obs_data_t *obs_data_create_from_json(const char *json_string)
 {
 	obs_data_t *data = obs_data_create();
+	struct obs_data_json_error error;
 
-	json_error_t error;
-	json_t *root = json_loads(json_string, JSON_REJECT_DUPLICATES, &error);
-
-	if (root) {
-		obs_data_add_json_object_data(data, root);
-		json_decref(root);
-	} else {
+	if (!obs_data_json_read(data, json_string, &error)) {
 		blog(LOG_ERROR,
 		     "obs-data.c: [obs_data_create_from_json] "
 		     "Failed reading json string (%d): %s",
@@ -672,8 +521,7 @@ static inline void obs_data_destroy(struct obs_data *data)
 		obs_data_item_release(&item);
 	}
 
-	/* NOTE: don't use bfree for json text, allocated by json */
-	free(data->json);
+	bfree(data->json);
 	bfree(data);
 }
 
@@ -691,20 +539,13 @@ static const char *obs_data_get_json_internal(obs_data_t *data, bool pretty, boo
 	if (!data)
 		return NULL;
 
-	size_t flags = JSON_PRESERVE_ORDER;
-
-	if (pretty)
-		flags |= JSON_INDENT(4);
-	else
-		flags |= JSON_COMPACT;
+	struct dstr json = {0};
 
-	/* NOTE: don't use libobs bfree for json text */
-	free(data->json);
+	bfree(data->json);
 	data->json = NULL;
 
-	json_t *root = obs_data_to_json(data, with_defaults);
-	data->json = json_dumps(root, flags);
-	json_decref(root);
+	obs_data_json_write(&json, data, pretty, with_defaults);
+	data->json = json.array;
 
 	return data->json;
 }
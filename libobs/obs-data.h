@@ -39,9 +39,11 @@ struct quat;
 struct obs_data;
 struct obs_data_item;
 struct obs_data_array;
+struct obs_data_snapshot;
 typedef struct obs_data obs_data_t;
 typedef struct obs_data_item obs_data_item_t;
 typedef struct obs_data_array obs_data_array_t;
+typedef struct obs_data_snapshot obs_data_snapshot_t;
 
 enum obs_data_type {
 	OBS_DATA_NULL,
@@ -74,6 +76,23 @@ EXPORT bool obs_data_save_json_safe(obs_data_t *data, const char *file, const ch
 EXPORT bool obs_data_save_json_pretty_safe(obs_data_t *data, const char *file, const char *temp_ext,
 					   const char *backup_ext);
 
+/* ------------------------------------------------------------------------- */
+/* Binary snapshots */
+
+EXPORT obs_data_t *obs_data_create_from_binary(const void *buf, size_t size);
+EXPORT obs_data_t *obs_data_create_from_binary_file(const char *file);
+EXPORT void *obs_data_get_binary(obs_data_t *data, size_t *size);
+EXPORT bool obs_data_save_binary_safe(obs_data_t *data, const char *file, const char *temp_ext,
+				      const char *backup_ext);
+
+EXPORT obs_data_snapshot_t *obs_data_snapshot_open(const char *file);
+EXPORT void obs_data_snapshot_close(obs_data_snapshot_t *snapshot);
+EXPORT obs_data_t *obs_data_snapshot_get_obj(obs_data_snapshot_t *snapshot, const char *name);
+EXPORT size_t obs_data_snapshot_array_count(obs_data_snapshot_t *snapshot, const char *name);
+EXPORT obs_data_t *obs_data_snapshot_array_item(obs_data_snapshot_t *snapshot, const char *name, size_t idx);
+EXPORT obs_data_t *obs_data_snapshot_array_find(obs_data_snapshot_t *snapshot, const char *name, const char *key,
+						const char *value);
+
 EXPORT void obs_data_apply(obs_data_t *target, obs_data_t *apply_data);
 
 EXPORT void obs_data_erase(obs_data_t *data, const char *name);
@@ -18,6 +18,7 @@
 #include "obs.h"
 #include "obs-internal.h"
 #include "util/util_uint64.h"
+#include "media-io/video-frame.h"
 
 #define encoder_active(encoder) os_atomic_load_bool(&encoder->active)
 #define set_encoder_active(encoder, val) os_atomic_set_bool(&encoder->active, val)
@@ -140,6 +141,8 @@ obs_encoder_t *obs_audio_encoder_create(const char *id, const char *name, obs_da
 
 static void receive_video(void *param, struct video_data *frame);
 static void receive_audio(void *param, size_t mix_idx, struct audio_data *data);
+static void start_video_queue(struct obs_encoder *encoder, const struct video_scale_info *info);
+static void stop_video_queue(struct obs_encoder *encoder);
 
 static inline void get_audio_info(const struct obs_encoder *encoder, struct audio_convert_info *info)
 {
@@ -197,6 +200,26 @@ static inline bool gpu_encode_available(const struct obs_encoder *encoder)
  * will be created if it doesn't exist already to generate encoder
  * input
  */
+/* encoder mixes are kept sorted from the largest to the smallest output so
+ * that smaller renditions can be scaled from larger ones in the same frame */
+static size_t get_mix_insert_idx(const struct obs_core_video_mix *mix)
+{
+	const struct video_output_info *info = video_output_get_info(mix->video);
+	const uint64_t area = (uint64_t)info->width * (uint64_t)info->height;
+
+	for (size_t i = 0; i < obs->video.mixes.num; i++) {
+		const struct obs_core_video_mix *other = obs->video.mixes.array[i];
+		if (!other->encoder_only_mix)
+			continue;
+
+		const struct video_output_info *other_info = video_output_get_info(other->video);
+		if ((uint64_t)other_info->width * (uint64_t)other_info->height < area)
+			return i;
+	}
+
+	return obs->video.mixes.num;
+}
+
 static void maybe_set_up_gpu_rescale(struct obs_encoder *encoder)
 {
 	struct obs_core_video_mix *mix, *current_mix;
@@ -301,7 +324,7 @@ static void maybe_set_up_gpu_rescale(struct obs_encoder *encoder)
 	if (!create_mix) {
 		obs_free_video_mix(mix);
 	} else {
-		da_push_back(obs->video.mixes, &mix);
+		da_insert(obs->video.mixes, get_mix_insert_idx(mix), &mix);
 		obs_encoder_set_video(encoder, mix->video);
 	}
 
@@ -322,6 +345,8 @@ static void add_connection(struct obs_encoder *encoder)
 		if (gpu_encode_available(encoder)) {
 			start_gpu_encode(encoder);
 		} else {
+			if (encoder->video_queue_size)
+				start_video_queue(encoder, &info);
 			start_raw_video(encoder->media, &info, encoder->frame_rate_divisor, receive_video, encoder);
 		}
 	}
@@ -348,6 +373,7 @@ static void remove_connection(struct obs_encoder *encoder, bool shutdown)
 			stop_gpu_encode(encoder);
 		} else {
 			stop_raw_video(encoder->media, receive_video, encoder);
+			stop_video_queue(encoder);
 		}
 	}
 
@@ -944,6 +970,32 @@ bool obs_encoder_set_frame_rate_divisor(obs_encoder_t *encoder, uint32_t frame_r
 	return true;
 }
 
+bool obs_encoder_set_video_queue(obs_encoder_t *encoder, size_t size, enum obs_encoder_queue_mode mode)
+{
+	if (!obs_encoder_valid(encoder, "obs_encoder_set_video_queue"))
+		return false;
+
+	if (encoder->info.type != OBS_ENCODER_VIDEO) {
+		blog(LOG_WARNING,
+		     "obs_encoder_set_video_queue: "
+		     "encoder '%s' is not a video encoder",
+		     obs_encoder_get_name(encoder));
+		return false;
+	}
+
+	if (encoder_active(encoder)) {
+		blog(LOG_WARNING,
+		     "encoder '%s': Cannot set video queue "
+		     "while the encoder is active",
+		     obs_encoder_get_name(encoder));
+		return false;
+	}
+
+	encoder->video_queue_size = size;
+	encoder->video_queue_mode = mode;
+	return true;
+}
+
 bool obs_encoder_scaling_enabled(const obs_encoder_t *encoder)
 {
 	if (!obs_encoder_valid(encoder, "obs_encoder_scaling_enabled"))
@@ -1399,6 +1451,12 @@ bool do_encode(struct obs_encoder *encoder, struct encoder_frame *frame, const u
 		ept->pts = frame->pts;
 		ept->cts = *frame_cts;
 		ept->fer = fer_ts;
+
+		struct obs_frame_trace trace;
+		if (obs_get_frame_trace(encoder->media, *frame_cts, &trace)) {
+			ept->rendered = trace.rendered;
+			ept->downloaded = trace.downloaded;
+		}
 	}
 	send_off_encoder_packet(encoder, success, received, &pkt);
 
@@ -1436,6 +1494,252 @@ bool video_pause_check(struct pause_data *pause, uint64_t timestamp)
 	return ignore_frame;
 }
 
+/* ------------------------------------------------------------------------- */
+/* asynchronous raw video encoding */
+
+/* a queued frame is encoded count times with consecutive pts, so the slots of
+ * dropped frames are filled the same way texture encoders fill the slots of
+ * skipped frames, and pts stay contiguous */
+struct encoder_queued_frame {
+	struct video_frame frame;
+	int64_t pts;
+	uint64_t timestamp;
+	uint32_t count;
+};
+
+struct encoder_video_queue {
+	struct obs_encoder *encoder;
+	struct video_scale_info info;
+	size_t size;
+	enum obs_encoder_queue_mode mode;
+	uint64_t interval;
+
+	pthread_mutex_t mutex;
+	struct deque frames;
+	os_sem_t *frames_sem;
+	os_sem_t *space_sem;
+
+	pthread_t thread;
+	volatile bool stop;
+
+	/* set when the encode thread stops itself after an encode error, the
+	 * thread then cleans up the queue on its own */
+	volatile bool detached;
+};
+
+static inline size_t video_queue_depth(struct encoder_video_queue *queue)
+{
+	return queue->frames.size / sizeof(struct encoder_queued_frame);
+}
+
+static inline void free_queued_frame(struct encoder_video_queue *queue, struct encoder_queued_frame *qf)
+{
+	video_frame_free_pooled(&qf->frame, queue->info.format, queue->info.width, queue->info.height);
+}
+
+static void free_video_queue(struct encoder_video_queue *queue)
+{
+	struct encoder_queued_frame qf;
+
+	while (queue->frames.size) {
+		deque_pop_front(&queue->frames, &qf, sizeof(qf));
+		free_queued_frame(queue, &qf);
+	}
+
+	deque_free(&queue->frames);
+	os_sem_destroy(queue->frames_sem);
+	os_sem_destroy(queue->space_sem);
+	pthread_mutex_destroy(&queue->mutex);
+	bfree(queue);
+}
+
+static void *video_queue_thread(void *data)
+{
+	struct encoder_video_queue *queue = data;
+	struct obs_encoder *encoder = queue->encoder;
+	const char *thread_name =
+		profile_store_name(obs_get_profiler_name_store(), "video_queue_thread(%s)", encoder->context.name);
+
+	os_set_thread_name("obs encoder video queue thread");
+
+	while (os_sem_wait(queue->frames_sem) == 0) {
+		struct encoder_queued_frame qf;
+		struct encoder_frame enc_frame = {0};
+		bool success = true;
+
+		pthread_mutex_lock(&queue->mutex);
+		if (!queue->frames.size) {
+			pthread_mutex_unlock(&queue->mutex);
+
+			/* frames queued before the stop request are encoded
+			 * first, so an empty queue means the thread is done */
+			if (os_atomic_load_bool(&queue->stop))
+				break;
+			continue;
+		}
+		deque_pop_front(&queue->frames, &qf, sizeof(qf));
+		pthread_mutex_unlock(&queue->mutex);
+
+		/* free up the slot before encoding so a blocked video thread
+		 * can always make progress, even if the encode fails and stops
+		 * the encoder from this thread */
+		if (queue->space_sem)
+			os_sem_post(queue->space_sem);
+
+		profile_start(thread_name);
+
+		for (size_t i = 0; i < MAX_AV_PLANES; i++) {
+			enc_frame.data[i] = qf.frame.data[i];
+			enc_frame.linesize[i] = qf.frame.linesize[i];
+		}
+		enc_frame.frames = 1;
+
+		for (uint32_t i = 0; success && i < qf.count; i++) {
+			uint64_t timestamp = qf.timestamp + queue->interval * i;
+
+			enc_frame.pts = qf.pts + (int64_t)i * encoder->timebase_num * encoder->frame_rate_divisor;
+			success = do_encode(encoder, &enc_frame, &timestamp);
+
+			if (i > 0)
+				video_output_inc_texture_skipped_frames(encoder->media);
+			if (os_atomic_load_bool(&queue->detached))
+				break;
+		}
+
+		free_queued_frame(queue, &qf);
+
+		profile_end(thread_name);
+		profile_reenable_thread();
+
+		if (os_atomic_load_bool(&queue->detached))
+			break;
+	}
+
+	if (os_atomic_load_bool(&queue->detached))
+		free_video_queue(queue);
+	return NULL;
+}
+
+static void start_video_queue(struct obs_encoder *encoder, const struct video_scale_info *info)
+{
+	struct encoder_video_queue *queue = bzalloc(sizeof(*queue));
+	bool block = encoder->video_queue_mode == OBS_ENCODER_QUEUE_BLOCK;
+
+	queue->encoder = encoder;
+	queue->info = *info;
+	queue->size = encoder->video_queue_size;
+	queue->mode = encoder->video_queue_mode;
+	queue->interval = video_output_get_frame_time(encoder->media) * encoder->frame_rate_divisor;
+
+	pthread_mutex_init_value(&queue->mutex);
+	if (pthread_mutex_init(&queue->mutex, NULL) != 0)
+		goto fail;
+	if (os_sem_init(&queue->frames_sem, 0) != 0)
+		goto fail;
+	if (block && os_sem_init(&queue->space_sem, (int)queue->size) != 0)
+		goto fail;
+	if (pthread_create(&queue->thread, NULL, video_queue_thread, queue) != 0)
+		goto fail;
+
+	encoder->video_queue = queue;
+	return;
+
+fail:
+	blog(LOG_WARNING, "encoder '%s': Failed to start video queue, encoding synchronously", encoder->context.name);
+	free_video_queue(queue);
+}
+
+static void stop_video_queue(struct obs_encoder *encoder)
+{
+	struct encoder_video_queue *queue = encoder->video_queue;
+
+	if (!queue)
+		return;
+
+	encoder->video_queue = NULL;
+	os_atomic_set_bool(&queue->stop, true);
+
+	/* an encode error stops the encoder from the encode thread itself,
+	 * which can't be joined there */
+	if (pthread_equal(pthread_self(), queue->thread)) {
+		os_atomic_set_bool(&queue->detached, true);
+		pthread_detach(queue->thread);
+		return;
+	}
+
+	os_sem_post(queue->frames_sem);
+	pthread_join(queue->thread, NULL);
+	free_video_queue(queue);
+}
+
+/* the frame after the oldest one takes over its pts slots, so no pts are
+ * skipped */
+static void drop_oldest_queued_frame(struct encoder_video_queue *queue, struct encoder_queued_frame *new_frame)
+{
+	struct encoder_queued_frame oldest;
+	struct encoder_queued_frame next;
+
+	deque_pop_front(&queue->frames, &oldest, sizeof(oldest));
+	free_queued_frame(queue, &oldest);
+
+	if (!queue->frames.size) {
+		new_frame->pts = oldest.pts;
+		new_frame->timestamp = oldest.timestamp;
+		new_frame->count += oldest.count;
+		return;
+	}
+
+	deque_pop_front(&queue->frames, &next, sizeof(next));
+	next.pts = oldest.pts;
+	next.timestamp = oldest.timestamp;
+	next.count += oldest.count;
+	deque_push_front(&queue->frames, &next, sizeof(next));
+}
+
+static void queue_video_frame(struct encoder_video_queue *queue, struct video_data *frame)
+{
+	struct obs_encoder *encoder = queue->encoder;
+	struct encoder_queued_frame qf = {0};
+	struct video_frame src;
+
+	qf.pts = encoder->cur_pts;
+	qf.timestamp = frame->timestamp;
+	qf.count = 1;
+	encoder->cur_pts += encoder->timebase_num * encoder->frame_rate_divisor;
+
+	if (queue->space_sem)
+		os_sem_wait(queue->space_sem);
+
+	pthread_mutex_lock(&queue->mutex);
+
+	if (video_queue_depth(queue) >= queue->size) {
+		if (queue->mode == OBS_ENCODER_QUEUE_DROP_OLDEST) {
+			drop_oldest_queued_frame(queue, &qf);
+		} else {
+			/* the newest queued frame is encoded once more in
+			 * place of the new one */
+			struct encoder_queued_frame newest;
+
+			deque_pop_back(&queue->frames, &newest, sizeof(newest));
+			newest.count++;
+			deque_push_back(&queue->frames, &newest, sizeof(newest));
+			pthread_mutex_unlock(&queue->mutex);
+			return;
+		}
+	}
+
+	memcpy(src.data, frame->data, sizeof(src.data));
+	memcpy(src.linesize, frame->linesize, sizeof(src.linesize));
+
+	video_frame_init_pooled(&qf.frame, queue->info.format, queue->info.width, queue->info.height);
+	video_frame_copy(&qf.frame, &src, queue->info.format, queue->info.height);
+
+	deque_push_back(&queue->frames, &qf, sizeof(qf));
+	pthread_mutex_unlock(&queue->mutex);
+
+	os_sem_post(queue->frames_sem);
+}
+
 static const char *receive_video_name = "receive_video";
 static void receive_video(void *param, struct video_data *frame)
 {
@@ -1482,6 +1786,11 @@ static void receive_video(void *param, struct video_data *frame)
 	if (!encoder->start_ts)
 		encoder->start_ts = frame->timestamp;
 
+	if (encoder->video_queue) {
+		queue_video_frame(encoder->video_queue, frame);
+		goto wait_for_audio;
+	}
+
 	enc_frame.frames = 1;
 	enc_frame.pts = encoder->cur_pts;
 
@@ -1739,10 +2048,14 @@ void obs_encoder_remove_output(struct obs_encoder *encoder, struct obs_output *o
 
 void obs_encoder_packet_create_instance(struct encoder_packet *dst, const struct encoder_packet *src)
 {
+	static int memory_tag = -1;
 	long *p_refs;
 
+	if (memory_tag < 0)
+		memory_tag = bmem_get_tag("encoder-packets");
+
 	*dst = *src;
-	p_refs = bmalloc(src->size + sizeof(long));
+	p_refs = bmalloc_tagged(src->size + sizeof(long), memory_tag);
 	dst->data = (void *)(p_refs + 1);
 	*p_refs = 1;
 	memcpy(dst->data, src->data, src->size);
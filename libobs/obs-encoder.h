@@ -49,14 +49,14 @@ enum obs_encoder_type {
  * with each video frame. This is useful for deriving absolute
  * timestamps (i.e. wall-clock based formats) and measuring latency.
  *
- * For each frame, there are four events of interest, described in
- * the encoder_packet_time struct, namely cts, fer, ferc, and pir.
- * The timebase of these four events is os_gettime_ns(), which provides
- * very high resolution timestamping, and the ability to convert the
- * timing to any other time format.
+ * For each frame, there are six events of interest, described in
+ * the encoder_packet_time struct, namely cts, rendered, downloaded, fer,
+ * ferc, and pir. The timebase of these events is os_gettime_ns(), which
+ * provides very high resolution timestamping, and the ability to convert
+ * the timing to any other time format.
  *
  * Each frame follows a timeline in the following temporal order:
- *   CTS, FER, FERC, PIR
+ *   CTS, rendered, downloaded, FER, FERC, PIR
  *
  * PTS is the integer-based monotonically increasing value that is used
  * to associate an encoder_packet_time entry with a specific encoder_packet.
@@ -93,6 +93,18 @@ struct encoder_packet_time {
 	 * and packet interleaving.
 	 */
 	uint64_t pir;
+
+	/* Rendered is when the frame finished rendering and
+	 * color conversion on the graphics thread. This is the
+	 * time the GPU commands were submitted, not the time
+	 * the GPU finished executing them.
+	 */
+	uint64_t rendered;
+
+	/* Downloaded is when the frame was read back from the GPU
+	 * for raw (non-texture) encoders, 0 for texture encoders.
+	 */
+	uint64_t downloaded;
 };
 
 /** Encoder output packet */
@@ -174,6 +186,16 @@ struct obs_encoder_roi {
 	float priority;
 };
 
+/** Backpressure behavior of asynchronous raw video encoder queues */
+enum obs_encoder_queue_mode {
+	/* Wait for the encoder to free up a slot (default) */
+	OBS_ENCODER_QUEUE_BLOCK,
+	/* Drop the oldest queued frame to make room for the new one */
+	OBS_ENCODER_QUEUE_DROP_OLDEST,
+	/* Drop the new frame */
+	OBS_ENCODER_QUEUE_DROP_NEWEST,
+};
+
 struct gs_texture;
 
 /** Encoder input texture */
@@ -46,7 +46,9 @@
 #define HASH_FIND_UUID(head, uuid, out) HASH_FIND(hh_uuid, head, uuid, UUID_STR_LENGTH, out)
 #define HASH_ADD_UUID(head, uuid_field, add) HASH_ADD(hh_uuid, head, uuid_field[0], UUID_STR_LENGTH, add)
 
-#define NUM_TEXTURES 2
+/* maximum depth of the raw video readback ring */
+#define NUM_TEXTURES 4
+#define DEFAULT_NUM_TEXTURES 2
 #define NUM_CHANNELS 3
 #define MICROSECOND_DEN 1000000
 #define NUM_ENCODE_TEXTURES 10
@@ -258,6 +260,7 @@ struct obs_tex_frame {
 	gs_texture_t *tex_uv;
 	uint32_t handle;
 	uint64_t timestamp;
+	uint64_t rendered;
 	uint64_t lock_key;
 	int count;
 	bool released;
@@ -268,6 +271,19 @@ struct obs_task_info {
 	void *param;
 };
 
+/* most recent frames traced per video mix */
+#define FRAME_TRACE_HISTORY 32
+
+/* render and readback times of a raw video frame, looked up by raw encoders
+ * to fill in their encoder_packet_time entries */
+struct obs_frame_trace {
+	uint64_t timestamp;
+	uint64_t rendered;
+	uint64_t downloaded;
+};
+
+extern bool obs_get_frame_trace(video_t *video, uint64_t timestamp, struct obs_frame_trace *trace);
+
 struct obs_core_video_mix {
 	struct obs_view *view;
 
@@ -281,8 +297,11 @@ struct obs_core_video_mix {
 	gs_texture_t *render_texture;
 	gs_texture_t *output_texture;
 	enum gs_color_space render_space;
+	uint64_t output_scaled_time;
 	bool texture_rendered;
 	bool textures_copied[NUM_TEXTURES];
+	uint64_t rendered_times[NUM_TEXTURES];
+	uint64_t staged_times[NUM_TEXTURES];
 	bool texture_converted;
 	bool using_nv12_tex;
 	bool using_p010_tex;
@@ -290,11 +309,15 @@ struct obs_core_video_mix {
 	struct deque vframe_info_buffer_gpu;
 	gs_stagesurf_t *mapped_surfaces[NUM_CHANNELS];
 	int cur_texture;
+	int num_textures;
 	volatile long raw_active;
 	volatile long gpu_encoder_active;
 	bool gpu_was_active;
 	bool raw_was_active;
 	bool was_active;
+	pthread_mutex_t frame_trace_mutex;
+	struct obs_frame_trace frame_traces[FRAME_TRACE_HISTORY];
+	size_t frame_trace_idx;
 	pthread_mutex_t gpu_encoder_mutex;
 	struct deque gpu_encoder_queue;
 	struct deque gpu_encoder_avail_queue;
@@ -346,6 +369,9 @@ struct obs_core_video {
 	pthread_t video_thread;
 	uint32_t total_frames;
 	uint32_t lagged_frames;
+	uint32_t readback_depth;
+	struct obs_video_readback_stats readback_stats;
+	uint64_t readback_latency_total_ns;
 	bool thread_initialized;
 
 	gs_texture_t *transparent_texture;
@@ -371,6 +397,7 @@ struct obs_core_video {
 	pthread_mutex_t mixes_mutex;
 	DARRAY(struct obs_core_video_mix *) mixes;
 	struct obs_core_video_mix *main_mix;
+
 };
 
 extern void add_ready_encoder_group(obs_encoder_t *encoder);
@@ -490,6 +517,7 @@ struct obs_core {
 
 	char *locale;
 	char *module_config_path;
+	char *shader_cache_path;
 	bool name_store_owned;
 	profiler_name_store_t *name_store;
 
@@ -513,6 +541,7 @@ struct obs_graphics_context {
 	uint64_t frame_time_total_ns;
 	uint64_t fps_total_ns;
 	uint32_t fps_total_frames;
+	uint64_t memory_log_time;
 	const char *video_thread_name;
 };
 
@@ -528,6 +557,9 @@ extern gs_effect_t *obs_load_effect(gs_effect_t **effect, const char *file);
 extern bool audio_callback(void *param, uint64_t start_ts_in, uint64_t end_ts_in, uint64_t *out_ts, uint32_t mixers,
 			   struct audio_output_data *mixes);
 
+extern void obs_volmeter_service_tick(uint64_t ts);
+extern void obs_volmeter_service_free(void);
+
 extern struct obs_core_video_mix *get_mix_for_video(video_t *video);
 
 extern void start_raw_video(video_t *video, const struct video_scale_info *conversion, uint32_t frame_rate_divisor,
@@ -662,6 +694,33 @@ struct audio_action {
 	};
 };
 
+/* Audio received from a source, waiting for the audio thread.  The capture
+ * thread (serialized by filter_mutex) is the only producer and the audio
+ * thread the only consumer, so neither ever waits for the other. */
+#define AUDIO_INPUT_PACKETS 256
+
+struct audio_input_packet {
+	uint64_t timestamp;
+	uint32_t offset; /* position of the first frame in the sample ring */
+	uint32_t frames;
+	bool push_back;
+};
+
+struct audio_input_queue {
+	float *samples[MAX_AUDIO_CHANNELS];
+	volatile long channels; /* planes allocated, only ever grows */
+	uint32_t capacity;      /* in frames, power of two */
+	struct audio_input_packet packets[AUDIO_INPUT_PACKETS];
+
+	/* written by the producer only */
+	volatile long write_packet;
+	uint32_t write_frame;
+
+	/* written by the audio thread only */
+	volatile long read_packet;
+	volatile long read_frame;
+};
+
 struct obs_weak_source {
 	struct obs_weak_ref ref;
 	struct obs_source *source;
@@ -756,7 +815,8 @@ struct obs_source {
 	struct obs_source *next_audio_source;
 	struct obs_source **prev_next_audio_source;
 	uint64_t audio_ts;
-	struct deque audio_input_buf[MAX_AUDIO_CHANNELS];
+	struct audio_input_queue *audio_input;
+	struct deque audio_input_buf[MAX_AUDIO_CHANNELS]; /* audio thread only */
 	size_t last_audio_input_buf_size;
 	DARRAY(struct audio_action) audio_actions;
 	float *audio_output_buf[MAX_AUDIO_MIXES][MAX_AUDIO_CHANNELS];
@@ -764,7 +824,16 @@ struct obs_source {
 	struct resample_info sample_info;
 	audio_resampler_t *resampler;
 	pthread_mutex_t audio_actions_mutex;
-	pthread_mutex_t audio_buf_mutex;
+	pthread_mutex_t audio_buf_mutex; /* protects audio reset requests */
+	volatile bool audio_reset_pending; /* applied by the audio thread */
+	uint64_t audio_reset_ts;
+	long audio_reset_packet;
+	volatile bool audio_timing_reset_pending; /* applied by the producer */
+	bool audio_timing_reset_set;
+	uint64_t audio_timing_reset_ts;
+	uint64_t audio_timing_reset_sys_ts;
+	uint64_t audio_input_dropped; /* producer only, in frames */
+	uint64_t audio_input_drop_log_ts;
 	pthread_mutex_t audio_mutex;
 	pthread_mutex_t audio_cb_mutex;
 	DARRAY(struct audio_cb_info) audio_cb_list;
@@ -877,6 +946,16 @@ struct obs_source {
 	/* color space */
 	gs_texrender_t *color_space_texrender;
 
+	/* per-frame render cache */
+	gs_texrender_t *render_cache_texrender;
+	enum obs_render_cache_mode render_cache_mode;
+	enum gs_color_space render_cache_space;
+	uint32_t render_cache_count;
+	uint32_t render_cache_last_count;
+	bool render_cache_valid;
+	bool render_cache_linear_srgb;
+	bool rendering_cache;
+
 	/* audio monitoring */
 	struct audio_monitor *monitor;
 	enum obs_monitoring_type monitoring_type;
@@ -997,6 +1076,7 @@ extern void obs_source_video_tick(obs_source_t *source, float seconds);
 extern float obs_source_get_target_volume(obs_source_t *source, obs_source_t *target);
 extern uint64_t obs_source_get_last_async_ts(const obs_source_t *source);
 
+extern void obs_source_process_audio_input(obs_source_t *source);
 extern void obs_source_audio_render(obs_source_t *source, uint32_t mixers, size_t channels, size_t sample_rate,
 				    size_t size);
 
@@ -1155,6 +1235,10 @@ struct obs_output {
 	pthread_mutex_t pkt_callbacks_mutex;
 	DARRAY(struct packet_callback) pkt_callbacks;
 
+	/* Per-frame pipeline stage tracing */
+	pthread_mutex_t trace_mutex;
+	struct output_frame_trace *trace;
+
 	struct reconnect_callback reconnect_callback;
 
 	bool valid;
@@ -1187,6 +1271,11 @@ extern void process_delay(void *data, struct encoder_packet *packet, struct enco
 extern void obs_output_cleanup_delay(obs_output_t *output);
 extern bool obs_output_delay_start(obs_output_t *output);
 extern void obs_output_delay_stop(obs_output_t *output);
+
+extern void obs_output_trace_frame(struct obs_output *output, const struct encoder_packet *packet,
+				   const struct encoder_packet_time *packet_time);
+extern void obs_output_trace_reset(struct obs_output *output);
+extern void obs_output_trace_free(struct obs_output *output);
 extern bool obs_output_actual_start(obs_output_t *output);
 extern void obs_output_actual_stop(obs_output_t *output, bool force, uint64_t ts);
 
@@ -1273,6 +1362,11 @@ struct obs_encoder {
 	// Number of frames successfully encoded
 	uint32_t encoded_frames;
 
+	/* asynchronous raw video encoding, see obs_encoder_set_video_queue */
+	size_t video_queue_size;
+	enum obs_encoder_queue_mode video_queue_mode;
+	struct encoder_video_queue *video_queue;
+
 	/* Regions of interest to prioritize during encoding */
 	pthread_mutex_t roi_mutex;
 	DARRAY(struct obs_encoder_roi) roi;
@@ -1390,6 +1484,8 @@ extern void source_profiler_source_tick_end(obs_source_t *source, uint64_t start
 extern uint64_t source_profiler_source_render_begin(gs_timer_t **timer);
 /* Submit start timestamp and GPU timer after rendering source */
 extern void source_profiler_source_render_end(obs_source_t *source, uint64_t start, gs_timer_t *timer);
+/* Count a render pass that was drawn from the source's render cache */
+extern void source_profiler_render_cache_hit(obs_source_t *source);
 
 /* Remove source from profiler hashmaps */
 extern void source_profiler_remove_source(obs_source_t *source);
@@ -0,0 +1,241 @@
+/******************************************************************************
+    Copyright (C) 2026 by OBS Project contributors
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+******************************************************************************/
+
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include "obs-internal.h"
+
+/* number of most recent frames the stage percentiles are calculated over */
+#define TRACE_SAMPLES 512
+
+/* interleaved frames waiting for the output to report them as sent */
+#define TRACE_PENDING 64
+
+struct pending_frame {
+	size_t track_idx;
+	struct encoder_packet_time packet_time;
+	bool used;
+};
+
+struct output_frame_trace {
+	uint64_t samples[OBS_FRAME_STAGE_COUNT][TRACE_SAMPLES];
+	uint64_t num_samples[OBS_FRAME_STAGE_COUNT];
+
+	struct pending_frame pending[TRACE_PENDING];
+	size_t pending_idx;
+	bool reports_sent;
+
+	FILE *log;
+};
+
+static inline void add_sample(struct output_frame_trace *trace, enum obs_frame_stage stage, uint64_t begin,
+			      uint64_t end)
+{
+	if (!begin || !end || end < begin)
+		return;
+
+	trace->samples[stage][trace->num_samples[stage]++ % TRACE_SAMPLES] = end - begin;
+}
+
+static void record_frame(struct output_frame_trace *trace, size_t track_idx, const struct encoder_packet_time *ept,
+			 uint64_t sent)
+{
+	uint64_t ready = ept->downloaded ? ept->downloaded : ept->rendered;
+
+	add_sample(trace, OBS_FRAME_STAGE_RENDER, ept->cts, ept->rendered);
+	add_sample(trace, OBS_FRAME_STAGE_READBACK, ept->rendered, ept->downloaded);
+	add_sample(trace, OBS_FRAME_STAGE_QUEUE, ready, ept->fer);
+	add_sample(trace, OBS_FRAME_STAGE_ENCODE, ept->fer, ept->ferc);
+	add_sample(trace, OBS_FRAME_STAGE_INTERLEAVE, ept->ferc, ept->pir);
+	add_sample(trace, OBS_FRAME_STAGE_SEND, ept->pir, sent);
+	add_sample(trace, OBS_FRAME_STAGE_TOTAL, ept->cts, ept->pir);
+	add_sample(trace, OBS_FRAME_STAGE_END_TO_END, ept->cts, sent);
+
+	if (trace->log) {
+		fprintf(trace->log,
+			"%zu,%" PRId64 ",%" PRIu64 ",%" PRIu64 ",%" PRIu64 ",%" PRIu64 ",%" PRIu64 ",%" PRIu64
+			",%" PRIu64 "\n",
+			track_idx, ept->pts, ept->cts, ept->rendered, ept->downloaded, ept->fer, ept->ferc, ept->pir,
+			sent);
+	}
+}
+
+static inline struct output_frame_trace *get_trace(struct obs_output *output)
+{
+	if (!output->trace)
+		output->trace = bzalloc(sizeof(struct output_frame_trace));
+	return output->trace;
+}
+
+void obs_output_trace_frame(struct obs_output *output, const struct encoder_packet *packet,
+			    const struct encoder_packet_time *packet_time)
+{
+	pthread_mutex_lock(&output->trace_mutex);
+
+	struct output_frame_trace *trace = get_trace(output);
+
+	if (trace->reports_sent) {
+		struct pending_frame *pending = &trace->pending[trace->pending_idx];
+
+		/* the output never reported the oldest frame as sent, most
+		 * likely because it was dropped */
+		if (pending->used)
+			record_frame(trace, pending->track_idx, &pending->packet_time, 0);
+
+		pending->track_idx = packet->track_idx;
+		pending->packet_time = *packet_time;
+		pending->used = true;
+		trace->pending_idx = (trace->pending_idx + 1) % TRACE_PENDING;
+	} else {
+		record_frame(trace, packet->track_idx, packet_time, 0);
+	}
+
+	pthread_mutex_unlock(&output->trace_mutex);
+}
+
+void obs_output_trace_reset(struct obs_output *output)
+{
+	pthread_mutex_lock(&output->trace_mutex);
+	if (output->trace) {
+		memset(output->trace->pending, 0, sizeof(output->trace->pending));
+		output->trace->pending_idx = 0;
+	}
+	pthread_mutex_unlock(&output->trace_mutex);
+}
+
+void obs_output_trace_free(struct obs_output *output)
+{
+	if (output->trace) {
+		if (output->trace->log)
+			fclose(output->trace->log);
+		bfree(output->trace);
+		output->trace = NULL;
+	}
+}
+
+void obs_output_packet_sent(obs_output_t *output, const struct encoder_packet *packet)
+{
+	if (!obs_output_valid(output, "obs_output_packet_sent"))
+		return;
+	if (!obs_ptr_valid(packet, "obs_output_packet_sent"))
+		return;
+	if (packet->type != OBS_ENCODER_VIDEO)
+		return;
+
+	uint64_t sent = os_gettime_ns();
+
+	pthread_mutex_lock(&output->trace_mutex);
+
+	struct output_frame_trace *trace = get_trace(output);
+	trace->reports_sent = true;
+
+	for (size_t i = 0; i < TRACE_PENDING; i++) {
+		struct pending_frame *pending = &trace->pending[i];
+
+		if (pending->used && pending->track_idx == packet->track_idx &&
+		    pending->packet_time.pts == packet->pts) {
+			record_frame(trace, pending->track_idx, &pending->packet_time, sent);
+			pending->used = false;
+			break;
+		}
+	}
+
+	pthread_mutex_unlock(&output->trace_mutex);
+}
+
+static int compare_samples(const void *a, const void *b)
+{
+	uint64_t val_a = *(const uint64_t *)a;
+	uint64_t val_b = *(const uint64_t *)b;
+	return val_a < val_b ? -1 : (val_a > val_b ? 1 : 0);
+}
+
+static inline uint64_t percentile(const uint64_t *sorted, size_t num, size_t pct)
+{
+	return sorted[(num - 1) * pct / 100];
+}
+
+bool obs_output_get_frame_stage_stats(const obs_output_t *output, enum obs_frame_stage stage,
+				      struct obs_frame_stage_stats *stats)
+{
+	uint64_t samples[TRACE_SAMPLES];
+	size_t num = 0;
+
+	if (!obs_output_valid(output, "obs_output_get_frame_stage_stats"))
+		return false;
+	if (!obs_ptr_valid(stats, "obs_output_get_frame_stage_stats"))
+		return false;
+	if ((size_t)stage >= OBS_FRAME_STAGE_COUNT)
+		return false;
+
+	struct obs_output *out = (struct obs_output *)output;
+
+	pthread_mutex_lock(&out->trace_mutex);
+	if (out->trace) {
+		uint64_t total = out->trace->num_samples[stage];
+
+		num = total < TRACE_SAMPLES ? (size_t)total : TRACE_SAMPLES;
+		memcpy(samples, out->trace->samples[stage], num * sizeof(uint64_t));
+	}
+	pthread_mutex_unlock(&out->trace_mutex);
+
+	memset(stats, 0, sizeof(*stats));
+	if (!num)
+		return false;
+
+	qsort(samples, num, sizeof(uint64_t), compare_samples);
+
+	stats->samples = num;
+	stats->min_ns = samples[0];
+	stats->p50_ns = percentile(samples, num, 50);
+	stats->p90_ns = percentile(samples, num, 90);
+	stats->p99_ns = percentile(samples, num, 99);
+	stats->max_ns = samples[num - 1];
+	return true;
+}
+
+bool obs_output_set_frame_trace_log(obs_output_t *output, const char *path)
+{
+	bool success = true;
+
+	if (!obs_output_valid(output, "obs_output_set_frame_trace_log"))
+		return false;
+
+	pthread_mutex_lock(&output->trace_mutex);
+
+	struct output_frame_trace *trace = get_trace(output);
+
+	if (trace->log) {
+		fclose(trace->log);
+		trace->log = NULL;
+	}
+
+	if (path && *path) {
+		trace->log = os_fopen(path, "w");
+		if (trace->log) {
+			fprintf(trace->log, "track,pts,cts,rendered,downloaded,fer,ferc,pir,sent\n");
+		} else {
+			blog(LOG_WARNING, "output '%s': Failed to open frame trace log '%s'", output->context.name,
+			     path);
+			success = false;
+		}
+	}
+
+	pthread_mutex_unlock(&output->trace_mutex);
+	return success;
+}
@@ -170,6 +170,7 @@ obs_output_t *obs_output_create(const char *id, const char *name, obs_data_t *se
 	pthread_mutex_init_value(&output->delay_mutex);
 	pthread_mutex_init_value(&output->pause.mutex);
 	pthread_mutex_init_value(&output->pkt_callbacks_mutex);
+	pthread_mutex_init_value(&output->trace_mutex);
 
 	if (pthread_mutex_init(&output->interleaved_mutex, NULL) != 0)
 		goto fail;
@@ -179,6 +180,8 @@ obs_output_t *obs_output_create(const char *id, const char *name, obs_data_t *se
 		goto fail;
 	if (pthread_mutex_init(&output->pkt_callbacks_mutex, NULL) != 0)
 		goto fail;
+	if (pthread_mutex_init(&output->trace_mutex, NULL) != 0)
+		goto fail;
 	if (os_event_init(&output->stopping_event, OS_EVENT_TYPE_MANUAL) != 0)
 		goto fail;
 	if (!init_output_handlers(output, name, settings, hotkey_data))
@@ -298,6 +301,7 @@ void obs_output_destroy(obs_output_t *output)
 			da_free(output->encoder_packet_times[i]);
 
 		da_free(output->pkt_callbacks);
+		obs_output_trace_free(output);
 
 		clear_raw_audio_buffers(output);
 
@@ -306,6 +310,7 @@ void obs_output_destroy(obs_output_t *output)
 		pthread_mutex_destroy(&output->interleaved_mutex);
 		pthread_mutex_destroy(&output->delay_mutex);
 		pthread_mutex_destroy(&output->pkt_callbacks_mutex);
+		pthread_mutex_destroy(&output->trace_mutex);
 		os_event_destroy(output->reconnect_stop_event);
 		obs_context_data_free(&output->context);
 		deque_free(&output->delay_data);
@@ -1725,6 +1730,12 @@ static inline void send_interleaved(struct obs_output *output)
 	}
 	pthread_mutex_unlock(&output->pkt_callbacks_mutex);
 
+	if (found_ept) {
+		if (!ept_local.pir)
+			ept_local.pir = os_gettime_ns();
+		obs_output_trace_frame(output, &out, &ept_local);
+	}
+
 	output->info.encoded_packet(output->context.data, &out);
 	obs_encoder_packet_release(&out);
 }
@@ -2395,6 +2406,8 @@ static void reset_packet_data(obs_output_t *output)
 		output->encoder_packet_times[i].num = 0;
 	}
 
+	obs_output_trace_reset(output);
+
 	for (size_t i = 0; i < MAX_OUTPUT_VIDEO_ENCODERS; i++) {
 		output->received_video[i] = false;
 		output->video_offsets[i] = 0;
@@ -87,6 +87,37 @@ struct obs_output_info {
 	const char *protocols;
 };
 
+/** Stages of the video pipeline traced for every encoded frame */
+enum obs_frame_stage {
+	/* Frame time to the end of rendering and color conversion */
+	OBS_FRAME_STAGE_RENDER,
+	/* Rendering to GPU readback, raw (non-texture) encoders only */
+	OBS_FRAME_STAGE_READBACK,
+	/* Readback (or rendering for texture encoders) to encode request */
+	OBS_FRAME_STAGE_QUEUE,
+	/* Encode request to encode request complete */
+	OBS_FRAME_STAGE_ENCODE,
+	/* Encode request complete to packet interleave */
+	OBS_FRAME_STAGE_INTERLEAVE,
+	/* Packet interleave to network send, if the output reports it */
+	OBS_FRAME_STAGE_SEND,
+	/* Frame time to packet interleave */
+	OBS_FRAME_STAGE_TOTAL,
+	/* Frame time to network send, if the output reports it */
+	OBS_FRAME_STAGE_END_TO_END,
+	OBS_FRAME_STAGE_COUNT,
+};
+
+/** Latency percentiles of a pipeline stage over the most recent frames */
+struct obs_frame_stage_stats {
+	uint64_t samples;
+	uint64_t min_ns;
+	uint64_t p50_ns;
+	uint64_t p90_ns;
+	uint64_t p99_ns;
+	uint64_t max_ns;
+};
+
 EXPORT void obs_register_output_s(const struct obs_output_info *info, size_t size);
 
 #define obs_register_output(info) obs_register_output_s(info, sizeof(struct obs_output_info))
@@ -159,6 +159,10 @@ static void *scene_create(obs_data_t *settings, struct obs_source *source)
 		scene->custom_size = true;
 		scene->cx = 0;
 		scene->cy = 0;
+	} else {
+		/* scenes are often shown in the program, the preview, projectors
+		 * and multiview cells in the same frame */
+		source->render_cache_mode = OBS_RENDER_CACHE_AUTO;
 	}
 
 	signal_handler_add_array(obs_source_get_signal_handler(source), obs_scene_signals);
@@ -154,6 +154,56 @@ static void allocate_audio_mix_buffer(struct obs_source *source)
 	}
 }
 
+/* half a second of audio, the audio thread empties the queue every tick.
+ * the queue outlives audio resets, so it has room for the highest sample
+ * rate rather than the current one. audio reaches the queue already converted
+ * to the output speaker layout, so only that many channel planes are
+ * allocated, more are added if a later audio reset widens the layout. */
+#define AUDIO_INPUT_MAX_SAMPLE_RATE 48000
+
+/* producer only. the audio thread never reads more planes than the queue
+ * reports, and planes are only freed with the queue */
+static void grow_audio_input_queue(struct audio_input_queue *queue, size_t channels)
+{
+	size_t cur = (size_t)queue->channels;
+
+	if (channels > MAX_AUDIO_CHANNELS)
+		channels = MAX_AUDIO_CHANNELS;
+	if (channels <= cur)
+		return;
+
+	for (size_t i = cur; i < channels; i++)
+		queue->samples[i] = bzalloc(sizeof(float) * queue->capacity);
+
+	os_atomic_set_long(&queue->channels, (long)channels);
+}
+
+static void allocate_audio_input_queue(struct obs_source *source)
+{
+	struct audio_input_queue *queue;
+	uint32_t capacity = 1;
+
+	while (capacity < AUDIO_INPUT_MAX_SAMPLE_RATE / 2)
+		capacity <<= 1;
+
+	queue = bzalloc(sizeof(*queue));
+	queue->capacity = capacity;
+	source->audio_input = queue;
+
+	if (obs->audio.audio)
+		grow_audio_input_queue(queue, audio_output_get_channels(obs->audio.audio));
+}
+
+static void free_audio_input_queue(struct obs_source *source)
+{
+	if (source->audio_input) {
+		for (size_t i = 0; i < MAX_AUDIO_CHANNELS; i++)
+			bfree(source->audio_input->samples[i]);
+		bfree(source->audio_input);
+		source->audio_input = NULL;
+	}
+}
+
 static inline bool is_audio_source(const struct obs_source *source)
 {
 	return source->info.output_flags & OBS_SOURCE_AUDIO;
@@ -201,6 +251,8 @@ static bool obs_source_init(struct obs_source *source)
 
 	if (is_audio_source(source) || is_composite_source(source))
 		allocate_audio_output_buffer(source);
+	if (is_audio_source(source))
+		allocate_audio_input_queue(source);
 	if (source->info.audio_mix)
 		allocate_audio_mix_buffer(source);
 
@@ -563,10 +615,47 @@ void obs_source_frame_init(struct obs_source_frame *frame, enum video_format for
 	}
 }
 
+/* async cache and preload frames take their buffers from the frame pool.
+ * destroy_pooled_frame returns them to it, and falls back to freeing the
+ * buffer for frames that were allocated elsewhere (e.g. by filters). */
+static struct obs_source_frame *create_pooled_frame(enum video_format format, uint32_t width, uint32_t height)
+{
+	struct obs_source_frame *frame = bzalloc(sizeof(struct obs_source_frame));
+	struct video_frame vid_frame;
+
+	video_frame_init_pooled(&vid_frame, format, width, height);
+	frame->format = format;
+	frame->width = width;
+	frame->height = height;
+
+	for (size_t i = 0; i < MAX_AV_PLANES; i++) {
+		frame->data[i] = vid_frame.data[i];
+		frame->linesize[i] = vid_frame.linesize[i];
+	}
+
+	return frame;
+}
+
+static void destroy_pooled_frame(struct obs_source_frame *frame)
+{
+	struct video_frame vid_frame;
+
+	if (!frame)
+		return;
+
+	for (size_t i = 0; i < MAX_AV_PLANES; i++) {
+		vid_frame.data[i] = frame->data[i];
+		vid_frame.linesize[i] = frame->linesize[i];
+	}
+
+	video_frame_free_pooled(&vid_frame, frame->format, frame->width, frame->height);
+	bfree(frame);
+}
+
 static inline void obs_source_frame_decref(struct obs_source_frame *frame)
 {
 	if (os_atomic_dec_long(&frame->refs) == 0)
-		obs_source_frame_destroy(frame);
+		destroy_pooled_frame(frame);
 }
 
 static bool obs_source_filter_remove_refless(obs_source_t *source, obs_source_t *filter);
@@ -661,17 +750,20 @@ static void obs_source_destroy_defer(struct obs_source *source)
 		gs_texrender_destroy(source->filter_texrender);
 	if (source->color_space_texrender)
 		gs_texrender_destroy(source->color_space_texrender);
+	if (source->render_cache_texrender)
+		gs_texrender_destroy(source->render_cache_texrender);
 	gs_leave_context();
 
 	for (i = 0; i < MAX_AV_PLANES; i++)
 		bfree(source->audio_data.data[i]);
 	for (i = 0; i < MAX_AUDIO_CHANNELS; i++)
 		deque_free(&source->audio_input_buf[i]);
+	free_audio_input_queue(source);
 	audio_resampler_destroy(source->resampler);
 	bfree(source->audio_output_buf[0][0]);
 	bfree(source->audio_mix_buf[0]);
 
-	obs_source_frame_destroy(source->async_preload_frame);
+	destroy_pooled_frame(source->async_preload_frame);
 
 	if (source->info.type == OBS_SOURCE_TYPE_TRANSITION)
 		obs_transition_free(source);
@@ -1233,6 +1325,11 @@ void obs_source_video_tick(obs_source_t *source, float seconds)
 	if (source->filter_texrender)
 		gs_texrender_reset(source->filter_texrender);
 
+	/* the render cache only holds the output of the current frame */
+	source->render_cache_last_count = source->render_cache_count;
+	source->render_cache_count = 0;
+	source->render_cache_valid = false;
+
 	/* call show/hide if the reference changed */
 	now_showing = !!source->show_refs;
 	if (now_showing != source->showing) {
@@ -1313,6 +1410,7 @@ static inline void reset_audio_timing(obs_source_t *source, uint64_t timestamp,
 	source->timing_adjust = os_time - timestamp;
 }
 
+/* audio thread only */
 static void reset_audio_data(obs_source_t *source, uint64_t os_time)
 {
 	for (size_t i = 0; i < MAX_AUDIO_CHANNELS; i++) {
@@ -1322,9 +1420,20 @@ static void reset_audio_data(obs_source_t *source, uint64_t os_time)
 
 	source->last_audio_input_buf_size = 0;
 	source->audio_ts = os_time;
-	source->next_audio_sys_ts_min = os_time;
 }
 
+/* the audio thread applies the reset the next time it takes in audio from
+ * the source, dropping everything that was queued before the request */
+static void request_audio_reset_locked(obs_source_t *source, uint64_t os_time)
+{
+	struct audio_input_queue *queue = source->audio_input;
+
+	source->audio_reset_ts = os_time;
+	source->audio_reset_packet = queue ? os_atomic_load_long(&queue->write_packet) : 0;
+	os_atomic_set_bool(&source->audio_reset_pending, true);
+}
+
+/* producer only */
 static void handle_ts_jump(obs_source_t *source, uint64_t expected, uint64_t ts, uint64_t diff, uint64_t os_time)
 {
 	blog(LOG_DEBUG,
@@ -1332,10 +1441,46 @@ static void handle_ts_jump(obs_source_t *source, uint64_t expected, uint64_t ts,
 	     "expected value %" PRIu64 ", input value %" PRIu64,
 	     source->context.name, diff, expected, ts);
 
-	pthread_mutex_lock(&source->audio_buf_mutex);
 	reset_audio_timing(source, ts, os_time);
-	reset_audio_data(source, os_time);
+	source->next_audio_sys_ts_min = os_time;
+
+	pthread_mutex_lock(&source->audio_buf_mutex);
+	request_audio_reset_locked(source, os_time);
+	pthread_mutex_unlock(&source->audio_buf_mutex);
+}
+
+/* for threads other than the producer. the timing is reset by the producer
+ * before it outputs its next audio, the queued audio by the audio thread. if
+ * set is false, the timing is taken from the next audio instead. */
+static void request_audio_timing_reset(obs_source_t *source, bool set, uint64_t timestamp, uint64_t os_time)
+{
+	pthread_mutex_lock(&source->audio_buf_mutex);
+	source->audio_timing_reset_set = set;
+	source->audio_timing_reset_ts = timestamp;
+	source->audio_timing_reset_sys_ts = os_time;
+	os_atomic_set_bool(&source->audio_timing_reset_pending, true);
+	request_audio_reset_locked(source, os_time);
+	pthread_mutex_unlock(&source->audio_buf_mutex);
+}
+
+static void apply_audio_timing_reset(obs_source_t *source)
+{
+	bool set;
+	uint64_t timestamp;
+	uint64_t os_time;
+
+	pthread_mutex_lock(&source->audio_buf_mutex);
+	set = source->audio_timing_reset_set;
+	timestamp = source->audio_timing_reset_ts;
+	os_time = source->audio_timing_reset_sys_ts;
+	os_atomic_set_bool(&source->audio_timing_reset_pending, false);
 	pthread_mutex_unlock(&source->audio_buf_mutex);
+
+	if (set)
+		reset_audio_timing(source, timestamp, os_time);
+	else
+		source->timing_set = false;
+	source->next_audio_sys_ts_min = os_time;
 }
 
 static void source_signal_audio_data(obs_source_t *source, const struct audio_data *in, bool muted)
@@ -1361,22 +1506,41 @@ static inline size_t get_buf_placement(audio_t *audio, uint64_t offset)
 	return (size_t)util_mul_div64(offset, sample_rate, 1000000000ULL);
 }
 
-static void source_output_audio_place(obs_source_t *source, const struct audio_data *in)
+/* the samples of a packet may wrap around the end of the queue */
+static inline size_t packet_first_frames(const struct audio_input_queue *queue,
+					 const struct audio_input_packet *packet)
+{
+	size_t pos = packet->offset & (queue->capacity - 1);
+	size_t first = queue->capacity - pos;
+	return first < packet->frames ? first : packet->frames;
+}
+
+static inline size_t audio_input_channels(const struct audio_input_queue *queue)
 {
+	size_t channels = audio_output_get_channels(obs->audio.audio);
+	size_t planes = (size_t)os_atomic_load_long(&queue->channels);
+	return channels < planes ? channels : planes;
+}
+
+static void source_output_audio_place(obs_source_t *source, const struct audio_input_packet *packet)
+{
+	struct audio_input_queue *queue = source->audio_input;
 	audio_t *audio = obs->audio.audio;
 	size_t buf_placement;
-	size_t channels = audio_output_get_channels(audio);
-	size_t size = in->frames * sizeof(float);
+	size_t channels = audio_input_channels(queue);
+	size_t pos = packet->offset & (queue->capacity - 1);
+	size_t first = packet_first_frames(queue, packet) * sizeof(float);
+	size_t size = packet->frames * sizeof(float);
 
-	if (!source->audio_ts || in->timestamp < source->audio_ts)
-		reset_audio_data(source, in->timestamp);
+	if (!source->audio_ts || packet->timestamp < source->audio_ts)
+		reset_audio_data(source, packet->timestamp);
 
-	buf_placement = get_buf_placement(audio, in->timestamp - source->audio_ts) * sizeof(float);
+	buf_placement = get_buf_placement(audio, packet->timestamp - source->audio_ts) * sizeof(float);
 
 #if DEBUG_AUDIO == 1
-	blog(LOG_DEBUG, "frames: %lu, size: %lu, placement: %lu, base_ts: %llu, ts: %llu", (unsigned long)in->frames,
-	     (unsigned long)source->audio_input_buf[0].size, (unsigned long)buf_placement, source->audio_ts,
-	     in->timestamp);
+	blog(LOG_DEBUG, "frames: %lu, size: %lu, placement: %lu, base_ts: %llu, ts: %llu",
+	     (unsigned long)packet->frames, (unsigned long)source->audio_input_buf[0].size,
+	     (unsigned long)buf_placement, source->audio_ts, packet->timestamp);
 #endif
 
 	/* do not allow the circular buffers to become too big */
@@ -1384,7 +1548,10 @@ static void source_output_audio_place(obs_source_t *source, const struct audio_d
 		return;
 
 	for (size_t i = 0; i < channels; i++) {
-		deque_place(&source->audio_input_buf[i], buf_placement, in->data[i], size);
+		deque_place(&source->audio_input_buf[i], buf_placement, queue->samples[i] + pos, first);
+		if (size > first)
+			deque_place(&source->audio_input_buf[i], buf_placement + first, queue->samples[i],
+				    size - first);
 		deque_pop_back(&source->audio_input_buf[i], NULL,
 			       source->audio_input_buf[i].size - (buf_placement + size));
 	}
@@ -1392,24 +1559,143 @@ static void source_output_audio_place(obs_source_t *source, const struct audio_d
 	source->last_audio_input_buf_size = 0;
 }
 
-static inline void source_output_audio_push_back(obs_source_t *source, const struct audio_data *in)
+static inline void source_output_audio_push_back(obs_source_t *source, const struct audio_input_packet *packet)
 {
-	audio_t *audio = obs->audio.audio;
-	size_t channels = audio_output_get_channels(audio);
-	size_t size = in->frames * sizeof(float);
+	struct audio_input_queue *queue = source->audio_input;
+	size_t channels = audio_input_channels(queue);
+	size_t pos = packet->offset & (queue->capacity - 1);
+	size_t first = packet_first_frames(queue, packet) * sizeof(float);
+	size_t size = packet->frames * sizeof(float);
 
 	/* do not allow the circular buffers to become too big */
 	if ((source->audio_input_buf[0].size + size) > MAX_BUF_SIZE)
 		return;
 
-	for (size_t i = 0; i < channels; i++)
-		deque_push_back(&source->audio_input_buf[i], in->data[i], size);
+	for (size_t i = 0; i < channels; i++) {
+		deque_push_back(&source->audio_input_buf[i], queue->samples[i] + pos, first);
+		if (size > first)
+			deque_push_back(&source->audio_input_buf[i], queue->samples[i], size - first);
+	}
 
 	/* reset audio input buffer size to ensure that audio doesn't get
 	 * perpetually cut */
 	source->last_audio_input_buf_size = 0;
 }
 
+void obs_source_process_audio_input(obs_source_t *source)
+{
+	struct audio_input_queue *queue = source->audio_input;
+	unsigned long reset_packet = 0;
+	bool reset = false;
+	unsigned long read;
+	unsigned long write;
+	uint32_t read_frame = 0;
+
+	if (os_atomic_load_bool(&source->audio_reset_pending)) {
+		pthread_mutex_lock(&source->audio_buf_mutex);
+		uint64_t reset_ts = source->audio_reset_ts;
+		reset_packet = (unsigned long)source->audio_reset_packet;
+		os_atomic_set_bool(&source->audio_reset_pending, false);
+		pthread_mutex_unlock(&source->audio_buf_mutex);
+
+		reset_audio_data(source, reset_ts);
+		reset = true;
+	}
+
+	if (!queue)
+		return;
+
+	read = (unsigned long)queue->read_packet;
+	write = (unsigned long)os_atomic_load_long(&queue->write_packet);
+	if (read == write)
+		return;
+
+	while (read != write) {
+		const struct audio_input_packet *packet = &queue->packets[read & (AUDIO_INPUT_PACKETS - 1)];
+
+		/* audio queued before a reset was requested is dropped */
+		if (!reset || (long)(read - reset_packet) >= 0) {
+			if (packet->push_back && source->audio_ts)
+				source_output_audio_push_back(source, packet);
+			else
+				source_output_audio_place(source, packet);
+		}
+
+		read_frame = packet->offset + packet->frames;
+		read++;
+	}
+
+	os_atomic_set_long(&queue->read_frame, (long)read_frame);
+	os_atomic_set_long(&queue->read_packet, (long)read);
+}
+
+/* capture thread only, returns false if the audio thread has fallen behind
+ * too far to take the audio */
+static bool queue_audio_input(obs_source_t *source, const struct audio_data *in, bool push_back)
+{
+	struct audio_input_queue *queue = source->audio_input;
+	size_t sample_rate = audio_output_get_sample_rate(obs->audio.audio);
+	size_t channels = audio_input_channels(queue);
+	uint32_t max_frames = queue->capacity / 2;
+	uint32_t done = 0;
+
+	/* blocks larger than half the queue are split up, the parts after the
+	 * first one always directly follow the previous one */
+	while (done < in->frames) {
+		unsigned long write = (unsigned long)queue->write_packet;
+		unsigned long read = (unsigned long)os_atomic_load_long(&queue->read_packet);
+		uint32_t used = queue->write_frame - (uint32_t)os_atomic_load_long(&queue->read_frame);
+		uint32_t frames = in->frames - done;
+
+		if (frames > max_frames)
+			frames = max_frames;
+		if (write - read >= AUDIO_INPUT_PACKETS || queue->capacity - used < frames)
+			return false;
+
+		struct audio_input_packet *packet = &queue->packets[write & (AUDIO_INPUT_PACKETS - 1)];
+		packet->timestamp = in->timestamp + conv_frames_to_time(sample_rate, done);
+		packet->offset = queue->write_frame;
+		packet->frames = frames;
+		packet->push_back = push_back || done > 0;
+
+		size_t pos = packet->offset & (queue->capacity - 1);
+		size_t first = packet_first_frames(queue, packet);
+
+		for (size_t i = 0; i < channels; i++) {
+			const float *data = (const float *)in->data[i] + done;
+
+			memcpy(queue->samples[i] + pos, data, first * sizeof(float));
+			if (frames > first)
+				memcpy(queue->samples[i], data + first, (frames - first) * sizeof(float));
+		}
+
+		queue->write_frame += frames;
+		os_atomic_set_long(&queue->write_packet, (long)(write + 1));
+		done += frames;
+	}
+
+	return true;
+}
+
+/* logs once every few seconds at most, a stalled audio thread would
+ * otherwise log every packet */
+#define AUDIO_INPUT_DROP_LOG_INTERVAL 5000000000ULL
+
+static void audio_input_dropped(obs_source_t *source, uint32_t frames, uint64_t os_time)
+{
+	uint64_t last = source->audio_input_drop_log_ts;
+
+	source->audio_input_dropped += frames;
+	if (last && os_time - last < AUDIO_INPUT_DROP_LOG_INTERVAL)
+		return;
+
+	source->audio_input_drop_log_ts = os_time;
+	blog(LOG_WARNING,
+	     "Audio input queue of '%s' is full, the audio thread is not keeping up. "
+	     "%" PRIu64 " frames dropped so far",
+	     source->context.name, source->audio_input_dropped);
+}
+
 static inline bool source_muted(obs_source_t *source, uint64_t os_time)
 {
 	if (source->push_to_mute_enabled && source->user_push_to_mute_pressed)
@@ -1435,6 +1721,9 @@ static void source_output_audio_data(obs_source_t *source, const struct audio_da
 	bool using_direct_ts = false;
 	bool push_back = false;
 
+	if (os_atomic_load_bool(&source->audio_timing_reset_pending))
+		apply_audio_timing_reset(source);
+
 	/* detects 'directly' set timestamps as long as they're within
 	 * a certain threshold */
 	if (uint64_diff(in.timestamp, os_time) < MAX_TS_VAR) {
@@ -1468,8 +1757,6 @@ static void source_output_audio_data(obs_source_t *source, const struct audio_da
 
 	in.timestamp += source->timing_adjust;
 
-	pthread_mutex_lock(&source->audio_buf_mutex);
-
 	if (source->next_audio_sys_ts_min == in.timestamp) {
 		push_back = true;
 
@@ -1503,14 +1790,12 @@ static void source_output_audio_data(obs_source_t *source, const struct audio_da
 		source->last_sync_offset = sync_offset;
 	}
 
-	if (source->monitoring_type != OBS_MONITORING_TYPE_MONITOR_ONLY) {
-		if (push_back && source->audio_ts)
-			source_output_audio_push_back(source, &in);
-		else
-			source_output_audio_place(source, &in);
-	}
+	if (source->monitoring_type != OBS_MONITORING_TYPE_MONITOR_ONLY && source->audio_input) {
+		grow_audio_input_queue(source->audio_input, audio_output_get_channels(obs->audio.audio));
 
-	pthread_mutex_unlock(&source->audio_buf_mutex);
+		if (!queue_audio_input(source, &in, push_back))
+			audio_input_dropped(source, in.frames, os_time);
+	}
 
 	source_signal_audio_data(source, data, source_muted(source, os_time));
 }
@@ -2801,6 +3086,140 @@ static inline void render_video(obs_source_t *source)
 	GS_DEBUG_MARKER_END();
 }
 
+static const char *render_cache_hit_name = "obs_source_render_cache_hit";
+
+static inline bool render_cache_enabled(obs_source_t *source)
+{
+	const uint32_t flags = source->info.output_flags;
+
+	if ((flags & OBS_SOURCE_VIDEO) == 0 || !source->context.data || !source->enabled)
+		return false;
+
+	switch (source->render_cache_mode) {
+	case OBS_RENDER_CACHE_AUTO:
+		if ((flags & OBS_SOURCE_COMPOSITE) == 0)
+			return false;
+		break;
+	case OBS_RENDER_CACHE_ENABLED:
+		break;
+	case OBS_RENDER_CACHE_DISABLED:
+		return false;
+	}
+
+	/* only worth the extra pass if the source was rendered more than
+	 * once in the previous frame */
+	if (source->render_cache_last_count < 2)
+		return false;
+
+	/* sources that are not custom draw render with the effect of the
+	 * caller, which a cached texture cannot reproduce */
+	return gs_get_effect() == NULL;
+}
+
+static void draw_render_cache(obs_source_t *source)
+{
+	gs_texture_t *tex = gs_texrender_get_texture(source->render_cache_texrender);
+	if (!tex)
+		return;
+
+	gs_effect_t *effect = obs->video.default_effect;
+	gs_technique_t *tech = gs_effect_get_technique(effect, "Draw");
+	gs_eparam_t *image = gs_effect_get_param_by_name(effect, "image");
+	size_t passes, i;
+
+	const bool linear_srgb = source->render_cache_linear_srgb;
+
+	const bool previous = gs_framebuffer_srgb_enabled();
+	gs_enable_framebuffer_srgb(linear_srgb);
+
+	if (linear_srgb)
+		gs_effect_set_texture_srgb(image, tex);
+	else
+		gs_effect_set_texture(image, tex);
+
+	passes = gs_technique_begin(tech);
+	for (i = 0; i < passes; i++) {
+		gs_technique_begin_pass(tech, i);
+		gs_draw_sprite(tex, 0, 0, 0);
+		gs_technique_end_pass(tech);
+	}
+	gs_technique_end(tech);
+
+	gs_enable_framebuffer_srgb(previous);
+}
+
+/* renders the source to its cache texture the first time it is rendered in a
+ * frame, and draws that texture for every render after that.  returns false
+ * if the source has to be rendered normally. */
+static bool render_cached(obs_source_t *source)
+{
+	/* renders of a filter chain and of the cache itself are part of
+	 * another render of the source */
+	if (source->info.type == OBS_SOURCE_TYPE_FILTER || source->filter_parent || source->rendering_filter ||
+	    source->rendering_cache)
+		return false;
+
+	source->render_cache_count++;
+
+	if (!render_cache_enabled(source))
+		return false;
+
+	const enum gs_color_space space = gs_get_color_space();
+	const bool linear_srgb = gs_get_linear_srgb();
+
+	if (source->render_cache_valid) {
+		/* the cache was rendered for a different target */
+		if (source->render_cache_space != space || source->render_cache_linear_srgb != linear_srgb)
+			return false;
+
+		profile_start(render_cache_hit_name);
+		draw_render_cache(source);
+		source_profiler_render_cache_hit(source);
+		profile_end(render_cache_hit_name);
+		return true;
+	}
+
+	const uint32_t cx = obs_source_get_width(source);
+	const uint32_t cy = obs_source_get_height(source);
+	if (!cx || !cy)
+		return false;
+
+	const enum gs_color_format format = gs_get_format_from_space(space);
+	if (source->render_cache_texrender && gs_texrender_get_format(source->render_cache_texrender) != format) {
+		gs_texrender_destroy(source->render_cache_texrender);
+		source->render_cache_texrender = NULL;
+	}
+
+	if (!source->render_cache_texrender)
+		source->render_cache_texrender = gs_texrender_create(format, GS_ZS_NONE);
+
+	gs_texrender_reset(source->render_cache_texrender);
+	if (!gs_texrender_begin_with_color_space(source->render_cache_texrender, cx, cy, space))
+		return false;
+
+	struct vec4 clear_color;
+	vec4_zero(&clear_color);
+	gs_clear(GS_CLEAR_COLOR, &clear_color, 0.0f, 0);
+	gs_ortho(0.0f, (float)cx, 0.0f, (float)cy, -100.0f, 100.0f);
+
+	gs_blend_state_push();
+	gs_blend_function(GS_BLEND_ONE, GS_BLEND_INVSRCALPHA);
+
+	source->rendering_cache = true;
+	render_video(source);
+	source->rendering_cache = false;
+
+	gs_blend_state_pop();
+	gs_texrender_end(source->render_cache_texrender);
+
+	source->render_cache_valid = true;
+	source->render_cache_space = space;
+	source->render_cache_linear_srgb = linear_srgb;
+
+	draw_render_cache(source);
+	return true;
+}
+
 void obs_source_video_render(obs_source_t *source)
 {
 	if (!obs_source_valid(source, "obs_source_video_render"))
@@ -2808,11 +3227,26 @@ void obs_source_video_render(obs_source_t *source)
 
 	source = obs_source_get_ref(source);
 	if (source) {
-		render_video(source);
+		if (!render_cached(source))
+			render_video(source);
 		obs_source_release(source);
 	}
 }
 
+void obs_source_set_render_cache_mode(obs_source_t *source, enum obs_render_cache_mode mode)
+{
+	if (!obs_source_valid(source, "obs_source_set_render_cache_mode"))
+		return;
+
+	source->render_cache_mode = mode;
+}
+
+enum obs_render_cache_mode obs_source_get_render_cache_mode(const obs_source_t *source)
+{
+	return obs_source_valid(source, "obs_source_get_render_cache_mode") ? source->render_cache_mode
+									      : OBS_RENDER_CACHE_DISABLED;
+}
+
 static uint32_t get_recurse_width(obs_source_t *source)
 {
 	uint32_t width;
@@ -3349,7 +3783,7 @@ static void clean_cache(obs_source_t *source)
 		struct async_frame *af = &source->async_cache.array[i - 1];
 		if (!af->used) {
 			if (++af->unused_count == MAX_UNUSED_FRAME_DURATION) {
-				obs_source_frame_destroy(af->frame);
+				destroy_pooled_frame(af->frame);
 				da_erase(source->async_cache, i - 1);
 			}
 		}
@@ -3357,7 +3791,7 @@ static void clean_cache(obs_source_t *source)
 }
 
 #define MAX_ASYNC_FRAMES 30
-//if return value is not null then do (os_atomic_dec_long(&output->refs) == 0) && obs_source_frame_destroy(output)
+//if return value is not null then do (os_atomic_dec_long(&output->refs) == 0) && destroy_pooled_frame(output)
 static inline struct obs_source_frame *cache_video(struct obs_source *source, const struct obs_source_frame *frame)
 {
 	struct obs_source_frame *new_frame = NULL;
@@ -3398,7 +3832,7 @@ static inline struct obs_source_frame *cache_video(struct obs_source *source, co
 	if (!new_frame) {
 		struct async_frame new_af;
 
-		new_frame = obs_source_frame_create(format, frame->width, frame->height);
+		new_frame = create_pooled_frame(format, frame->width, frame->height);
 		new_af.frame = new_frame;
 		new_af.used = true;
 		new_af.unused_count = 0;
@@ -3438,7 +3872,7 @@ static void obs_source_output_video_internal(obs_source_t *source, const struct
 	pthread_mutex_lock(&source->async_mutex);
 	if (output) {
 		if (os_atomic_dec_long(&output->refs) == 0) {
-			obs_source_frame_destroy(output);
+			destroy_pooled_frame(output);
 			output = NULL;
 		} else {
 			da_push_back(source->async_frames, &output);
@@ -3564,8 +3998,8 @@ static void obs_source_preload_video_internal(obs_source_t *source, const struct
 		return;
 
 	if (preload_frame_changed(source, frame)) {
-		obs_source_frame_destroy(source->async_preload_frame);
-		source->async_preload_frame = obs_source_frame_create(frame->format, frame->width, frame->height);
+		destroy_pooled_frame(source->async_preload_frame);
+		source->async_preload_frame = create_pooled_frame(frame->format, frame->width, frame->height);
 	}
 
 	copy_frame_data(source->async_preload_frame, frame);
@@ -3641,11 +4075,8 @@ void obs_source_show_preloaded_video(obs_source_t *source)
 
 	obs_leave_graphics();
 
-	pthread_mutex_lock(&source->audio_buf_mutex);
 	sys_ts = (source->monitoring_type != OBS_MONITORING_TYPE_MONITOR_ONLY) ? os_gettime_ns() : 0;
-	reset_audio_timing(source, source->last_frame_ts, sys_ts);
-	reset_audio_data(source, sys_ts);
-	pthread_mutex_unlock(&source->audio_buf_mutex);
+	request_audio_timing_reset(source, true, source->last_frame_ts, sys_ts);
 }
 
 static void obs_source_set_video_frame_internal(obs_source_t *source, const struct obs_source_frame *frame)
@@ -3658,8 +4089,8 @@ static void obs_source_set_video_frame_internal(obs_source_t *source, const stru
 	obs_enter_graphics();
 
 	if (preload_frame_changed(source, frame)) {
-		obs_source_frame_destroy(source->async_preload_frame);
-		source->async_preload_frame = obs_source_frame_create(frame->format, frame->width, frame->height);
+		destroy_pooled_frame(source->async_preload_frame);
+		source->async_preload_frame = create_pooled_frame(frame->format, frame->width, frame->height);
 	}
 
 	copy_frame_data(source->async_preload_frame, frame);
@@ -3882,6 +4313,14 @@ static void process_audio(obs_source_t *source, const struct obs_source_audio *a
 		downmix_to_mono_planar(source, frames);
 }
 
+static int source_audio_memory_tag(void)
+{
+	static int tag = -1;
+	if (tag < 0)
+		tag = bmem_get_tag("source-audio");
+	return tag;
+}
+
 void obs_source_output_audio(obs_source_t *source, const struct obs_source_audio *audio_in)
 {
 	struct obs_audio_data *output;
@@ -3901,6 +4340,9 @@ void obs_source_output_audio(obs_source_t *source, const struct obs_source_audio
 	for (size_t i = channels; i < MAX_AUDIO_CHANNELS; i++)
 		audio.data[i] = NULL;
 
+	/* resampler output and the audio input buffers grow from here */
+	int prev_tag = bmem_set_thread_tag(source_audio_memory_tag());
+
 	process_audio(source, &audio);
 
 	pthread_mutex_lock(&source->filter_mutex);
@@ -3921,6 +4363,8 @@ void obs_source_output_audio(obs_source_t *source, const struct obs_source_audio
 	}
 
 	pthread_mutex_unlock(&source->filter_mutex);
+
+	bmem_set_thread_tag(prev_tag);
 }
 
 void remove_async_frame(obs_source_t *source, struct obs_source_frame *frame)
@@ -4079,12 +4523,12 @@ void obs_source_release_frame(obs_source_t *source, struct obs_source_frame *fra
 		return;
 
 	if (!source) {
-		obs_source_frame_destroy(frame);
+		destroy_pooled_frame(frame);
 	} else {
 		pthread_mutex_lock(&source->async_mutex);
 
 		if (os_atomic_dec_long(&frame->refs) == 0)
-			obs_source_frame_destroy(frame);
+			destroy_pooled_frame(frame);
 		else
 			remove_async_frame(source, frame);
 
@@ -5103,7 +5547,7 @@ static inline void apply_audio_action(obs_source_t *source, const struct audio_a
 	}
 }
 
-static void apply_audio_actions(obs_source_t *source, size_t channels, size_t sample_rate)
+static void apply_audio_actions(obs_source_t *source, uint32_t mixers, size_t channels, size_t sample_rate)
 {
 	float vol_data[AUDIO_OUTPUT_FRAMES];
 	float cur_vol = get_source_volume(source, source->audio_ts);
@@ -5142,7 +5586,7 @@ static void apply_audio_actions(obs_source_t *source, size_t channels, size_t sa
 	pthread_mutex_unlock(&source->audio_actions_mutex);
 
 	for (size_t mix = 0; mix < MAX_AUDIO_MIXES; mix++) {
-		if ((source->audio_mixers & (1 << mix)) != 0)
+		if ((source->audio_mixers & mixers & (1 << mix)) != 0)
 			multiply_vol_data(source, mix, channels, vol_data);
 	}
 }
@@ -5165,7 +5609,7 @@ static void apply_audio_volume(obs_source_t *source, uint32_t mixers, size_t cha
 		uint64_t duration = conv_frames_to_time(sample_rate, AUDIO_OUTPUT_FRAMES);
 
 		if (action.timestamp < (source->audio_ts + duration)) {
-			apply_audio_actions(source, channels, sample_rate);
+			apply_audio_actions(source, mixers, channels, sample_rate);
 			return;
 		}
 	}
@@ -5259,19 +5703,14 @@ static inline void process_audio_source_tick(obs_source_t *source, uint32_t mixe
 {
 	bool audio_submix = !!(source->info.output_flags & OBS_SOURCE_SUBMIX);
 
-	pthread_mutex_lock(&source->audio_buf_mutex);
-
 	if (source->audio_input_buf[0].size < size) {
 		source->audio_pending = true;
-		pthread_mutex_unlock(&source->audio_buf_mutex);
 		return;
 	}
 
 	for (size_t ch = 0; ch < channels; ch++)
 		deque_peek_front(&source->audio_input_buf[ch], source->audio_output_buf[0][ch], size);
 
-	pthread_mutex_unlock(&source->audio_buf_mutex);
-
 	for (size_t mix = 1; mix < MAX_AUDIO_MIXES; mix++) {
 		uint32_t mix_and_val = (1 << mix);
 
@@ -5283,7 +5722,11 @@ static inline void process_audio_source_tick(obs_source_t *source, uint32_t mixe
 			mix_and_val = 1;
 		}
 
-		if ((source->audio_mixers & mix_and_val) == 0 || (mixers & mix_and_val) == 0) {
+		/* nothing reads mixes without outputs, so skip them entirely */
+		if ((mixers & mix_and_val) == 0)
+			continue;
+
+		if ((source->audio_mixers & mix_and_val) == 0) {
 			memset(source->audio_output_buf[mix][0], 0, size * channels);
 			continue;
 		}
@@ -5297,7 +5740,7 @@ static inline void process_audio_source_tick(obs_source_t *source, uint32_t mixe
 		return;
 	}
 
-	if ((source->audio_mixers & 1) == 0 || (mixers & 1) == 0)
+	if ((source->audio_mixers & 1) == 0 && (mixers & 1) != 0)
 		memset(source->audio_output_buf[0][0], 0, size * channels);
 
 	apply_audio_volume(source, mixers, channels, sample_rate);
@@ -5322,6 +5765,11 @@ void obs_source_audio_render(obs_source_t *source, uint32_t mixers, size_t chann
 
 	if (source->info.audio_mix) {
 		audio_submix(source, channels, sample_rate);
+
+		/* the submix was output through the input queue after it was
+		 * drained for this tick, take it in now instead of a tick
+		 * later */
+		obs_source_process_audio_input(source);
 	}
 
 	if (!source->audio_ts) {
@@ -5472,12 +5920,8 @@ void obs_source_set_async_decoupled(obs_source_t *source, bool decouple)
 		return;
 
 	source->async_decoupled = decouple;
-	if (decouple) {
-		pthread_mutex_lock(&source->audio_buf_mutex);
-		source->timing_set = false;
-		reset_audio_data(source, 0);
-		pthread_mutex_unlock(&source->audio_buf_mutex);
-	}
+	if (decouple)
+		request_audio_timing_reset(source, false, 0, 0);
 }
 
 bool obs_source_async_decoupled(const obs_source_t *source)
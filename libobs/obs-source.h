@@ -203,6 +203,13 @@ enum obs_media_state {
  */
 #define OBS_SOURCE_CAP_DONT_SHOW_PROPERTIES (1 << 16)
 
+/**
+ * Source type can be created (including its create and update callbacks)
+ * from any thread, concurrently with other sources.  Allows
+ * obs_load_sources to create it on a worker thread.
+ */
+#define OBS_SOURCE_THREADSAFE_CREATE (1 << 17)
+
 /** @} */
 
 typedef void (*obs_source_enum_proc_t)(obs_source_t *parent, obs_source_t *child, void *param);
@@ -214,7 +214,8 @@ static inline void render_main_texture(struct obs_core_video_mix *video)
 	profile_end(render_main_texture_name);
 }
 
-static inline gs_effect_t *get_scale_effect_internal(struct obs_core_video_mix *mix)
+static inline gs_effect_t *get_scale_effect_internal(struct obs_core_video_mix *mix, uint32_t src_width,
+						       uint32_t src_height)
 {
 	struct obs_core_video *video = &obs->video;
 	const struct video_output_info *info = video_output_get_info(mix->video);
@@ -222,7 +223,7 @@ static inline gs_effect_t *get_scale_effect_internal(struct obs_core_video_mix *
 	/* if the dimension is under half the size of the original image,
 	 * bicubic/lanczos can't sample enough pixels to create an accurate
 	 * image, so use the bilinear low resolution effect instead */
-	if (info->width < (mix->ovi.base_width / 2) && info->height < (mix->ovi.base_height / 2)) {
+	if (info->width < (src_width / 2) && info->height < (src_height / 2)) {
 		return video->bilinear_lowres_effect;
 	}
 
@@ -240,30 +241,67 @@ static inline gs_effect_t *get_scale_effect_internal(struct obs_core_video_mix *
 	return video->bicubic_effect;
 }
 
-static inline bool resolution_close(struct obs_core_video_mix *mix, uint32_t width, uint32_t height)
+static inline bool resolution_close(uint32_t src_width, uint32_t src_height, uint32_t width, uint32_t height)
 {
-	long width_cmp = (long)mix->ovi.base_width - (long)width;
-	long height_cmp = (long)mix->ovi.base_height - (long)height;
+	long width_cmp = (long)src_width - (long)width;
+	long height_cmp = (long)src_height - (long)height;
 
 	return labs(width_cmp) <= 16 && labs(height_cmp) <= 16;
 }
 
-static inline gs_effect_t *get_scale_effect(struct obs_core_video_mix *mix, uint32_t width, uint32_t height)
+static inline gs_effect_t *get_scale_effect(struct obs_core_video_mix *mix, uint32_t src_width, uint32_t src_height,
+					    uint32_t width, uint32_t height)
 {
 	struct obs_core_video *video = &obs->video;
 
-	if (resolution_close(mix, width, height)) {
+	if (resolution_close(src_width, src_height, width, height)) {
 		return video->default_effect;
 	} else {
 		/* if the scale method couldn't be loaded, use either bicubic
 		 * or bilinear by default */
-		gs_effect_t *effect = get_scale_effect_internal(mix);
+		gs_effect_t *effect = get_scale_effect_internal(mix, src_width, src_height);
 		if (!effect)
 			effect = !!video->bicubic_effect ? video->bicubic_effect : video->default_effect;
 		return effect;
 	}
 }
 
+/* Encoder mixes of a rendition ladder (e.g. 1080p -> 720p -> 480p -> 360p)
+ * are scaled from the smallest larger output that has already been scaled
+ * this frame instead of from the full canvas each.  Encoder mixes are kept
+ * sorted from the largest to the smallest output to make this possible. */
+static inline struct obs_core_video_mix *get_cascade_source(const struct obs_core_video_mix *mix, uint32_t width,
+							    uint32_t height)
+{
+	struct obs_core_video_mix *best = NULL;
+	uint64_t best_area = 0;
+
+	for (size_t i = 0, num = obs->video.mixes.num; i < num; i++) {
+		struct obs_core_video_mix *other = obs->video.mixes.array[i];
+		if (other == mix || other->view != mix->view)
+			continue;
+		if (other->render_space != mix->render_space || other->ovi.scale_type != mix->ovi.scale_type)
+			continue;
+		if (other->ovi.base_width != mix->ovi.base_width || other->ovi.base_height != mix->ovi.base_height)
+			continue;
+		if (other->output_scaled_time != obs->video.video_time)
+			continue;
+
+		const uint32_t other_width = gs_texture_get_width(other->output_texture);
+		const uint32_t other_height = gs_texture_get_height(other->output_texture);
+		const uint64_t area = (uint64_t)other_width * (uint64_t)other_height;
+		if (other_width < width || other_height < height)
+			continue;
+
+		if (!best || area < best_area) {
+			best = other;
+			best_area = area;
+		}
+	}
+
+	return best;
+}
+
 static const char *render_output_texture_name = "render_output_texture";
 static inline gs_texture_t *render_output_texture(struct obs_core_video_mix *mix)
 {
@@ -277,7 +315,17 @@ static inline gs_texture_t *render_output_texture(struct obs_core_video_mix *mix
 
 	profile_start(render_output_texture_name);
 
-	gs_effect_t *effect = get_scale_effect(mix, width, height);
+	uint32_t src_width = ovi->base_width;
+	uint32_t src_height = ovi->base_height;
+
+	struct obs_core_video_mix *source = mix->encoder_only_mix ? get_cascade_source(mix, width, height) : NULL;
+	if (source) {
+		texture = source->output_texture;
+		src_width = gs_texture_get_width(texture);
+		src_height = gs_texture_get_height(texture);
+	}
+
+	gs_effect_t *effect = get_scale_effect(mix, src_width, src_height, width, height);
 	gs_technique_t *tech = gs_effect_get_technique(effect, "Draw");
 
 	gs_eparam_t *image = gs_effect_get_param_by_name(effect, "image");
@@ -290,13 +338,13 @@ static inline gs_texture_t *render_output_texture(struct obs_core_video_mix *mix
 
 	if (bres) {
 		struct vec2 base;
-		vec2_set(&base, (float)mix->ovi.base_width, (float)mix->ovi.base_height);
+		vec2_set(&base, (float)src_width, (float)src_height);
 		gs_effect_set_vec2(bres, &base);
 	}
 
 	if (bres_i) {
 		struct vec2 base_i;
-		vec2_set(&base_i, 1.0f / (float)mix->ovi.base_width, 1.0f / (float)mix->ovi.base_height);
+		vec2_set(&base_i, 1.0f / (float)src_width, 1.0f / (float)src_height);
 		gs_effect_set_vec2(bres_i, &base_i);
 	}
 
@@ -314,6 +362,8 @@ static inline gs_texture_t *render_output_texture(struct obs_core_video_mix *mix
 	gs_enable_blending(true);
 	gs_enable_framebuffer_srgb(false);
 
+	mix->output_scaled_time = obs->video.video_time;
+
 	profile_end(render_output_texture_name);
 
 	return target;
@@ -420,6 +470,7 @@ static inline void stage_output_texture(struct obs_core_video_mix *video, int cu
 			video->active_copy_surfaces[cur_texture][i] = NULL;
 
 		video->textures_copied[cur_texture] = true;
+		video->staged_times[cur_texture] = os_gettime_ns();
 	} else if (video->texture_converted) {
 		for (size_t i = 0; i < channel_count; i++) {
 			gs_stagesurf_t *copy = copy_surfaces[i];
@@ -432,6 +483,7 @@ static inline void stage_output_texture(struct obs_core_video_mix *video, int cu
 			video->active_copy_surfaces[cur_texture][i] = NULL;
 
 		video->textures_copied[cur_texture] = true;
+		video->staged_times[cur_texture] = os_gettime_ns();
 	}
 
 	profile_end(stage_output_texture_name);
@@ -492,6 +544,7 @@ static inline bool queue_frame(struct obs_core_video_mix *video, bool raw_active
 
 	tf.count = 1;
 	tf.timestamp = vframe_info->timestamp;
+	tf.rendered = video->rendered_times[video->cur_texture];
 	tf.released = true;
 #ifdef _WIN32
 	tf.handle = gs_texture_get_shared_handle(tf.tex);
@@ -563,6 +616,8 @@ static inline void render_video(struct obs_core_video_mix *video, bool raw_activ
 			render_convert_texture(video, convert_textures, output_texture);
 		}
 
+		video->rendered_times[cur_texture] = os_gettime_ns();
+
 		if (gpu_active) {
 			gs_flush();
 			output_gpu_encoders(video, raw_active);
@@ -580,21 +635,74 @@ static inline void render_video(struct obs_core_video_mix *video, bool raw_activ
 	gs_end_scene();
 }
 
+static inline bool download_frame_ready(struct obs_core_video_mix *video, int prev_texture)
+{
+	for (int channel = 0; channel < NUM_CHANNELS; ++channel) {
+		gs_stagesurf_t *surface = video->active_copy_surfaces[prev_texture][channel];
+		if (surface && !gs_stagesurface_ready(surface))
+			return false;
+	}
+	return true;
+}
+
+/* called with the mixes mutex held */
+static inline void add_readback_stats(struct obs_core_video_mix *video, int prev_texture, uint64_t stall_start,
+				      uint64_t mapped)
+{
+	struct obs_video_readback_stats *stats = &obs->video.readback_stats;
+	uint64_t latency = mapped - video->staged_times[prev_texture];
+
+	if (stall_start) {
+		stats->stalls++;
+		stats->stall_time_ns += mapped - stall_start;
+	}
+
+	stats->frames++;
+	stats->latency_last_ns = latency;
+	if (latency > stats->latency_max_ns)
+		stats->latency_max_ns = latency;
+
+	obs->video.readback_latency_total_ns += latency;
+	stats->latency_avg_ns = obs->video.readback_latency_total_ns / stats->frames;
+}
+
+static const char *download_frame_stall_name = "download_frame_stall";
 static inline bool download_frame(struct obs_core_video_mix *video, int prev_texture, struct video_data *frame)
 {
+	uint64_t stall_start = 0;
+	bool success = true;
+	bool stalled;
+
 	if (!video->textures_copied[prev_texture])
 		return false;
 
+	/* the oldest frame in the readback ring has to be downloaded now since
+	 * it gets overwritten next frame, so time how long we block on it */
+	stalled = !download_frame_ready(video, prev_texture);
+	if (stalled) {
+		profile_start(download_frame_stall_name);
+		stall_start = os_gettime_ns();
+	}
+
 	for (int channel = 0; channel < NUM_CHANNELS; ++channel) {
 		gs_stagesurf_t *surface = video->active_copy_surfaces[prev_texture][channel];
 		if (surface) {
-			if (!gs_stagesurface_map(surface, &frame->data[channel], &frame->linesize[channel]))
-				return false;
+			if (!gs_stagesurface_map(surface, &frame->data[channel], &frame->linesize[channel])) {
+				success = false;
+				break;
+			}
 
 			video->mapped_surfaces[channel] = surface;
 		}
 	}
-	return true;
+
+	if (stalled)
+		profile_end(download_frame_stall_name);
+
+	if (success)
+		add_readback_stats(video, prev_texture, stall_start, os_gettime_ns());
+
+	return success;
 }
 
 static const uint8_t *set_gpu_converted_plane(uint32_t width, uint32_t height, uint32_t linesize_input,
@@ -774,6 +882,41 @@ static inline void copy_rgbx_frame(struct video_frame *output, const struct vide
 	}
 }
 
+static void add_frame_trace(struct obs_core_video_mix *video, uint64_t timestamp, uint64_t rendered,
+			    uint64_t downloaded)
+{
+	pthread_mutex_lock(&video->frame_trace_mutex);
+	struct obs_frame_trace *trace = &video->frame_traces[video->frame_trace_idx];
+	trace->timestamp = timestamp;
+	trace->rendered = rendered;
+	trace->downloaded = downloaded;
+	video->frame_trace_idx = (video->frame_trace_idx + 1) % FRAME_TRACE_HISTORY;
+	pthread_mutex_unlock(&video->frame_trace_mutex);
+}
+
+bool obs_get_frame_trace(video_t *video, uint64_t timestamp, struct obs_frame_trace *trace)
+{
+	struct obs_core_video_mix *mix = get_mix_for_video(video);
+	bool found = false;
+
+	if (!mix)
+		return false;
+
+	pthread_mutex_lock(&mix->frame_trace_mutex);
+	for (size_t i = 0; i < FRAME_TRACE_HISTORY; i++) {
+		const struct obs_frame_trace *cur = &mix->frame_traces[i];
+
+		if (cur->timestamp && cur->timestamp == timestamp) {
+			*trace = *cur;
+			found = true;
+			break;
+		}
+	}
+	pthread_mutex_unlock(&mix->frame_trace_mutex);
+
+	return found;
+}
+
 static inline void output_video_data(struct obs_core_video_mix *video, struct video_data *input_frame, int count)
 {
 	const struct video_output_info *info;
@@ -871,9 +1014,10 @@ static inline void output_frame(struct obs_core_video_mix *video)
 	const bool gpu_active = video->gpu_was_active;
 
 	int cur_texture = video->cur_texture;
-	int prev_texture = cur_texture == 0 ? NUM_TEXTURES - 1 : cur_texture - 1;
+	int prev_texture = (cur_texture + 1) % video->num_textures;
 	struct video_data frame;
 	bool frame_ready = 0;
+	uint64_t downloaded = 0;
 
 	memset(&frame, 0, sizeof(struct video_data));
 
@@ -889,6 +1033,7 @@ static inline void output_frame(struct obs_core_video_mix *video)
 	if (raw_active) {
 		profile_start(output_frame_download_frame_name);
 		frame_ready = download_frame(video, prev_texture, &frame);
+		downloaded = os_gettime_ns();
 		profile_end(output_frame_download_frame_name);
 	}
 
@@ -904,12 +1049,14 @@ static inline void output_frame(struct obs_core_video_mix *video)
 		deque_pop_front(&video->vframe_info_buffer, &vframe_info, sizeof(vframe_info));
 
 		frame.timestamp = vframe_info.timestamp;
+		add_frame_trace(video, frame.timestamp, video->rendered_times[prev_texture], downloaded);
+
 		profile_start(output_frame_output_video_data_name);
 		output_video_data(video, &frame, vframe_info.count);
 		profile_end(output_frame_output_video_data_name);
 	}
 
-	if (++video->cur_texture == NUM_TEXTURES)
+	if (++video->cur_texture == video->num_textures)
 		video->cur_texture = 0;
 }
 
@@ -1094,6 +1241,9 @@ static inline bool stop_requested(void)
 	return success;
 }
 
+/* how often memory usage is logged when allocation tracking is enabled */
+#define MEMORY_LOG_INTERVAL_NS 60000000000ULL
+
 bool obs_graphics_thread_loop(struct obs_graphics_context *context)
 {
 	uint64_t frame_start = os_gettime_ns();
@@ -1155,6 +1305,11 @@ bool obs_graphics_thread_loop(struct obs_graphics_context *context)
 		context->fps_total_frames = 0;
 	}
 
+	if (bmem_tracking_enabled() && frame_start - context->memory_log_time >= MEMORY_LOG_INTERVAL_NS) {
+		bmem_log_tag_stats();
+		context->memory_log_time = frame_start;
+	}
+
 	return !stop_requested();
 }
 
@@ -1184,6 +1339,7 @@ void *obs_graphics_thread(void *param)
 	context.frame_time_total_ns = 0;
 	context.fps_total_ns = 0;
 	context.fps_total_frames = 0;
+	context.memory_log_time = os_gettime_ns();
 	context.last_time = 0;
 	context.video_thread_name = video_thread_name;
 
@@ -19,6 +19,7 @@
 
 #include "graphics/matrix4.h"
 #include "callback/calldata.h"
+#include "media-io/video-frame.h"
 
 #include "obs.h"
 #include "obs-internal.h"
@@ -370,7 +371,7 @@ static bool obs_init_textures(struct obs_core_video_mix *video)
 		break;
 	}
 
-	for (size_t i = 0; i < NUM_TEXTURES; i++) {
+	for (int i = 0; i < video->num_textures; i++) {
 #ifdef _WIN32
 		if (video->using_nv12_tex) {
 			video->copy_surfaces_encode[i] = gs_stagesurface_create_nv12(info->width, info->height);
@@ -504,6 +505,9 @@ static int obs_init_graphics(struct obs_video_info *ovi)
 	profile_start(shader_comp_name);
 	gs_enter_context(video->graphics);
 
+	if (obs->shader_cache_path)
+		gs_set_shader_cache_path(obs->shader_cache_path);
+
 	char *filename = obs_find_data_file("default.effect");
 	video->default_effect = gs_effect_create_from_file(filename, NULL);
 	bfree(filename);
@@ -607,6 +611,7 @@ static int obs_init_video_mix(struct obs_video_info *ovi, struct obs_core_video_
 	struct video_output_info vi;
 
 	pthread_mutex_init_value(&video->gpu_encoder_mutex);
+	pthread_mutex_init_value(&video->frame_trace_mutex);
 
 	make_video_info(&vi, ovi);
 	video->ovi = *ovi;
@@ -623,6 +628,7 @@ static int obs_init_video_mix(struct obs_video_info *ovi, struct obs_core_video_
 	pthread_mutex_unlock(&obs->video.mixes_mutex);
 
 	video->gpu_conversion = ovi->gpu_conversion;
+	video->num_textures = obs->video.readback_depth ? (int)obs->video.readback_depth : DEFAULT_NUM_TEXTURES;
 	video->gpu_was_active = false;
 	video->raw_was_active = false;
 	video->was_active = false;
@@ -642,6 +648,8 @@ static int obs_init_video_mix(struct obs_video_info *ovi, struct obs_core_video_
 
 	if (pthread_mutex_init(&video->gpu_encoder_mutex, NULL) < 0)
 		return OBS_VIDEO_FAIL;
+	if (pthread_mutex_init(&video->frame_trace_mutex, NULL) < 0)
+		return OBS_VIDEO_FAIL;
 
 	gs_enter_context(obs->video.graphics);
 
@@ -784,6 +792,9 @@ void obs_free_video_mix(struct obs_core_video_mix *video)
 		pthread_mutex_init_value(&video->gpu_encoder_mutex);
 		da_free(video->gpu_encoders);
 
+		pthread_mutex_destroy(&video->frame_trace_mutex);
+		pthread_mutex_init_value(&video->frame_trace_mutex);
+
 		video->gpu_encoder_active = 0;
 		video->cur_texture = 0;
 	}
@@ -899,6 +910,7 @@ static void obs_free_audio(void)
 	if (audio->audio)
 		audio_output_close(audio->audio);
 
+	obs_volmeter_service_free();
 	deque_free(&audio->buffered_timestamps);
 	da_free(audio->render_order);
 	da_free(audio->root_nodes);
@@ -1360,6 +1372,7 @@ void obs_shutdown(void)
 	obs_free_audio();
 	obs_free_video();
 	os_task_queue_destroy(obs->destruction_task_thread);
+	video_frame_pool_trim(true);
 	obs_free_hotkeys();
 	obs_free_graphics();
 	proc_handler_destroy(obs->procs);
@@ -1379,6 +1392,7 @@ void obs_shutdown(void)
 		profiler_name_store_free(obs->name_store);
 
 	bfree(obs->module_config_path);
+	bfree(obs->shader_cache_path);
 	bfree(obs->locale);
 	bfree(obs);
 	obs = NULL;
@@ -1427,6 +1441,28 @@ const char *obs_get_locale(void)
 	return obs->locale;
 }
 
+void obs_set_video_readback_depth(uint32_t depth)
+{
+	if (!obs)
+		return;
+
+	if (depth && depth < DEFAULT_NUM_TEXTURES)
+		depth = DEFAULT_NUM_TEXTURES;
+	else if (depth > NUM_TEXTURES)
+		depth = NUM_TEXTURES;
+
+	obs->video.readback_depth = depth;
+}
+
+void obs_set_shader_cache_path(const char *path)
+{
+	if (!obs)
+		return;
+
+	bfree(obs->shader_cache_path);
+	obs->shader_cache_path = (path && *path) ? bstrdup(path) : NULL;
+}
+
 #define OBS_SIZE_MIN 2
 #define OBS_SIZE_MAX (32 * 1024)
 
@@ -2252,30 +2288,192 @@ obs_source_t *obs_load_private_source(obs_data_t *source_data)
 	return obs_load_source_type(source_data, true);
 }
 
+struct source_load_job {
+	obs_data_t *data;
+	obs_source_t *source;
+	const char *id;
+	uint64_t time_ns;
+	bool threaded;
+};
+
+struct source_loader {
+	struct source_load_job *jobs;
+	size_t count;
+	volatile long next;
+};
+
+struct source_load_time {
+	const char *id;
+	size_t count;
+	uint64_t time_ns;
+};
+
+#define MAX_SOURCE_LOAD_THREADS 8
+
+static inline bool source_type_threadsafe(const char *id)
+{
+	const struct obs_source_info *info = get_source_info(id);
+	return info && (info->output_flags & OBS_SOURCE_THREADSAFE_CREATE) != 0;
+}
+
+static inline const char *get_source_data_id(obs_data_t *source_data)
+{
+	const char *v_id = obs_data_get_string(source_data, "versioned_id");
+	return *v_id ? v_id : obs_data_get_string(source_data, "id");
+}
+
+/* a source can only be created off the calling thread if its type and the
+ * types of all of its filters say it's safe to */
+static bool can_load_source_threaded(obs_data_t *source_data)
+{
+	obs_data_array_t *filters;
+	bool threadsafe;
+
+	if (!source_type_threadsafe(get_source_data_id(source_data)))
+		return false;
+
+	filters = obs_data_get_array(source_data, "filters");
+	threadsafe = true;
+
+	for (size_t i = 0, count = obs_data_array_count(filters); threadsafe && i < count; i++) {
+		obs_data_t *filter_data = obs_data_array_item(filters, i);
+		threadsafe = source_type_threadsafe(get_source_data_id(filter_data));
+		obs_data_release(filter_data);
+	}
+
+	obs_data_array_release(filters);
+	return threadsafe;
+}
+
+static inline void run_source_load_job(struct source_load_job *job)
+{
+	uint64_t start = os_gettime_ns();
+	job->source = obs_load_source(job->data);
+	job->time_ns = os_gettime_ns() - start;
+}
+
+static void *source_load_thread(void *param)
+{
+	struct source_loader *loader = param;
+
+	os_set_thread_name("libobs: source loader");
+
+	for (;;) {
+		size_t idx = (size_t)os_atomic_inc_long(&loader->next) - 1;
+		if (idx >= loader->count)
+			break;
+
+		if (loader->jobs[idx].threaded)
+			run_source_load_job(&loader->jobs[idx]);
+	}
+
+	return NULL;
+}
+
+static void log_source_load_times(struct source_load_job *jobs, size_t count, size_t threaded, uint64_t total_ns)
+{
+	DARRAY(struct source_load_time) times;
+
+	if (!count)
+		return;
+
+	da_init(times);
+
+	for (size_t i = 0; i < count; i++) {
+		struct source_load_time *time = NULL;
+
+		for (size_t j = 0; j < times.num; j++) {
+			if (strcmp(times.array[j].id, jobs[i].id) == 0) {
+				time = times.array + j;
+				break;
+			}
+		}
+
+		if (!time) {
+			time = da_push_back_new(times);
+			time->id = jobs[i].id;
+		}
+
+		time->count++;
+		time->time_ns += jobs[i].time_ns;
+	}
+
+	blog(LOG_INFO, "Created %zu sources (%zu on worker threads) in %.1f ms", count, threaded,
+	     (double)total_ns / 1000000.0);
+
+	for (size_t i = 0; i < times.num; i++) {
+		struct source_load_time *time = times.array + i;
+		blog(LOG_INFO, "    %s: %zu source%s, %.1f ms", time->id, time->count, time->count == 1 ? "" : "s",
+		     (double)time->time_ns / 1000000.0);
+	}
+
+	da_free(times);
+}
+
+static void create_sources(struct source_load_job *jobs, size_t count)
+{
+	struct source_loader loader = {.jobs = jobs, .count = count};
+	pthread_t threads[MAX_SOURCE_LOAD_THREADS];
+	size_t num_threads = 0;
+	size_t threaded = 0;
+	uint64_t start = os_gettime_ns();
+
+	for (size_t i = 0; i < count; i++) {
+		jobs[i].id = get_source_data_id(jobs[i].data);
+		jobs[i].threaded = can_load_source_threaded(jobs[i].data);
+		if (jobs[i].threaded)
+			threaded++;
+	}
+
+	if (threaded > 1) {
+		int cores = os_get_logical_cores();
+		size_t max_threads = cores > 1 ? (size_t)cores : 1;
+
+		if (max_threads > MAX_SOURCE_LOAD_THREADS)
+			max_threads = MAX_SOURCE_LOAD_THREADS;
+		if (max_threads > threaded)
+			max_threads = threaded;
+
+		for (; num_threads < max_threads; num_threads++) {
+			if (pthread_create(&threads[num_threads], NULL, source_load_thread, &loader) != 0)
+				break;
+		}
+	}
+
+	/* everything else is created here, in order, while the workers run */
+	for (size_t i = 0; i < count; i++) {
+		if (!jobs[i].threaded || !num_threads)
+			run_source_load_job(&jobs[i]);
+	}
+
+	for (size_t i = 0; i < num_threads; i++)
+		pthread_join(threads[i], NULL);
+
+	log_source_load_times(jobs, count, num_threads ? threaded : 0, os_gettime_ns() - start);
+}
+
 void obs_load_sources(obs_data_array_t *array, obs_load_source_cb cb, void *private_data)
 {
-	DARRAY(obs_source_t *) sources;
+	DARRAY(struct source_load_job) jobs;
 	size_t count;
 	size_t i;
 
-	da_init(sources);
+	da_init(jobs);
 
 	count = obs_data_array_count(array);
-	da_reserve(sources, count);
+	da_resize(jobs, count);
 
 	for (i = 0; i < count; i++) {
-		obs_data_t *source_data = obs_data_array_item(array, i);
-		obs_source_t *source = obs_load_source(source_data);
-
-		da_push_back(sources, &source);
-
-		obs_data_release(source_data);
+		jobs.array[i].data = obs_data_array_item(array, i);
+		jobs.array[i].source = NULL;
 	}
 
+	create_sources(jobs.array, jobs.num);
+
 	/* tell sources that we want to load */
-	for (i = 0; i < sources.num; i++) {
-		obs_source_t *source = sources.array[i];
-		obs_data_t *source_data = obs_data_array_item(array, i);
+	for (i = 0; i < jobs.num; i++) {
+		obs_source_t *source = jobs.array[i].source;
+		obs_data_t *source_data = jobs.array[i].data;
 		if (source) {
 			if (source->info.type == OBS_SOURCE_TYPE_TRANSITION)
 				obs_transition_load(source, source_data);
@@ -2283,13 +2481,14 @@ void obs_load_sources(obs_data_array_t *array, obs_load_source_cb cb, void *priv
 			if (cb)
 				cb(private_data, source);
 		}
-		obs_data_release(source_data);
 	}
 
-	for (i = 0; i < sources.num; i++)
-		obs_source_release(sources.array[i]);
+	for (i = 0; i < jobs.num; i++) {
+		obs_source_release(jobs.array[i].source);
+		obs_data_release(jobs.array[i].data);
+	}
 
-	da_free(sources);
+	da_free(jobs);
 }
 
 obs_data_t *obs_save_source(obs_source_t *source)
@@ -2919,6 +3118,16 @@ uint32_t obs_get_lagged_frames(void)
 	return obs->video.lagged_frames;
 }
 
+void obs_get_video_readback_stats(struct obs_video_readback_stats *stats)
+{
+	if (!obs || !stats)
+		return;
+
+	pthread_mutex_lock(&obs->video.mixes_mutex);
+	*stats = obs->video.readback_stats;
+	pthread_mutex_unlock(&obs->video.mixes_mutex);
+}
+
 struct obs_core_video_mix *get_mix_for_video(video_t *v)
 {
 	struct obs_core_video_mix *result = NULL;
@@ -386,6 +386,22 @@ EXPORT void obs_set_locale(const char *locale);
 /** @return the current locale */
 EXPORT const char *obs_get_locale(void);
 
+/**
+ * Sets the directory used to cache compiled shaders between sessions.  Takes
+ * effect the next time the graphics subsystem is initialized, so it should be
+ * called before obs_reset_video.  NULL disables the cache.
+ */
+EXPORT void obs_set_shader_cache_path(const char *path);
+
+/**
+ * Sets how many frames of raw video may be in flight between the GPU and
+ * raw outputs/encoders (2-4, 0 for the default of 2).  Deeper rings add a
+ * frame of latency per step but give slow readbacks more time to complete
+ * before the graphics thread has to wait on them.  Takes effect on the next
+ * obs_reset_video.
+ */
+EXPORT void obs_set_video_readback_depth(uint32_t depth);
+
 /** Initialize the Windows-specific crash handler */
 
 #ifdef _WIN32
@@ -837,6 +853,18 @@ EXPORT uint64_t obs_get_frame_interval_ns(void);
 EXPORT uint32_t obs_get_total_frames(void);
 EXPORT uint32_t obs_get_lagged_frames(void);
 
+/** Raw video readback statistics, accumulated over all video mixes */
+struct obs_video_readback_stats {
+	uint64_t frames;          /**< frames read back from the GPU */
+	uint64_t stalls;          /**< frames that were not ready when mapped */
+	uint64_t stall_time_ns;   /**< total time spent waiting on them */
+	uint64_t latency_last_ns; /**< submit to map time of the last frame */
+	uint64_t latency_avg_ns;
+	uint64_t latency_max_ns;
+};
+
+EXPORT void obs_get_video_readback_stats(struct obs_video_readback_stats *stats);
+
 OBS_DEPRECATED EXPORT bool obs_nv12_tex_active(void);
 OBS_DEPRECATED EXPORT bool obs_p010_tex_active(void);
 
@@ -1036,6 +1064,22 @@ EXPORT void obs_source_reset_settings(obs_source_t *source, obs_data_t *settings
 /** Renders a video source. */
 EXPORT void obs_source_video_render(obs_source_t *source);
 
+enum obs_render_cache_mode {
+	OBS_RENDER_CACHE_DISABLED,
+	OBS_RENDER_CACHE_AUTO,
+	OBS_RENDER_CACHE_ENABLED,
+};
+
+/**
+ * Sets whether the output of a source that is rendered more than once per
+ * frame is rendered to a texture the first time and drawn from that texture
+ * afterwards.  The automatic mode only caches composite sources.  The cache
+ * is disabled unless it is enabled for a source with this function, scenes
+ * are created with the automatic mode.
+ */
+EXPORT void obs_source_set_render_cache_mode(obs_source_t *source, enum obs_render_cache_mode mode);
+EXPORT enum obs_render_cache_mode obs_source_get_render_cache_mode(const obs_source_t *source);
+
 /** Gets the width of a source (if it has video) */
 EXPORT uint32_t obs_source_get_width(obs_source_t *source);
 
@@ -2074,6 +2118,20 @@ EXPORT void obs_output_remove_packet_callback(obs_output_t *output,
 								struct encoder_packet_time *pkt_time, void *param),
 					      void *param);
 
+/* Gets the latency percentiles of a video pipeline stage over the most
+ * recently interleaved frames of an encoded output.  Returns false if no
+ * frames have been traced for the stage. */
+EXPORT bool obs_output_get_frame_stage_stats(const obs_output_t *output, enum obs_frame_stage stage,
+					     struct obs_frame_stage_stats *stats);
+
+/* Logs the stage timestamps of every traced frame of an encoded output as
+ * CSV to the given file.  Set path to NULL to stop logging. */
+EXPORT bool obs_output_set_frame_trace_log(obs_output_t *output, const char *path);
+
+/* Called by outputs right after a packet has been sent over the network, to
+ * trace the send stage of video frames. */
+EXPORT void obs_output_packet_sent(obs_output_t *output, const struct encoder_packet *packet);
+
 /* Sets a callback to be called when the output checks if it should attempt to reconnect.
  * If the callback returns false, the output will not attempt to reconnect. */
 EXPORT void obs_output_set_reconnect_callback(obs_output_t *output,
@@ -2203,6 +2261,16 @@ EXPORT void obs_encoder_set_gpu_scale_type(obs_encoder_t *encoder, enum obs_scal
  */
 EXPORT bool obs_encoder_set_frame_rate_divisor(obs_encoder_t *encoder, uint32_t divisor);
 
+/**
+ * Sets up an asynchronous queue for a raw (non-texture) video encoder.
+ * Frames are copied into a queue of up to size frames and encoded on a thread
+ * owned by the encoder, so a slow encoder no longer stalls the other outputs
+ * of its video output.  Set size to 0 to encode synchronously (default).
+ *
+ * Can only be called on stopped encoders, changing this on the fly is not supported
+ */
+EXPORT bool obs_encoder_set_video_queue(obs_encoder_t *encoder, size_t size, enum obs_encoder_queue_mode mode);
+
 /**
  * Adds region of interest (ROI) for an encoder. This allows prioritizing
  * quality of regions of the frame.
@@ -98,14 +98,228 @@ static void a_free(void *ptr)
 
 static long num_allocs = 0;
 
-void *bmalloc(size_t size)
+/* ------------------------------------------------------------------------- */
+/* Tagged allocation tracking
+ *
+ * When enabled, every allocation is preceded by a header holding its size
+ * and tag.  Counters are kept per thread so that allocating never writes to
+ * memory shared with other threads, and are only summed up when statistics
+ * are read.  The call counters are always kept, only the header and the
+ * tag counters depend on tracking being enabled.  Each counter is only written by its own thread, so it is
+ * updated with a relaxed atomic load and store instead of a read-modify-write,
+ * which lets other threads read it without tearing.  Whether tracking is
+ * enabled has to be decided before the first allocation, because the header
+ * changes the layout of every block. */
+
+#define TRACKING_ENV "OBS_MEMORY_TRACKING"
+
+#define TRACKING_UNKNOWN 0
+#define TRACKING_OFF 1
+#define TRACKING_ON 2
+
+struct alloc_header {
+	size_t size;
+	int tag;
+};
+
+#define HEADER_SIZE ALIGNMENT
+
+#ifdef _MSC_VER
+/* aligned 64-bit volatile accesses are atomic on the 64-bit targets MSVC
+ * builds libobs for */
+#define counter_load(ptr) (*(ptr))
+#define counter_store(ptr, val) (*(ptr) = (val))
+#else
+#define counter_load(ptr) __atomic_load_n(ptr, __ATOMIC_RELAXED)
+#define counter_store(ptr, val) __atomic_store_n(ptr, val, __ATOMIC_RELAXED)
+#endif
+
+struct tag_counters {
+	volatile long long live_bytes;
+	volatile long long allocs;
+	volatile long long alloc_bytes;
+};
+
+struct call_counters {
+	volatile long long allocs;
+	volatile long long reallocs;
+	volatile long long frees;
+};
+
+struct thread_counters {
+	struct tag_counters tags[BMEM_MAX_TAGS];
+	struct call_counters calls;
+	struct thread_counters *prev;
+	struct thread_counters *next;
+};
+
+static volatile long tracking_state = TRACKING_UNKNOWN;
+static pthread_once_t tracking_once = PTHREAD_ONCE_INIT;
+static pthread_key_t counters_key;
+static pthread_mutex_t tracking_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+/* everything below is protected by tracking_mutex */
+static struct thread_counters *thread_list = NULL;
+static struct tag_counters exited_threads[BMEM_MAX_TAGS];
+static struct call_counters exited_calls;
+static const char *tag_names[BMEM_MAX_TAGS] = {"untagged"};
+static long long tag_peaks[BMEM_MAX_TAGS];
+static volatile long num_tags = 1;
+
+static THREAD_LOCAL struct thread_counters *cur_counters = NULL;
+static THREAD_LOCAL int cur_tag = BMEM_TAG_NONE;
+
+/* only called by the thread that owns the counter */
+static inline void counter_add(volatile long long *counter, long long val)
+{
+	counter_store(counter, counter_load(counter) + val);
+}
+
+/* dst is only accessed with tracking_mutex held */
+static void add_counters(struct tag_counters *dst, const struct tag_counters *src)
+{
+	for (size_t i = 0; i < BMEM_MAX_TAGS; i++) {
+		dst[i].live_bytes += counter_load(&src[i].live_bytes);
+		dst[i].allocs += counter_load(&src[i].allocs);
+		dst[i].alloc_bytes += counter_load(&src[i].alloc_bytes);
+	}
+}
+
+static void add_calls(struct call_counters *dst, const struct call_counters *src)
+{
+	dst->allocs += counter_load(&src->allocs);
+	dst->reallocs += counter_load(&src->reallocs);
+	dst->frees += counter_load(&src->frees);
+}
+
+static void thread_counters_destroy(void *data)
+{
+	struct thread_counters *tc = data;
+
+	pthread_mutex_lock(&tracking_mutex);
+	add_counters(exited_threads, tc->tags);
+	add_calls(&exited_calls, &tc->calls);
+	if (tc->prev)
+		tc->prev->next = tc->next;
+	else
+		thread_list = tc->next;
+	if (tc->next)
+		tc->next->prev = tc->prev;
+	pthread_mutex_unlock(&tracking_mutex);
+
+	cur_counters = NULL;
+	free(tc);
+}
+
+static void init_tracking(void)
+{
+	const char *env = getenv(TRACKING_ENV);
+	bool enable = env && *env && strcmp(env, "0") != 0;
+
+	/* the key is needed for the call counters either way */
+	if (pthread_key_create(&counters_key, thread_counters_destroy) != 0)
+		enable = false;
+
+	os_atomic_set_long(&tracking_state, enable ? TRACKING_ON : TRACKING_OFF);
+}
+
+static inline bool tracking_enabled(void)
+{
+	long state = tracking_state;
+
+	if (state == TRACKING_UNKNOWN) {
+		pthread_once(&tracking_once, init_tracking);
+		state = os_atomic_load_long(&tracking_state);
+	}
+
+	return state == TRACKING_ON;
+}
+
+/* counters are allocated with malloc as they are needed by bmalloc itself */
+static struct thread_counters *get_thread_counters(void)
+{
+	struct thread_counters *tc = cur_counters;
+	if (tc)
+		return tc;
+
+	tc = calloc(1, sizeof(*tc));
+	if (!tc) {
+		os_breakpoint();
+		bcrash("Out of memory while trying to allocate memory tracking counters");
+	}
+
+	pthread_setspecific(counters_key, tc);
+
+	pthread_mutex_lock(&tracking_mutex);
+	tc->next = thread_list;
+	if (thread_list)
+		thread_list->prev = tc;
+	thread_list = tc;
+	pthread_mutex_unlock(&tracking_mutex);
+
+	cur_counters = tc;
+	return tc;
+}
+
+static inline void count_alloc(struct thread_counters *tc, int tag, long long size)
+{
+	struct tag_counters *counters = &tc->tags[tag];
+	counter_add(&counters->live_bytes, size);
+	counter_add(&counters->allocs, 1);
+	counter_add(&counters->alloc_bytes, size);
+}
+
+static void *tracked_malloc(size_t size, int tag)
+{
+	struct alloc_header *header = a_malloc(size + HEADER_SIZE);
+	if (!header)
+		return NULL;
+
+	struct thread_counters *tc = get_thread_counters();
+
+	header->size = size;
+	header->tag = tag;
+	count_alloc(tc, tag, (long long)size);
+	return (char *)header + HEADER_SIZE;
+}
+
+static void *tracked_realloc(void *ptr, size_t size)
+{
+	struct alloc_header *header = (struct alloc_header *)((char *)ptr - HEADER_SIZE);
+	size_t old_size = header->size;
+	int tag = header->tag;
+
+	header = a_realloc(header, size + HEADER_SIZE);
+	if (!header)
+		return NULL;
+
+	struct thread_counters *tc = get_thread_counters();
+
+	header->size = size;
+	count_alloc(tc, tag, (long long)size - (long long)old_size);
+	return (char *)header + HEADER_SIZE;
+}
+
+static void tracked_free(void *ptr)
+{
+	struct alloc_header *header = (struct alloc_header *)((char *)ptr - HEADER_SIZE);
+
+	struct thread_counters *tc = get_thread_counters();
+
+	counter_add(&tc->tags[header->tag].live_bytes, -(long long)header->size);
+	a_free(header);
+}
+
+/* ------------------------------------------------------------------------- */
+
+static void *alloc_internal(size_t size, int tag)
 {
 	if (!size) {
 		os_breakpoint();
 		bcrash("bmalloc: Allocating 0 bytes is broken behavior, please fix your code!");
 	}
 
-	void *ptr = a_malloc(size);
+	void *ptr = tracking_enabled() ? tracked_malloc(size, tag < 0 ? cur_tag : tag) : a_malloc(size);
 
 	if (!ptr) {
 		os_breakpoint();
@@ -113,26 +327,40 @@ void *bmalloc(size_t size)
 	}
 
 	os_atomic_inc_long(&num_allocs);
+	counter_add(&get_thread_counters()->calls.allocs, 1);
 	return ptr;
 }
 
+void *bmalloc(size_t size)
+{
+	return alloc_internal(size, -1);
+}
+
+void *bmalloc_tagged(size_t size, int tag)
+{
+	if (tag < 0 || tag >= BMEM_MAX_TAGS)
+		tag = BMEM_TAG_NONE;
+	return alloc_internal(size, tag);
+}
+
 void *brealloc(void *ptr, size_t size)
 {
 	if (!ptr)
-		os_atomic_inc_long(&num_allocs);
+		return alloc_internal(size, -1);
 
 	if (!size) {
 		os_breakpoint();
 		bcrash("brealloc: Allocating 0 bytes is broken behavior, please fix your code!");
 	}
 
-	ptr = a_realloc(ptr, size);
+	ptr = tracking_enabled() ? tracked_realloc(ptr, size) : a_realloc(ptr, size);
 
 	if (!ptr) {
 		os_breakpoint();
 		bcrash("Out of memory while trying to allocate %lu bytes", (unsigned long)size);
 	}
 
+	counter_add(&get_thread_counters()->calls.reallocs, 1);
 	return ptr;
 }
 
@@ -140,15 +368,167 @@ void bfree(void *ptr)
 {
 	if (ptr) {
 		os_atomic_dec_long(&num_allocs);
-		a_free(ptr);
+		if (tracking_enabled())
+			tracked_free(ptr);
+		else
+			a_free(ptr);
+		counter_add(&get_thread_counters()->calls.frees, 1);
+	}
+}
+
+bool bmem_tracking_enabled(void)
+{
+	return tracking_enabled();
+}
+
+int bmem_get_tag(const char *name)
+{
+	int tag = BMEM_TAG_NONE;
+
+	if (!name || !*name || !tracking_enabled())
+		return BMEM_TAG_NONE;
+
+	pthread_mutex_lock(&tracking_mutex);
+
+	for (long i = 1; i < num_tags; i++) {
+		if (strcmp(tag_names[i], name) == 0) {
+			tag = (int)i;
+			break;
+		}
+	}
+
+	if (tag == BMEM_TAG_NONE && num_tags < BMEM_MAX_TAGS) {
+		/* names stay allocated until exit, and can't be counted
+		 * themselves */
+		char *copy = malloc(strlen(name) + 1);
+		if (copy) {
+			strcpy(copy, name);
+			tag = (int)num_tags;
+			tag_names[tag] = copy;
+			os_atomic_inc_long(&num_tags);
+		}
+	}
+
+	pthread_mutex_unlock(&tracking_mutex);
+	return tag;
+}
+
+int bmem_set_thread_tag(int tag)
+{
+	int prev = cur_tag;
+
+	if (tag < 0 || tag >= BMEM_MAX_TAGS)
+		tag = BMEM_TAG_NONE;
+
+	cur_tag = tag;
+	return prev;
+}
+
+int bmem_get_thread_tag(void)
+{
+	return cur_tag;
+}
+
+size_t bmem_get_tag_stats(struct bmem_tag_stats *out, size_t count)
+{
+	struct tag_counters totals[BMEM_MAX_TAGS];
+	size_t tags;
+
+	if (!tracking_enabled())
+		return 0;
+
+	pthread_mutex_lock(&tracking_mutex);
+
+	memcpy(totals, exited_threads, sizeof(totals));
+	for (struct thread_counters *tc = thread_list; tc; tc = tc->next)
+		add_counters(totals, tc->tags);
+
+	tags = (size_t)num_tags;
+	if (count > tags)
+		count = tags;
+
+	for (size_t i = 0; i < tags; i++) {
+		if (totals[i].live_bytes > tag_peaks[i])
+			tag_peaks[i] = totals[i].live_bytes;
 	}
+
+	for (size_t i = 0; i < count; i++) {
+		out[i].name = tag_names[i];
+		out[i].live_bytes = totals[i].live_bytes;
+		out[i].peak_bytes = tag_peaks[i];
+		out[i].allocs = totals[i].allocs;
+		out[i].alloc_bytes = totals[i].alloc_bytes;
+	}
+
+	pthread_mutex_unlock(&tracking_mutex);
+	return count;
 }
 
+#define MB(bytes) ((double)(bytes) / (1024.0 * 1024.0))
+
+void bmem_log_tag_stats(void)
+{
+	static struct bmem_tag_stats last[BMEM_MAX_TAGS];
+	static uint64_t last_time = 0;
+	struct bmem_tag_stats cur[BMEM_MAX_TAGS];
+	uint64_t now = os_gettime_ns();
+	size_t count;
+	double seconds;
+
+	count = bmem_get_tag_stats(cur, BMEM_MAX_TAGS);
+	if (!count)
+		return;
+
+	seconds = last_time ? (double)(now - last_time) / 1000000000.0 : 0.0;
+
+	blog(LOG_INFO, "Memory usage by tag:");
+	for (size_t i = 0; i < count; i++) {
+		double allocs_per_sec = 0.0;
+		double mb_per_sec = 0.0;
+
+		if (seconds > 0.0) {
+			allocs_per_sec = (double)(cur[i].allocs - last[i].allocs) / seconds;
+			mb_per_sec = MB(cur[i].alloc_bytes - last[i].alloc_bytes) / seconds;
+		}
+
+		blog(LOG_INFO, "\t%-20s live: %9.2f MB, peak: %9.2f MB, %9.1f allocs/s, %8.2f MB/s", cur[i].name,
+		     MB(cur[i].live_bytes), MB(cur[i].peak_bytes), allocs_per_sec, mb_per_sec);
+	}
+
+	memcpy(last, cur, sizeof(cur));
+	last_time = now;
+}
+
+#undef MB
+
 long bnum_allocs(void)
 {
 	return num_allocs;
 }
 
+void bmem_get_stats(struct bmem_stats *out)
+{
+	struct call_counters totals;
+
+	if (!out)
+		return;
+
+	memset(out, 0, sizeof(*out));
+	out->active = os_atomic_load_long(&num_allocs);
+
+	pthread_mutex_lock(&tracking_mutex);
+
+	totals = exited_calls;
+	for (struct thread_counters *tc = thread_list; tc; tc = tc->next)
+		add_calls(&totals, &tc->calls);
+
+	pthread_mutex_unlock(&tracking_mutex);
+
+	out->allocs = (long)totals.allocs;
+	out->reallocs = (long)totals.reallocs;
+	out->frees = (long)totals.frees;
+}
+
 int base_get_alignment(void)
 {
 	return ALIGNMENT;
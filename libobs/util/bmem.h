@@ -39,6 +39,47 @@ EXPORT int base_get_alignment(void);
 
 EXPORT long bnum_allocs(void);
 
+/* running totals since startup, these wrap around so allocation rates should
+ * be taken from the difference between two samples */
+struct bmem_stats {
+	long active; /* same as bnum_allocs */
+	long allocs;
+	long reallocs;
+	long frees;
+};
+
+EXPORT void bmem_get_stats(struct bmem_stats *stats);
+
+/* Tagged allocation tracking.  Enabled by setting the OBS_MEMORY_TRACKING
+ * environment variable before libobs is loaded, otherwise tags are ignored
+ * and cost nothing.  Allocations made with bmalloc/brealloc inherit the tag
+ * of the calling thread, and reallocations keep their original tag. */
+#define BMEM_MAX_TAGS 64
+#define BMEM_TAG_NONE 0
+
+struct bmem_tag_stats {
+	const char *name;
+	long long live_bytes;
+	long long peak_bytes; /* highest live_bytes seen when stats were read */
+	long long allocs;
+	long long alloc_bytes;
+};
+
+EXPORT bool bmem_tracking_enabled(void);
+
+/* returns the tag with the given name, registering it on first use */
+EXPORT int bmem_get_tag(const char *name);
+
+/* sets the tag inherited by allocations of this thread, returns the
+ * previous one so that it can be restored */
+EXPORT int bmem_set_thread_tag(int tag);
+EXPORT int bmem_get_thread_tag(void);
+
+EXPORT void *bmalloc_tagged(size_t size, int tag);
+
+EXPORT size_t bmem_get_tag_stats(struct bmem_tag_stats *stats, size_t count);
+EXPORT void bmem_log_tag_stats(void);
+
 EXPORT void *bmemdup(const void *ptr, size_t size);
 
 static inline void *bzalloc(size_t size)
@@ -49,6 +90,14 @@ static inline void *bzalloc(size_t size)
 	return mem;
 }
 
+static inline void *bzalloc_tagged(size_t size, int tag)
+{
+	void *mem = bmalloc_tagged(size, tag);
+	if (mem)
+		memset(mem, 0, size);
+	return mem;
+}
+
 static inline char *bstrdup_n(const char *str, size_t n)
 {
 	char *dup;
@@ -26,6 +26,8 @@
 #include <errno.h>
 #include <sys/types.h>
 #include <sys/stat.h>
+#include <sys/mman.h>
+#include <fcntl.h>
 #include <sys/statvfs.h>
 #include <dirent.h>
 #include <stdlib.h>
@@ -539,6 +541,68 @@ void os_closedir(os_dir_t *dir)
 	}
 }
 
+struct os_mmap {
+	void *data;
+	size_t size;
+};
+
+os_mmap_t *os_mmap_open(const char *path, size_t size, bool writable)
+{
+	struct os_mmap *map;
+	struct stat st;
+	void *data;
+	int fd;
+
+	if (!path || (writable && !size))
+		return NULL;
+
+	fd = open(path, writable ? O_RDWR | O_CREAT : O_RDONLY, 0644);
+	if (fd == -1)
+		return NULL;
+
+	if (writable) {
+		if (ftruncate(fd, (off_t)size) != 0) {
+			close(fd);
+			return NULL;
+		}
+	} else {
+		if (fstat(fd, &st) != 0 || st.st_size <= 0) {
+			close(fd);
+			return NULL;
+		}
+		size = (size_t)st.st_size;
+	}
+
+	data = mmap(NULL, size, writable ? PROT_READ | PROT_WRITE : PROT_READ, MAP_SHARED, fd, 0);
+	close(fd);
+
+	if (data == MAP_FAILED)
+		return NULL;
+
+	map = bmalloc(sizeof(struct os_mmap));
+	map->data = data;
+	map->size = size;
+	return map;
+}
+
+void os_mmap_close(os_mmap_t *map)
+{
+	if (map) {
+		munmap(map->data, map->size);
+		bfree(map);
+	}
+}
+
+void *os_mmap_get_data(os_mmap_t *map)
+{
+	return map ? map->data : NULL;
+}
+
+size_t os_mmap_get_size(os_mmap_t *map)
+{
+	return map ? map->size : 0;
+}
+
 #ifndef __APPLE__
 int64_t os_get_free_space(const char *path)
 {
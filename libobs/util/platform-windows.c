@@ -655,6 +655,85 @@ void os_closedir(os_dir_t *dir)
 	}
 }
 
+struct os_mmap {
+	void *data;
+	size_t size;
+};
+
+os_mmap_t *os_mmap_open(const char *path, size_t size, bool writable)
+{
+	struct os_mmap *map;
+	HANDLE file = INVALID_HANDLE_VALUE;
+	HANDLE mapping = NULL;
+	LARGE_INTEGER file_size;
+	wchar_t *wpath = NULL;
+	void *data = NULL;
+
+	if (!path || (writable && !size))
+		return NULL;
+
+	if (!os_utf8_to_wcs_ptr(path, 0, &wpath))
+		return NULL;
+
+	/* FILE_SHARE_DELETE so the file can still be renamed over or removed
+	 * while it is mapped, like on other platforms */
+	file = CreateFileW(wpath, writable ? GENERIC_READ | GENERIC_WRITE : GENERIC_READ,
+			   FILE_SHARE_READ | FILE_SHARE_DELETE, NULL, writable ? OPEN_ALWAYS : OPEN_EXISTING,
+			   FILE_ATTRIBUTE_NORMAL, NULL);
+	bfree(wpath);
+
+	if (file == INVALID_HANDLE_VALUE)
+		return NULL;
+
+	if (writable) {
+		file_size.QuadPart = (LONGLONG)size;
+		if (!SetFilePointerEx(file, file_size, NULL, FILE_BEGIN) || !SetEndOfFile(file))
+			goto fail;
+	} else {
+		if (!GetFileSizeEx(file, &file_size) || file_size.QuadPart <= 0)
+			goto fail;
+		size = (size_t)file_size.QuadPart;
+	}
+
+	mapping = CreateFileMappingW(file, NULL, writable ? PAGE_READWRITE : PAGE_READONLY, 0, 0, NULL);
+	if (!mapping)
+		goto fail;
+
+	data = MapViewOfFile(mapping, writable ? FILE_MAP_WRITE : FILE_MAP_READ, 0, 0, size);
+
+fail:
+	/* the view keeps the mapping and file alive */
+	if (mapping)
+		CloseHandle(mapping);
+	CloseHandle(file);
+
+	if (!data)
+		return NULL;
+
+	map = bmalloc(sizeof(struct os_mmap));
+	map->data = data;
+	map->size = size;
+	return map;
+}
+
+void os_mmap_close(os_mmap_t *map)
+{
+	if (map) {
+		UnmapViewOfFile(map->data);
+		bfree(map);
+	}
+}
+
+void *os_mmap_get_data(os_mmap_t *map)
+{
+	return map ? map->data : NULL;
+}
+
+size_t os_mmap_get_size(os_mmap_t *map)
+{
+	return map ? map->size : 0;
+}
+
 int64_t os_get_free_space(const char *path)
 {
 	ULARGE_INTEGER remainingSpace;
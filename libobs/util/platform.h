@@ -57,6 +57,17 @@ EXPORT bool os_quick_write_mbs_file(const char *path, const char *str, size_t le
 EXPORT int64_t os_get_file_size(const char *path);
 EXPORT int64_t os_get_free_space(const char *path);
 
+/* Maps a file into memory.  Read-only maps cover the whole existing file and
+ * ignore size, writable maps create the file if needed and resize it to
+ * size bytes.  Changes to writable maps are written back to the file. */
+struct os_mmap;
+typedef struct os_mmap os_mmap_t;
+
+EXPORT os_mmap_t *os_mmap_open(const char *path, size_t size, bool writable);
+EXPORT void os_mmap_close(os_mmap_t *map);
+EXPORT void *os_mmap_get_data(os_mmap_t *map);
+EXPORT size_t os_mmap_get_size(os_mmap_t *map);
+
 EXPORT size_t os_mbs_to_wcs(const char *str, size_t str_len, wchar_t *dst, size_t dst_size);
 EXPORT size_t os_utf8_to_wcs(const char *str, size_t len, wchar_t *dst, size_t dst_size);
 EXPORT size_t os_wcs_to_mbs(const wchar_t *str, size_t len, char *dst, size_t dst_size);
@@ -27,11 +27,13 @@ struct frame_sample {
 	uint64_t tick;
 	DARRAY(uint64_t) render_cpu;
 	DARRAY(gs_timer_t *) render_timers;
+	uint64_t render_cache_hits;
 };
 
 /* Buffer frame data collection to give GPU time to finish rendering.
- * Set to the same as the rendering buffer (NUM_TEXTURES) */
-#define FRAME_BUFFER_SIZE NUM_TEXTURES
+ * Kept at the default rendering buffer depth, a deeper readback ring
+ * (NUM_TEXTURES) does not delay the timer queries. */
+#define FRAME_BUFFER_SIZE DEFAULT_NUM_TEXTURES
 
 struct source_samples {
 	/* the pointer address of the source is the hashtable key */
@@ -65,6 +67,8 @@ struct profiler_entry {
 	/* Sum of all render passes in a frame, for last N frames */
 	struct ucirclebuf render_cpu_sum;
 	struct ucirclebuf render_gpu_sum;
+	/* Render passes served from the render cache, for last N frames */
+	struct ucirclebuf render_cache_hits;
 	/* Timestamps of last N async frame submissions */
 	struct ucirclebuf async_frame_ts;
 	/* Timestamps of last N async frames rendered */
@@ -172,6 +176,7 @@ static struct profiler_entry *entry_create(const uintptr_t key)
 	ucirclebuf_init(&ent->render_gpu, profiler_samples);
 	ucirclebuf_init(&ent->render_cpu_sum, profiler_samples);
 	ucirclebuf_init(&ent->render_gpu_sum, profiler_samples);
+	ucirclebuf_init(&ent->render_cache_hits, profiler_samples);
 	ucirclebuf_init(&ent->async_frame_ts, profiler_samples);
 	ucirclebuf_init(&ent->async_rendered_ts, profiler_samples);
 	return ent;
@@ -184,6 +189,7 @@ static void entry_destroy(struct profiler_entry *entry)
 	ucirclebuf_free(&entry->render_gpu);
 	ucirclebuf_free(&entry->render_cpu_sum);
 	ucirclebuf_free(&entry->render_gpu_sum);
+	ucirclebuf_free(&entry->render_cache_hits);
 	ucirclebuf_free(&entry->async_frame_ts);
 	ucirclebuf_free(&entry->async_rendered_ts);
 	bfree(entry);
@@ -341,6 +347,9 @@ void source_profiler_frame_collect(void)
 			ucirclebuf_push(&ent->render_cpu_sum, 0);
 		}
 
+		ucirclebuf_push(&ent->render_cache_hits, smp->render_cache_hits);
+		smp->render_cache_hits = 0;
+
 		/* Note that we still check this even if GPU profiling has been
 		 * disabled to destroy leftover timers. */
 		if (smp->render_timers.num) {
@@ -478,6 +487,18 @@ void source_profiler_source_render_end(obs_source_t *source, uint64_t start, gs_
 	}
 }
 
+void source_profiler_render_cache_hit(obs_source_t *source)
+{
+	if (!enabled)
+		return;
+
+	struct source_samples *smp;
+	HASH_FIND_PTR(hm_samples, &source, smp);
+
+	if (smp)
+		smp->frames[smp->frame_idx]->render_cache_hits++;
+}
+
 static void task_delete_source(void *key)
 {
 	struct source_samples *smp;
@@ -541,6 +562,13 @@ static inline void calculate_render(struct profiler_entry *ent, struct profiler_
 		result->render_sum = sum_sum / idx;
 	}
 
+	sum = 0;
+	for (idx = 0; idx < ent->render_cache_hits.num; idx++)
+		sum += ent->render_cache_hits.array[idx];
+
+	if (idx)
+		result->render_cache_hits = (double)sum / (double)idx;
+
 	if (!gpu_enabled)
 		return;
 
@@ -49,6 +49,10 @@ typedef struct profiler_result {
 	uint64_t async_input_worst;
 	uint64_t async_rendered_best;
 	uint64_t async_rendered_worst;
+
+	/* Average number of render passes in a frame that were drawn from
+	 * the source's render cache instead of being rendered again */
+	double render_cache_hits;
 } profiler_result_t;
 
 /* Enable/disable profiler (applied on next frame) */
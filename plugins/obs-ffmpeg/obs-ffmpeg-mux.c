@@ -22,6 +22,7 @@
 #include "util/windows/win-version.h"
 #endif
 
+#include <inttypes.h>
 #include <libavformat/avformat.h>
 
 #define do_log(level, format, ...) \
@@ -44,14 +45,46 @@ static const char *ffmpeg_mpegts_mux_getname(void *type)
 }
 #endif
 
+static inline bool packet_on_disk(os_mmap_t *map, const struct encoder_packet *packet)
+{
+	const uint8_t *base = os_mmap_get_data(map);
+	return base && packet->data >= base && packet->data < base + os_mmap_get_size(map);
+}
+
+static inline void release_packet(struct ffmpeg_muxer *stream, struct encoder_packet *packet)
+{
+	if (!packet_on_disk(stream->disk_map, packet))
+		obs_encoder_packet_release(packet);
+}
+
+/* never waits for a save, this is called from the encoder packet thread when
+ * the buffer stops.  a save that is still reading from the file is left the
+ * mapping and closes it when it is done, the file itself is removed right
+ * away and only goes away once it is unmapped. */
+static void close_disk_buffer(struct ffmpeg_muxer *stream)
+{
+	if (!stream->disk_map)
+		return;
+
+	pthread_mutex_lock(&stream->disk_mutex);
+	if (stream->disk_map != stream->mux_disk_map)
+		os_mmap_close(stream->disk_map);
+	stream->disk_map = NULL;
+	pthread_mutex_unlock(&stream->disk_mutex);
+
+	os_unlink(stream->disk_path.array);
+	dstr_free(&stream->disk_path);
+}
+
 static inline void replay_buffer_clear(struct ffmpeg_muxer *stream)
 {
 	while (stream->packets.size > 0) {
 		struct encoder_packet pkt;
 		deque_pop_front(&stream->packets, &pkt, sizeof(pkt));
-		obs_encoder_packet_release(&pkt);
+		release_packet(stream, &pkt);
 	}
 
+	close_disk_buffer(stream);
 	deque_free(&stream->packets);
 	stream->cur_size = 0;
 	stream->cur_time = 0;
@@ -953,6 +986,12 @@ static void *replay_buffer_create(obs_data_t *settings, obs_output_t *output)
 	struct ffmpeg_muxer *stream = bzalloc(sizeof(*stream));
 	stream->output = output;
 
+	pthread_mutex_init_value(&stream->disk_mutex);
+	if (pthread_mutex_init(&stream->disk_mutex, NULL) != 0) {
+		bfree(stream);
+		return NULL;
+	}
+
 	stream->hotkey = obs_hotkey_register_output(output, "ReplayBuffer.Save", obs_module_text("ReplayBuffer.Save"),
 						    replay_buffer_hotkey, stream);
 
@@ -971,9 +1010,81 @@ static void replay_buffer_destroy(void *data)
 	struct ffmpeg_muxer *stream = data;
 	if (stream->hotkey)
 		obs_hotkey_unregister(stream->hotkey);
+
+	replay_buffer_clear(stream);
+	if (stream->mux_thread_joinable) {
+		pthread_join(stream->mux_thread, NULL);
+		stream->mux_thread_joinable = false;
+	}
+	pthread_mutex_destroy(&stream->disk_mutex);
+
 	ffmpeg_mux_destroy(data);
 }
 
+static int64_t get_encoder_bitrate(obs_encoder_t *encoder)
+{
+	if (!encoder)
+		return 0;
+
+	obs_data_t *settings = obs_encoder_get_settings(encoder);
+	int64_t bitrate = obs_data_get_int(settings, "bitrate");
+	obs_data_release(settings);
+	return bitrate;
+}
+
+/* sizes the buffer file from the encoder bitrates when only a maximum time
+ * is set, returns 0 if the encoders have no fixed bitrate */
+static int64_t estimate_disk_buffer_size(struct ffmpeg_muxer *stream)
+{
+	int64_t video_kbps = 0;
+	int64_t audio_kbps = 0;
+
+	for (size_t i = 0; i < MAX_OUTPUT_VIDEO_ENCODERS; i++)
+		video_kbps += get_encoder_bitrate(obs_output_get_video_encoder2(stream->output, i));
+	for (size_t i = 0; i < MAX_OUTPUT_AUDIO_ENCODERS; i++)
+		audio_kbps += get_encoder_bitrate(obs_output_get_audio_encoder(stream->output, i));
+
+	if (!video_kbps || !stream->max_time)
+		return 0;
+
+	/* double the average to leave room for bitrate peaks */
+	return (video_kbps + audio_kbps) * 1000 / 8 * (stream->max_time / 1000000) * 2;
+}
+
+static void open_disk_buffer(struct ffmpeg_muxer *stream, obs_data_t *settings)
+{
+	const char *dir = obs_data_get_string(settings, "directory");
+	int64_t size = stream->max_size ? stream->max_size : estimate_disk_buffer_size(stream);
+	struct dstr name = {0};
+
+	if (size <= 0 || (uint64_t)size > SIZE_MAX) {
+		warn("Could not determine the size of the replay buffer file, buffering in memory");
+		return;
+	}
+
+	dstr_copy(&stream->disk_path, dir);
+	dstr_replace(&stream->disk_path, "\\", "/");
+	if (dstr_end(&stream->disk_path) != '/')
+		dstr_cat_ch(&stream->disk_path, '/');
+	os_mkdirs(stream->disk_path.array);
+
+	dstr_printf(&name, ".replay-buffer-%s.tmp", obs_output_get_name(stream->output));
+	dstr_replace(&name, "/", "_");
+	dstr_replace(&name, "\\", "_");
+	dstr_cat_dstr(&stream->disk_path, &name);
+	dstr_free(&name);
+
+	stream->disk_map = os_mmap_open(stream->disk_path.array, (size_t)size, true);
+	if (!stream->disk_map) {
+		warn("Failed to create replay buffer file '%s', buffering in memory", stream->disk_path.array);
+		dstr_free(&stream->disk_path);
+		return;
+	}
+
+	stream->disk_pos = 0;
+	info("Buffering replay in '%s' (%" PRId64 " MB)", stream->disk_path.array, size / (1024 * 1024));
+}
+
 static bool replay_buffer_start(void *data)
 {
 	struct ffmpeg_muxer *stream = data;
@@ -986,6 +1097,8 @@ static bool replay_buffer_start(void *data)
 	obs_data_t *s = obs_output_get_settings(stream->output);
 	stream->max_time = obs_data_get_int(s, "max_time_sec") * 1000000LL;
 	stream->max_size = obs_data_get_int(s, "max_size_mb") * (1024 * 1024);
+	if (obs_data_get_bool(s, "use_disk_buffer"))
+		open_disk_buffer(stream, s);
 	obs_data_release(s);
 
 	os_atomic_set_bool(&stream->active, true);
@@ -1021,7 +1134,7 @@ static bool purge_front(struct ffmpeg_muxer *stream)
 		stream->cur_size -= (int64_t)pkt.size;
 	}
 
-	obs_encoder_packet_release(&pkt);
+	release_packet(stream, &pkt);
 	return keyframe;
 }
 
@@ -1059,13 +1172,87 @@ static inline void replay_buffer_purge(struct ffmpeg_muxer *stream, struct encod
 		purge(stream);
 }
 
-static void insert_packet(mux_packets_t *packets, struct encoder_packet *packet, int64_t video_offset,
+static inline size_t disk_offset(struct ffmpeg_muxer *stream, const struct encoder_packet *packet)
+{
+	return (size_t)(packet->data - (uint8_t *)os_mmap_get_data(stream->disk_map));
+}
+
+static inline bool disk_overlaps(struct ffmpeg_muxer *stream, const struct encoder_packet *packet, size_t pos,
+				 size_t size)
+{
+	size_t offset = disk_offset(stream, packet);
+	return offset < pos + size && offset + packet->size > pos;
+}
+
+/* packets of a save in progress are moved to memory before the region of the
+ * file they are stored in gets overwritten */
+static void protect_mux_packets(struct ffmpeg_muxer *stream, size_t pos, size_t size)
+{
+	pthread_mutex_lock(&stream->disk_mutex);
+	for (size_t i = stream->mux_pos; i < stream->mux_packets.num; i++) {
+		struct encoder_packet *pkt = &stream->mux_packets.array[i];
+
+		if (packet_on_disk(stream->mux_disk_map, pkt) && disk_overlaps(stream, pkt, pos, size))
+			pkt->data = bmemdup(pkt->data, pkt->size);
+	}
+	pthread_mutex_unlock(&stream->disk_mutex);
+}
+
+static bool disk_buffer_push(struct ffmpeg_muxer *stream, struct encoder_packet *packet)
+{
+	uint8_t *base = os_mmap_get_data(stream->disk_map);
+	size_t map_size = os_mmap_get_size(stream->disk_map);
+	size_t size = packet->size;
+	struct encoder_packet pkt;
+
+	if (size > map_size) {
+		warn("Packet of %zu bytes does not fit in the replay buffer file", size);
+		return false;
+	}
+
+	/* the space left at the end of the file is too small, the packets
+	 * stored there are the oldest ones and go first */
+	if (stream->disk_pos + size > map_size) {
+		while (stream->packets.size) {
+			deque_peek_front(&stream->packets, &pkt, sizeof(pkt));
+			if (disk_offset(stream, &pkt) < stream->disk_pos)
+				break;
+			purge(stream);
+		}
+
+		stream->disk_pos = 0;
+	}
+
+	while (stream->packets.size) {
+		deque_peek_front(&stream->packets, &pkt, sizeof(pkt));
+		if (!disk_overlaps(stream, &pkt, stream->disk_pos, size))
+			break;
+		purge(stream);
+	}
+
+	if (os_atomic_load_bool(&stream->muxing))
+		protect_mux_packets(stream, stream->disk_pos, size);
+
+	pkt = *packet;
+	pkt.data = base + stream->disk_pos;
+	memcpy(pkt.data, packet->data, size);
+	stream->disk_pos += size;
+
+	deque_push_back(&stream->packets, &pkt, sizeof(pkt));
+	return true;
+}
+
+static void insert_packet(mux_packets_t *packets, struct encoder_packet *packet, bool ref, int64_t video_offset,
 			  int64_t *audio_offsets, int64_t video_pts_offset, int64_t *audio_dts_offsets)
 {
 	struct encoder_packet pkt;
 	size_t idx;
 
-	obs_encoder_packet_ref(&pkt, packet);
+	/* packets stored on disk are not reference counted */
+	if (ref)
+		obs_encoder_packet_ref(&pkt, packet);
+	else
+		pkt = *packet;
 
 	if (pkt.type == OBS_ENCODER_VIDEO) {
 		pkt.dts_usec -= video_offset;
@@ -1086,6 +1273,47 @@ static void insert_packet(mux_packets_t *packets, struct encoder_packet *packet,
 	da_insert(*packets, idx, &pkt);
 }
 
+/* copies the next packet of a disk backed save to memory, so the writer is
+ * free to overwrite it in the file once the lock is released */
+static bool get_disk_mux_packet(struct ffmpeg_muxer *stream, struct encoder_packet *pkt)
+{
+	bool found = false;
+
+	pthread_mutex_lock(&stream->disk_mutex);
+	if (stream->mux_pos < stream->mux_packets.num) {
+		*pkt = stream->mux_packets.array[stream->mux_pos++];
+
+		da_copy_array(stream->mux_buffer, pkt->data, pkt->size);
+		if (!packet_on_disk(stream->mux_disk_map, pkt))
+			bfree(pkt->data);
+
+		pkt->data = stream->mux_buffer.array;
+		found = true;
+	}
+	pthread_mutex_unlock(&stream->disk_mutex);
+
+	return found;
+}
+
+static void free_disk_mux_packets(struct ffmpeg_muxer *stream)
+{
+	pthread_mutex_lock(&stream->disk_mutex);
+	for (size_t i = stream->mux_pos; i < stream->mux_packets.num; i++) {
+		struct encoder_packet *pkt = &stream->mux_packets.array[i];
+		if (!packet_on_disk(stream->mux_disk_map, pkt))
+			bfree(pkt->data);
+	}
+	da_free(stream->mux_packets);
+	da_free(stream->mux_buffer);
+	stream->mux_pos = 0;
+
+	/* the buffer was closed while saving */
+	if (stream->disk_map != stream->mux_disk_map)
+		os_mmap_close(stream->mux_disk_map);
+	stream->mux_disk_map = NULL;
+	pthread_mutex_unlock(&stream->disk_mutex);
+}
+
 static void *replay_buffer_mux_thread(void *data)
 {
 	struct ffmpeg_muxer *stream = data;
@@ -1105,14 +1333,26 @@ static void *replay_buffer_mux_thread(void *data)
 		goto error;
 	}
 
-	for (size_t i = 0; i < stream->mux_packets.num; i++) {
-		struct encoder_packet *pkt = &stream->mux_packets.array[i];
-		if (!write_packet(stream, pkt)) {
-			warn("Could not write packet for file '%s'", stream->path.array);
-			error = true;
-			goto error;
+	if (stream->mux_disk_map) {
+		struct encoder_packet pkt;
+
+		while (get_disk_mux_packet(stream, &pkt)) {
+			if (!write_packet(stream, &pkt)) {
+				warn("Could not write packet for file '%s'", stream->path.array);
+				error = true;
+				goto error;
+			}
+		}
+	} else {
+		for (size_t i = 0; i < stream->mux_packets.num; i++) {
+			struct encoder_packet *pkt = &stream->mux_packets.array[i];
+			if (!write_packet(stream, pkt)) {
+				warn("Could not write packet for file '%s'", stream->path.array);
+				error = true;
+				goto error;
+			}
+			obs_encoder_packet_release(pkt);
 		}
-		obs_encoder_packet_release(pkt);
 	}
 
 	info("Wrote replay buffer to '%s'", stream->path.array);
@@ -1120,11 +1360,15 @@ static void *replay_buffer_mux_thread(void *data)
 error:
 	os_process_pipe_destroy(stream->pipe);
 	stream->pipe = NULL;
-	if (error) {
-		for (size_t i = 0; i < stream->mux_packets.num; i++)
-			obs_encoder_packet_release(&stream->mux_packets.array[i]);
+	if (stream->mux_disk_map) {
+		free_disk_mux_packets(stream);
+	} else {
+		if (error) {
+			for (size_t i = 0; i < stream->mux_packets.num; i++)
+				obs_encoder_packet_release(&stream->mux_packets.array[i]);
+		}
+		da_free(stream->mux_packets);
 	}
-	da_free(stream->mux_packets);
 	os_atomic_set_bool(&stream->muxing, false);
 
 	if (!error) {
@@ -1171,16 +1415,21 @@ static void replay_buffer_save(struct ffmpeg_muxer *stream)
 			}
 		}
 
-		insert_packet(&stream->mux_packets, pkt, video_offset, audio_offsets, video_pts_offset,
-			      audio_dts_offsets);
+		insert_packet(&stream->mux_packets, pkt, !stream->disk_map, video_offset, audio_offsets,
+			      video_pts_offset, audio_dts_offsets);
 	}
 
+	stream->mux_pos = 0;
+	stream->mux_disk_map = stream->disk_map;
+
 	generate_filename(stream, &stream->path, true);
 
 	os_atomic_set_bool(&stream->muxing, true);
 	stream->mux_thread_joinable = pthread_create(&stream->mux_thread, NULL, replay_buffer_mux_thread, stream) == 0;
 	if (!stream->mux_thread_joinable) {
 		warn("Failed to create muxer thread");
+		if (stream->mux_disk_map)
+			free_disk_mux_packets(stream);
 		os_atomic_set_bool(&stream->muxing, false);
 	}
 }
@@ -1220,14 +1469,19 @@ static void replay_buffer_data(void *data, struct encoder_packet *packet)
 		}
 	}
 
-	obs_encoder_packet_ref(&pkt, packet);
-	replay_buffer_purge(stream, &pkt);
+	replay_buffer_purge(stream, packet);
 
-	if (!stream->packets.size)
-		stream->cur_time = pkt.dts_usec;
-	stream->cur_size += pkt.size;
+	if (stream->disk_map) {
+		if (!disk_buffer_push(stream, packet))
+			return;
+	} else {
+		obs_encoder_packet_ref(&pkt, packet);
+		deque_push_back(&stream->packets, &pkt, sizeof(pkt));
+	}
 
-	deque_push_back(&stream->packets, packet, sizeof(*packet));
+	if (stream->packets.size == sizeof(pkt))
+		stream->cur_time = packet->dts_usec;
+	stream->cur_size += packet->size;
 
 	if (packet->type == OBS_ENCODER_VIDEO && packet->keyframe)
 		stream->keyframes++;
@@ -1250,11 +1504,28 @@ static void replay_buffer_defaults(obs_data_t *s)
 {
 	obs_data_set_default_int(s, "max_time_sec", 15);
 	obs_data_set_default_int(s, "max_size_mb", 500);
+	obs_data_set_default_bool(s, "use_disk_buffer", false);
 	obs_data_set_default_string(s, "format", "%CCYY-%MM-%DD %hh-%mm-%ss");
 	obs_data_set_default_string(s, "extension", "mp4");
 	obs_data_set_default_bool(s, "allow_spaces", true);
 }
 
+static obs_properties_t *replay_buffer_properties(void *unused)
+{
+	UNUSED_PARAMETER(unused);
+
+	obs_properties_t *props = obs_properties_create();
+	obs_property_t *p;
+
+	obs_properties_add_int(props, "max_time_sec", obs_module_text("ReplayBuffer.MaxTime"), 1, 21600, 1);
+	obs_properties_add_int(props, "max_size_mb", obs_module_text("ReplayBuffer.MaxSize"), 0, 1024 * 1024, 1);
+	p = obs_properties_add_bool(props, "use_disk_buffer", obs_module_text("ReplayBuffer.UseDiskBuffer"));
+	obs_property_set_long_description(p, obs_module_text("ReplayBuffer.UseDiskBuffer.ToolTip"));
+	obs_properties_add_path(props, "directory", obs_module_text("ReplayBuffer.Directory"), OBS_PATH_DIRECTORY,
+				NULL, NULL);
+	return props;
+}
+
 struct obs_output_info replay_buffer = {
 	.id = "replay_buffer",
 	.flags = OBS_OUTPUT_AV | OBS_OUTPUT_ENCODED | OBS_OUTPUT_MULTI_TRACK | OBS_OUTPUT_CAN_PAUSE,
@@ -1266,4 +1537,5 @@ struct obs_output_info replay_buffer = {
 	.encoded_packet = replay_buffer_data,
 	.get_total_bytes = ffmpeg_mux_total_bytes,
 	.get_defaults = replay_buffer_defaults,
+	.get_properties = replay_buffer_properties,
 };
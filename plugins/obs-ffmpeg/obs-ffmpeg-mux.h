@@ -38,6 +38,19 @@ struct ffmpeg_muxer {
 	volatile bool muxing;
 	mux_packets_t mux_packets;
 
+	/* disk backed replay buffer, packet data lives in a memory mapped
+	 * circular file instead of RAM */
+	os_mmap_t *disk_map;
+	struct dstr disk_path;
+	size_t disk_pos;
+	pthread_mutex_t disk_mutex;
+
+	/* mapping read by a save in progress, closed by the mux thread if the
+	 * buffer was closed while it was still saving */
+	os_mmap_t *mux_disk_map;
+	size_t mux_pos;
+	DARRAY(uint8_t) mux_buffer;
+
 	/* split file */
 	bool found_video;
 	bool found_audio[MAX_AUDIO_MIXES];
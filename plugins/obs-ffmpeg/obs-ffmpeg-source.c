@@ -41,6 +41,7 @@ struct ffmpeg_source {
 	char *input_format;
 	char *ffmpeg_options;
 	int buffering_mb;
+	int cache_budget_mb;
 	int speed_percent;
 	bool is_looping;
 	bool is_local_file;
@@ -300,6 +301,7 @@ static void ffmpeg_source_open(struct ffmpeg_source *s)
 			.path = s->input,
 			.format = s->input_format,
 			.buffering = s->buffering_mb * 1024 * 1024,
+			.cache_budget = (size_t)s->cache_budget_mb * 1024 * 1024,
 			.speed = s->speed_percent,
 			.force_range = s->range,
 			.is_linear_alpha = s->is_linear_alpha,
@@ -456,6 +458,7 @@ static void ffmpeg_source_update(void *data, obs_data_t *settings)
 	s->input_format = input_format ? bstrdup(input_format) : NULL;
 	s->is_hw_decoding = is_hw_decoding;
 	s->full_decode = obs_data_get_bool(settings, "full_decode");
+	s->cache_budget_mb = (int)obs_data_get_int(settings, "cache_budget_mb");
 	s->is_clear_on_media_end = obs_data_get_bool(settings, "clear_on_media_end");
 	s->restart_on_activate = !astrcmpi_n(input, RIST_PROTO, sizeof(RIST_PROTO) - 1)
 					 ? false
@@ -1,6 +1,12 @@
+#include <inttypes.h>
 #include <obs-module.h>
+#include <media-io/video-frame.h>
 #include <util/deque.h>
+#include <util/darray.h>
+#include <util/platform.h>
+#include <util/threading.h>
 #include <util/util_uint64.h>
+#include "frame-compress.h"
 
 /* NOTE: Delaying audio shouldn't be necessary because the audio subsystem will
  * automatically sync audio to video frames */
@@ -15,13 +21,71 @@
 #endif
 
 #define SETTING_DELAY_MS "delay_ms"
+#define SETTING_STORAGE "storage"
+#define SETTING_MEMORY_LIMIT "memory_limit_mb"
 
 #define TEXT_DELAY_MS obs_module_text("DelayMs")
+#define TEXT_STORAGE obs_module_text("DelayStorage")
+#define TEXT_STORAGE_FULL obs_module_text("DelayStorage.Full")
+#define TEXT_STORAGE_LOSSLESS obs_module_text("DelayStorage.Lossless")
+#define TEXT_STORAGE_SUBSAMPLED obs_module_text("DelayStorage.Subsampled")
+#define TEXT_MEMORY_LIMIT obs_module_text("DelayMemoryLimit")
+#define TEXT_MEMORY_LIMIT_DESC obs_module_text("DelayMemoryLimit.Description")
+
+#define do_log(level, format, ...) \
+	blog(level, "[async delay: '%s'] " format, obs_source_get_name(filter->context), ##__VA_ARGS__)
+
+#define warn(format, ...) do_log(LOG_WARNING, format, ##__VA_ARGS__)
+
+enum delay_storage {
+	STORAGE_FULL,
+	STORAGE_LOSSLESS,
+	STORAGE_SUBSAMPLED,
+};
+
+#define MAX_WORKERS 4
+#define DECODE_AHEAD 2
+#define MAX_FREE_ENTRIES 4
+#define MAX_POOL_FRAMES 8
+
+/* A delayed frame is either the source's own frame (uncompressed storage or
+ * formats the codec does not handle), or a picture that is compressed by the
+ * worker threads and decoded again shortly before it is due. */
+struct delayed_frame {
+	struct obs_source_frame *source_frame;
+	struct obs_source_frame *raw;
+	struct obs_source_frame *decoded;
+
+	/* properties of the original frame, data pointers are unused */
+	struct obs_source_frame info;
+
+	enum video_format stored_format;
+	struct frame_plane planes[MAX_AV_PLANES];
+	size_t plane_count;
+	size_t plane_sizes[MAX_AV_PLANES];
+	uint8_t *data;
+	size_t capacity;
+
+	size_t bytes;
+	bool compressed;
+	bool busy;
+	bool failed;
+	bool discard;
+};
+
+struct delay_worker {
+	struct async_delay_data *filter;
+	pthread_t thread;
+
+	uint8_t *buffer;
+	size_t buffer_size;
+	struct obs_source_frame *i420;
+};
 
 struct async_delay_data {
 	obs_source_t *context;
 
-	/* contains struct obs_source_frame* */
+	/* contains struct delayed_frame* */
 	struct deque video_frames;
 
 #ifdef DELAY_AUDIO
@@ -38,6 +102,28 @@ struct async_delay_data {
 	bool audio_delay_reached;
 	bool reset_video;
 	bool reset_audio;
+
+	/* settings are applied by the video thread on reset */
+	enum delay_storage new_storage;
+	enum delay_storage storage;
+	uint64_t memory_limit;
+	uint64_t memory_used;
+	bool limit_reached;
+
+	/* protects the frame queue, the pools and the worker state */
+	pthread_mutex_t mutex;
+	os_sem_t *work_sem;
+	os_event_t *job_done;
+	struct delay_worker workers[MAX_WORKERS];
+	size_t worker_count;
+	struct delay_worker scratch; /* used by the video thread */
+	volatile bool stop_workers;
+	size_t busy_jobs;
+
+	DARRAY(struct delayed_frame *) free_entries;
+	DARRAY(struct obs_source_frame *) frame_pool;
+
+	int memory_tag;
 };
 
 static const char *async_delay_filter_name(void *unused)
@@ -46,14 +132,382 @@ static const char *async_delay_filter_name(void *unused)
 	return obs_module_text("AsyncDelayFilter");
 }
 
+/* ------------------------------------------------------------------------- */
+/* frame pool                                                                */
+
+static inline bool same_layout(const struct obs_source_frame *a, const struct obs_source_frame *b)
+{
+	if (a->format != b->format || a->width != b->width || a->height != b->height)
+		return false;
+
+	for (size_t i = 0; i < MAX_AV_PLANES; i++) {
+		if (a->linesize[i] != b->linesize[i])
+			return false;
+	}
+
+	return true;
+}
+
+/* frames from the pool are allocated exactly like the source's own frames, so
+ * their buffers can be swapped with the frames passing through the filter.
+ * libobs takes those buffers from the video frame pool, so the filter does
+ * too and always hands buffers back through it, whichever frame they ended
+ * up in. */
+static struct obs_source_frame *create_pooled_frame(enum video_format format, uint32_t width, uint32_t height)
+{
+	struct obs_source_frame *frame = bzalloc(sizeof(struct obs_source_frame));
+	struct video_frame vid_frame;
+
+	video_frame_init_pooled(&vid_frame, format, width, height);
+	frame->format = format;
+	frame->width = width;
+	frame->height = height;
+
+	for (size_t i = 0; i < MAX_AV_PLANES; i++) {
+		frame->data[i] = vid_frame.data[i];
+		frame->linesize[i] = vid_frame.linesize[i];
+	}
+
+	return frame;
+}
+
+static void destroy_pooled_frame(struct obs_source_frame *frame)
+{
+	struct video_frame vid_frame;
+
+	if (!frame)
+		return;
+
+	for (size_t i = 0; i < MAX_AV_PLANES; i++) {
+		vid_frame.data[i] = frame->data[i];
+		vid_frame.linesize[i] = frame->linesize[i];
+	}
+
+	video_frame_free_pooled(&vid_frame, frame->format, frame->width, frame->height);
+	bfree(frame);
+}
+
+static inline void swap_buffers(struct obs_source_frame *a, struct obs_source_frame *b)
+{
+	for (size_t i = 0; i < MAX_AV_PLANES; i++) {
+		uint8_t *data = a->data[i];
+		a->data[i] = b->data[i];
+		b->data[i] = data;
+	}
+}
+
+static struct obs_source_frame *pool_get_frame(struct async_delay_data *filter, enum video_format format,
+					       uint32_t width, uint32_t height)
+{
+	for (size_t i = filter->frame_pool.num; i > 0; i--) {
+		struct obs_source_frame *frame = filter->frame_pool.array[i - 1];
+
+		if (frame->format == format && frame->width == width && frame->height == height) {
+			da_erase(filter->frame_pool, i - 1);
+			return frame;
+		}
+	}
+
+	return create_pooled_frame(format, width, height);
+}
+
+static void pool_put_frame(struct async_delay_data *filter, struct obs_source_frame *frame)
+{
+	if (!frame)
+		return;
+
+	if (filter->frame_pool.num == MAX_POOL_FRAMES) {
+		destroy_pooled_frame(filter->frame_pool.array[0]);
+		da_erase(filter->frame_pool, 0);
+	}
+
+	da_push_back(filter->frame_pool, &frame);
+}
+
+static size_t frame_size(const struct obs_source_frame *frame)
+{
+	struct frame_plane planes[MAX_AV_PLANES];
+	size_t count = frame_compress_get_planes(frame->format, frame->width, frame->height, planes);
+	size_t size = 0;
+
+	/* formats the codec does not know are assumed to have full height
+	 * planes, which overestimates subsampled ones */
+	for (size_t i = 0; i < MAX_AV_PLANES; i++)
+		size += (size_t)frame->linesize[i] * (count ? planes[i].height : frame->height);
+	return size;
+}
+
+/* ------------------------------------------------------------------------- */
+/* delayed frames                                                            */
+
+static struct delayed_frame *get_entry(struct async_delay_data *filter)
+{
+	struct delayed_frame *df;
+
+	if (filter->free_entries.num) {
+		df = filter->free_entries.array[filter->free_entries.num - 1];
+		da_pop_back(filter->free_entries);
+	} else {
+		df = bzalloc(sizeof(*df));
+	}
+
+	return df;
+}
+
+static void recycle_entry(struct async_delay_data *filter, struct delayed_frame *df)
+{
+	filter->memory_used -= df->bytes;
+
+	pool_put_frame(filter, df->raw);
+	pool_put_frame(filter, df->decoded);
+
+	uint8_t *data = df->data;
+	size_t capacity = df->capacity;
+
+	memset(df, 0, sizeof(*df));
+
+	if (filter->free_entries.num < MAX_FREE_ENTRIES) {
+		df->data = data;
+		df->capacity = capacity;
+		da_push_back(filter->free_entries, &df);
+	} else {
+		bfree(data);
+		bfree(df);
+	}
+}
+
 static void free_video_data(struct async_delay_data *filter, obs_source_t *parent)
 {
+	DARRAY(struct obs_source_frame *) release;
+	da_init(release);
+
+	pthread_mutex_lock(&filter->mutex);
+
 	while (filter->video_frames.size) {
-		struct obs_source_frame *frame;
+		struct delayed_frame *df;
 
-		deque_pop_front(&filter->video_frames, &frame, sizeof(struct obs_source_frame *));
-		obs_source_release_frame(parent, frame);
+		deque_pop_front(&filter->video_frames, &df, sizeof(df));
+
+		/* workers free what they are working on once they are done */
+		if (df->busy) {
+			df->discard = true;
+			continue;
+		}
+
+		if (df->source_frame)
+			da_push_back(release, &df->source_frame);
+		df->source_frame = NULL;
+		recycle_entry(filter, df);
+	}
+
+	while (filter->busy_jobs) {
+		pthread_mutex_unlock(&filter->mutex);
+		os_event_wait(filter->job_done);
+		pthread_mutex_lock(&filter->mutex);
+	}
+
+	pthread_mutex_unlock(&filter->mutex);
+
+	for (size_t i = 0; i < release.num; i++)
+		obs_source_release_frame(parent, release.array[i]);
+	da_free(release);
+}
+
+/* ------------------------------------------------------------------------- */
+/* workers                                                                   */
+
+static inline struct obs_source_frame *get_i420_frame(struct delay_worker *worker, uint32_t width, uint32_t height)
+{
+	struct obs_source_frame *frame = worker->i420;
+
+	if (!frame || frame->width != width || frame->height != height) {
+		obs_source_frame_destroy(frame);
+		frame = worker->i420 = obs_source_frame_create(VIDEO_FORMAT_I420, width, height);
 	}
+
+	return frame;
+}
+
+static void compress_frame(struct delay_worker *worker, struct delayed_frame *df)
+{
+	struct obs_source_frame *src = df->raw;
+	size_t bound = 0;
+	size_t size = 0;
+
+	if (df->stored_format == VIDEO_FORMAT_I420 && src->format != VIDEO_FORMAT_I420) {
+		struct obs_source_frame *i420 = get_i420_frame(worker, src->width, src->height);
+		frame_convert_to_i420(i420, src);
+		src = i420;
+	}
+
+	for (size_t i = 0; i < df->plane_count; i++)
+		bound += frame_compress_bound(&df->planes[i]);
+
+	if (worker->buffer_size < bound) {
+		worker->buffer = brealloc(worker->buffer, bound);
+		worker->buffer_size = bound;
+	}
+
+	for (size_t i = 0; i < df->plane_count; i++) {
+		df->plane_sizes[i] =
+			frame_compress_plane(worker->buffer + size, src->data[i], src->linesize[i], &df->planes[i]);
+		size += df->plane_sizes[i];
+	}
+
+	/* keep some slack so that buffers can be reused by later frames, but
+	 * never hold on to much more than the frame needs */
+	if (df->capacity < size || df->capacity > size + size / 4) {
+		df->capacity = size + size / 8;
+		bfree(df->data);
+		df->data = bmalloc(df->capacity);
+	}
+
+	memcpy(df->data, worker->buffer, size);
+}
+
+static bool decode_frame(struct delay_worker *worker, struct delayed_frame *df, struct obs_source_frame *dst)
+{
+	struct obs_source_frame *out = dst;
+	const uint8_t *data = df->data;
+
+	if (df->stored_format != dst->format)
+		out = get_i420_frame(worker, dst->width, dst->height);
+
+	for (size_t i = 0; i < df->plane_count; i++) {
+		if (!frame_decompress_plane(out->data[i], out->linesize[i], data, df->plane_sizes[i], &df->planes[i]))
+			return false;
+		data += df->plane_sizes[i];
+	}
+
+	if (out != dst)
+		frame_convert_from_i420(dst, out);
+	return true;
+}
+
+static struct delayed_frame *find_job(struct async_delay_data *filter)
+{
+	struct delayed_frame *compress = NULL;
+	size_t count = filter->video_frames.size / sizeof(struct delayed_frame *);
+
+	for (size_t i = 0; i < count; i++) {
+		struct delayed_frame *df =
+			*(struct delayed_frame **)deque_data(&filter->video_frames, i * sizeof(df));
+
+		if (df->busy)
+			continue;
+
+		/* frames that are due soon are decoded ahead of time */
+		if (i < DECODE_AHEAD && df->compressed && !df->decoded && !df->failed)
+			return df;
+		if (!compress && df->raw)
+			compress = df;
+	}
+
+	return compress;
+}
+
+static void *delay_worker_thread(void *data)
+{
+	struct delay_worker *worker = data;
+	struct async_delay_data *filter = worker->filter;
+
+	os_set_thread_name("async delay: worker");
+	bmem_set_thread_tag(filter->memory_tag);
+
+	while (os_sem_wait(filter->work_sem) == 0) {
+		if (os_atomic_load_bool(&filter->stop_workers))
+			break;
+
+		pthread_mutex_lock(&filter->mutex);
+
+		struct delayed_frame *df;
+		while (!os_atomic_load_bool(&filter->stop_workers) && (df = find_job(filter)) != NULL) {
+			struct obs_source_frame *dst = NULL;
+			bool decode = df->compressed;
+			bool success = true;
+
+			if (decode)
+				dst = pool_get_frame(filter, df->info.format, df->info.width, df->info.height);
+
+			df->busy = true;
+			filter->busy_jobs++;
+			pthread_mutex_unlock(&filter->mutex);
+
+			if (decode)
+				success = decode_frame(worker, df, dst);
+			else
+				compress_frame(worker, df);
+
+			pthread_mutex_lock(&filter->mutex);
+			df->busy = false;
+			filter->busy_jobs--;
+
+			if (decode && success) {
+				df->decoded = dst;
+				df->bytes += frame_size(dst);
+				filter->memory_used += frame_size(dst);
+			} else if (decode) {
+				warn("Failed to decode delayed frame");
+				pool_put_frame(filter, dst);
+				df->failed = true;
+			} else {
+				size_t raw_size = frame_size(df->raw);
+				pool_put_frame(filter, df->raw);
+				df->raw = NULL;
+				df->compressed = true;
+
+				filter->memory_used = filter->memory_used - raw_size + df->capacity;
+				df->bytes = df->bytes - raw_size + df->capacity;
+			}
+
+			if (df->discard)
+				recycle_entry(filter, df);
+
+			os_event_signal(filter->job_done);
+		}
+
+		pthread_mutex_unlock(&filter->mutex);
+	}
+
+	return NULL;
+}
+
+static void start_workers(struct async_delay_data *filter)
+{
+	int cores = os_get_logical_cores();
+	size_t count = cores > 2 ? (size_t)cores / 2 : 1;
+	if (count > MAX_WORKERS)
+		count = MAX_WORKERS;
+
+	os_atomic_set_bool(&filter->stop_workers, false);
+
+	for (size_t i = 0; i < count; i++) {
+		struct delay_worker *worker = &filter->workers[filter->worker_count];
+		worker->filter = filter;
+
+		if (pthread_create(&worker->thread, NULL, delay_worker_thread, worker) != 0)
+			break;
+		filter->worker_count++;
+	}
+}
+
+static void stop_workers(struct async_delay_data *filter)
+{
+	os_atomic_set_bool(&filter->stop_workers, true);
+
+	for (size_t i = 0; i < filter->worker_count; i++)
+		os_sem_post(filter->work_sem);
+
+	for (size_t i = 0; i < filter->worker_count; i++) {
+		struct delay_worker *worker = &filter->workers[i];
+
+		pthread_join(worker->thread, NULL);
+		obs_source_frame_destroy(worker->i420);
+		bfree(worker->buffer);
+		memset(worker, 0, sizeof(*worker));
+	}
+
+	filter->worker_count = 0;
 }
 
 #ifdef DELAY_AUDIO
@@ -80,14 +534,21 @@ static void async_delay_filter_update(void *data, obs_data_t *settings)
 	struct async_delay_data *filter = data;
 	uint64_t new_interval = (uint64_t)obs_data_get_int(settings, SETTING_DELAY_MS) * MSEC_TO_NSEC;
 
-	if (new_interval < filter->interval)
-		free_video_data(filter, obs_filter_get_parent(filter->context));
-
+	pthread_mutex_lock(&filter->mutex);
+	filter->new_storage = (enum delay_storage)obs_data_get_int(settings, SETTING_STORAGE);
+	filter->memory_limit = (uint64_t)obs_data_get_int(settings, SETTING_MEMORY_LIMIT) * 1024 * 1024;
 	filter->reset_audio = true;
 	filter->reset_video = true;
 	filter->interval = new_interval;
 	filter->video_delay_reached = false;
 	filter->audio_delay_reached = false;
+	pthread_mutex_unlock(&filter->mutex);
+}
+
+static void async_delay_filter_defaults(obs_data_t *settings)
+{
+	obs_data_set_default_int(settings, SETTING_STORAGE, STORAGE_FULL);
+	obs_data_set_default_int(settings, SETTING_MEMORY_LIMIT, 0);
 }
 
 static void *async_delay_filter_create(obs_data_t *settings, obs_source_t *context)
@@ -96,23 +557,65 @@ static void *async_delay_filter_create(obs_data_t *settings, obs_source_t *conte
 	struct obs_audio_info oai;
 
 	filter->context = context;
+	filter->memory_tag = bmem_get_tag("async-delay");
+
+	if (pthread_mutex_init(&filter->mutex, NULL) != 0)
+		goto fail_mutex;
+	if (os_sem_init(&filter->work_sem, 0) != 0)
+		goto fail_sem;
+	if (os_event_init(&filter->job_done, OS_EVENT_TYPE_AUTO) != 0)
+		goto fail_event;
+
 	async_delay_filter_update(filter, settings);
 
 	obs_get_audio_info(&oai);
 	filter->samplerate = oai.samples_per_sec;
 
 	return filter;
+
+fail_event:
+	os_sem_destroy(filter->work_sem);
+fail_sem:
+	pthread_mutex_destroy(&filter->mutex);
+fail_mutex:
+	bfree(filter);
+	return NULL;
 }
 
 static void async_delay_filter_destroy(void *data)
 {
 	struct async_delay_data *filter = data;
 
+	stop_workers(filter);
+	obs_source_frame_destroy(filter->scratch.i420);
+	bfree(filter->scratch.buffer);
+
+	/* source frames were already handed back in filter_remove */
+	while (filter->video_frames.size) {
+		struct delayed_frame *df;
+
+		deque_pop_front(&filter->video_frames, &df, sizeof(df));
+		df->source_frame = NULL;
+		recycle_entry(filter, df);
+	}
+
+	for (size_t i = 0; i < filter->free_entries.num; i++) {
+		bfree(filter->free_entries.array[i]->data);
+		bfree(filter->free_entries.array[i]);
+	}
+	for (size_t i = 0; i < filter->frame_pool.num; i++)
+		destroy_pooled_frame(filter->frame_pool.array[i]);
+
+	da_free(filter->free_entries);
+	da_free(filter->frame_pool);
 	deque_free(&filter->video_frames);
 #ifdef DELAY_AUDIO
 	free_audio_packet(&filter->audio_output);
 	deque_free(&filter->audio_frames);
 #endif
+	os_event_destroy(filter->job_done);
+	os_sem_destroy(filter->work_sem);
+	pthread_mutex_destroy(&filter->mutex);
 	bfree(data);
 }
 
@@ -123,6 +626,15 @@ static obs_properties_t *async_delay_filter_properties(void *data)
 	obs_property_t *p = obs_properties_add_int(props, SETTING_DELAY_MS, TEXT_DELAY_MS, 0, 20000, 1);
 	obs_property_int_set_suffix(p, " ms");
 
+	p = obs_properties_add_list(props, SETTING_STORAGE, TEXT_STORAGE, OBS_COMBO_TYPE_LIST, OBS_COMBO_FORMAT_INT);
+	obs_property_list_add_int(p, TEXT_STORAGE_FULL, STORAGE_FULL);
+	obs_property_list_add_int(p, TEXT_STORAGE_LOSSLESS, STORAGE_LOSSLESS);
+	obs_property_list_add_int(p, TEXT_STORAGE_SUBSAMPLED, STORAGE_SUBSAMPLED);
+
+	p = obs_properties_add_int(props, SETTING_MEMORY_LIMIT, TEXT_MEMORY_LIMIT, 0, 65536, 64);
+	obs_property_int_set_suffix(p, " MB");
+	obs_property_set_long_description(p, TEXT_MEMORY_LIMIT_DESC);
+
 	UNUSED_PARAMETER(data);
 	return props;
 }
@@ -146,33 +658,193 @@ static inline bool is_timestamp_jump(uint64_t ts, uint64_t prev_ts)
 	return ts < prev_ts || (ts - prev_ts) > SEC_TO_NSEC;
 }
 
-static struct obs_source_frame *async_delay_filter_video(void *data, struct obs_source_frame *frame)
+static inline void copy_frame_info(struct obs_source_frame *dst, const struct obs_source_frame *src)
+{
+	dst->timestamp = src->timestamp;
+	memcpy(dst->color_matrix, src->color_matrix, sizeof(dst->color_matrix));
+	dst->full_range = src->full_range;
+	dst->max_luminance = src->max_luminance;
+	memcpy(dst->color_range_min, src->color_range_min, sizeof(dst->color_range_min));
+	memcpy(dst->color_range_max, src->color_range_max, sizeof(dst->color_range_max));
+	dst->flip = src->flip;
+	dst->flags = src->flags;
+	dst->trc = src->trc;
+}
+
+/* stores the incoming frame, returns true if the frame itself was queued */
+static bool push_frame(struct async_delay_data *filter, struct obs_source_frame *frame)
+{
+	size_t size = frame_size(frame);
+
+	if (filter->memory_limit && filter->memory_used + size > filter->memory_limit) {
+		if (!filter->limit_reached)
+			warn("Memory limit of %" PRIu64 " MB reached, dropping frames",
+			     filter->memory_limit / 1024 / 1024);
+		filter->limit_reached = true;
+		return false;
+	}
+
+	struct delayed_frame *df = get_entry(filter);
+	df->info = *frame;
+	memset(df->info.data, 0, sizeof(df->info.data));
+	df->bytes = size;
+	filter->memory_used += size;
+
+	df->stored_format = frame->format;
+	if (filter->storage == STORAGE_SUBSAMPLED && frame->width >= 2) {
+		switch (frame->format) {
+		case VIDEO_FORMAT_I422:
+		case VIDEO_FORMAT_I444:
+		case VIDEO_FORMAT_YVYU:
+		case VIDEO_FORMAT_YUY2:
+		case VIDEO_FORMAT_UYVY:
+			df->stored_format = VIDEO_FORMAT_I420;
+			break;
+		default:
+			break;
+		}
+	}
+
+	if (filter->storage != STORAGE_FULL)
+		df->plane_count =
+			frame_compress_get_planes(df->stored_format, frame->width, frame->height, df->planes);
+
+	if (df->plane_count) {
+		/* take the picture and leave the frame with a spare buffer */
+		df->raw = pool_get_frame(filter, frame->format, frame->width, frame->height);
+		if (same_layout(df->raw, frame)) {
+			swap_buffers(df->raw, frame);
+		} else {
+			pool_put_frame(filter, df->raw);
+			df->raw = NULL;
+			df->plane_count = 0;
+		}
+	}
+
+	if (!df->plane_count)
+		df->source_frame = frame;
+
+	deque_push_back(&filter->video_frames, &df, sizeof(df));
+	return df->source_frame == frame;
+}
+
+static struct delayed_frame *pop_frame(struct async_delay_data *filter, uint64_t ts)
+{
+	struct delayed_frame *df;
+
+	if (!filter->video_frames.size)
+		return NULL;
+
+	deque_peek_front(&filter->video_frames, &df, sizeof(df));
+
+	/* once frames are being dropped, only output frames that are due so
+	 * that the delay is kept at the cost of the frame rate */
+	uint64_t cur_interval = ts - df->info.timestamp;
+	if ((!filter->video_delay_reached || filter->limit_reached) && cur_interval < filter->interval)
+		return NULL;
+
+	/* a worker may still be compressing or decoding the frame */
+	while (df->busy) {
+		pthread_mutex_unlock(&filter->mutex);
+		os_event_wait(filter->job_done);
+		pthread_mutex_lock(&filter->mutex);
+	}
+
+	deque_pop_front(&filter->video_frames, NULL, sizeof(df));
+	filter->video_delay_reached = true;
+	return df;
+}
+
+/* returns the frame to output, which is either the source frame of the
+ * entry, or the incoming frame filled with the delayed picture.  entries
+ * that still have to be decoded are returned in *decode. */
+static struct obs_source_frame *get_output(struct async_delay_data *filter, struct delayed_frame *df,
+					   struct obs_source_frame *frame, struct delayed_frame **decode)
+{
+	struct obs_source_frame *picture = df->decoded ? df->decoded : df->raw;
+
+	if (df->source_frame) {
+		struct obs_source_frame *output = df->source_frame;
+		df->source_frame = NULL;
+		recycle_entry(filter, df);
+		return output;
+	}
+
+	if (picture && same_layout(picture, frame)) {
+		swap_buffers(picture, frame);
+		copy_frame_info(frame, &df->info);
+		recycle_entry(filter, df);
+		return frame;
+	}
+
+	/* the workers fell behind, decode it on this thread */
+	if (!picture && df->compressed && !df->failed && same_layout(&df->info, frame)) {
+		*decode = df;
+		return frame;
+	}
+
+	recycle_entry(filter, df);
+	return NULL;
+}
+
+static struct obs_source_frame *delay_video(struct async_delay_data *filter, struct obs_source_frame *frame)
 {
-	struct async_delay_data *filter = data;
 	obs_source_t *parent = obs_filter_get_parent(filter->context);
-	struct obs_source_frame *output;
-	uint64_t cur_interval;
+	struct obs_source_frame *output = NULL;
+	struct delayed_frame *decode = NULL;
+	struct delayed_frame *df;
+	bool queued;
 
 	if (filter->reset_video || is_timestamp_jump(frame->timestamp, filter->last_video_ts)) {
 		free_video_data(filter, parent);
+
+		pthread_mutex_lock(&filter->mutex);
+		filter->storage = filter->new_storage;
+		filter->limit_reached = false;
 		filter->video_delay_reached = false;
 		filter->reset_video = false;
+		pthread_mutex_unlock(&filter->mutex);
+
+		if (filter->storage != STORAGE_FULL && !filter->worker_count)
+			start_workers(filter);
 	}
 
 	filter->last_video_ts = frame->timestamp;
 
-	deque_push_back(&filter->video_frames, &frame, sizeof(struct obs_source_frame *));
-	deque_peek_front(&filter->video_frames, &output, sizeof(struct obs_source_frame *));
+	pthread_mutex_lock(&filter->mutex);
+	queued = push_frame(filter, frame);
+	df = pop_frame(filter, frame->timestamp);
+	if (df)
+		output = get_output(filter, df, frame, &decode);
+	pthread_mutex_unlock(&filter->mutex);
+
+	if (filter->worker_count)
+		os_sem_post(filter->work_sem);
+
+	if (decode) {
+		if (decode_frame(&filter->scratch, decode, frame))
+			copy_frame_info(frame, &decode->info);
+		else
+			output = NULL;
+
+		pthread_mutex_lock(&filter->mutex);
+		recycle_entry(filter, decode);
+		pthread_mutex_unlock(&filter->mutex);
+	}
 
-	cur_interval = frame->timestamp - output->timestamp;
-	if (!filter->video_delay_reached && cur_interval < filter->interval)
-		return NULL;
+	if (output != frame && !queued)
+		obs_source_release_frame(parent, frame);
 
-	deque_pop_front(&filter->video_frames, NULL, sizeof(struct obs_source_frame *));
+	return output;
+}
 
-	if (!filter->video_delay_reached)
-		filter->video_delay_reached = true;
+static struct obs_source_frame *async_delay_filter_video(void *data, struct obs_source_frame *frame)
+{
+	struct async_delay_data *filter = data;
+	int prev_tag = bmem_set_thread_tag(filter->memory_tag);
+	struct obs_source_frame *output = delay_video(filter, frame);
 
+	bmem_set_thread_tag(prev_tag);
 	return output;
 }
 
@@ -230,6 +902,7 @@ struct obs_source_info async_delay_filter = {
 	.create = async_delay_filter_create,
 	.destroy = async_delay_filter_destroy,
 	.update = async_delay_filter_update,
+	.get_defaults = async_delay_filter_defaults,
 	.get_properties = async_delay_filter_properties,
 	.filter_video = async_delay_filter_video,
 #ifdef DELAY_AUDIO
@@ -0,0 +1,509 @@
+/******************************************************************************
+    Copyright (C) 2026 by OBS Project contributors
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+******************************************************************************/
+
+#include <string.h>
+#include <util/sse-intrin.h>
+#include "frame-compress.h"
+
+#define BLOCK_SIZE 16
+#define HALF(size) (((size) + 1) / 2)
+
+enum plane_method {
+	PLANE_RAW,
+	PLANE_PACKED,
+};
+
+size_t frame_compress_get_planes(enum video_format format, uint32_t width, uint32_t height,
+				 struct frame_plane planes[MAX_AV_PLANES])
+{
+	memset(planes, 0, sizeof(struct frame_plane) * MAX_AV_PLANES);
+
+	/* row sizes match what obs_source_frame_init allocates */
+	switch (format) {
+	case VIDEO_FORMAT_I420:
+		planes[0] = (struct frame_plane){width, height, 1};
+		planes[1] = (struct frame_plane){HALF(width), HALF(height), 1};
+		planes[2] = planes[1];
+		return 3;
+	case VIDEO_FORMAT_NV12:
+		planes[0] = (struct frame_plane){width, height, 1};
+		planes[1] = (struct frame_plane){width, HALF(height), 2};
+		return 2;
+	case VIDEO_FORMAT_I422:
+		planes[0] = (struct frame_plane){width, height, 1};
+		planes[1] = (struct frame_plane){HALF(width), height, 1};
+		planes[2] = planes[1];
+		return 3;
+	case VIDEO_FORMAT_I444:
+		planes[0] = (struct frame_plane){width, height, 1};
+		planes[1] = planes[0];
+		planes[2] = planes[0];
+		return 3;
+	case VIDEO_FORMAT_YVYU:
+	case VIDEO_FORMAT_YUY2:
+	case VIDEO_FORMAT_UYVY:
+		planes[0] = (struct frame_plane){width * 2, height, 4};
+		return 1;
+	case VIDEO_FORMAT_Y800:
+		planes[0] = (struct frame_plane){width, height, 1};
+		return 1;
+	case VIDEO_FORMAT_RGBA:
+	case VIDEO_FORMAT_BGRA:
+	case VIDEO_FORMAT_BGRX:
+		planes[0] = (struct frame_plane){width * 4, height, 4};
+		return 1;
+	case VIDEO_FORMAT_BGR3:
+		planes[0] = (struct frame_plane){width * 3, height, 3};
+		return 1;
+	default:
+		return 0;
+	}
+}
+
+size_t frame_compress_bound(const struct frame_plane *plane)
+{
+	size_t samples = (size_t)plane->width * plane->height;
+	size_t blocks = (samples + BLOCK_SIZE - 1) / BLOCK_SIZE;
+
+	/* method byte, then a width byte and up to one byte per sample for
+	 * every block.  blocks do not straddle rows. */
+	return 1 + blocks * (BLOCK_SIZE + 1) + (size_t)plane->height * (BLOCK_SIZE + 1);
+}
+
+/* ------------------------------------------------------------------------- */
+
+/* median edge detector, written as a clamp so that it vectorizes */
+static inline uint8_t predict(uint8_t left, uint8_t top, uint8_t top_left)
+{
+	int max = left > top ? left : top;
+	int min = left > top ? top : left;
+	int grad = (int)left + (int)top - (int)top_left;
+
+	grad = grad < min ? min : grad;
+	return (uint8_t)(grad > max ? max : grad);
+}
+
+static inline uint8_t zigzag(uint8_t diff)
+{
+	/* shift the unsigned value, left shifts of negative values are
+	 * undefined; matches zigzag16() */
+	int8_t val = (int8_t)diff;
+	return (uint8_t)(((uint8_t)val << 1) ^ (uint8_t)(val >> 7));
+}
+
+static inline uint8_t unzigzag(uint8_t val)
+{
+	return (uint8_t)((val >> 1) ^ -(int)(val & 1));
+}
+
+/* rows are coded in chunks so that blocks never straddle two rows */
+#define CHUNK_SIZE 1024
+
+/* blocks are stored as a width byte followed by one 16-bit mask per bit,
+ * lowest bit first, which lets both directions work on whole vectors */
+static uint8_t *pack_block(uint8_t *out, const uint8_t *block)
+{
+	__m128i val = _mm_loadu_si128((const __m128i *)block);
+	__m128i any = _mm_or_si128(val, _mm_srli_si128(val, 8));
+	any = _mm_or_si128(any, _mm_srli_si128(any, 4));
+	any = _mm_or_si128(any, _mm_srli_si128(any, 2));
+	any = _mm_or_si128(any, _mm_srli_si128(any, 1));
+
+	uint32_t mask = (uint32_t)_mm_cvtsi128_si32(any) & 0xFF;
+	uint32_t bits = 0;
+	while (mask >> bits)
+		bits++;
+
+	*out++ = (uint8_t)bits;
+
+	for (uint32_t bit = 0; bit < bits; bit++) {
+		int plane = _mm_movemask_epi8(_mm_sll_epi16(val, _mm_cvtsi32_si128((int)(7 - bit))));
+		*out++ = (uint8_t)plane;
+		*out++ = (uint8_t)(plane >> 8);
+	}
+
+	return out;
+}
+
+static const uint8_t *unpack_block(uint8_t *block, const uint8_t *in, const uint8_t *end)
+{
+	if (in >= end)
+		return NULL;
+
+	uint32_t bits = *in++;
+	if (bits > 8 || (size_t)(end - in) < bits * 2)
+		return NULL;
+
+	const __m128i select = _mm_set_epi8((char)0x80, 0x40, 0x20, 0x10, 0x08, 0x04, 0x02, 0x01, (char)0x80, 0x40,
+					    0x20, 0x10, 0x08, 0x04, 0x02, 0x01);
+	__m128i val = _mm_setzero_si128();
+
+	for (uint32_t bit = 0; bit < bits; bit++) {
+		__m128i plane = _mm_set_epi64x((long long)(in[1] * 0x0101010101010101ULL),
+					       (long long)(in[0] * 0x0101010101010101ULL));
+		__m128i set = _mm_cmpeq_epi8(_mm_and_si128(plane, select), select);
+		val = _mm_or_si128(val, _mm_and_si128(set, _mm_set1_epi8((char)(1 << bit))));
+		in += 2;
+	}
+
+	_mm_storeu_si128((__m128i *)block, val);
+	return in;
+}
+
+static inline __m128i zigzag16(__m128i diff)
+{
+	__m128i sign = _mm_cmpgt_epi8(_mm_setzero_si128(), diff);
+	return _mm_xor_si128(_mm_add_epi8(diff, diff), sign);
+}
+
+static inline __m128i select16(__m128i mask, __m128i a, __m128i b)
+{
+	return _mm_or_si128(_mm_and_si128(mask, a), _mm_andnot_si128(mask, b));
+}
+
+/* same as predict, the gradient only needs to wrap when it is not used */
+static inline __m128i predict16(__m128i left, __m128i top, __m128i top_left)
+{
+	__m128i min = _mm_min_epu8(left, top);
+	__m128i max = _mm_max_epu8(left, top);
+	__m128i grad = _mm_sub_epi8(_mm_add_epi8(left, top), top_left);
+	__m128i above = _mm_cmpeq_epi8(_mm_max_epu8(top_left, max), top_left);
+	__m128i below = _mm_cmpeq_epi8(_mm_min_epu8(top_left, min), top_left);
+
+	return select16(above, min, select16(below, max, grad));
+}
+
+static void get_residuals(uint8_t *res, const uint8_t *row, const uint8_t *top, uint32_t x, uint32_t count,
+			  uint32_t step)
+{
+	uint32_t i = 0;
+
+	for (; i < count && x + i < step; i++)
+		res[i] = zigzag(row[x + i] - (top ? top[x + i] : 0));
+
+	if (top) {
+		for (; i + 16 <= count; i += 16) {
+			const uint32_t pos = x + i;
+			__m128i cur = _mm_loadu_si128((const __m128i *)(row + pos));
+			__m128i pred = predict16(_mm_loadu_si128((const __m128i *)(row + pos - step)),
+						 _mm_loadu_si128((const __m128i *)(top + pos)),
+						 _mm_loadu_si128((const __m128i *)(top + pos - step)));
+			_mm_storeu_si128((__m128i *)(res + i), zigzag16(_mm_sub_epi8(cur, pred)));
+		}
+		for (; i < count; i++) {
+			const uint32_t pos = x + i;
+			res[i] = zigzag(row[pos] - predict(row[pos - step], top[pos], top[pos - step]));
+		}
+	} else {
+		for (; i + 16 <= count; i += 16) {
+			const uint32_t pos = x + i;
+			__m128i cur = _mm_loadu_si128((const __m128i *)(row + pos));
+			__m128i left = _mm_loadu_si128((const __m128i *)(row + pos - step));
+			_mm_storeu_si128((__m128i *)(res + i), zigzag16(_mm_sub_epi8(cur, left)));
+		}
+		for (; i < count; i++)
+			res[i] = zigzag(row[x + i] - row[x + i - step]);
+	}
+}
+
+size_t frame_compress_plane(uint8_t *out, const uint8_t *in, uint32_t linesize, const struct frame_plane *plane)
+{
+	const uint32_t width = plane->width;
+	const uint32_t step = plane->step < width ? plane->step : width;
+	uint8_t res[CHUNK_SIZE];
+	uint8_t *pos = out + 1;
+
+	for (uint32_t y = 0; y < plane->height; y++) {
+		const uint8_t *row = in + (size_t)y * linesize;
+		const uint8_t *top = y ? row - linesize : NULL;
+
+		for (uint32_t x = 0; x < width; x += CHUNK_SIZE) {
+			uint32_t count = width - x < CHUNK_SIZE ? width - x : CHUNK_SIZE;
+			uint32_t padded = (count + BLOCK_SIZE - 1) & ~(uint32_t)(BLOCK_SIZE - 1);
+
+			get_residuals(res, row, top, x, count, step);
+			memset(res + count, 0, padded - count);
+
+			for (uint32_t i = 0; i < padded; i += BLOCK_SIZE)
+				pos = pack_block(pos, res + i);
+		}
+	}
+
+	size_t size = (size_t)(pos - out);
+	size_t raw_size = (size_t)width * plane->height;
+
+	/* noise can make the packed data larger than the plane itself */
+	if (size > raw_size + 1) {
+		out[0] = PLANE_RAW;
+		for (uint32_t y = 0; y < plane->height; y++)
+			memcpy(out + 1 + (size_t)y * width, in + (size_t)y * linesize, width);
+		return raw_size + 1;
+	}
+
+	out[0] = PLANE_PACKED;
+	return size;
+}
+
+/* ------------------------------------------------------------------------- */
+
+static void apply_residuals(uint8_t *row, const uint8_t *top, const uint8_t *res, uint32_t x, uint32_t count,
+			    uint32_t step)
+{
+	uint32_t i = 0;
+
+	for (; i < count && x + i < step; i++)
+		row[x + i] = (uint8_t)(unzigzag(res[i]) + (top ? top[x + i] : 0));
+
+	if (top) {
+		for (; i < count; i++) {
+			uint32_t pos = x + i;
+			row[pos] = (uint8_t)(unzigzag(res[i]) + predict(row[pos - step], top[pos], top[pos - step]));
+		}
+	} else {
+		for (; i < count; i++)
+			row[x + i] = (uint8_t)(unzigzag(res[i]) + row[x + i - step]);
+	}
+}
+
+bool frame_decompress_plane(uint8_t *out, uint32_t linesize, const uint8_t *in, size_t size,
+			    const struct frame_plane *plane)
+{
+	const uint32_t width = plane->width;
+	const uint32_t step = plane->step < width ? plane->step : width;
+	const uint8_t *end = in + size;
+	uint8_t res[CHUNK_SIZE];
+
+	if (!size)
+		return false;
+
+	if (in[0] == PLANE_RAW) {
+		if (size - 1 < (size_t)width * plane->height)
+			return false;
+
+		for (uint32_t y = 0; y < plane->height; y++)
+			memcpy(out + (size_t)y * linesize, in + 1 + (size_t)y * width, width);
+		return true;
+	}
+
+	if (in[0] != PLANE_PACKED)
+		return false;
+
+	in++;
+
+	for (uint32_t y = 0; y < plane->height; y++) {
+		uint8_t *row = out + (size_t)y * linesize;
+		const uint8_t *top = y ? row - linesize : NULL;
+
+		for (uint32_t x = 0; x < width; x += CHUNK_SIZE) {
+			uint32_t count = width - x < CHUNK_SIZE ? width - x : CHUNK_SIZE;
+
+			for (uint32_t i = 0; i < count; i += BLOCK_SIZE) {
+				in = unpack_block(res + i, in, end);
+				if (!in)
+					return false;
+			}
+
+			apply_residuals(row, top, res, x, count, step);
+		}
+	}
+
+	return true;
+}
+
+/* ------------------------------------------------------------------------- */
+
+static inline uint8_t avg2(uint8_t a, uint8_t b)
+{
+	return (uint8_t)(((uint32_t)a + b + 1) >> 1);
+}
+
+static inline uint8_t avg4(uint8_t a, uint8_t b, uint8_t c, uint8_t d)
+{
+	return (uint8_t)(((uint32_t)a + b + c + d + 2) >> 2);
+}
+
+static void copy_plane(uint8_t *dst, uint32_t dst_linesize, const uint8_t *src, uint32_t src_linesize, uint32_t width,
+		       uint32_t height)
+{
+	for (uint32_t y = 0; y < height; y++)
+		memcpy(dst + (size_t)y * dst_linesize, src + (size_t)y * src_linesize, width);
+}
+
+/* halves the vertical resolution of a chroma plane, and optionally the
+ * horizontal resolution as well */
+static void downsample_chroma(uint8_t *dst, uint32_t dst_linesize, const uint8_t *src, uint32_t src_linesize,
+			      uint32_t src_width, uint32_t src_height, bool horizontal)
+{
+	uint32_t dst_width = horizontal ? HALF(src_width) : src_width;
+
+	for (uint32_t y = 0; y < HALF(src_height); y++) {
+		const uint8_t *row0 = src + (size_t)(y * 2) * src_linesize;
+		const uint8_t *row1 = y * 2 + 1 < src_height ? row0 + src_linesize : row0;
+		uint8_t *out = dst + (size_t)y * dst_linesize;
+
+		if (!horizontal) {
+			for (uint32_t x = 0; x < dst_width; x++)
+				out[x] = avg2(row0[x], row1[x]);
+			continue;
+		}
+
+		for (uint32_t x = 0; x < dst_width; x++) {
+			uint32_t x0 = x * 2;
+			uint32_t x1 = x0 + 1 < src_width ? x0 + 1 : x0;
+			out[x] = avg4(row0[x0], row0[x1], row1[x0], row1[x1]);
+		}
+	}
+}
+
+static void packed_422_to_i420(struct obs_source_frame *dst, const struct obs_source_frame *src, uint32_t y_offset,
+			       uint32_t u_offset, uint32_t v_offset)
+{
+	const uint32_t width = src->width;
+	const uint32_t height = src->height;
+	const uint32_t pairs = width / 2 ? width / 2 : 1;
+
+	for (uint32_t y = 0; y < height; y++) {
+		const uint8_t *row = src->data[0] + (size_t)y * src->linesize[0];
+		uint8_t *out = dst->data[0] + (size_t)y * dst->linesize[0];
+
+		for (uint32_t x = 0; x < width; x++)
+			out[x] = row[(x / 2) * 4 + y_offset + (x & 1) * 2];
+	}
+
+	for (uint32_t y = 0; y < HALF(height); y++) {
+		const uint8_t *row0 = src->data[0] + (size_t)(y * 2) * src->linesize[0];
+		const uint8_t *row1 = y * 2 + 1 < height ? row0 + src->linesize[0] : row0;
+		uint8_t *out_u = dst->data[1] + (size_t)y * dst->linesize[1];
+		uint8_t *out_v = dst->data[2] + (size_t)y * dst->linesize[2];
+
+		for (uint32_t x = 0; x < HALF(width); x++) {
+			uint32_t pair = (x < pairs ? x : pairs - 1) * 4;
+			out_u[x] = avg2(row0[pair + u_offset], row1[pair + u_offset]);
+			out_v[x] = avg2(row0[pair + v_offset], row1[pair + v_offset]);
+		}
+	}
+}
+
+bool frame_convert_to_i420(struct obs_source_frame *dst, const struct obs_source_frame *src)
+{
+	const uint32_t width = src->width;
+	const uint32_t height = src->height;
+
+	if (dst->format != VIDEO_FORMAT_I420 || dst->width != width || dst->height != height || width < 2)
+		return false;
+
+	switch (src->format) {
+	case VIDEO_FORMAT_I422:
+		copy_plane(dst->data[0], dst->linesize[0], src->data[0], src->linesize[0], width, height);
+		for (size_t i = 1; i < 3; i++)
+			downsample_chroma(dst->data[i], dst->linesize[i], src->data[i], src->linesize[i], HALF(width),
+					  height, false);
+		return true;
+	case VIDEO_FORMAT_I444:
+		copy_plane(dst->data[0], dst->linesize[0], src->data[0], src->linesize[0], width, height);
+		for (size_t i = 1; i < 3; i++)
+			downsample_chroma(dst->data[i], dst->linesize[i], src->data[i], src->linesize[i], width,
+					  height, true);
+		return true;
+	case VIDEO_FORMAT_YUY2:
+		packed_422_to_i420(dst, src, 0, 1, 3);
+		return true;
+	case VIDEO_FORMAT_YVYU:
+		packed_422_to_i420(dst, src, 0, 3, 1);
+		return true;
+	case VIDEO_FORMAT_UYVY:
+		packed_422_to_i420(dst, src, 1, 0, 2);
+		return true;
+	default:
+		return false;
+	}
+}
+
+/* ------------------------------------------------------------------------- */
+
+static void upsample_chroma(uint8_t *dst, uint32_t dst_linesize, uint32_t dst_width, uint32_t dst_height,
+			    const uint8_t *src, uint32_t src_linesize, bool horizontal)
+{
+	for (uint32_t y = 0; y < dst_height; y++) {
+		const uint8_t *row = src + (size_t)(y / 2) * src_linesize;
+		uint8_t *out = dst + (size_t)y * dst_linesize;
+
+		if (!horizontal) {
+			memcpy(out, row, dst_width);
+			continue;
+		}
+
+		for (uint32_t x = 0; x < dst_width; x++)
+			out[x] = row[x / 2];
+	}
+}
+
+static void i420_to_packed_422(struct obs_source_frame *dst, const struct obs_source_frame *src, uint32_t y_offset,
+			       uint32_t u_offset, uint32_t v_offset)
+{
+	const uint32_t width = src->width;
+	const uint32_t pairs = width / 2;
+
+	for (uint32_t y = 0; y < src->height; y++) {
+		const uint8_t *luma = src->data[0] + (size_t)y * src->linesize[0];
+		const uint8_t *u = src->data[1] + (size_t)(y / 2) * src->linesize[1];
+		const uint8_t *v = src->data[2] + (size_t)(y / 2) * src->linesize[2];
+		uint8_t *out = dst->data[0] + (size_t)y * dst->linesize[0];
+
+		for (uint32_t x = 0; x < pairs; x++) {
+			out[x * 4 + y_offset] = luma[x * 2];
+			out[x * 4 + y_offset + 2] = luma[x * 2 + 1];
+			out[x * 4 + u_offset] = u[x];
+			out[x * 4 + v_offset] = v[x];
+		}
+	}
+}
+
+bool frame_convert_from_i420(struct obs_source_frame *dst, const struct obs_source_frame *src)
+{
+	const uint32_t width = src->width;
+	const uint32_t height = src->height;
+
+	if (src->format != VIDEO_FORMAT_I420 || dst->width != width || dst->height != height || width < 2)
+		return false;
+
+	switch (dst->format) {
+	case VIDEO_FORMAT_I422:
+		copy_plane(dst->data[0], dst->linesize[0], src->data[0], src->linesize[0], width, height);
+		for (size_t i = 1; i < 3; i++)
+			upsample_chroma(dst->data[i], dst->linesize[i], HALF(width), height, src->data[i],
+					src->linesize[i], false);
+		return true;
+	case VIDEO_FORMAT_I444:
+		copy_plane(dst->data[0], dst->linesize[0], src->data[0], src->linesize[0], width, height);
+		for (size_t i = 1; i < 3; i++)
+			upsample_chroma(dst->data[i], dst->linesize[i], width, height, src->data[i], src->linesize[i],
+					true);
+		return true;
+	case VIDEO_FORMAT_YUY2:
+		i420_to_packed_422(dst, src, 0, 1, 3);
+		return true;
+	case VIDEO_FORMAT_YVYU:
+		i420_to_packed_422(dst, src, 0, 3, 1);
+		return true;
+	case VIDEO_FORMAT_UYVY:
+		i420_to_packed_422(dst, src, 1, 0, 2);
+		return true;
+	default:
+		return false;
+	}
+}
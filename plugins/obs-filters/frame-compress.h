@@ -0,0 +1,52 @@
+/******************************************************************************
+    Copyright (C) 2026 by OBS Project contributors
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+******************************************************************************/
+
+#pragma once
+
+#include <obs.h>
+
+/* Fast lossless intra-frame coding used to keep long video delays in memory.
+ *
+ * Each plane is predicted with the median edge detector used by LOCO-I, the
+ * residuals are zigzag mapped and bit packed in blocks of 16 samples.  There
+ * is no entropy coding, which keeps both directions at several hundred
+ * megabytes per second on a single core. */
+
+struct frame_plane {
+	uint32_t width; /* bytes per row */
+	uint32_t height;
+	uint32_t step; /* distance between neighbouring samples of a component */
+};
+
+/* returns the number of planes, or 0 if the format is not supported */
+extern size_t frame_compress_get_planes(enum video_format format, uint32_t width, uint32_t height,
+					struct frame_plane planes[MAX_AV_PLANES]);
+
+extern size_t frame_compress_bound(const struct frame_plane *plane);
+
+/* out must hold at least frame_compress_bound bytes, returns the size used */
+extern size_t frame_compress_plane(uint8_t *out, const uint8_t *in, uint32_t linesize,
+				   const struct frame_plane *plane);
+extern bool frame_decompress_plane(uint8_t *out, uint32_t linesize, const uint8_t *in, size_t size,
+				   const struct frame_plane *plane);
+
+/* converts 4:2:2 and 4:4:4 8-bit YUV to I420, dst must be an I420 frame of
+ * the same size.  returns false for any other format. */
+extern bool frame_convert_to_i420(struct obs_source_frame *dst, const struct obs_source_frame *src);
+
+/* the reverse of frame_convert_to_i420, chroma samples are duplicated */
+extern bool frame_convert_from_i420(struct obs_source_frame *dst, const struct obs_source_frame *src);
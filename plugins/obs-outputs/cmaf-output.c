@@ -0,0 +1,772 @@
+/******************************************************************************
+    Copyright (C) 2026 by OBS Project contributors
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+******************************************************************************/
+
+/* Segments the stream into CMAF (fragmented MP4) init and media segments
+ * with the MP4 muxer, writes the HLS playlist (with LL-HLS partial segments)
+ * and optionally a DASH manifest, and hands everything to a cmaf_writer on a
+ * separate thread so that slow uploads never block the packet callback. */
+
+#include "mp4-mux.h"
+#include "cmaf-writer.h"
+
+#include <inttypes.h>
+#include <time.h>
+
+#include <obs-avc.h>
+#include <obs-module.h>
+#include <util/array-serializer.h>
+#include <util/deque.h>
+#include <util/dstr.h>
+#include <util/platform.h>
+#include <util/threading.h>
+
+#define do_log(level, format, ...) \
+	blog(level, "[cmaf output: '%s'] " format, obs_output_get_name(out->output), ##__VA_ARGS__)
+
+#define warn(format, ...) do_log(LOG_WARNING, format, ##__VA_ARGS__)
+#define info(format, ...) do_log(LOG_INFO, format, ##__VA_ARGS__)
+
+#define PLAYLIST_NAME "playlist.m3u8"
+#define MANIFEST_NAME "manifest.mpd"
+#define INIT_NAME "init.mp4"
+
+/* Partial segments are only listed for the most recent segments, older ones
+ * are played back as full segments */
+#define PART_SEGMENTS 2
+
+/* Keyframes placed slightly before the target duration still start a new
+ * segment instead of doubling its length */
+#define SEGMENT_TOLERANCE_PERCENT 90
+
+struct cmaf_part {
+	int64_t duration_usec;
+	bool independent;
+};
+
+struct cmaf_segment {
+	uint32_t number;
+	int64_t start_usec;
+	int64_t duration_usec;
+	DARRAY(struct cmaf_part) parts;
+};
+
+enum cmaf_job_type {
+	CMAF_JOB_PUT,
+	CMAF_JOB_REMOVE,
+};
+
+struct cmaf_job {
+	enum cmaf_job_type type;
+	char *name;
+	uint8_t *data;
+	size_t size;
+};
+
+struct cmaf_output {
+	obs_output_t *output;
+	pthread_mutex_t mutex;
+
+	volatile bool active;
+	volatile bool stopping;
+	uint64_t stop_ts;
+	uint64_t total_bytes;
+
+	struct mp4_mux *muxer;
+	struct serializer serializer;
+	struct array_output_data fragment;
+
+	/* Settings */
+	int64_t segment_duration;
+	int64_t part_duration;
+	size_t window_size;
+	bool write_dash;
+	bool delete_segments;
+
+	/* Segments in the playlist window and the one being written */
+	DARRAY(struct cmaf_segment) segments;
+	struct cmaf_segment cur;
+	DARRAY(uint8_t) segment_data;
+	uint32_t next_number;
+	int64_t max_segment_duration;
+
+	struct dstr codecs;
+	int64_t bandwidth;
+	time_t start_time;
+
+	/* Writer thread */
+	struct cmaf_writer writer;
+	pthread_t writer_thread;
+	bool writer_thread_active;
+	pthread_mutex_t jobs_mutex;
+	os_sem_t *jobs_sem;
+	struct deque jobs;
+	bool jobs_stop;
+	volatile bool write_failed;
+};
+
+static inline bool stopping(struct cmaf_output *out)
+{
+	return os_atomic_load_bool(&out->stopping);
+}
+
+static inline bool active(struct cmaf_output *out)
+{
+	return os_atomic_load_bool(&out->active);
+}
+
+/* ------------------------------------------------------------------------- */
+/* Writer thread                                                             */
+
+static void free_job(struct cmaf_job *job)
+{
+	bfree(job->name);
+	bfree(job->data);
+}
+
+static void push_job(struct cmaf_output *out, enum cmaf_job_type type, const char *name, uint8_t *data, size_t size)
+{
+	struct cmaf_job job = {type, bstrdup(name), data, size};
+
+	pthread_mutex_lock(&out->jobs_mutex);
+	deque_push_back(&out->jobs, &job, sizeof(job));
+	pthread_mutex_unlock(&out->jobs_mutex);
+
+	os_sem_post(out->jobs_sem);
+}
+
+static inline void put_copy(struct cmaf_output *out, const char *name, const uint8_t *data, size_t size)
+{
+	push_job(out, CMAF_JOB_PUT, name, bmemdup(data, size), size);
+}
+
+static void *writer_thread(void *data)
+{
+	struct cmaf_output *out = data;
+
+	os_set_thread_name("cmaf-output: writer");
+
+	for (;;) {
+		struct cmaf_job job;
+
+		os_sem_wait(out->jobs_sem);
+
+		pthread_mutex_lock(&out->jobs_mutex);
+		if (!out->jobs.size) {
+			bool stop = out->jobs_stop;
+			pthread_mutex_unlock(&out->jobs_mutex);
+			if (stop)
+				break;
+			continue;
+		}
+		deque_pop_front(&out->jobs, &job, sizeof(job));
+		pthread_mutex_unlock(&out->jobs_mutex);
+
+		if (job.type == CMAF_JOB_PUT) {
+			if (!cmaf_writer_put(&out->writer, job.name, job.data, job.size))
+				os_atomic_set_bool(&out->write_failed, true);
+		} else {
+			/* Old segments that are already gone are not an error */
+			cmaf_writer_remove(&out->writer, job.name);
+		}
+
+		free_job(&job);
+	}
+
+	return NULL;
+}
+
+static bool start_writer(struct cmaf_output *out, const char *path)
+{
+	if (!cmaf_writer_init(&out->writer, path)) {
+		warn("Unable to open '%s'", path);
+		return false;
+	}
+
+	out->jobs_stop = false;
+	os_atomic_set_bool(&out->write_failed, false);
+
+	if (pthread_create(&out->writer_thread, NULL, writer_thread, out) != 0) {
+		warn("Failed to create writer thread");
+		cmaf_writer_free(&out->writer);
+		return false;
+	}
+
+	out->writer_thread_active = true;
+	return true;
+}
+
+/* Waits for all pending writes to finish */
+static void stop_writer(struct cmaf_output *out)
+{
+	if (out->writer_thread_active) {
+		pthread_mutex_lock(&out->jobs_mutex);
+		out->jobs_stop = true;
+		pthread_mutex_unlock(&out->jobs_mutex);
+
+		os_sem_post(out->jobs_sem);
+		pthread_join(out->writer_thread, NULL);
+		out->writer_thread_active = false;
+	}
+
+	while (out->jobs.size) {
+		struct cmaf_job job;
+		deque_pop_front(&out->jobs, &job, sizeof(job));
+		free_job(&job);
+	}
+
+	cmaf_writer_free(&out->writer);
+}
+
+/* ------------------------------------------------------------------------- */
+/* Playlists                                                                 */
+
+static inline void segment_name(struct dstr *dst, uint32_t number)
+{
+	dstr_printf(dst, "seg%" PRIu32 ".m4s", number);
+}
+
+static inline void part_name(struct dstr *dst, uint32_t number, size_t part)
+{
+	dstr_printf(dst, "seg%" PRIu32 ".%zu.m4s", number, part);
+}
+
+static inline double usec_to_sec(int64_t usec)
+{
+	return (double)usec / 1000000.0;
+}
+
+static void write_parts(struct dstr *m3u8, const struct cmaf_segment *seg)
+{
+	struct dstr name = {0};
+
+	for (size_t i = 0; i < seg->parts.num; i++) {
+		const struct cmaf_part *part = &seg->parts.array[i];
+
+		part_name(&name, seg->number, i);
+		dstr_catf(m3u8, "#EXT-X-PART:DURATION=%.5f,URI=\"%s\"%s\n", usec_to_sec(part->duration_usec),
+			  name.array, part->independent ? ",INDEPENDENT=YES" : "");
+	}
+
+	dstr_free(&name);
+}
+
+static void write_hls_playlist(struct cmaf_output *out, bool ended)
+{
+	struct dstr m3u8 = {0};
+	struct dstr name = {0};
+	bool parts = out->part_duration > 0;
+	int64_t target = out->segment_duration > out->max_segment_duration ? out->segment_duration
+									  : out->max_segment_duration;
+
+	dstr_cat(&m3u8, "#EXTM3U\n#EXT-X-VERSION:6\n");
+	dstr_catf(&m3u8, "#EXT-X-TARGETDURATION:%" PRId64 "\n", (target + 999999) / 1000000);
+
+	if (parts) {
+		/* Without blocking playlist reloads the client has to stay at
+		 * least three part durations behind the live edge */
+		dstr_catf(&m3u8, "#EXT-X-SERVER-CONTROL:PART-HOLD-BACK=%.3f\n", usec_to_sec(out->part_duration * 3));
+		dstr_catf(&m3u8, "#EXT-X-PART-INF:PART-TARGET=%.5f\n", usec_to_sec(out->part_duration));
+	}
+
+	uint32_t sequence = out->segments.num ? out->segments.array[0].number : out->cur.number;
+	dstr_catf(&m3u8, "#EXT-X-MEDIA-SEQUENCE:%" PRIu32 "\n", sequence);
+	dstr_cat(&m3u8, "#EXT-X-INDEPENDENT-SEGMENTS\n#EXT-X-MAP:URI=\"" INIT_NAME "\"\n");
+
+	for (size_t i = 0; i < out->segments.num; i++) {
+		const struct cmaf_segment *seg = &out->segments.array[i];
+
+		if (parts && !ended && i + PART_SEGMENTS >= out->segments.num)
+			write_parts(&m3u8, seg);
+
+		segment_name(&name, seg->number);
+		dstr_catf(&m3u8, "#EXTINF:%.5f,\n%s\n", usec_to_sec(seg->duration_usec), name.array);
+	}
+
+	if (ended)
+		dstr_cat(&m3u8, "#EXT-X-ENDLIST\n");
+	else if (parts)
+		write_parts(&m3u8, &out->cur);
+
+	push_job(out, CMAF_JOB_PUT, PLAYLIST_NAME, (uint8_t *)m3u8.array, m3u8.len);
+	dstr_free(&name);
+}
+
+static void format_utc_time(char *buf, size_t size, time_t t)
+{
+	struct tm tm;
+
+#ifdef _WIN32
+	gmtime_s(&tm, &t);
+#else
+	gmtime_r(&t, &tm);
+#endif
+	strftime(buf, size, "%Y-%m-%dT%H:%M:%SZ", &tm);
+}
+
+static void write_dash_manifest(struct cmaf_output *out, bool ended)
+{
+	struct dstr mpd = {0};
+	char start_time[32];
+	char publish_time[32];
+	double target = usec_to_sec(out->segment_duration);
+
+	if (!out->segments.num)
+		return;
+
+	format_utc_time(start_time, sizeof(start_time), out->start_time);
+	format_utc_time(publish_time, sizeof(publish_time), time(NULL));
+
+	dstr_cat(&mpd, "<?xml version=\"1.0\" encoding=\"utf-8\"?>\n"
+		       "<MPD xmlns=\"urn:mpeg:dash:schema:mpd:2011\" "
+		       "profiles=\"urn:mpeg:dash:profile:isoff-live:2011\"");
+
+	if (ended) {
+		const struct cmaf_segment *last = &out->segments.array[out->segments.num - 1];
+		dstr_catf(&mpd, " type=\"static\" mediaPresentationDuration=\"PT%.3fS\"",
+			  usec_to_sec(last->start_usec + last->duration_usec));
+	} else {
+		dstr_catf(&mpd,
+			  " type=\"dynamic\" availabilityStartTime=\"%s\" publishTime=\"%s\""
+			  " minimumUpdatePeriod=\"PT%.3fS\" timeShiftBufferDepth=\"PT%.3fS\"",
+			  start_time, publish_time, target, target * (double)out->window_size);
+	}
+
+	dstr_catf(&mpd,
+		  " minBufferTime=\"PT%.3fS\" maxSegmentDuration=\"PT%.3fS\">\n"
+		  "  <Period id=\"0\" start=\"PT0S\">\n"
+		  "    <AdaptationSet mimeType=\"video/mp4\" segmentAlignment=\"true\" startWithSAP=\"1\">\n"
+		  "      <Representation id=\"0\" codecs=\"%s\" bandwidth=\"%" PRId64 "\">\n"
+		  "        <SegmentTemplate timescale=\"1000000\" initialization=\"" INIT_NAME "\""
+		  " media=\"seg$Number$.m4s\" startNumber=\"%" PRIu32 "\">\n"
+		  "          <SegmentTimeline>\n",
+		  target, usec_to_sec(out->max_segment_duration), out->codecs.array, out->bandwidth,
+		  out->segments.array[0].number);
+
+	for (size_t i = 0; i < out->segments.num; i++) {
+		const struct cmaf_segment *seg = &out->segments.array[i];
+		dstr_catf(&mpd, "            <S t=\"%" PRId64 "\" d=\"%" PRId64 "\"/>\n", seg->start_usec,
+			  seg->duration_usec);
+	}
+
+	dstr_cat(&mpd, "          </SegmentTimeline>\n"
+		       "        </SegmentTemplate>\n"
+		       "      </Representation>\n"
+		       "    </AdaptationSet>\n"
+		       "  </Period>\n"
+		       "</MPD>\n");
+
+	push_job(out, CMAF_JOB_PUT, MANIFEST_NAME, (uint8_t *)mpd.array, mpd.len);
+}
+
+/* ------------------------------------------------------------------------- */
+/* Segmenting                                                                */
+
+static void remove_parts(struct cmaf_output *out, struct cmaf_segment *seg)
+{
+	struct dstr name = {0};
+
+	for (size_t i = 0; i < seg->parts.num; i++) {
+		part_name(&name, seg->number, i);
+		push_job(out, CMAF_JOB_REMOVE, name.array, NULL, 0);
+	}
+
+	dstr_free(&name);
+}
+
+static void finish_segment(struct cmaf_output *out)
+{
+	struct dstr name = {0};
+
+	if (!out->cur.parts.num)
+		return;
+
+	segment_name(&name, out->cur.number);
+	push_job(out, CMAF_JOB_PUT, name.array, out->segment_data.array, out->segment_data.num);
+	memset(&out->segment_data, 0, sizeof(out->segment_data));
+
+	if (out->cur.duration_usec > out->max_segment_duration)
+		out->max_segment_duration = out->cur.duration_usec;
+
+	da_push_back(out->segments, &out->cur);
+	memset(&out->cur, 0, sizeof(out->cur));
+
+	/* Parts are no longer listed once the segment falls out of the part
+	 * window, and whole segments once they leave the playlist */
+	if (out->delete_segments && out->part_duration && out->segments.num > PART_SEGMENTS)
+		remove_parts(out, &out->segments.array[out->segments.num - PART_SEGMENTS - 1]);
+
+	while (out->segments.num > out->window_size) {
+		struct cmaf_segment *seg = &out->segments.array[0];
+
+		if (out->delete_segments) {
+			segment_name(&name, seg->number);
+			push_job(out, CMAF_JOB_REMOVE, name.array, NULL, 0);
+		}
+
+		da_free(seg->parts);
+		da_erase(out->segments, 0);
+	}
+
+	dstr_free(&name);
+}
+
+static void fragment_written(void *param, const struct mp4_fragment_info *fi)
+{
+	struct cmaf_output *out = param;
+	const uint8_t *data = out->fragment.bytes.array;
+	size_t size = out->fragment.bytes.num;
+	bool segment_done = false;
+
+	if (fi->init) {
+		put_copy(out, INIT_NAME, data, size);
+		array_output_serializer_reset(&out->fragment);
+		return;
+	}
+
+	if (fi->independent && out->cur.parts.num &&
+	    out->cur.duration_usec * 100 >= out->segment_duration * SEGMENT_TOLERANCE_PERCENT) {
+		finish_segment(out);
+		segment_done = true;
+	}
+
+	if (!out->cur.parts.num) {
+		out->cur.number = out->next_number++;
+		out->cur.start_usec = fi->start_usec;
+	}
+
+	if (out->part_duration) {
+		struct dstr name = {0};
+		part_name(&name, out->cur.number, out->cur.parts.num);
+		put_copy(out, name.array, data, size);
+		dstr_free(&name);
+	}
+
+	da_push_back_array(out->segment_data, data, size);
+
+	struct cmaf_part *part = da_push_back_new(out->cur.parts);
+	part->duration_usec = fi->duration_usec;
+	part->independent = fi->independent;
+	out->cur.duration_usec += fi->duration_usec;
+
+	array_output_serializer_reset(&out->fragment);
+
+	/* New parts have to be announced right away, full segments only once
+	 * they are complete */
+	if (out->part_duration || segment_done)
+		write_hls_playlist(out, false);
+	if (out->write_dash && segment_done)
+		write_dash_manifest(out, false);
+}
+
+static void free_segments(struct cmaf_output *out)
+{
+	for (size_t i = 0; i < out->segments.num; i++)
+		da_free(out->segments.array[i].parts);
+
+	da_free(out->segments);
+	da_free(out->cur.parts);
+	da_free(out->segment_data);
+	memset(&out->cur, 0, sizeof(out->cur));
+	out->next_number = 0;
+	out->max_segment_duration = 0;
+}
+
+/* ------------------------------------------------------------------------- */
+/* Codec information for the DASH manifest                                   */
+
+static void add_codec(struct cmaf_output *out, obs_encoder_t *enc)
+{
+	const char *codec = obs_encoder_get_codec(enc);
+	uint8_t *extra_data = NULL;
+	size_t extra_size = 0;
+
+	if (out->codecs.len)
+		dstr_cat_ch(&out->codecs, ',');
+
+	if (strcmp(codec, "h264") == 0) {
+		uint8_t *avcc = NULL;
+		size_t avcc_size = 0;
+
+		/* avc1.PPCCLL from the profile, constraints and level of
+		 * the SPS */
+		if (obs_encoder_get_extra_data(enc, &extra_data, &extra_size))
+			avcc_size = obs_parse_avc_header(&avcc, extra_data, extra_size);
+
+		if (avcc_size >= 4)
+			dstr_catf(&out->codecs, "avc1.%02X%02X%02X", avcc[1], avcc[2], avcc[3]);
+		else
+			dstr_cat(&out->codecs, "avc1");
+
+		bfree(avcc);
+	} else if (strcmp(codec, "hevc") == 0) {
+		dstr_cat(&out->codecs, "hvc1");
+	} else if (strcmp(codec, "av1") == 0) {
+		dstr_cat(&out->codecs, "av01");
+	} else if (strcmp(codec, "opus") == 0) {
+		dstr_cat(&out->codecs, "opus");
+	} else {
+		dstr_cat(&out->codecs, "mp4a.40.2");
+	}
+
+	obs_data_t *settings = obs_encoder_get_settings(enc);
+	out->bandwidth += obs_data_get_int(settings, "bitrate") * 1000;
+	obs_data_release(settings);
+}
+
+static void get_codecs(struct cmaf_output *out)
+{
+	obs_encoder_t *venc = obs_output_get_video_encoder2(out->output, 0);
+	obs_encoder_t *aenc = obs_output_get_audio_encoder(out->output, 0);
+
+	dstr_free(&out->codecs);
+	out->bandwidth = 0;
+
+	if (venc)
+		add_codec(out, venc);
+	if (aenc)
+		add_codec(out, aenc);
+
+	if (!out->bandwidth)
+		out->bandwidth = 1;
+}
+
+/* ------------------------------------------------------------------------- */
+
+static const char *cmaf_output_name(void *unused)
+{
+	UNUSED_PARAMETER(unused);
+	return obs_module_text("CMAFOutput");
+}
+
+static void *cmaf_output_create(obs_data_t *settings, obs_output_t *output)
+{
+	struct cmaf_output *out = bzalloc(sizeof(struct cmaf_output));
+	out->output = output;
+	pthread_mutex_init(&out->mutex, NULL);
+	pthread_mutex_init(&out->jobs_mutex, NULL);
+
+	if (os_sem_init(&out->jobs_sem, 0) != 0) {
+		pthread_mutex_destroy(&out->jobs_mutex);
+		pthread_mutex_destroy(&out->mutex);
+		bfree(out);
+		return NULL;
+	}
+
+	UNUSED_PARAMETER(settings);
+	return out;
+}
+
+static void cmaf_output_destroy(void *data)
+{
+	struct cmaf_output *out = data;
+
+	/* Only left over if the output never received its stop packet */
+	if (out->muxer)
+		mp4_mux_destroy(out->muxer);
+	stop_writer(out);
+	array_output_serializer_free(&out->fragment);
+	free_segments(out);
+
+	deque_free(&out->jobs);
+	os_sem_destroy(out->jobs_sem);
+	pthread_mutex_destroy(&out->jobs_mutex);
+	pthread_mutex_destroy(&out->mutex);
+	dstr_free(&out->codecs);
+	bfree(out);
+}
+
+static bool cmaf_output_start(void *data)
+{
+	struct cmaf_output *out = data;
+
+	if (!obs_output_can_begin_data_capture(out->output, 0))
+		return false;
+	if (!obs_output_initialize_encoders(out->output, 0))
+		return false;
+
+	os_atomic_set_bool(&out->stopping, false);
+
+	obs_data_t *settings = obs_output_get_settings(out->output);
+	const char *path = obs_data_get_string(settings, "path");
+	out->segment_duration = obs_data_get_int(settings, "segment_duration_ms") * 1000;
+	out->part_duration = obs_data_get_int(settings, "part_duration_ms") * 1000;
+	out->window_size = (size_t)obs_data_get_int(settings, "window_size");
+	out->write_dash = obs_data_get_bool(settings, "dash");
+	out->delete_segments = obs_data_get_bool(settings, "delete_segments");
+
+	if (!path || !*path) {
+		warn("Output path not specified");
+		obs_data_release(settings);
+		return false;
+	}
+
+	if (out->segment_duration <= 0)
+		out->segment_duration = 2000000;
+	if (out->part_duration >= out->segment_duration)
+		out->part_duration = 0;
+	if (!out->window_size)
+		out->window_size = 1;
+
+	bool success = start_writer(out, path);
+	if (success)
+		info("Writing CMAF segments to '%s'...", path);
+
+	obs_data_release(settings);
+
+	if (!success)
+		return false;
+
+	get_codecs(out);
+	out->start_time = time(NULL);
+	out->total_bytes = 0;
+
+	array_output_serializer_init(&out->serializer, &out->fragment);
+
+	/* Partial segments are the fragments of the muxer, without them every
+	 * GOP becomes a single fragment. */
+	out->muxer = mp4_mux_create(out->output, &out->serializer, MP4_CMAF_SEGMENTS | MP4_USE_NEGATIVE_CTS);
+	mp4_mux_set_fragment_callback(out->muxer, fragment_written, out);
+	mp4_mux_set_fragment_duration(out->muxer, out->part_duration);
+
+	os_atomic_set_bool(&out->active, true);
+	obs_output_begin_data_capture(out->output, 0);
+	return true;
+}
+
+static void cmaf_output_stop(void *data, uint64_t ts)
+{
+	struct cmaf_output *out = data;
+	out->stop_ts = ts / 1000;
+	os_atomic_set_bool(&out->stopping, true);
+}
+
+static void mp4_mux_destroy_task(void *ptr)
+{
+	struct mp4_mux *muxer = ptr;
+	mp4_mux_destroy(muxer);
+}
+
+static void cmaf_output_actual_stop(struct cmaf_output *out, int code)
+{
+	os_atomic_set_bool(&out->active, false);
+
+	uint64_t start_time = os_gettime_ns();
+
+	/* Flush the last fragment and publish the final playlists */
+	mp4_mux_finalise(out->muxer);
+	finish_segment(out);
+	write_hls_playlist(out, true);
+	if (out->write_dash)
+		write_dash_manifest(out, true);
+
+	if (code) {
+		obs_output_signal_stop(out->output, code);
+	} else {
+		obs_output_end_data_capture(out->output);
+	}
+
+	info("Waiting for writer to finish...");
+
+	stop_writer(out);
+	obs_queue_task(OBS_TASK_DESTROY, mp4_mux_destroy_task, out->muxer, false);
+	out->muxer = NULL;
+
+	array_output_serializer_free(&out->fragment);
+	free_segments(out);
+
+	info("CMAF output complete. Finalization took %" PRIu64 " ms.", (os_gettime_ns() - start_time) / 1000000);
+}
+
+static void cmaf_output_packet(void *data, struct encoder_packet *packet)
+{
+	struct cmaf_output *out = data;
+
+	pthread_mutex_lock(&out->mutex);
+
+	if (!active(out))
+		goto unlock;
+
+	if (!packet) {
+		cmaf_output_actual_stop(out, OBS_OUTPUT_ENCODE_ERROR);
+		goto unlock;
+	}
+
+	if (stopping(out)) {
+		if (packet->sys_dts_usec >= (int64_t)out->stop_ts) {
+			cmaf_output_actual_stop(out, 0);
+			goto unlock;
+		}
+	}
+
+	if (os_atomic_load_bool(&out->write_failed)) {
+		cmaf_output_actual_stop(out, OBS_OUTPUT_DISCONNECTED);
+		goto unlock;
+	}
+
+	out->total_bytes += packet->size;
+	mp4_mux_submit_packet(out->muxer, packet);
+
+unlock:
+	pthread_mutex_unlock(&out->mutex);
+}
+
+static void cmaf_output_defaults(obs_data_t *settings)
+{
+	obs_data_set_default_int(settings, "segment_duration_ms", 2000);
+	obs_data_set_default_int(settings, "part_duration_ms", 500);
+	obs_data_set_default_int(settings, "window_size", 6);
+	obs_data_set_default_bool(settings, "dash", false);
+	obs_data_set_default_bool(settings, "delete_segments", true);
+}
+
+static obs_properties_t *cmaf_output_properties(void *unused)
+{
+	UNUSED_PARAMETER(unused);
+
+	obs_properties_t *props = obs_properties_create();
+
+	obs_properties_add_text(props, "path", obs_module_text("CMAFOutput.Path"), OBS_TEXT_DEFAULT);
+	obs_properties_add_int(props, "segment_duration_ms", obs_module_text("CMAFOutput.SegmentDuration"), 500,
+			       30000, 100);
+	obs_properties_add_int(props, "part_duration_ms", obs_module_text("CMAFOutput.PartDuration"), 0, 5000, 10);
+	obs_properties_add_int(props, "window_size", obs_module_text("CMAFOutput.WindowSize"), 1, 100, 1);
+	obs_properties_add_bool(props, "dash", obs_module_text("CMAFOutput.DASH"));
+	obs_properties_add_bool(props, "delete_segments", obs_module_text("CMAFOutput.DeleteSegments"));
+	return props;
+}
+
+static uint64_t cmaf_output_total_bytes(void *data)
+{
+	struct cmaf_output *out = data;
+	return out->total_bytes;
+}
+
+struct obs_output_info cmaf_output_info = {
+	.id = "cmaf_output",
+	.flags = OBS_OUTPUT_AV | OBS_OUTPUT_ENCODED,
+	.encoded_video_codecs = "h264;hevc;av1",
+	.encoded_audio_codecs = "aac;opus",
+	.get_name = cmaf_output_name,
+	.create = cmaf_output_create,
+	.destroy = cmaf_output_destroy,
+	.start = cmaf_output_start,
+	.stop = cmaf_output_stop,
+	.encoded_packet = cmaf_output_packet,
+	.get_defaults = cmaf_output_defaults,
+	.get_properties = cmaf_output_properties,
+	.get_total_bytes = cmaf_output_total_bytes,
+};
@@ -0,0 +1,272 @@
+/******************************************************************************
+    Copyright (C) 2026 by OBS Project contributors
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+******************************************************************************/
+
+#include "cmaf-writer.h"
+
+#include <obs-module.h>
+#include <util/curl/curl-helper.h>
+#include <util/platform.h>
+#include <util/dstr.h>
+
+#define HTTP_TIMEOUT_SEC 10L
+
+static inline void get_path(struct dstr *dst, const char *base, const char *name)
+{
+	dstr_copy(dst, base);
+	if (dstr_end(dst) != '/')
+		dstr_cat_ch(dst, '/');
+	dstr_cat(dst, name);
+}
+
+/* ------------------------------------------------------------------------- */
+/* Local directory                                                           */
+
+struct file_writer {
+	struct dstr dir;
+};
+
+static void *file_writer_create(const char *base)
+{
+	struct file_writer *fw = bzalloc(sizeof(struct file_writer));
+
+	dstr_copy(&fw->dir, base);
+	dstr_replace(&fw->dir, "\\", "/");
+
+	if (os_mkdirs(fw->dir.array) == MKDIR_ERROR) {
+		blog(LOG_WARNING, "[cmaf file writer] Failed to create directory '%s'", fw->dir.array);
+		dstr_free(&fw->dir);
+		bfree(fw);
+		return NULL;
+	}
+
+	return fw;
+}
+
+static void file_writer_destroy(void *data)
+{
+	struct file_writer *fw = data;
+
+	dstr_free(&fw->dir);
+	bfree(fw);
+}
+
+static bool file_writer_put(void *data, const char *name, const uint8_t *buf, size_t size)
+{
+	struct file_writer *fw = data;
+	struct dstr path = {0};
+	struct dstr tmp = {0};
+	bool success = false;
+
+	get_path(&path, fw->dir.array, name);
+	dstr_printf(&tmp, "%s.tmp", path.array);
+
+	/* Write to a temporary file first so that a web server never serves
+	 * a partially written playlist or segment. */
+	FILE *file = os_fopen(tmp.array, "wb");
+	if (!file) {
+		blog(LOG_WARNING, "[cmaf file writer] Failed to open '%s'", tmp.array);
+		goto fail;
+	}
+
+	success = fwrite(buf, 1, size, file) == size;
+	fclose(file);
+
+	if (success)
+		success = os_safe_replace(path.array, tmp.array, NULL) == 0;
+	if (!success) {
+		blog(LOG_WARNING, "[cmaf file writer] Failed to write '%s'", path.array);
+		os_unlink(tmp.array);
+	}
+
+fail:
+	dstr_free(&path);
+	dstr_free(&tmp);
+	return success;
+}
+
+static bool file_writer_remove(void *data, const char *name)
+{
+	struct file_writer *fw = data;
+	struct dstr path = {0};
+
+	get_path(&path, fw->dir.array, name);
+	bool success = os_unlink(path.array) == 0;
+	dstr_free(&path);
+
+	return success;
+}
+
+const struct cmaf_writer_info cmaf_file_writer = {
+	.id = "file",
+	.create = file_writer_create,
+	.destroy = file_writer_destroy,
+	.put = file_writer_put,
+	.remove = file_writer_remove,
+};
+
+/* ------------------------------------------------------------------------- */
+/* HTTP PUT/DELETE                                                           */
+
+struct http_writer {
+	struct dstr base;
+	CURL *curl;
+	struct curl_slist *headers;
+	char error[CURL_ERROR_SIZE];
+};
+
+struct http_upload {
+	const uint8_t *buf;
+	size_t size;
+	size_t pos;
+};
+
+static size_t http_read_cb(char *ptr, size_t size, size_t nmemb, void *param)
+{
+	struct http_upload *upload = param;
+	size_t len = size * nmemb;
+
+	if (len > upload->size - upload->pos)
+		len = upload->size - upload->pos;
+
+	memcpy(ptr, upload->buf + upload->pos, len);
+	upload->pos += len;
+	return len;
+}
+
+static size_t http_discard_cb(char *ptr, size_t size, size_t nmemb, void *param)
+{
+	UNUSED_PARAMETER(ptr);
+	UNUSED_PARAMETER(param);
+	return size * nmemb;
+}
+
+static void *http_writer_create(const char *base)
+{
+	struct http_writer *hw = bzalloc(sizeof(struct http_writer));
+
+	hw->curl = curl_easy_init();
+	if (!hw->curl) {
+		bfree(hw);
+		return NULL;
+	}
+
+	dstr_copy(&hw->base, base);
+
+	/* Segments are small and latency matters more than saving a round
+	 * trip on rejected uploads. */
+	hw->headers = curl_slist_append(hw->headers, "Expect:");
+
+	/* The handle is reused for every request to keep the connection
+	 * alive between segments. */
+	curl_easy_setopt(hw->curl, CURLOPT_HTTPHEADER, hw->headers);
+	curl_easy_setopt(hw->curl, CURLOPT_ERRORBUFFER, hw->error);
+	curl_easy_setopt(hw->curl, CURLOPT_WRITEFUNCTION, http_discard_cb);
+	curl_easy_setopt(hw->curl, CURLOPT_READFUNCTION, http_read_cb);
+	curl_easy_setopt(hw->curl, CURLOPT_TIMEOUT, HTTP_TIMEOUT_SEC);
+	curl_easy_setopt(hw->curl, CURLOPT_NOSIGNAL, 1L);
+	curl_easy_setopt(hw->curl, CURLOPT_TCP_NODELAY, 1L);
+	curl_easy_setopt(hw->curl, CURLOPT_SSL_VERIFYPEER, 1L);
+	curl_easy_setopt(hw->curl, CURLOPT_SSL_VERIFYHOST, 2L);
+	curl_obs_set_revoke_setting(hw->curl);
+
+	return hw;
+}
+
+static void http_writer_destroy(void *data)
+{
+	struct http_writer *hw = data;
+
+	curl_easy_cleanup(hw->curl);
+	curl_slist_free_all(hw->headers);
+	dstr_free(&hw->base);
+	bfree(hw);
+}
+
+static bool http_perform(struct http_writer *hw, const char *method, const char *name)
+{
+	struct dstr url = {0};
+	long response = 0;
+
+	get_path(&url, hw->base.array, name);
+	curl_easy_setopt(hw->curl, CURLOPT_URL, url.array);
+
+	hw->error[0] = 0;
+	CURLcode code = curl_easy_perform(hw->curl);
+	curl_easy_getinfo(hw->curl, CURLINFO_RESPONSE_CODE, &response);
+
+	bool success = code == CURLE_OK && response >= 200 && response < 300;
+	if (!success) {
+		blog(LOG_WARNING, "[cmaf http writer] %s '%s' failed: %s (%ld)", method, url.array,
+		     hw->error[0] ? hw->error : curl_easy_strerror(code), response);
+	}
+
+	dstr_free(&url);
+	return success;
+}
+
+static bool http_writer_put(void *data, const char *name, const uint8_t *buf, size_t size)
+{
+	struct http_writer *hw = data;
+	struct http_upload upload = {buf, size, 0};
+
+	curl_easy_setopt(hw->curl, CURLOPT_CUSTOMREQUEST, NULL);
+	curl_easy_setopt(hw->curl, CURLOPT_NOBODY, 0L);
+	curl_easy_setopt(hw->curl, CURLOPT_UPLOAD, 1L);
+	curl_easy_setopt(hw->curl, CURLOPT_READDATA, &upload);
+	curl_easy_setopt(hw->curl, CURLOPT_INFILESIZE_LARGE, (curl_off_t)size);
+
+	return http_perform(hw, "PUT", name);
+}
+
+static bool http_writer_remove(void *data, const char *name)
+{
+	struct http_writer *hw = data;
+
+	curl_easy_setopt(hw->curl, CURLOPT_UPLOAD, 0L);
+	curl_easy_setopt(hw->curl, CURLOPT_NOBODY, 1L);
+	curl_easy_setopt(hw->curl, CURLOPT_CUSTOMREQUEST, "DELETE");
+
+	return http_perform(hw, "DELETE", name);
+}
+
+const struct cmaf_writer_info cmaf_http_writer = {
+	.id = "http",
+	.create = http_writer_create,
+	.destroy = http_writer_destroy,
+	.put = http_writer_put,
+	.remove = http_writer_remove,
+};
+
+/* ------------------------------------------------------------------------- */
+
+bool cmaf_writer_init(struct cmaf_writer *writer, const char *base)
+{
+	if (astrcmpi_n(base, "http://", 7) == 0 || astrcmpi_n(base, "https://", 8) == 0)
+		writer->info = &cmaf_http_writer;
+	else
+		writer->info = &cmaf_file_writer;
+
+	writer->data = writer->info->create(base);
+	return writer->data != NULL;
+}
+
+void cmaf_writer_free(struct cmaf_writer *writer)
+{
+	if (writer->data)
+		writer->info->destroy(writer->data);
+	writer->data = NULL;
+}
@@ -0,0 +1,57 @@
+/******************************************************************************
+    Copyright (C) 2026 by OBS Project contributors
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+******************************************************************************/
+
+#pragma once
+
+#include <util/c99defs.h>
+
+/* Destination for the segments and playlists of the CMAF output.  Every
+ * object is written in one call, so an implementation only has to know how
+ * to store and remove named blobs below its base location. */
+
+struct cmaf_writer_info {
+	const char *id;
+
+	void *(*create)(const char *base);
+	void (*destroy)(void *data);
+
+	bool (*put)(void *data, const char *name, const uint8_t *buf, size_t size);
+	bool (*remove)(void *data, const char *name);
+};
+
+struct cmaf_writer {
+	const struct cmaf_writer_info *info;
+	void *data;
+};
+
+extern const struct cmaf_writer_info cmaf_file_writer;
+extern const struct cmaf_writer_info cmaf_http_writer;
+
+/* Picks the HTTP writer for http:// and https:// locations, otherwise the
+ * location is treated as a local directory. */
+extern bool cmaf_writer_init(struct cmaf_writer *writer, const char *base);
+extern void cmaf_writer_free(struct cmaf_writer *writer);
+
+static inline bool cmaf_writer_put(struct cmaf_writer *writer, const char *name, const uint8_t *buf, size_t size)
+{
+	return writer->info->put(writer->data, name, buf, size);
+}
+
+static inline bool cmaf_writer_remove(struct cmaf_writer *writer, const char *name)
+{
+	return writer->info->remove(writer->data, name);
+}
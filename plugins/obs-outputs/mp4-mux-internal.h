@@ -78,6 +78,7 @@ struct fragment_sample {
 	uint32_t size;
 	int32_t offset;
 	uint32_t duration;
+	bool keyframe;
 };
 
 struct mp4_track {
@@ -141,6 +142,13 @@ struct mp4_mux {
 	uint32_t fragments_written;
 	/* PTS where next fragmentation should take place */
 	int64_t next_frag_pts;
+	/* PTS where the last fragmentation took place */
+	int64_t last_frag_pts;
+	/* Maximum fragment duration between keyframes (0 = disabled) */
+	int64_t fragment_duration;
+
+	mp4_mux_fragment_cb fragment_cb;
+	void *fragment_cb_param;
 
 	/* Creation time (seconds since Jan 1 1904) */
 	uint64_t creation_time;
@@ -112,6 +112,10 @@ static size_t mp4_write_ftyp(struct mp4_mux *mux, bool fragmented)
 
 	s_write(s, "iso2", 4);
 
+	/* CMAF segments are also compatible with the CMAF base brand */
+	if (mux->flags & MP4_CMAF_SEGMENTS)
+		s_write(s, "cmfc", 4);
+
 	/* Include H.264 brand if used */
 	for (size_t i = 0; i < mux->tracks.num; i++) {
 		struct mp4_track *track = &mux->tracks.array[i];
@@ -1991,7 +1995,14 @@ static size_t mp4_write_tfhd(struct mp4_mux *mux, struct mp4_track *track, size_
 	struct serializer *s = mux->serializer;
 	int64_t start = serializer_get_pos(s);
 
-	uint32_t flags = BASE_DATA_OFFSET_PRESENT | DEFAULT_SAMPLE_FLAGS_PRESENT;
+	uint32_t flags = DEFAULT_SAMPLE_FLAGS_PRESENT;
+
+	/* CMAF fragments are delivered separately, so sample data offsets
+	 * have to be relative to the moof rather than the file. */
+	if (mux->flags & MP4_CMAF_SEGMENTS)
+		flags |= DEFAULT_BASE_IS_MOOF;
+	else
+		flags |= BASE_DATA_OFFSET_PRESENT;
 
 	/* Add default size/duration if all samples match. */
 	bool durations_match = true;
@@ -2023,7 +2034,9 @@ static size_t mp4_write_tfhd(struct mp4_mux *mux, struct mp4_track *track, size_
 	write_fullbox(s, 0, "tfhd", 0, flags);
 
 	s_wb32(s, track->track_id); // track_ID
-	s_wb64(s, moof_start);      // base_data_offset
+
+	if (flags & BASE_DATA_OFFSET_PRESENT)
+		s_wb64(s, moof_start); // base_data_offset
 
 	// default_sample_duration
 	if (durations_match) {
@@ -2112,8 +2125,13 @@ static size_t mp4_write_trun(struct mp4_mux *mux, struct mp4_track *track, uint3
 	if (track->sample_size)
 		return write_box_size(s, start);
 
-	if (track->type == TRACK_VIDEO)
-		s_wb32(s, SAMPLE_FLAG_DEPENDS_NO); // first_sample_flags
+	/* Fragments split between keyframes do not start with a sync sample */
+	if (track->type == TRACK_VIDEO) {
+		if (track->fragment_samples.array[0].keyframe)
+			s_wb32(s, SAMPLE_FLAG_DEPENDS_NO); // first_sample_flags
+		else
+			s_wb32(s, SAMPLE_FLAG_DEPENDS_YES | SAMPLE_FLAG_IS_NON_SYNC);
+	}
 
 	for (size_t idx = 0; idx < sample_count; idx++) {
 		struct fragment_sample *smp = &track->fragment_samples.array[idx];
@@ -2265,7 +2283,7 @@ static void process_packets(struct mp4_mux *mux, struct mp4_track *track, uint64
 
 		/* When using negative CTS, subtract DTS-PTS offset. */
 		if (track->type == TRACK_VIDEO && mux->flags & MP4_USE_NEGATIVE_CTS) {
-			if (!track->offsets.num)
+			if (!track->samples)
 				track->dts_offset = offset;
 
 			offset -= track->dts_offset;
@@ -2276,12 +2294,22 @@ static void process_packets(struct mp4_mux *mux, struct mp4_track *track, uint64
 		smp->size = size;
 		smp->offset = offset;
 		smp->duration = duration;
+		smp->keyframe = pkt->keyframe;
 
 		*mdat_size += size;
 
 		/* Update global sample information for full moov */
 		track->duration += duration;
 
+		/* CMAF segments never get a full moov, so do not keep growing
+		 * the sample tables for the entire duration of the stream. */
+		if (mux->flags & MP4_CMAF_SEGMENTS) {
+			if (!track->samples)
+				track->first_pts = pkt->pts;
+			track->samples++;
+			continue;
+		}
+
 		if (track->sample_size) {
 			/* Adjust duration/count for fixed sample size */
 			sample_count = size / track->sample_size;
@@ -2337,6 +2365,18 @@ static void write_packets(struct mp4_mux *mux, struct mp4_track *track)
 	if (!count || !track->fragment_samples.num)
 		return;
 
+	if (mux->flags & MP4_CMAF_SEGMENTS) {
+		for (size_t i = 0; i < track->fragment_samples.num; i++) {
+			struct encoder_packet pkt;
+			deque_pop_front(&track->packets, &pkt, sizeof(struct encoder_packet));
+			s_write(s, pkt.data, pkt.size);
+			obs_encoder_packet_release(&pkt);
+		}
+
+		da_clear(track->fragment_samples);
+		return;
+	}
+
 	struct chunk *chk = da_push_back_new(track->chunks);
 	chk->offset = serializer_get_pos(s);
 	chk->samples = (uint32_t)track->fragment_samples.num;
@@ -2357,16 +2397,40 @@ static void write_packets(struct mp4_mux *mux, struct mp4_track *track)
 	da_clear(track->fragment_samples);
 }
 
+static void get_fragment_info(struct mp4_mux *mux, struct mp4_fragment_info *info)
+{
+	memset(info, 0, sizeof(*info));
+
+	for (size_t i = 0; i < mux->tracks.num; i++) {
+		struct mp4_track *track = &mux->tracks.array[i];
+		uint64_t duration = 0;
+
+		if (track->type != TRACK_VIDEO)
+			continue;
+
+		for (size_t idx = 0; idx < track->fragment_samples.num; idx++)
+			duration += track->fragment_samples.array[idx].duration;
+
+		info->independent = track->fragment_samples.num && track->fragment_samples.array[0].keyframe;
+		info->start_usec = (int64_t)util_mul_div64(track->duration - duration, 1000000, track->timebase_den);
+		info->duration_usec = (int64_t)util_mul_div64(duration, 1000000, track->timebase_den);
+		break;
+	}
+}
+
 static void mp4_flush_fragment(struct mp4_mux *mux)
 {
 	struct serializer *s = mux->serializer;
+	bool cmaf = mux->flags & MP4_CMAF_SEGMENTS;
 
 	// Write file header if not already done
 	if (!mux->fragments_written) {
 		mp4_write_ftyp(mux, true);
 		/* Placeholder to write mdat header during soft-remux */
-		mux->placeholder_offset = serializer_get_pos(s);
-		mp4_write_free(mux);
+		if (!cmaf) {
+			mux->placeholder_offset = serializer_get_pos(s);
+			mp4_write_free(mux);
+		}
 	}
 
 	// Array output as temporary buffer to avoid sending seeks to disk
@@ -2380,6 +2444,12 @@ static void mp4_flush_fragment(struct mp4_mux *mux)
 		mp4_write_moov(mux, true);
 		s_write(s, aod.bytes.array, aod.bytes.num);
 		array_output_serializer_reset(&aod);
+
+		/* ftyp and moov make up the CMAF init segment */
+		if (cmaf && mux->fragment_cb) {
+			struct mp4_fragment_info init = {.init = true};
+			mux->fragment_cb(mux->fragment_cb_param, &init);
+		}
 	}
 
 	mux->fragments_written++;
@@ -2404,6 +2474,9 @@ static void mp4_flush_fragment(struct mp4_mux *mux)
 		process_packets(mux, mux->chapter_track, &mdat_size);
 	}
 
+	struct mp4_fragment_info info;
+	get_fragment_info(mux, &info);
+
 	// write moof once to get size
 	int64_t moof_start = serializer_get_pos(s);
 	size_t moof_size = mp4_write_moof(mux, 0, moof_start);
@@ -2439,6 +2512,10 @@ static void mp4_flush_fragment(struct mp4_mux *mux)
 	if (!mux->next_frag_pts && mux->chapter_track)
 		write_packets(mux, mux->chapter_track);
 
+	if (mux->fragment_cb)
+		mux->fragment_cb(mux->fragment_cb_param, &info);
+
+	mux->last_frag_pts = mux->next_frag_pts;
 	mux->next_frag_pts = 0;
 }
 
@@ -2662,6 +2739,14 @@ bool mp4_mux_submit_packet(struct mp4_mux *mux, struct encoder_packet *pkt)
 		/* Set fragmentation PTS if packet is keyframe and PTS > 0 */
 		if (parsed_packet.keyframe && parsed_packet.pts > 0) {
 			mux->next_frag_pts = packet_pts_usec(&parsed_packet);
+		} else if (mux->fragment_duration && !mux->next_frag_pts && pkt->track_idx == 0) {
+			/* Otherwise split between keyframes before the current
+			 * fragment would exceed the maximum duration */
+			int64_t pts_usec = packet_pts_usec(&parsed_packet);
+			int64_t frame_usec = (int64_t)util_mul_div64(1000000, track->timebase_num, track->timebase_den);
+
+			if (pts_usec - mux->last_frag_pts + frame_usec > mux->fragment_duration)
+				mux->next_frag_pts = pts_usec;
 		}
 	}
 
@@ -2670,6 +2755,17 @@ bool mp4_mux_submit_packet(struct mp4_mux *mux, struct encoder_packet *pkt)
 	return true;
 }
 
+void mp4_mux_set_fragment_callback(struct mp4_mux *mux, mp4_mux_fragment_cb callback, void *param)
+{
+	mux->fragment_cb = callback;
+	mux->fragment_cb_param = param;
+}
+
+void mp4_mux_set_fragment_duration(struct mp4_mux *mux, int64_t duration_usec)
+{
+	mux->fragment_duration = duration_usec;
+}
+
 bool mp4_mux_add_chapter(struct mp4_mux *mux, int64_t dts_usec, const char *name)
 {
 	if (dts_usec < 0)
@@ -2705,6 +2801,10 @@ bool mp4_mux_finalise(struct mp4_mux *mux)
 
 	info("Number of fragments: %u", mux->fragments_written);
 
+	/* CMAF segments have no file to finalise */
+	if (mux->flags & MP4_CMAF_SEGMENTS)
+		return true;
+
 	if (mux->flags & MP4_SKIP_FINALISATION) {
 		warn("Skipping MP4 finalization!");
 		return true;
@@ -31,10 +31,31 @@ enum mp4_mux_flags {
 	MP4_SKIP_FINALISATION = 1 << 2,
 	/* Use negative CTS instead of edit lists */
 	MP4_USE_NEGATIVE_CTS = 1 << 3,
+	/* Write self-contained CMAF fragments for segmented delivery instead
+	 * of a single file, see mp4_mux_set_fragment_callback() */
+	MP4_CMAF_SEGMENTS = 1 << 4,
 };
 
+struct mp4_fragment_info {
+	/* Init segment (ftyp + moov) rather than a media fragment */
+	bool init;
+	/* Fragment starts with a keyframe on the primary video track */
+	bool independent;
+	/* Timing of the primary video track samples in the fragment */
+	int64_t start_usec;
+	int64_t duration_usec;
+};
+
+/* Called after a fragment has been written to the serializer */
+typedef void (*mp4_mux_fragment_cb)(void *param, const struct mp4_fragment_info *info);
+
 struct mp4_mux *mp4_mux_create(obs_output_t *output, struct serializer *serializer, enum mp4_mux_flags flags);
 void mp4_mux_destroy(struct mp4_mux *mux);
 bool mp4_mux_submit_packet(struct mp4_mux *mux, struct encoder_packet *pkt);
 bool mp4_mux_add_chapter(struct mp4_mux *mux, int64_t dts_usec, const char *name);
 bool mp4_mux_finalise(struct mp4_mux *mux);
+
+void mp4_mux_set_fragment_callback(struct mp4_mux *mux, mp4_mux_fragment_cb callback, void *param);
+/* Also fragment between keyframes so that fragments on the primary video
+ * track never exceed this duration, 0 to only fragment on keyframes */
+void mp4_mux_set_fragment_duration(struct mp4_mux *mux, int64_t duration_usec);
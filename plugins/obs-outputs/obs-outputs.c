@@ -13,9 +13,11 @@ MODULE_EXPORT const char *obs_module_description(void)
 }
 
 extern struct obs_output_info rtmp_output_info;
+extern struct obs_output_info rtmp_multi_output_info;
 extern struct obs_output_info null_output_info;
 extern struct obs_output_info flv_output_info;
 extern struct obs_output_info mp4_output_info;
+extern struct obs_output_info cmaf_output_info;
 
 #if defined(_WIN32) && defined(MBEDTLS_THREADING_ALT)
 void mbed_mutex_init(mbedtls_threading_mutex_t *m)
@@ -60,9 +62,11 @@ bool obs_module_load(void)
 #endif
 
 	obs_register_output(&rtmp_output_info);
+	obs_register_output(&rtmp_multi_output_info);
 	obs_register_output(&null_output_info);
 	obs_register_output(&flv_output_info);
 	obs_register_output(&mp4_output_info);
+	obs_register_output(&cmaf_output_info);
 	return true;
 }
 
@@ -0,0 +1,236 @@
+/******************************************************************************
+    Copyright (C) 2026 by OBS Project contributors
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+******************************************************************************/
+
+#include <string.h>
+#include <util/bmem.h>
+
+#include "rtmp-congestion.h"
+
+/* ------------------------------------------------------------------------- */
+/* Delivery rate controller
+ *
+ * Measures the rate at which the peer acknowledges data and watches the round
+ * trip time for queues building up in the network.  While the path is not
+ * congested the bitrate slowly probes upward, once a queue is detected the
+ * bitrate is brought down to what was actually delivered, with some margin
+ * so the queue can drain. */
+
+#define DR_SAMPLE_INTERVAL_NS 100000000ULL
+#define DR_WINDOW_BINS 10
+#define DR_BIN_DURATION_NS 1000000000ULL
+
+/* queueing delay that counts as congestion, at least this much and at least
+ * the minimum round trip time */
+#define DR_MIN_QUEUE_DELAY_USEC 50000
+/* duration of buffered packets in the output that counts as congestion */
+#define DR_MAX_QUEUED_USEC 200000
+
+#define DR_DRAIN_GAIN 0.85
+#define DR_PROBE_GAIN_PER_SEC 0.03
+#define DR_PROBE_MIN_DELIVERY 0.97
+#define DR_PACING_GAIN 1.25
+#define DR_HOLD_NS 5000000000ULL
+
+struct delivery_rate_cc {
+	long max_bitrate;
+	long min_bitrate;
+	long audio_bitrate;
+
+	double bitrate;
+	double delivery_kbps;
+
+	double bins[DR_WINDOW_BINS];
+	size_t bin_idx;
+	uint64_t bin_start;
+
+	bool have_sample;
+	uint64_t last_ts;
+	uint64_t last_delivered;
+	uint32_t min_rtt_usec;
+	uint64_t hold_until;
+};
+
+static void *dr_create(long max_bitrate, long min_bitrate, long audio_bitrate)
+{
+	struct delivery_rate_cc *cc = bzalloc(sizeof(*cc));
+	cc->max_bitrate = max_bitrate;
+	cc->min_bitrate = min_bitrate;
+	cc->audio_bitrate = audio_bitrate;
+	cc->bitrate = (double)max_bitrate;
+	return cc;
+}
+
+static void dr_destroy(void *data)
+{
+	bfree(data);
+}
+
+static void dr_add_to_window(struct delivery_rate_cc *cc, uint64_t ts, double kbps)
+{
+	if (!cc->bin_start) {
+		cc->bin_start = ts;
+	} else if (ts - cc->bin_start >= DR_BIN_DURATION_NS) {
+		cc->bin_idx = (cc->bin_idx + 1) % DR_WINDOW_BINS;
+		cc->bins[cc->bin_idx] = 0.0;
+		cc->bin_start = ts;
+	}
+
+	if (kbps > cc->bins[cc->bin_idx])
+		cc->bins[cc->bin_idx] = kbps;
+}
+
+static double dr_max_delivery(const struct delivery_rate_cc *cc)
+{
+	double max = 0.0;
+	for (size_t i = 0; i < DR_WINDOW_BINS; i++) {
+		if (cc->bins[i] > max)
+			max = cc->bins[i];
+	}
+	return max;
+}
+
+static bool dr_congested(struct delivery_rate_cc *cc, const struct rtmp_cc_sample *sample)
+{
+	if (sample->queued_usec > DR_MAX_QUEUED_USEC)
+		return true;
+	if (!sample->rtt_usec || !cc->min_rtt_usec)
+		return false;
+
+	uint32_t threshold = cc->min_rtt_usec > DR_MIN_QUEUE_DELAY_USEC ? cc->min_rtt_usec : DR_MIN_QUEUE_DELAY_USEC;
+	return sample->rtt_usec > cc->min_rtt_usec + threshold;
+}
+
+static void dr_update(void *data, const struct rtmp_cc_sample *sample)
+{
+	struct delivery_rate_cc *cc = data;
+	uint64_t delivered = sample->bytes_acked ? sample->bytes_acked : sample->bytes_sent;
+
+	if (!cc->have_sample) {
+		cc->have_sample = true;
+		cc->last_ts = sample->ts;
+		cc->last_delivered = delivered;
+		return;
+	}
+
+	uint64_t elapsed = sample->ts - cc->last_ts;
+	if (elapsed < DR_SAMPLE_INTERVAL_NS)
+		return;
+
+	double kbps = (double)(delivered - cc->last_delivered) * 8000000.0 / (double)elapsed;
+	cc->last_ts = sample->ts;
+	cc->last_delivered = delivered;
+
+	cc->delivery_kbps = cc->delivery_kbps > 0.0 ? cc->delivery_kbps * 0.75 + kbps * 0.25 : kbps;
+	dr_add_to_window(cc, sample->ts, cc->delivery_kbps);
+
+	if (sample->min_rtt_usec)
+		cc->min_rtt_usec = sample->min_rtt_usec;
+	else if (sample->rtt_usec && (!cc->min_rtt_usec || sample->rtt_usec < cc->min_rtt_usec))
+		cc->min_rtt_usec = sample->rtt_usec;
+
+	if (dr_congested(cc, sample)) {
+		/* whatever got through while congested is what the path can
+		 * carry, leave room for the queue to drain */
+		double target = cc->delivery_kbps * DR_DRAIN_GAIN - (double)cc->audio_bitrate;
+
+		if (target < cc->bitrate)
+			cc->bitrate = (cc->bitrate + target) * 0.5;
+
+		cc->hold_until = sample->ts + DR_HOLD_NS;
+
+	} else if (sample->ts >= cc->hold_until &&
+		   cc->delivery_kbps >= (cc->bitrate + (double)cc->audio_bitrate) * DR_PROBE_MIN_DELIVERY) {
+		/* only probe while the path keeps up with what is produced */
+		cc->bitrate += cc->bitrate * DR_PROBE_GAIN_PER_SEC * (double)elapsed / 1000000000.0;
+	}
+
+	if (cc->bitrate > (double)cc->max_bitrate)
+		cc->bitrate = (double)cc->max_bitrate;
+	if (cc->bitrate < (double)cc->min_bitrate)
+		cc->bitrate = (double)cc->min_bitrate;
+}
+
+static long dr_get_bitrate(void *data)
+{
+	struct delivery_rate_cc *cc = data;
+	return (long)cc->bitrate;
+}
+
+static uint64_t dr_get_pacing_rate(void *data)
+{
+	struct delivery_rate_cc *cc = data;
+	double kbps = dr_max_delivery(cc);
+	double wanted = cc->bitrate + (double)cc->audio_bitrate;
+
+	if (kbps <= 0.0)
+		return 0;
+	if (kbps < wanted)
+		kbps = wanted;
+
+	return (uint64_t)(kbps * DR_PACING_GAIN * 1000.0 / 8.0);
+}
+
+static const struct rtmp_cc_info delivery_rate_cc_info = {
+	.id = "delivery_rate",
+	.create = dr_create,
+	.destroy = dr_destroy,
+	.update = dr_update,
+	.get_bitrate = dr_get_bitrate,
+	.get_pacing_rate = dr_get_pacing_rate,
+};
+
+/* ------------------------------------------------------------------------- */
+
+static const struct rtmp_cc_info *controllers[] = {
+	&delivery_rate_cc_info,
+};
+
+const struct rtmp_cc_info *rtmp_cc_find(const char *id)
+{
+	if (!id || !*id)
+		return NULL;
+
+	for (size_t i = 0; i < sizeof(controllers) / sizeof(controllers[0]); i++) {
+		if (strcmp(controllers[i]->id, id) == 0)
+			return controllers[i];
+	}
+
+	return NULL;
+}
+
+bool rtmp_cc_create(struct rtmp_cc *cc, const char *id, long max_bitrate, long min_bitrate, long audio_bitrate)
+{
+	const struct rtmp_cc_info *info = rtmp_cc_find(id);
+
+	rtmp_cc_destroy(cc);
+
+	if (!info)
+		return false;
+
+	cc->info = info;
+	cc->data = info->create(max_bitrate, min_bitrate, audio_bitrate);
+	return true;
+}
+
+void rtmp_cc_destroy(struct rtmp_cc *cc)
+{
+	if (cc->info)
+		cc->info->destroy(cc->data);
+
+	cc->info = NULL;
+	cc->data = NULL;
+}
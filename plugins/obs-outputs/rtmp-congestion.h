@@ -0,0 +1,92 @@
+/******************************************************************************
+    Copyright (C) 2026 by OBS Project contributors
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+******************************************************************************/
+
+#pragma once
+
+#include <util/c99defs.h>
+
+/* Congestion controllers decide the video bitrate and the send pacing rate of
+ * a stream from periodic samples of the connection state.  They are pure
+ * computation and are driven by the send thread of the output. */
+
+struct rtmp_cc_sample {
+	/* time of the sample in nanoseconds */
+	uint64_t ts;
+
+	/* total bytes handed to the socket */
+	uint64_t bytes_sent;
+
+	/* total bytes acknowledged by the peer, 0 if the platform does not
+	 * report it, in which case bytes_sent is used as delivered */
+	uint64_t bytes_acked;
+
+	/* smoothed and minimum round trip time, 0 if unknown */
+	uint32_t rtt_usec;
+	uint32_t min_rtt_usec;
+
+	/* duration of the packets waiting to be sent by the output */
+	int64_t queued_usec;
+};
+
+struct rtmp_cc_info {
+	const char *id;
+
+	/* bitrates are video bitrates in kbps, audio_bitrate is added on top
+	 * of the video bitrate on the wire */
+	void *(*create)(long max_bitrate, long min_bitrate, long audio_bitrate);
+	void (*destroy)(void *data);
+
+	void (*update)(void *data, const struct rtmp_cc_sample *sample);
+
+	/* video bitrate the encoder should use */
+	long (*get_bitrate)(void *data);
+
+	/* bytes per second to pace sends at, 0 to send as fast as possible */
+	uint64_t (*get_pacing_rate)(void *data);
+};
+
+struct rtmp_cc {
+	const struct rtmp_cc_info *info;
+	void *data;
+};
+
+/* returns NULL if there is no controller with this id */
+extern const struct rtmp_cc_info *rtmp_cc_find(const char *id);
+
+extern bool rtmp_cc_create(struct rtmp_cc *cc, const char *id, long max_bitrate, long min_bitrate,
+			   long audio_bitrate);
+extern void rtmp_cc_destroy(struct rtmp_cc *cc);
+
+static inline bool rtmp_cc_active(const struct rtmp_cc *cc)
+{
+	return cc->info != NULL;
+}
+
+static inline void rtmp_cc_update(struct rtmp_cc *cc, const struct rtmp_cc_sample *sample)
+{
+	cc->info->update(cc->data, sample);
+}
+
+static inline long rtmp_cc_get_bitrate(struct rtmp_cc *cc)
+{
+	return cc->info->get_bitrate(cc->data);
+}
+
+static inline uint64_t rtmp_cc_get_pacing_rate(struct rtmp_cc *cc)
+{
+	return cc->info->get_pacing_rate ? cc->info->get_pacing_rate(cc->data) : 0;
+}
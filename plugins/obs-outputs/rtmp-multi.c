@@ -0,0 +1,1074 @@
+/******************************************************************************
+    Copyright (C) 2026 by OBS Project contributors
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+******************************************************************************/
+
+/* Streams one set of encoders to several RTMP servers.  Packets are
+ * interleaved once by libobs and serialized to FLV once, the resulting tags
+ * are reference counted and shared by the send queues of all destinations.
+ * Every destination has its own connection, send thread and frame drop state,
+ * so a slow server only drops frames on its own queue. */
+
+#include <obs-module.h>
+#include <obs-avc.h>
+#include <obs-hevc.h>
+#include <util/platform.h>
+#include <util/deque.h>
+#include <util/darray.h>
+#include <util/dstr.h>
+#include <util/threading.h>
+#include <inttypes.h>
+#include "librtmp/rtmp.h"
+#include "librtmp/log.h"
+#include "flv-mux.h"
+#include "rtmp-av1.h"
+#include "rtmp-hevc.h"
+
+#ifndef _WIN32
+#include <sys/ioctl.h>
+#endif
+
+#define do_log(level, format, ...) \
+	blog(level, "[rtmp multi: '%s'] " format, obs_output_get_name(multi->output), ##__VA_ARGS__)
+#define dest_log(level, format, ...)                                                                        \
+	blog(level, "[rtmp multi: '%s' #%zu] " format, obs_output_get_name(dest->multi->output), dest->idx, \
+	     ##__VA_ARGS__)
+
+#define warn(format, ...) do_log(LOG_WARNING, format, ##__VA_ARGS__)
+#define info(format, ...) do_log(LOG_INFO, format, ##__VA_ARGS__)
+
+#define OPT_DESTINATIONS "destinations"
+#define OPT_SERVER "server"
+#define OPT_KEY "key"
+#define OPT_USERNAME "username"
+#define OPT_PASSWORD "password"
+#define OPT_DROP_THRESHOLD "drop_threshold_ms"
+#define OPT_PFRAME_DROP_THRESHOLD "pframe_drop_threshold_ms"
+#define OPT_MAX_SHUTDOWN_TIME_SEC "max_shutdown_time_sec"
+
+/* One serialized FLV tag.  The data is written by every destination but
+ * never modified, so the tag is freed when the last queue releases it. */
+struct flv_tag {
+	volatile long refs;
+	uint8_t *data;
+	size_t size;
+
+	enum obs_encoder_type type;
+	size_t track_idx;
+	bool keyframe;
+	int drop_priority;
+	int64_t pts;
+	int64_t dts_usec;
+	int64_t sys_dts_usec;
+};
+
+struct rtmp_multi;
+
+struct rtmp_dest {
+	struct rtmp_multi *multi;
+	size_t idx;
+
+	struct dstr server, key;
+	struct dstr username, password;
+	struct dstr encoder_name;
+	RTMP rtmp;
+
+	pthread_t send_thread;
+	bool thread_active;
+	os_sem_t *send_sem;
+	bool sent_headers;
+	int stop_code;
+
+	/* queued tags and the drop state below are protected by mutex */
+	pthread_mutex_t mutex;
+	struct deque tags;
+	bool connected;
+	bool got_keyframe;
+
+	int64_t drop_threshold_usec;
+	int64_t pframe_drop_threshold_usec;
+	int min_priority;
+	int64_t last_dts_usec;
+	float congestion;
+
+	uint64_t total_bytes_sent;
+	int dropped_frames;
+};
+
+struct rtmp_multi {
+	obs_output_t *output;
+
+	DARRAY(struct rtmp_dest *) dests;
+	volatile long active_dests;
+
+	/* only accessed from the encoded packet callback until the first tag
+	 * has been queued, read only by the send threads afterwards */
+	DARRAY(struct flv_tag *) headers;
+	bool got_first_packet;
+	int64_t start_dts_offset;
+
+	enum audio_id_t audio_codec[MAX_OUTPUT_AUDIO_ENCODERS];
+	enum video_id_t video_codec[MAX_OUTPUT_VIDEO_ENCODERS];
+
+	volatile bool active;
+	volatile bool encode_error;
+	os_event_t *stop_event;
+	uint64_t stop_ts;
+	uint64_t shutdown_timeout_ts;
+	int max_shutdown_time_sec;
+};
+
+static const char *rtmp_multi_getname(void *unused)
+{
+	UNUSED_PARAMETER(unused);
+	return obs_module_text("RTMPMulti");
+}
+
+static void log_rtmp(int level, const char *format, va_list args)
+{
+	if (level > RTMP_LOGWARNING)
+		return;
+
+	blogva(LOG_INFO, format, args);
+}
+
+static inline bool stopping(struct rtmp_multi *multi)
+{
+	return os_event_try(multi->stop_event) != EAGAIN;
+}
+
+static inline bool active(struct rtmp_multi *multi)
+{
+	return os_atomic_load_bool(&multi->active);
+}
+
+/* ------------------------------------------------------------------------- */
+/* Shared tags                                                               */
+
+static struct flv_tag *flv_tag_create(uint8_t *data, size_t size)
+{
+	struct flv_tag *tag = bzalloc(sizeof(struct flv_tag));
+	tag->refs = 1;
+	tag->data = data;
+	tag->size = size;
+	return tag;
+}
+
+static inline void flv_tag_addref(struct flv_tag *tag)
+{
+	os_atomic_inc_long(&tag->refs);
+}
+
+static inline void flv_tag_release(struct flv_tag *tag)
+{
+	if (os_atomic_dec_long(&tag->refs) == 0) {
+		bfree(tag->data);
+		bfree(tag);
+	}
+}
+
+static void free_headers(struct rtmp_multi *multi)
+{
+	for (size_t i = 0; i < multi->headers.num; i++)
+		flv_tag_release(multi->headers.array[i]);
+	da_free(multi->headers);
+}
+
+static void add_audio_header(struct rtmp_multi *multi, size_t idx)
+{
+	obs_encoder_t *aencoder = obs_output_get_audio_encoder(multi->output, idx);
+	struct encoder_packet packet = {.type = OBS_ENCODER_AUDIO, .timebase_den = 1};
+	uint8_t *data;
+	size_t size;
+
+	if (!aencoder || !obs_encoder_get_extra_data(aencoder, &packet.data, &packet.size))
+		return;
+
+	if (idx == 0)
+		flv_packet_mux(&packet, 0, &data, &size, true);
+	else
+		flv_packet_audio_start(&packet, multi->audio_codec[idx], &data, &size, idx);
+
+	struct flv_tag *tag = flv_tag_create(data, size);
+	da_push_back(multi->headers, &tag);
+}
+
+/* same as rtmp_stream, HDR metadata is only sent for the Y2023 codecs */
+static void add_video_metadata(struct rtmp_multi *multi, size_t idx)
+{
+	const struct video_output_info *info = video_output_get_info(obs_get_video());
+	enum video_id_t codec = multi->video_codec[idx];
+	int bits_per_raw_sample = 8;
+	int trc;
+	int max_luminance;
+	uint8_t *data;
+	size_t size;
+
+	if (codec == CODEC_H264)
+		return;
+
+	if (info->colorspace == VIDEO_CS_2100_PQ) {
+		trc = 16; // OBSCOL_TRC_SMPTE2084
+		max_luminance = (int)obs_get_video_hdr_nominal_peak_level();
+	} else if (info->colorspace == VIDEO_CS_2100_HLG) {
+		trc = 18; // OBSCOL_TRC_ARIB_STD_B67
+		max_luminance = 1000;
+	} else {
+		return;
+	}
+
+	if (info->format == VIDEO_FORMAT_I010 || info->format == VIDEO_FORMAT_P010 ||
+	    info->format == VIDEO_FORMAT_I210)
+		bits_per_raw_sample = 10;
+	else if (info->format == VIDEO_FORMAT_I412 || info->format == VIDEO_FORMAT_YA2L)
+		bits_per_raw_sample = 12;
+
+	// OBSCOL_PRI_BT2020, OBSCOL_SPC_BT2020_NCL
+	flv_packet_metadata(codec, &data, &size, bits_per_raw_sample, 9, trc, 9, 0, max_luminance, idx);
+
+	struct flv_tag *tag = flv_tag_create(data, size);
+	da_push_back(multi->headers, &tag);
+}
+
+static void add_video_header(struct rtmp_multi *multi, size_t idx)
+{
+	obs_encoder_t *vencoder = obs_output_get_video_encoder2(multi->output, idx);
+	struct encoder_packet packet = {.type = OBS_ENCODER_VIDEO, .timebase_den = 1, .keyframe = true};
+	uint8_t *header;
+	size_t header_size;
+	uint8_t *data = NULL;
+	size_t size = 0;
+
+	if (!obs_encoder_get_extra_data(vencoder, &header, &header_size))
+		return;
+
+	switch (multi->video_codec[idx]) {
+	case CODEC_NONE:
+		return;
+	case CODEC_H264:
+		packet.size = obs_parse_avc_header(&packet.data, header, header_size);
+		// Always send H.264 on track 0 as old style for compatibility.
+		if (idx == 0)
+			flv_packet_mux(&packet, 0, &data, &size, true);
+		else
+			flv_packet_start(&packet, CODEC_H264, &data, &size, idx);
+		break;
+	case CODEC_HEVC:
+#ifdef ENABLE_HEVC
+		packet.size = obs_parse_hevc_header(&packet.data, header, header_size);
+		flv_packet_start(&packet, CODEC_HEVC, &data, &size, idx);
+		break;
+#else
+		return;
+#endif
+	case CODEC_AV1:
+		packet.size = obs_parse_av1_header(&packet.data, header, header_size);
+		flv_packet_start(&packet, CODEC_AV1, &data, &size, idx);
+		break;
+	}
+
+	bfree(packet.data);
+
+	struct flv_tag *tag = flv_tag_create(data, size);
+	da_push_back(multi->headers, &tag);
+}
+
+/* Serializes the tags every destination sends after connecting.  Encoders may
+ * only know their headers once they produced the first packet, so this is
+ * done when the first packet arrives rather than on start. */
+static void build_headers(struct rtmp_multi *multi)
+{
+	uint8_t *data;
+	size_t size;
+
+	flv_meta_data(multi->output, &data, &size, false);
+	struct flv_tag *tag = flv_tag_create(data, size);
+	da_push_back(multi->headers, &tag);
+
+	add_audio_header(multi, 0);
+
+	for (size_t i = 0; i < MAX_OUTPUT_VIDEO_ENCODERS; i++) {
+		if (!obs_output_get_video_encoder2(multi->output, i))
+			continue;
+
+		add_video_metadata(multi, i);
+		add_video_header(multi, i);
+	}
+
+	for (size_t i = 1; i < MAX_OUTPUT_AUDIO_ENCODERS; i++)
+		add_audio_header(multi, i);
+}
+
+static struct flv_tag *serialize_packet(struct rtmp_multi *multi, struct encoder_packet *packet)
+{
+	int32_t offset = (int32_t)multi->start_dts_offset;
+	size_t idx = packet->track_idx;
+	uint8_t *data;
+	size_t size = 0;
+
+	if (packet->type == OBS_ENCODER_VIDEO && (multi->video_codec[idx] != CODEC_H264 || idx != 0))
+		flv_packet_frames(packet, multi->video_codec[idx], offset, &data, &size, idx);
+	else if (packet->type == OBS_ENCODER_AUDIO && idx != 0)
+		flv_packet_audio_frames(packet, multi->audio_codec[idx], offset, &data, &size, idx);
+	else
+		flv_packet_mux(packet, offset, &data, &size, false);
+
+	struct flv_tag *tag = flv_tag_create(data, size);
+	tag->type = packet->type;
+	tag->track_idx = idx;
+	tag->keyframe = packet->keyframe;
+	tag->drop_priority = packet->drop_priority;
+	tag->pts = packet->pts;
+	tag->dts_usec = packet->dts_usec;
+	tag->sys_dts_usec = packet->sys_dts_usec;
+	return tag;
+}
+
+/* ------------------------------------------------------------------------- */
+/* Destinations                                                              */
+
+static inline size_t num_queued_tags(struct rtmp_dest *dest)
+{
+	return dest->tags.size / sizeof(struct flv_tag *);
+}
+
+static void free_tags(struct rtmp_dest *dest)
+{
+	pthread_mutex_lock(&dest->mutex);
+	while (dest->tags.size) {
+		struct flv_tag *tag;
+		deque_pop_front(&dest->tags, &tag, sizeof(tag));
+		flv_tag_release(tag);
+	}
+	pthread_mutex_unlock(&dest->mutex);
+}
+
+static inline bool get_next_tag(struct rtmp_dest *dest, struct flv_tag **tag)
+{
+	bool new_tag = false;
+
+	pthread_mutex_lock(&dest->mutex);
+	if (dest->tags.size) {
+		deque_pop_front(&dest->tags, tag, sizeof(*tag));
+		new_tag = true;
+	}
+	pthread_mutex_unlock(&dest->mutex);
+
+	return new_tag;
+}
+
+static void drop_tags(struct rtmp_dest *dest, int highest_priority)
+{
+	size_t num_tags = num_queued_tags(dest);
+	int num_frames_dropped = 0;
+
+	/* same rotation as rtmp_stream, kept tags fill the space of the
+	 * popped ones so the deque never reallocates */
+	for (size_t i = 0; i < num_tags; i++) {
+		struct flv_tag *tag;
+		deque_pop_front(&dest->tags, &tag, sizeof(tag));
+
+		/* do not drop audio data or video keyframes */
+		if (tag->type == OBS_ENCODER_AUDIO || tag->drop_priority >= highest_priority) {
+			deque_push_back(&dest->tags, &tag, sizeof(tag));
+		} else {
+			num_frames_dropped++;
+			flv_tag_release(tag);
+		}
+	}
+
+	if (dest->min_priority < highest_priority)
+		dest->min_priority = highest_priority;
+
+	dest->dropped_frames += num_frames_dropped;
+}
+
+static struct flv_tag *find_first_video_tag(struct rtmp_dest *dest)
+{
+	size_t count = num_queued_tags(dest);
+
+	for (size_t i = 0; i < count; i++) {
+		struct flv_tag *tag = *(struct flv_tag **)deque_data(&dest->tags, i * sizeof(tag));
+		if (tag->type == OBS_ENCODER_VIDEO && !tag->keyframe)
+			return tag;
+	}
+
+	return NULL;
+}
+
+static void check_to_drop_tags(struct rtmp_dest *dest, bool pframes)
+{
+	int priority = pframes ? OBS_NAL_PRIORITY_HIGHEST : OBS_NAL_PRIORITY_HIGH;
+	int64_t drop_threshold = pframes ? dest->pframe_drop_threshold_usec : dest->drop_threshold_usec;
+	struct flv_tag *first;
+
+	if (num_queued_tags(dest) < 5) {
+		if (!pframes)
+			dest->congestion = 0.0f;
+		return;
+	}
+
+	first = find_first_video_tag(dest);
+	if (!first)
+		return;
+
+	/* if the amount of time stored in the queued tags waiting to be sent
+	 * is higher than threshold, drop frames */
+	int64_t buffer_duration_usec = dest->last_dts_usec - first->dts_usec;
+
+	if (!pframes)
+		dest->congestion = (float)buffer_duration_usec / (float)drop_threshold;
+
+	if (buffer_duration_usec > drop_threshold)
+		drop_tags(dest, priority);
+}
+
+static bool add_video_tag(struct rtmp_dest *dest, struct flv_tag *tag)
+{
+	check_to_drop_tags(dest, false);
+	check_to_drop_tags(dest, true);
+
+	/* if currently dropping frames, drop tags until it reaches the
+	 * desired priority */
+	if (tag->drop_priority < dest->min_priority) {
+		dest->dropped_frames++;
+		return false;
+	} else {
+		dest->min_priority = 0;
+	}
+
+	dest->last_dts_usec = tag->dts_usec;
+	return true;
+}
+
+static void add_tag(struct rtmp_dest *dest, struct flv_tag *tag)
+{
+	bool added = false;
+	bool wake = false;
+
+	pthread_mutex_lock(&dest->mutex);
+
+	if (!dest->connected)
+		goto unlock;
+
+	/* destinations that connected late start with the next keyframe, the
+	 * stream is not decodable before it */
+	if (!dest->got_keyframe) {
+		if (tag->type != OBS_ENCODER_VIDEO || tag->track_idx != 0 || !tag->keyframe) {
+			wake = stopping(dest->multi);
+			goto unlock;
+		}
+		dest->got_keyframe = true;
+	}
+
+	added = tag->type == OBS_ENCODER_VIDEO ? add_video_tag(dest, tag) : true;
+	if (added) {
+		flv_tag_addref(tag);
+		deque_push_back(&dest->tags, &tag, sizeof(tag));
+	}
+
+unlock:
+	pthread_mutex_unlock(&dest->mutex);
+
+	if (added || wake)
+		os_sem_post(dest->send_sem);
+}
+
+static inline void set_rtmp_dstr(AVal *val, struct dstr *str)
+{
+	bool valid = !dstr_is_empty(str);
+	val->av_val = valid ? str->array : NULL;
+	val->av_len = valid ? (int)str->len : 0;
+}
+
+static int connect_dest(struct rtmp_dest *dest)
+{
+	RTMP *rtmp = &dest->rtmp;
+
+	dest_log(LOG_INFO, "Connecting to RTMP URL %s...", dest->server.array);
+
+	RTMP_TLS_Free(rtmp);
+	RTMP_Init(rtmp);
+
+	if (!RTMP_SetupURL(rtmp, dest->server.array))
+		return OBS_OUTPUT_BAD_PATH;
+
+	RTMP_EnableWrite(rtmp);
+
+	dstr_copy(&dest->encoder_name, "FMLE/3.0 (compatible; FMSc/1.0)");
+
+	set_rtmp_dstr(&rtmp->Link.pubUser, &dest->username);
+	set_rtmp_dstr(&rtmp->Link.pubPasswd, &dest->password);
+	set_rtmp_dstr(&rtmp->Link.flashVer, &dest->encoder_name);
+	rtmp->Link.swfUrl = rtmp->Link.tcUrl;
+
+	RTMP_AddStream(rtmp, dest->key.array);
+
+	rtmp->m_outChunkSize = 4096;
+	rtmp->m_bSendChunkSizeInfo = true;
+	rtmp->m_bUseNagle = true;
+
+	if (!RTMP_Connect(rtmp, NULL))
+		return OBS_OUTPUT_CONNECT_FAILED;
+	if (!RTMP_ConnectStream(rtmp, 0))
+		return OBS_OUTPUT_INVALID_STREAM;
+
+	dest_log(LOG_INFO, "Connection to %s successful", dest->server.array);
+	return OBS_OUTPUT_SUCCESS;
+}
+
+/* reads acknowledgements and pings so the server does not stall */
+static bool handle_socket_read(struct rtmp_dest *dest)
+{
+	int recv_size = 0;
+	int ret;
+
+#ifdef _WIN32
+	ret = ioctlsocket(dest->rtmp.m_sb.sb_socket, FIONREAD, (u_long *)&recv_size);
+#else
+	ret = ioctl(dest->rtmp.m_sb.sb_socket, FIONREAD, &recv_size);
+#endif
+
+	if (ret >= 0 && recv_size > 0) {
+		RTMPPacket packet = {0};
+
+		if (!RTMP_ReadPacket(&dest->rtmp, &packet)) {
+			dest_log(LOG_ERROR, "RTMP_ReadPacket error");
+			return false;
+		}
+
+		RTMPPacket_Free(&packet);
+	}
+
+	return true;
+}
+
+static inline bool write_tag(struct rtmp_dest *dest, const struct flv_tag *tag)
+{
+	if (!handle_socket_read(dest))
+		return false;
+	if (RTMP_Write(&dest->rtmp, (const char *)tag->data, (int)tag->size, 0) < 0)
+		return false;
+
+	dest->total_bytes_sent += tag->size;
+	return true;
+}
+
+static bool send_headers(struct rtmp_dest *dest)
+{
+	struct rtmp_multi *multi = dest->multi;
+
+	dest->sent_headers = true;
+
+	for (size_t i = 0; i < multi->headers.num; i++) {
+		if (!write_tag(dest, multi->headers.array[i]))
+			return false;
+	}
+
+	return true;
+}
+
+/* the end of sequence tags are a few bytes and only sent once, so they are
+ * serialized by every destination */
+static bool send_footers(struct rtmp_dest *dest)
+{
+	struct rtmp_multi *multi = dest->multi;
+
+	for (size_t i = 0; i < MAX_OUTPUT_VIDEO_ENCODERS; i++) {
+		struct encoder_packet packet = {.type = OBS_ENCODER_VIDEO, .timebase_den = 1};
+		struct flv_tag tag = {0};
+
+		if (!obs_output_get_video_encoder2(multi->output, i))
+			continue;
+		if (i == 0 && multi->video_codec[i] == CODEC_H264)
+			continue;
+
+		flv_packet_end(&packet, multi->video_codec[i], &tag.data, &tag.size, i);
+		bool success = write_tag(dest, &tag);
+		bfree(tag.data);
+
+		if (!success)
+			return false;
+	}
+
+	return true;
+}
+
+static inline bool can_shutdown(struct rtmp_multi *multi, const struct flv_tag *tag)
+{
+	uint64_t cur_time = os_gettime_ns();
+	bool timeout = cur_time >= multi->shutdown_timeout_ts;
+
+	return timeout || tag->sys_dts_usec >= (int64_t)multi->stop_ts;
+}
+
+static void finish_dest(struct rtmp_dest *dest)
+{
+	struct rtmp_multi *multi = dest->multi;
+
+	pthread_mutex_lock(&dest->mutex);
+	dest->connected = false;
+	pthread_mutex_unlock(&dest->mutex);
+
+	free_tags(dest);
+
+	/* the last destination to finish ends the output, one server going
+	 * away does not affect the others */
+	if (os_atomic_dec_long(&multi->active_dests) != 0)
+		return;
+
+	bool encode_error = os_atomic_load_bool(&multi->encode_error);
+	os_atomic_set_bool(&multi->active, false);
+
+	if (!stopping(multi))
+		obs_output_signal_stop(multi->output, dest->stop_code);
+	else if (encode_error)
+		obs_output_signal_stop(multi->output, OBS_OUTPUT_ENCODE_ERROR);
+	else
+		obs_output_end_data_capture(multi->output);
+}
+
+static void *send_thread(void *data)
+{
+	struct rtmp_dest *dest = data;
+	struct rtmp_multi *multi = dest->multi;
+
+	os_set_thread_name("rtmp-multi: send_thread");
+
+	dest->stop_code = connect_dest(dest);
+	if (dest->stop_code != OBS_OUTPUT_SUCCESS) {
+		dest_log(LOG_WARNING, "Connection to %s failed: %d", dest->server.array, dest->stop_code);
+		RTMP_Close(&dest->rtmp);
+		finish_dest(dest);
+		return NULL;
+	}
+
+	pthread_mutex_lock(&dest->mutex);
+	dest->connected = true;
+	pthread_mutex_unlock(&dest->mutex);
+
+	dest->stop_code = OBS_OUTPUT_DISCONNECTED;
+	bool disconnected = false;
+
+	while (os_sem_wait(dest->send_sem) == 0) {
+		struct flv_tag *tag;
+
+		if (stopping(multi) && multi->stop_ts == 0)
+			break;
+
+		if (!get_next_tag(dest, &tag)) {
+			/* nothing was sent yet, no need to wait for the stop
+			 * timestamp */
+			if (stopping(multi) && !dest->sent_headers)
+				break;
+			continue;
+		}
+
+		if (stopping(multi) && can_shutdown(multi, tag)) {
+			flv_tag_release(tag);
+			break;
+		}
+
+		if ((!dest->sent_headers && !send_headers(dest)) || !write_tag(dest, tag)) {
+			flv_tag_release(tag);
+			disconnected = true;
+			break;
+		}
+
+		/* the frame trace records whichever destination sent the
+		 * frame first */
+		struct encoder_packet sent = {.type = tag->type, .track_idx = tag->track_idx, .pts = tag->pts};
+		obs_output_packet_sent(multi->output, &sent);
+
+		flv_tag_release(tag);
+	}
+
+	if (disconnected) {
+		dest_log(LOG_INFO, "Disconnected from %s", dest->server.array);
+	} else {
+		if (dest->sent_headers)
+			send_footers(dest); // Y2023 spec
+		dest->stop_code = OBS_OUTPUT_SUCCESS;
+	}
+
+	dest_log(LOG_INFO, "Sent %" PRIu64 " bytes, dropped %d frames", dest->total_bytes_sent, dest->dropped_frames);
+
+	RTMP_Close(&dest->rtmp);
+	finish_dest(dest);
+	return NULL;
+}
+
+static void destroy_dest(struct rtmp_dest *dest)
+{
+	if (dest->thread_active)
+		pthread_join(dest->send_thread, NULL);
+
+	free_tags(dest);
+	deque_free(&dest->tags);
+	RTMP_TLS_Free(&dest->rtmp);
+	dstr_free(&dest->server);
+	dstr_free(&dest->key);
+	dstr_free(&dest->username);
+	dstr_free(&dest->password);
+	dstr_free(&dest->encoder_name);
+	os_sem_destroy(dest->send_sem);
+	pthread_mutex_destroy(&dest->mutex);
+	bfree(dest);
+}
+
+static struct rtmp_dest *create_dest(struct rtmp_multi *multi, obs_data_t *settings, obs_data_t *item)
+{
+	struct rtmp_dest *dest = bzalloc(sizeof(struct rtmp_dest));
+	int64_t drop_b, drop_p;
+
+	dest->multi = multi;
+	dest->idx = multi->dests.num;
+	pthread_mutex_init_value(&dest->mutex);
+
+	if (pthread_mutex_init(&dest->mutex, NULL) != 0 || os_sem_init(&dest->send_sem, 0) != 0) {
+		destroy_dest(dest);
+		return NULL;
+	}
+
+	dstr_copy(&dest->server, obs_data_get_string(item, OPT_SERVER));
+	dstr_copy(&dest->key, obs_data_get_string(item, OPT_KEY));
+	dstr_copy(&dest->username, obs_data_get_string(item, OPT_USERNAME));
+	dstr_copy(&dest->password, obs_data_get_string(item, OPT_PASSWORD));
+	dstr_depad(&dest->server);
+	dstr_depad(&dest->key);
+
+	/* every destination can have its own drop policy, the output
+	 * settings are used where it does not */
+	drop_b = obs_data_has_user_value(item, OPT_DROP_THRESHOLD) ? obs_data_get_int(item, OPT_DROP_THRESHOLD)
+								    : obs_data_get_int(settings, OPT_DROP_THRESHOLD);
+	drop_p = obs_data_has_user_value(item, OPT_PFRAME_DROP_THRESHOLD)
+			 ? obs_data_get_int(item, OPT_PFRAME_DROP_THRESHOLD)
+			 : obs_data_get_int(settings, OPT_PFRAME_DROP_THRESHOLD);
+
+	if (drop_p < (drop_b + 200))
+		drop_p = drop_b + 200;
+
+	dest->drop_threshold_usec = 1000 * drop_b;
+	dest->pframe_drop_threshold_usec = 1000 * drop_p;
+	return dest;
+}
+
+static void free_dests(struct rtmp_multi *multi)
+{
+	for (size_t i = 0; i < multi->dests.num; i++)
+		destroy_dest(multi->dests.array[i]);
+	da_free(multi->dests);
+}
+
+/* ------------------------------------------------------------------------- */
+
+static void rtmp_multi_destroy(void *data)
+{
+	struct rtmp_multi *multi = data;
+
+	if (active(multi)) {
+		multi->stop_ts = 0;
+		os_event_signal(multi->stop_event);
+
+		for (size_t i = 0; i < multi->dests.num; i++)
+			os_sem_post(multi->dests.array[i]->send_sem);
+	}
+
+	free_dests(multi);
+	free_headers(multi);
+	os_event_destroy(multi->stop_event);
+	bfree(multi);
+}
+
+static void *rtmp_multi_create(obs_data_t *settings, obs_output_t *output)
+{
+	struct rtmp_multi *multi = bzalloc(sizeof(struct rtmp_multi));
+	multi->output = output;
+
+	RTMP_LogSetCallback(log_rtmp);
+	RTMP_LogSetLevel(RTMP_LOGWARNING);
+
+	if (os_event_init(&multi->stop_event, OS_EVENT_TYPE_MANUAL) != 0) {
+		bfree(multi);
+		return NULL;
+	}
+
+	UNUSED_PARAMETER(settings);
+	return multi;
+}
+
+static bool init_codecs(struct rtmp_multi *multi)
+{
+	const struct video_output_info *info = video_output_get_info(obs_get_video());
+	bool hdr = info->colorspace == VIDEO_CS_2100_HLG || info->colorspace == VIDEO_CS_2100_PQ;
+
+	for (size_t i = 0; i < MAX_OUTPUT_AUDIO_ENCODERS; i++) {
+		obs_encoder_t *enc = obs_output_get_audio_encoder(multi->output, i);
+		multi->audio_codec[i] = enc ? to_audio_type(obs_encoder_get_codec(enc)) : AUDIO_CODEC_NONE;
+	}
+
+	for (size_t i = 0; i < MAX_OUTPUT_VIDEO_ENCODERS; i++) {
+		obs_encoder_t *enc = obs_output_get_video_encoder2(multi->output, i);
+		multi->video_codec[i] = enc ? to_video_type(obs_encoder_get_codec(enc)) : CODEC_NONE;
+
+		// HDR streaming disabled for AV1
+		if (hdr && multi->video_codec[i] == CODEC_AV1) {
+			obs_output_set_last_error(multi->output, obs_module_text("RTMPMulti.HDRDisabled"));
+			return false;
+		}
+	}
+
+	return true;
+}
+
+static bool rtmp_multi_start(void *data)
+{
+	struct rtmp_multi *multi = data;
+
+	if (!obs_output_can_begin_data_capture(multi->output, 0))
+		return false;
+	if (!obs_output_initialize_encoders(multi->output, 0))
+		return false;
+	if (!init_codecs(multi))
+		return false;
+
+	/* threads of the previous session have already finished */
+	free_dests(multi);
+	free_headers(multi);
+	os_event_reset(multi->stop_event);
+	os_atomic_set_bool(&multi->encode_error, false);
+	multi->got_first_packet = false;
+
+	obs_data_t *settings = obs_output_get_settings(multi->output);
+	obs_data_array_t *array = obs_data_get_array(settings, OPT_DESTINATIONS);
+	size_t count = obs_data_array_count(array);
+
+	multi->max_shutdown_time_sec = (int)obs_data_get_int(settings, OPT_MAX_SHUTDOWN_TIME_SEC);
+
+	for (size_t i = 0; i < count; i++) {
+		obs_data_t *item = obs_data_array_item(array, i);
+
+		if (*obs_data_get_string(item, OPT_SERVER)) {
+			struct rtmp_dest *dest = create_dest(multi, settings, item);
+			if (dest)
+				da_push_back(multi->dests, &dest);
+		}
+
+		obs_data_release(item);
+	}
+
+	obs_data_array_release(array);
+	obs_data_release(settings);
+
+	if (!multi->dests.num) {
+		warn("No destinations");
+		return false;
+	}
+
+	info("Streaming to %zu destinations", multi->dests.num);
+
+	multi->active_dests = (long)multi->dests.num;
+	os_atomic_set_bool(&multi->active, true);
+	obs_output_begin_data_capture(multi->output, 0);
+
+	for (size_t i = 0; i < multi->dests.num; i++) {
+		struct rtmp_dest *dest = multi->dests.array[i];
+
+		dest->thread_active = pthread_create(&dest->send_thread, NULL, send_thread, dest) == 0;
+		if (!dest->thread_active) {
+			dest_log(LOG_WARNING, "Failed to create send thread");
+			dest->stop_code = OBS_OUTPUT_ERROR;
+			finish_dest(dest);
+		}
+	}
+
+	return true;
+}
+
+static void rtmp_multi_stop(void *data, uint64_t ts)
+{
+	struct rtmp_multi *multi = data;
+
+	if (stopping(multi) && ts != 0)
+		return;
+
+	multi->stop_ts = ts / 1000ULL;
+
+	if (ts)
+		multi->shutdown_timeout_ts = ts + (uint64_t)multi->max_shutdown_time_sec * 1000000000ULL;
+
+	if (active(multi)) {
+		os_event_signal(multi->stop_event);
+		if (multi->stop_ts == 0) {
+			for (size_t i = 0; i < multi->dests.num; i++)
+				os_sem_post(multi->dests.array[i]->send_sem);
+		}
+	} else {
+		obs_output_signal_stop(multi->output, OBS_OUTPUT_SUCCESS);
+	}
+}
+
+static void rtmp_multi_data(void *data, struct encoder_packet *packet)
+{
+	struct rtmp_multi *multi = data;
+	struct encoder_packet new_packet;
+
+	if (!active(multi))
+		return;
+
+	/* encoder fail */
+	if (!packet) {
+		os_atomic_set_bool(&multi->encode_error, true);
+		for (size_t i = 0; i < multi->dests.num; i++)
+			os_sem_post(multi->dests.array[i]->send_sem);
+		return;
+	}
+
+	if (!multi->got_first_packet) {
+		multi->start_dts_offset = get_ms_time(packet, packet->dts);
+		build_headers(multi);
+		multi->got_first_packet = true;
+	}
+
+	/* audio is serialized straight from the interleaved packet, no
+	 * destination holds a reference to encoder data */
+	if (packet->type == OBS_ENCODER_VIDEO) {
+		switch (multi->video_codec[packet->track_idx]) {
+		case CODEC_NONE:
+			blog(LOG_ERROR, "Codec not initialized for track %zu", packet->track_idx);
+			return;
+		case CODEC_H264:
+			obs_parse_avc_packet(&new_packet, packet);
+			break;
+		case CODEC_HEVC:
+#ifdef ENABLE_HEVC
+			obs_parse_hevc_packet(&new_packet, packet);
+			break;
+#else
+			return;
+#endif
+		case CODEC_AV1:
+			obs_parse_av1_packet(&new_packet, packet);
+			break;
+		}
+
+		packet = &new_packet;
+	}
+
+	struct flv_tag *tag = serialize_packet(multi, packet);
+
+	if (packet == &new_packet)
+		obs_encoder_packet_release(&new_packet);
+
+	for (size_t i = 0; i < multi->dests.num; i++)
+		add_tag(multi->dests.array[i], tag);
+
+	flv_tag_release(tag);
+}
+
+static void rtmp_multi_defaults(obs_data_t *defaults)
+{
+	obs_data_set_default_int(defaults, OPT_DROP_THRESHOLD, 700);
+	obs_data_set_default_int(defaults, OPT_PFRAME_DROP_THRESHOLD, 900);
+	obs_data_set_default_int(defaults, OPT_MAX_SHUTDOWN_TIME_SEC, 30);
+}
+
+static obs_properties_t *rtmp_multi_properties(void *unused)
+{
+	UNUSED_PARAMETER(unused);
+
+	obs_properties_t *props = obs_properties_create();
+	obs_property_t *p;
+
+	p = obs_properties_add_int(props, OPT_DROP_THRESHOLD, obs_module_text("RTMPStream.DropThreshold"), 200, 10000,
+				   100);
+	obs_property_int_set_suffix(p, " ms");
+
+	return props;
+}
+
+static uint64_t rtmp_multi_total_bytes_sent(void *data)
+{
+	struct rtmp_multi *multi = data;
+	uint64_t total = 0;
+
+	for (size_t i = 0; i < multi->dests.num; i++)
+		total += multi->dests.array[i]->total_bytes_sent;
+	return total;
+}
+
+/* frames dropped and congestion of the worst destination, so the numbers
+ * stay comparable with a single stream */
+static int rtmp_multi_dropped_frames(void *data)
+{
+	struct rtmp_multi *multi = data;
+	int dropped = 0;
+
+	for (size_t i = 0; i < multi->dests.num; i++) {
+		if (multi->dests.array[i]->dropped_frames > dropped)
+			dropped = multi->dests.array[i]->dropped_frames;
+	}
+	return dropped;
+}
+
+static float rtmp_multi_congestion(void *data)
+{
+	struct rtmp_multi *multi = data;
+	float congestion = 0.0f;
+
+	for (size_t i = 0; i < multi->dests.num; i++) {
+		struct rtmp_dest *dest = multi->dests.array[i];
+		float val = dest->min_priority > 0 ? 1.0f : dest->congestion;
+
+		if (val > congestion)
+			congestion = val;
+	}
+	return congestion;
+}
+
+static int rtmp_multi_connect_time(void *data)
+{
+	struct rtmp_multi *multi = data;
+	int connect_time = 0;
+
+	for (size_t i = 0; i < multi->dests.num; i++) {
+		if (multi->dests.array[i]->rtmp.connect_time_ms > connect_time)
+			connect_time = multi->dests.array[i]->rtmp.connect_time_ms;
+	}
+	return connect_time;
+}
+
+struct obs_output_info rtmp_multi_output_info = {
+	.id = "rtmp_multi_output",
+	.flags = OBS_OUTPUT_AV | OBS_OUTPUT_ENCODED | OBS_OUTPUT_MULTI_TRACK_AV,
+#ifdef ENABLE_HEVC
+	.encoded_video_codecs = "h264;hevc;av1",
+#else
+	.encoded_video_codecs = "h264;av1",
+#endif
+	.encoded_audio_codecs = "aac",
+	.get_name = rtmp_multi_getname,
+	.create = rtmp_multi_create,
+	.destroy = rtmp_multi_destroy,
+	.start = rtmp_multi_start,
+	.stop = rtmp_multi_stop,
+	.encoded_packet = rtmp_multi_data,
+	.get_defaults = rtmp_multi_defaults,
+	.get_properties = rtmp_multi_properties,
+	.get_total_bytes = rtmp_multi_total_bytes_sent,
+	.get_congestion = rtmp_multi_congestion,
+	.get_connect_time_ms = rtmp_multi_connect_time,
+	.get_dropped_frames = rtmp_multi_dropped_frames,
+};
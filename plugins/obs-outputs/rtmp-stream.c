@@ -24,6 +24,9 @@
 
 #ifdef _WIN32
 #include <util/windows/win-version.h>
+#include <mstcpip.h>
+#elif defined(__linux__)
+#include <netinet/tcp.h>
 #endif
 
 #ifndef SEC_TO_NSEC
@@ -44,6 +47,9 @@
 #define MIN_ESTIMATE_DURATION_MS 1000
 #define MAX_ESTIMATE_DURATION_MS 2000
 
+/* how often the congestion controller is sampled */
+#define CC_SAMPLE_INTERVAL_NS (100ULL * MSEC_TO_NSEC)
+
 static const char *rtmp_stream_getname(void *unused)
 {
 	UNUSED_PARAMETER(unused);
@@ -135,6 +141,7 @@ static void rtmp_stream_destroy(void *data)
 	deque_free(&stream->droptest_info);
 #endif
 	deque_free(&stream->dbr_frames);
+	rtmp_cc_destroy(&stream->cc);
 	pthread_mutex_destroy(&stream->dbr_mutex);
 
 	os_event_destroy(stream->buffer_space_available_event);
@@ -626,6 +633,108 @@ static void log_sndbuf_size(struct rtmp_stream *stream)
 }
 #endif
 
+#ifdef __linux__
+/* Prefix of the kernel's struct tcp_info.  The C library's version of the
+ * struct usually lags behind and lacks the fields needed here, the kernel
+ * returns how much of it was filled in. */
+struct rtmp_tcp_info {
+	uint8_t state, ca_state, retransmits, probes, backoff, options, wscale, flags;
+	uint32_t rto, ato, snd_mss, rcv_mss;
+	uint32_t unacked, sacked, lost, retrans, fackets;
+	uint32_t last_data_sent, last_ack_sent, last_data_recv, last_ack_recv;
+	uint32_t pmtu, rcv_ssthresh, rtt, rttvar, snd_ssthresh, snd_cwnd, advmss, reordering;
+	uint32_t rcv_rtt, rcv_space;
+	uint32_t total_retrans;
+	uint64_t pacing_rate, max_pacing_rate, bytes_acked, bytes_received;
+	uint32_t segs_out, segs_in;
+	uint32_t notsent_bytes, min_rtt;
+};
+#endif
+
+static void get_socket_info(struct rtmp_stream *stream, struct rtmp_cc_sample *sample)
+{
+#if defined(__linux__)
+	struct rtmp_tcp_info ti = {0};
+	socklen_t len = sizeof(ti);
+
+	if (getsockopt(stream->rtmp.m_sb.sb_socket, IPPROTO_TCP, TCP_INFO, &ti, &len) != 0)
+		return;
+
+	sample->rtt_usec = ti.rtt;
+	if (len >= offsetof(struct rtmp_tcp_info, bytes_received))
+		sample->bytes_acked = ti.bytes_acked;
+	if (len >= sizeof(ti))
+		sample->min_rtt_usec = ti.min_rtt;
+
+#elif defined(_WIN32) && defined(SIO_TCP_INFO)
+	TCP_INFO_v0 ti;
+	DWORD version = 0;
+	DWORD bytes = 0;
+
+	if (WSAIoctl(stream->rtmp.m_sb.sb_socket, SIO_TCP_INFO, &version, sizeof(version), &ti, sizeof(ti), &bytes,
+		     NULL, NULL) != 0)
+		return;
+
+	sample->rtt_usec = ti.RttUs;
+	sample->min_rtt_usec = ti.MinRttUs;
+	if (ti.BytesOut >= ti.BytesInFlight)
+		sample->bytes_acked = ti.BytesOut - ti.BytesInFlight;
+
+#else
+	UNUSED_PARAMETER(stream);
+	UNUSED_PARAMETER(sample);
+#endif
+}
+
+static bool find_first_video_packet(struct rtmp_stream *stream, struct encoder_packet *first);
+
+static void cc_sample(struct rtmp_stream *stream)
+{
+	struct rtmp_cc_sample sample = {0};
+	struct encoder_packet first;
+	uint64_t ts = os_gettime_ns();
+
+	if (ts - stream->cc_last_sample_ts < CC_SAMPLE_INTERVAL_NS)
+		return;
+
+	stream->cc_last_sample_ts = ts;
+	sample.ts = ts;
+	sample.bytes_sent = stream->total_bytes_sent;
+	get_socket_info(stream, &sample);
+
+	pthread_mutex_lock(&stream->packets_mutex);
+	if (find_first_video_packet(stream, &first))
+		sample.queued_usec = stream->last_dts_usec - first.dts_usec;
+	pthread_mutex_unlock(&stream->packets_mutex);
+
+	pthread_mutex_lock(&stream->dbr_mutex);
+	rtmp_cc_update(&stream->cc, &sample);
+	stream->cc_pacing_rate = rtmp_cc_get_pacing_rate(&stream->cc);
+	pthread_mutex_unlock(&stream->dbr_mutex);
+}
+
+/* Spreads sends out at the pacing rate of the congestion controller so that
+ * large packets such as keyframes do not go out as a single burst. */
+static void pace_send(struct rtmp_stream *stream, size_t size)
+{
+	uint64_t rate = stream->cc_pacing_rate;
+	uint64_t ts = os_gettime_ns();
+
+	if (!rate)
+		return;
+
+	if (stream->pacing_next_ts > ts) {
+		unsigned long wait_ms = (unsigned long)((stream->pacing_next_ts - ts) / MSEC_TO_NSEC);
+		if (wait_ms)
+			os_event_timedwait(stream->stop_event, wait_ms);
+		ts = os_gettime_ns();
+	}
+
+	if (stream->pacing_next_ts < ts)
+		stream->pacing_next_ts = ts;
+	stream->pacing_next_ts += util_mul_div64(size, SEC_TO_NSEC, rate);
+}
+
 static void *send_thread(void *data)
 {
 	struct rtmp_stream *stream = data;
@@ -661,11 +770,17 @@ static void *send_thread(void *data)
 			}
 		}
 
+		if (rtmp_cc_active(&stream->cc))
+			pace_send(stream, packet.size);
+
 		if (stream->dbr_enabled) {
 			dbr_frame.send_beg = os_gettime_ns();
 			dbr_frame.size = packet.size;
 		}
 
+		/* sending releases the packet, keep what tracing needs */
+		struct encoder_packet sent_packet = packet;
+
 		int sent;
 		if (packet.type == OBS_ENCODER_VIDEO &&
 		    (stream->video_codec[packet.track_idx] != CODEC_H264 ||
@@ -682,7 +797,12 @@ static void *send_thread(void *data)
 			break;
 		}
 
-		if (stream->dbr_enabled) {
+		obs_output_packet_sent(stream->output, &sent_packet);
+
+		if (rtmp_cc_active(&stream->cc)) {
+			cc_sample(stream);
+
+		} else if (stream->dbr_enabled) {
 			dbr_frame.send_end = os_gettime_ns();
 
 			pthread_mutex_lock(&stream->dbr_mutex);
@@ -1309,6 +1429,24 @@ static bool init_connect(struct rtmp_stream *stream)
 		info("Dynamic bitrate enabled.  Dropped frames begone!");
 	}
 
+	rtmp_cc_destroy(&stream->cc);
+	stream->cc_last_sample_ts = 0;
+	stream->cc_pacing_rate = 0;
+	stream->pacing_next_ts = 0;
+
+	if (stream->dbr_enabled) {
+		const char *cc_id = obs_data_get_string(settings, OPT_CONGESTION_CONTROL);
+		long min_bitrate = stream->dbr_orig_bitrate / 10;
+
+		if (min_bitrate < 50)
+			min_bitrate = 50;
+
+		if (rtmp_cc_create(&stream->cc, cc_id, stream->dbr_orig_bitrate, min_bitrate, stream->audio_bitrate))
+			info("Using '%s' congestion control", cc_id);
+		else if (*cc_id)
+			warn("Unknown congestion control '%s', using the default", cc_id);
+	}
+
 	obs_data_release(vsettings);
 	obs_data_release(asettings);
 
@@ -1419,7 +1557,7 @@ static void drop_frames(struct rtmp_stream *stream, const char *name, int highes
 {
 	UNUSED_PARAMETER(pframes);
 
-	struct deque new_buf = {0};
+	size_t num_packets = num_buffered_packets(stream);
 	int num_frames_dropped = 0;
 
 #ifdef _DEBUG
@@ -1428,15 +1566,15 @@ static void drop_frames(struct rtmp_stream *stream, const char *name, int highes
 	UNUSED_PARAMETER(name);
 #endif
 
-	deque_reserve(&new_buf, sizeof(struct encoder_packet) * 8);
-
-	while (stream->packets.size) {
+	/* rotate through the deque once, packets that are kept are pushed
+	 * back into the space the popped ones leave, so it never reallocates */
+	for (size_t i = 0; i < num_packets; i++) {
 		struct encoder_packet packet;
 		deque_pop_front(&stream->packets, &packet, sizeof(packet));
 
 		/* do not drop audio data or video keyframes */
 		if (packet.type == OBS_ENCODER_AUDIO || packet.drop_priority >= highest_priority) {
-			deque_push_back(&new_buf, &packet, sizeof(packet));
+			deque_push_back(&stream->packets, &packet, sizeof(packet));
 
 		} else {
 			num_frames_dropped++;
@@ -1444,9 +1582,6 @@ static void drop_frames(struct rtmp_stream *stream, const char *name, int highes
 		}
 	}
 
-	deque_free(&stream->packets);
-	stream->packets = new_buf;
-
 	if (stream->min_priority < highest_priority)
 		stream->min_priority = highest_priority;
 	if (!num_frames_dropped)
@@ -1560,6 +1695,24 @@ static void dbr_inc_bitrate(struct rtmp_stream *stream)
 	}
 }
 
+static void cc_set_bitrate(struct rtmp_stream *stream)
+{
+	pthread_mutex_lock(&stream->dbr_mutex);
+	long bitrate = rtmp_cc_get_bitrate(&stream->cc);
+	pthread_mutex_unlock(&stream->dbr_mutex);
+
+	long diff = labs(bitrate - stream->dbr_cur_bitrate);
+
+	/* the controller adapts continuously, only reconfigure the encoder for
+	 * changes that matter or when back at the original bitrate */
+	if (!diff || (diff < stream->dbr_cur_bitrate / 20 && bitrate != stream->dbr_orig_bitrate))
+		return;
+
+	stream->dbr_cur_bitrate = bitrate;
+	dbr_set_bitrate(stream);
+	info("bitrate changed to: %ld", bitrate);
+}
+
 static void check_to_drop_frames(struct rtmp_stream *stream, bool pframes)
 {
 	struct encoder_packet first;
@@ -1581,6 +1734,9 @@ static void check_to_drop_frames(struct rtmp_stream *stream, bool pframes)
 		}
 	}
 
+	if (!pframes && rtmp_cc_active(&stream->cc))
+		cc_set_bitrate(stream);
+
 	if (num_packets < 5) {
 		if (!pframes)
 			stream->congestion = 0.0f;
@@ -1598,11 +1754,17 @@ static void check_to_drop_frames(struct rtmp_stream *stream, bool pframes)
 		stream->congestion = (float)buffer_duration_usec / (float)drop_threshold;
 	}
 
+	/* the congestion controller keeps the buffer down by itself, only drop
+	 * p-frames as a last resort if the connection cannot keep up with even
+	 * the lowest bitrate */
+	if (rtmp_cc_active(&stream->cc) && !pframes)
+		return;
+
 	/* alternatively, drop only pframes:
 	 * (!pframes && stream->dbr_enabled)
 	 * but let's test without dropping frames
 	 * at all first */
-	if (stream->dbr_enabled) {
+	if (stream->dbr_enabled && !rtmp_cc_active(&stream->cc)) {
 		bool bitrate_changed = false;
 
 		if (pframes) {
@@ -8,6 +8,7 @@
 #include "librtmp/log.h"
 #include "flv-mux.h"
 #include "net-if.h"
+#include "rtmp-congestion.h"
 
 #ifdef _WIN32
 #include <Iphlpapi.h>
@@ -23,6 +24,7 @@
 #define debug(format, ...) do_log(LOG_DEBUG, format, ##__VA_ARGS__)
 
 #define OPT_DYN_BITRATE "dyn_bitrate"
+#define OPT_CONGESTION_CONTROL "congestion_control"
 #define OPT_DROP_THRESHOLD "drop_threshold_ms"
 #define OPT_PFRAME_DROP_THRESHOLD "pframe_drop_threshold_ms"
 #define OPT_MAX_SHUTDOWN_TIME_SEC "max_shutdown_time_sec"
@@ -113,6 +115,13 @@ struct rtmp_stream {
 	long dbr_inc_bitrate;
 	bool dbr_enabled;
 
+	/* congestion controller used for dynamic bitrate when one is set,
+	 * protected by dbr_mutex */
+	struct rtmp_cc cc;
+	uint64_t cc_last_sample_ts;
+	uint64_t cc_pacing_rate;
+	uint64_t pacing_next_ts;
+
 	enum audio_id_t audio_codec[MAX_OUTPUT_AUDIO_ENCODERS];
 	enum video_id_t video_codec[MAX_OUTPUT_VIDEO_ENCODERS];
 
@@ -70,12 +70,14 @@ static void stinger_update(void *data, obs_data_t *settings)
 	const char *path = obs_data_get_string(settings, "path");
 	bool hw_decode = obs_data_get_bool(settings, "hw_decode");
 	bool preload = obs_data_get_bool(settings, "preload");
+	int64_t preload_budget = obs_data_get_int(settings, "preload_budget_mb");
 
 	obs_data_t *media_settings = obs_data_create();
 	obs_data_set_string(media_settings, "local_file", path);
 	obs_data_set_bool(media_settings, "hw_decode", hw_decode);
 	obs_data_set_bool(media_settings, "looping", false);
 	obs_data_set_bool(media_settings, "full_decode", preload);
+	obs_data_set_int(media_settings, "cache_budget_mb", preload_budget);
 	obs_data_set_bool(media_settings, "is_stinger", true);
 	obs_data_set_bool(media_settings, "is_track_matte", s->track_matte_enabled);
 
@@ -116,7 +118,11 @@ static void stinger_update(void *data, obs_data_t *settings)
 
 		obs_data_t *tm_media_settings = obs_data_create();
 		obs_data_set_string(tm_media_settings, "local_file", tm_path);
+		obs_data_set_bool(tm_media_settings, "hw_decode", hw_decode);
 		obs_data_set_bool(tm_media_settings, "looping", false);
+		obs_data_set_bool(tm_media_settings, "full_decode", preload);
+		obs_data_set_int(tm_media_settings, "cache_budget_mb", preload_budget);
+		obs_data_set_bool(tm_media_settings, "is_stinger", true);
 
 		s->matte_source = obs_source_create_private("ffmpeg_source", NULL, tm_media_settings);
 		obs_data_release(tm_media_settings);
@@ -212,6 +218,7 @@ static void stinger_destroy(void *data)
 static void stinger_defaults(obs_data_t *settings)
 {
 	obs_data_set_default_bool(settings, "hw_decode", true);
+	obs_data_set_default_int(settings, "preload_budget_mb", 2048);
 }
 
 static void stinger_matte_render(void *data, gs_texture_t *a, gs_texture_t *b, float t, uint32_t cx, uint32_t cy)
@@ -569,6 +576,17 @@ static void stinger_transition_start(void *data)
 	s->transitioning = true;
 }
 
+static void preload_first_frame(obs_source_t *media_source)
+{
+	if (!media_source)
+		return;
+
+	proc_handler_t *ph = obs_source_get_proc_handler(media_source);
+
+	calldata_t cd = {0};
+	proc_handler_call(ph, "preload_first_frame", &cd);
+}
+
 static void stinger_transition_stop(void *data)
 {
 	struct stinger_info *s = data;
@@ -579,14 +597,23 @@ static void stinger_transition_stop(void *data)
 	if (s->matte_source)
 		obs_source_remove_active_child(s->source, s->matte_source);
 
-	proc_handler_t *ph = obs_source_get_proc_handler(s->media_source);
-
-	calldata_t cd = {0};
-	proc_handler_call(ph, "preload_first_frame", &cd);
+	preload_first_frame(s->media_source);
+	preload_first_frame(s->matte_source);
 
 	s->transitioning = false;
 }
 
+static void stinger_activate(void *data)
+{
+	struct stinger_info *s = data;
+
+	/* The transition becomes active as soon as it is selected, so decode
+	 * the stinger (and matte) ahead of time rather than when the first
+	 * transition starts. Preloaded media is only cached on request. */
+	preload_first_frame(s->media_source);
+	preload_first_frame(s->matte_source);
+}
+
 static void stinger_enum_active_sources(void *data, obs_source_enum_proc_t enum_callback, void *param)
 {
 	struct stinger_info *s = data;
@@ -679,6 +706,9 @@ static obs_properties_t *stinger_properties(void *data)
 	obs_properties_add_bool(ppts, "hw_decode", obs_module_text("HardwareDecode"));
 	p = obs_properties_add_bool(ppts, "preload", obs_module_text("PreloadVideoToRam"));
 	obs_property_set_long_description(p, obs_module_text("PreloadVideoToRam.Description"));
+	p = obs_properties_add_int(ppts, "preload_budget_mb", obs_module_text("PreloadBudget"), 0, 65536, 256);
+	obs_property_int_set_suffix(p, " MB");
+	obs_property_set_long_description(p, obs_module_text("PreloadBudget.Description"));
 
 	obs_properties_add_int(ppts, "transition_point", obs_module_text("TransitionPoint"), 0, 120000, 1);
 
@@ -814,5 +844,6 @@ struct obs_source_info stinger_transition = {
 	.enum_all_sources = stinger_enum_all_sources,
 	.transition_start = stinger_transition_start,
 	.transition_stop = stinger_transition_stop,
+	.activate = stinger_activate,
 	.video_get_color_space = stinger_get_color_space,
 };
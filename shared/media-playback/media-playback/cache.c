@@ -21,6 +21,8 @@
 #include "cache.h"
 #include "media.h"
 
+#include <libavutil/imgutils.h>
+
 extern bool mp_media_init2(mp_media_t *m);
 extern bool mp_media_prepare_frames(mp_media_t *m);
 extern bool mp_media_eof(mp_media_t *m);
@@ -32,6 +34,11 @@ static bool mp_cache_reset(mp_cache_t *c);
 
 static int64_t base_sys_ts = 0;
 
+static pthread_mutex_t total_size_mutex = PTHREAD_MUTEX_INITIALIZER;
+static size_t total_size = 0;
+
+#define MiB(size) ((double)(size) / (1024.0 * 1024.0))
+
 #define v_eof(c) (c->cur_v_idx == c->video_frames.num)
 #define a_eof(c) (c->cur_a_idx == c->audio_segments.num)
 
@@ -110,6 +117,68 @@ static bool mp_cache_eof(mp_cache_t *c)
 	return true;
 }
 
+static void mp_cache_free_frames(mp_cache_t *c)
+{
+	for (size_t i = 0; i < c->video_frames.num; i++) {
+		struct obs_source_frame *f = &c->video_frames.array[i];
+		obs_source_frame_free(f);
+	}
+	for (size_t i = 0; i < c->audio_segments.num; i++) {
+		struct obs_source_audio *a = &c->audio_segments.array[i];
+		bfree((void *)a->data[0]);
+	}
+	da_free(c->video_frames);
+	da_free(c->audio_segments);
+
+	if (c->decoded) {
+		pthread_mutex_lock(&total_size_mutex);
+		total_size -= c->size;
+		pthread_mutex_unlock(&total_size_mutex);
+	}
+
+	c->size = 0;
+}
+
+/* hands playback over to a real time decoder, with the state that was
+ * requested so far.  called once from the cache thread, after which the
+ * public functions forward to c->stream. */
+static bool mp_cache_start_streaming(mp_cache_t *c)
+{
+	struct mp_media_info info = c->stream_info;
+
+	pthread_mutex_lock(&c->mutex);
+	info.is_linear_alpha = c->is_linear_alpha;
+	pthread_mutex_unlock(&c->mutex);
+
+	if (!mp_media_init(&c->stream, &info))
+		return false;
+
+	pthread_mutex_lock(&c->mutex);
+
+	c->streaming = true;
+	c->stream.is_linear_alpha = c->is_linear_alpha;
+	c->stream.looping = c->looping;
+
+	if (c->active) {
+		mp_media_play(&c->stream, c->looping, false);
+		if (c->pause)
+			mp_media_play_pause(&c->stream, true);
+	} else if (c->preload_frame) {
+		mp_media_preload_frame(&c->stream);
+	}
+
+	pthread_mutex_unlock(&c->mutex);
+	return true;
+}
+
+static inline bool mp_cache_streaming(mp_cache_t *c)
+{
+	pthread_mutex_lock(&c->mutex);
+	bool streaming = c->streaming;
+	pthread_mutex_unlock(&c->mutex);
+	return streaming;
+}
+
 bool mp_cache_decode(mp_cache_t *c)
 {
 	mp_media_t *m = &c->m;
@@ -119,7 +188,7 @@ bool mp_cache_decode(mp_cache_t *c)
 
 	mp_media_reset(m);
 
-	while (!mp_media_eof(m)) {
+	while (!mp_media_eof(m) && !c->truncated) {
 		if (m->has_video)
 			mp_media_next_video(m, false);
 		if (m->has_audio)
@@ -129,12 +198,35 @@ bool mp_cache_decode(mp_cache_t *c)
 			goto fail;
 	}
 
+	if (c->truncated) {
+		blog(LOG_WARNING,
+		     "MP: '%s' exceeded its cache budget of %.1f MiB after %zu frames, "
+		     "decoding it in real time instead",
+		     c->path, MiB(c->budget), c->video_frames.num);
+
+		/* a partial cache would cut the media short, drop it and
+		 * play the file like the over budget estimate does */
+		mp_media_free(m);
+		mp_cache_free_frames(c);
+		return mp_cache_start_streaming(c);
+	}
+
 	success = true;
 
 	c->start_time = c->m.fmt->start_time;
 	if (c->start_time == AV_NOPTS_VALUE)
 		c->start_time = 0;
 
+	pthread_mutex_lock(&total_size_mutex);
+	total_size += c->size;
+	size_t total = total_size;
+	pthread_mutex_unlock(&total_size_mutex);
+
+	c->decoded = true;
+
+	blog(LOG_INFO, "MP: Cached '%s': %zu video frames, %zu audio segments, %.1f MiB (%.1f MiB cached in total)",
+	     c->path, c->video_frames.num, c->audio_segments.num, MiB(c->size), MiB(total));
+
 fail:
 	mp_media_free(m);
 	return success;
@@ -365,13 +457,39 @@ static void mp_cache_calc_next_ns(mp_cache_t *c)
 	c->next_pts_ns = min_next_ns;
 }
 
+/* Owners that request preloads themselves (stingers) only need the frames once
+ * they first ask for one, so don't hold on to the memory before that. */
+static bool mp_cache_wait_for_request(mp_cache_t *c)
+{
+	for (;;) {
+		pthread_mutex_lock(&c->mutex);
+		bool kill = c->kill;
+		bool requested = c->preload_frame || c->active;
+		pthread_mutex_unlock(&c->mutex);
+
+		if (kill)
+			return false;
+		if (requested) {
+			/* leave the wakeup for the main loop */
+			os_sem_post(c->sem);
+			return true;
+		}
+		if (os_sem_wait(c->sem) < 0)
+			return false;
+	}
+}
+
 static inline bool mp_cache_thread(mp_cache_t *c)
 {
 	os_set_thread_name("mp_cache_thread");
 
+	if (c->request_preload && !mp_cache_wait_for_request(c))
+		return true;
 	if (!mp_cache_decode(c)) {
 		return false;
 	}
+	if (c->streaming)
+		return true;
 
 	for (;;) {
 		bool reset, kill, is_active, seek, pause, reset_time, preload_frame;
@@ -465,11 +583,26 @@ static void *mp_cache_thread_start(void *opaque)
 	return NULL;
 }
 
+static bool mp_cache_reserve(mp_cache_t *c, size_t size)
+{
+	if (c->budget && c->size + size > c->budget) {
+		c->truncated = true;
+		return false;
+	}
+
+	c->size += size;
+	return true;
+}
+
 static void fill_video(void *data, struct obs_source_frame *frame)
 {
 	mp_cache_t *c = data;
 	struct obs_source_frame dup;
 
+	int size = av_image_get_buffer_size(c->m.scale_format, (int)frame->width, (int)frame->height, 1);
+	if (!mp_cache_reserve(c, size > 0 ? (size_t)size : 0))
+		return;
+
 	obs_source_frame_init(&dup, frame->format, frame->width, frame->height);
 	obs_source_frame_copy(&dup, frame);
 
@@ -486,6 +619,9 @@ static void fill_audio(void *data, struct obs_source_audio *audio)
 	struct obs_source_audio dup = *audio;
 
 	size_t size = get_total_audio_size(dup.format, dup.speakers, dup.frames);
+	if (!mp_cache_reserve(c, size))
+		return;
+
 	dup.data[0] = bmalloc(size);
 
 	size_t planes = get_audio_planes(dup.format, dup.speakers);
@@ -509,6 +645,37 @@ static void fill_audio(void *data, struct obs_source_audio *audio)
 	da_push_back(c->audio_segments, &dup);
 }
 
+static size_t mp_cache_estimate_size(mp_cache_t *c)
+{
+	mp_media_t *m = &c->m;
+	double duration = m->fmt->duration > 0 ? (double)m->fmt->duration / AV_TIME_BASE : 0.0;
+	size_t size = 0;
+
+	if (m->has_video) {
+		AVStream *stream = m->v.stream;
+		AVCodecParameters *par = stream->codecpar;
+		int64_t frames = stream->nb_frames;
+
+		if (frames <= 0 && stream->avg_frame_rate.num)
+			frames = (int64_t)(duration * av_q2d(stream->avg_frame_rate) + 0.5);
+
+		int frame_size = av_image_get_buffer_size((enum AVPixelFormat)par->format, par->width, par->height, 1);
+		if (frame_size > 0 && frames > 0)
+			size += (size_t)frame_size * (size_t)frames;
+
+		c->estimated_frames = frames;
+	}
+	if (m->has_audio) {
+		AVCodecParameters *par = m->a.stream->codecpar;
+		int sample_size = av_get_bytes_per_sample((enum AVSampleFormat)par->format);
+		double samples = duration * par->sample_rate * par->ch_layout.nb_channels;
+
+		size += (size_t)(samples * sample_size);
+	}
+
+	return size;
+}
+
 static inline bool mp_cache_init_internal(mp_cache_t *c, const struct mp_media_info *info)
 {
 	if (pthread_mutex_init(&c->mutex, NULL) != 0) {
@@ -523,6 +690,10 @@ static inline bool mp_cache_init_internal(mp_cache_t *c, const struct mp_media_i
 	c->path = info->path ? bstrdup(info->path) : NULL;
 	c->format_name = info->format ? bstrdup(info->format) : NULL;
 
+	c->stream_info = *info;
+	c->stream_info.path = c->path;
+	c->stream_info.format = c->format_name;
+
 	if (pthread_create(&c->thread, NULL, mp_cache_thread_start, c) != 0) {
 		blog(LOG_WARNING, "MP: Could not create media thread");
 		return false;
@@ -570,6 +741,24 @@ bool mp_cache_init(mp_cache_t *c, const struct mp_media_info *info)
 
 	c->has_video = m->has_video;
 	c->has_audio = m->has_audio;
+	c->budget = info->cache_budget;
+	c->is_linear_alpha = info->is_linear_alpha;
+
+	/* the whole file is cached rather than a bounded window of frames:
+	 * looping, seeking and the stinger's restart on every transition all
+	 * jump back to frame 0, and a window would refill through the
+	 * decoder right when playback has to start. files that don't fit
+	 * the budget are decoded in real time instead. */
+	size_t estimate = mp_cache_estimate_size(c);
+	if (c->budget && estimate > c->budget) {
+		blog(LOG_WARNING,
+		     "MP: '%s' needs about %.1f MiB to be cached, which exceeds its budget of %.1f MiB, "
+		     "decoding it in real time instead",
+		     info->path, MiB(estimate), MiB(c->budget));
+		mp_cache_free(c);
+		c->over_budget = true;
+		return false;
+	}
 
 	if (!base_sys_ts)
 		base_sys_ts = (int64_t)os_gettime_ns();
@@ -602,19 +791,12 @@ void mp_cache_free(mp_cache_t *c)
 	mp_cache_stop(c);
 	mp_kill_thread(c);
 
+	if (c->streaming)
+		mp_media_free(&c->stream);
 	if (c->m.fmt)
 		mp_media_free(&c->m);
 
-	for (size_t i = 0; i < c->video_frames.num; i++) {
-		struct obs_source_frame *f = &c->video_frames.array[i];
-		obs_source_frame_free(f);
-	}
-	for (size_t i = 0; i < c->audio_segments.num; i++) {
-		struct obs_source_audio *a = &c->audio_segments.array[i];
-		bfree((void *)a->data[0]);
-	}
-	da_free(c->video_frames);
-	da_free(c->audio_segments);
+	mp_cache_free_frames(c);
 
 	bfree(c->path);
 	bfree(c->format_name);
@@ -625,6 +807,11 @@ void mp_cache_free(mp_cache_t *c)
 
 void mp_cache_play(mp_cache_t *c, bool loop)
 {
+	if (mp_cache_streaming(c)) {
+		mp_media_play(&c->stream, loop, false);
+		return;
+	}
+
 	pthread_mutex_lock(&c->mutex);
 
 	if (c->active)
@@ -640,6 +827,11 @@ void mp_cache_play(mp_cache_t *c, bool loop)
 
 void mp_cache_play_pause(mp_cache_t *c, bool pause)
 {
+	if (mp_cache_streaming(c)) {
+		mp_media_play_pause(&c->stream, pause);
+		return;
+	}
+
 	pthread_mutex_lock(&c->mutex);
 	if (c->active) {
 		c->pause = pause;
@@ -652,6 +844,11 @@ void mp_cache_play_pause(mp_cache_t *c, bool pause)
 
 void mp_cache_stop(mp_cache_t *c)
 {
+	if (mp_cache_streaming(c)) {
+		mp_media_stop(&c->stream);
+		return;
+	}
+
 	pthread_mutex_lock(&c->mutex);
 	if (c->active) {
 		c->reset = true;
@@ -665,6 +862,11 @@ void mp_cache_stop(mp_cache_t *c)
 
 void mp_cache_preload_frame(mp_cache_t *c)
 {
+	if (mp_cache_streaming(c)) {
+		mp_media_preload_frame(&c->stream);
+		return;
+	}
+
 	if (c->request_preload && c->thread_valid && c->v_preload_cb) {
 		pthread_mutex_lock(&c->mutex);
 		c->preload_frame = true;
@@ -675,11 +877,19 @@ void mp_cache_preload_frame(mp_cache_t *c)
 
 int64_t mp_cache_get_current_time(mp_cache_t *c)
 {
+	if (mp_cache_streaming(c))
+		return mp_media_get_current_time(&c->stream);
+
 	return mp_cache_get_base_pts(c) * (int64_t)c->speed / 100000000LL;
 }
 
 void mp_cache_seek(mp_cache_t *c, int64_t pos)
 {
+	if (mp_cache_streaming(c)) {
+		mp_media_seek(&c->stream, pos);
+		return;
+	}
+
 	pthread_mutex_lock(&c->mutex);
 	if (c->active) {
 		c->seek = true;
@@ -692,10 +902,32 @@ void mp_cache_seek(mp_cache_t *c, int64_t pos)
 
 int64_t mp_cache_get_frames(mp_cache_t *c)
 {
-	return c->video_frames.num;
+	if (mp_cache_streaming(c))
+		return mp_media_get_frames(&c->stream);
+
+	return c->decoded ? (int64_t)c->video_frames.num : c->estimated_frames;
 }
 
 int64_t mp_cache_get_duration(mp_cache_t *c)
 {
 	return c->media_duration;
 }
+
+void mp_cache_set_looping(mp_cache_t *c, bool looping)
+{
+	pthread_mutex_lock(&c->mutex);
+	c->looping = looping;
+	if (c->streaming)
+		c->stream.looping = looping;
+	pthread_mutex_unlock(&c->mutex);
+}
+
+void mp_cache_set_is_linear_alpha(mp_cache_t *c, bool is_linear_alpha)
+{
+	pthread_mutex_lock(&c->mutex);
+	c->is_linear_alpha = is_linear_alpha;
+	c->m.is_linear_alpha = is_linear_alpha;
+	if (c->streaming)
+		c->stream.is_linear_alpha = is_linear_alpha;
+	pthread_mutex_unlock(&c->mutex);
+}
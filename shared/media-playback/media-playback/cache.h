@@ -39,6 +39,20 @@ struct mp_cache {
 	int buffering;
 	int speed;
 
+	size_t budget;
+	size_t size;
+	int64_t estimated_frames;
+	bool over_budget;
+	bool truncated;
+	bool decoded;
+	bool is_linear_alpha;
+
+	/* real time decoding, used instead of the cache when the budget is
+	 * exceeded while decoding */
+	struct mp_media_info stream_info;
+	mp_media_t stream;
+	bool streaming;
+
 	pthread_mutex_t mutex;
 	os_sem_t *sem;
 	bool preload_frame;
@@ -95,3 +109,5 @@ extern int64_t mp_cache_get_current_time(mp_cache_t *c);
 extern void mp_cache_seek(mp_cache_t *c, int64_t pos);
 extern int64_t mp_cache_get_frames(mp_cache_t *c);
 extern int64_t mp_cache_get_duration(mp_cache_t *c);
+extern void mp_cache_set_looping(mp_cache_t *c, bool looping);
+extern void mp_cache_set_is_linear_alpha(mp_cache_t *c, bool is_linear_alpha);
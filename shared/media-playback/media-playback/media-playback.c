@@ -31,8 +31,16 @@ media_playback_t *media_playback_create(const struct mp_media_info *info)
 	media_playback_t *mp = bzalloc(sizeof(*mp));
 	mp->is_cached = info->is_local_file && info->full_decode;
 
-	if ((mp->is_cached && !mp_cache_init(&mp->cache, info)) ||
-	    (!mp->is_cached && !mp_media_init(&mp->media, info))) {
+	if (mp->is_cached && !mp_cache_init(&mp->cache, info)) {
+		if (!mp->cache.over_budget) {
+			bfree(mp);
+			return NULL;
+		}
+
+		/* too large to cache, fall back to decoding in real time */
+		mp->is_cached = false;
+	}
+	if (!mp->is_cached && !mp_media_init(&mp->media, info)) {
 		bfree(mp);
 		return NULL;
 	}
@@ -88,7 +96,7 @@ void media_playback_stop(media_playback_t *mp)
 void media_playback_set_looping(media_playback_t *mp, bool looping)
 {
 	if (mp->is_cached)
-		mp->cache.looping = looping;
+		mp_cache_set_looping(&mp->cache, looping);
 	else
 		mp->media.looping = looping;
 }
@@ -96,7 +104,7 @@ void media_playback_set_looping(media_playback_t *mp, bool looping)
 void media_playback_set_is_linear_alpha(media_playback_t *mp, bool is_linear_alpha)
 {
 	if (mp->is_cached)
-		mp->cache.m.is_linear_alpha = is_linear_alpha;
+		mp_cache_set_is_linear_alpha(&mp->cache, is_linear_alpha);
 	else
 		mp->media.is_linear_alpha = is_linear_alpha;
 }
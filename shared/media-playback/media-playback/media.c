@@ -735,6 +735,7 @@ bool mp_media_init2(mp_media_t *m)
 static inline bool mp_media_thread(mp_media_t *m)
 {
 	os_set_thread_name("mp_media_thread");
+	bmem_set_thread_tag(bmem_get_tag("media-playback"));
 
 	if (!mp_media_init2(m)) {
 		return false;
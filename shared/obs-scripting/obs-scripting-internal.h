@@ -30,6 +30,13 @@ struct obs_script {
 	struct dstr path;
 	struct dstr file;
 	struct dstr desc;
+
+	/* time spent in callbacks run by the script thread, see
+	 * script_exec_begin/script_exec_end */
+	const char *profile_name;
+	uint64_t exec_time_ns;
+	uint64_t exec_count;
+	uint64_t slow_log_ts;
 };
 
 struct script_callback;
@@ -37,6 +44,20 @@ typedef void (*defer_call_cb)(void *param);
 
 extern void defer_call_post(defer_call_cb call, void *cb);
 
+/* Script ticks, timers and tick callbacks are run on the script thread
+ * rather than the graphics thread.  The script thread is paced by the
+ * graphics thread, anything that has to run on the graphics thread itself
+ * can be queued with script_graphics_call_post. */
+typedef void (*script_tick_cb)(void *param, float seconds);
+
+extern void script_add_tick_callback(script_tick_cb tick, void *param);
+extern void script_remove_tick_callback(script_tick_cb tick, void *param);
+extern void script_graphics_call_post(defer_call_cb call, void *cb);
+
+/* records the time spent calling into a script with the profiler */
+extern uint64_t script_exec_begin(obs_script_t *script);
+extern void script_exec_end(obs_script_t *script, uint64_t start);
+
 extern void script_log(obs_script_t *script, int level, const char *format, ...);
 extern void script_log_va(obs_script_t *script, int level, const char *format, va_list args);
 
@@ -294,7 +294,9 @@ static void timer_call(struct script_callback *p_cb)
 		return;
 
 	lock_callback();
+	uint64_t start = script_exec_begin(p_cb->script);
 	call_func_(cb->script, cb->reg_idx, 0, 0, "timer_cb", __FUNCTION__);
+	script_exec_end(p_cb->script, start);
 	unlock_callback();
 }
 
@@ -378,15 +380,17 @@ static void obs_lua_tick_callback(void *priv, float seconds)
 	lua_State *script = cb->script;
 
 	if (script_callback_removed(&cb->base)) {
-		obs_remove_tick_callback(obs_lua_tick_callback, cb);
+		script_remove_tick_callback(obs_lua_tick_callback, cb);
 		return;
 	}
 
 	lock_callback();
+	uint64_t start = script_exec_begin(cb->base.script);
 
 	lua_pushnumber(script, (lua_Number)seconds);
 	call_func(obs_lua_tick_callback, 1, 0);
 
+	script_exec_end(cb->base.script, start);
 	unlock_callback();
 }
 
@@ -403,7 +407,7 @@ static int obs_lua_remove_tick_callback(lua_State *script)
 
 static void defer_add_tick(void *cb)
 {
-	obs_add_tick_callback(obs_lua_tick_callback, cb);
+	script_add_tick_callback(obs_lua_tick_callback, cb);
 }
 
 static int obs_lua_add_tick_callback(lua_State *script)
@@ -418,6 +422,38 @@ static int obs_lua_add_tick_callback(lua_State *script)
 
 /* -------------------------------------------- */
 
+static void lua_graphics_call(void *p_cb)
+{
+	struct lua_obs_callback *cb = p_cb;
+	lua_State *script = cb->script;
+
+	if (script_callback_removed(&cb->base))
+		return;
+
+	lock_callback();
+	uint64_t start = script_exec_begin(cb->base.script);
+
+	call_func(lua_graphics_call, 0, 0);
+
+	script_exec_end(cb->base.script, start);
+	remove_lua_obs_callback(cb);
+	unlock_callback();
+
+	free_lua_obs_callback(cb);
+}
+
+static int run_on_graphics_thread(lua_State *script)
+{
+	if (!verify_args1(script, is_function))
+		return 0;
+
+	struct lua_obs_callback *cb = add_lua_obs_callback(script, 1);
+	script_graphics_call_post(lua_graphics_call, cb);
+	return 0;
+}
+
+/* -------------------------------------------- */
+
 static void calldata_signal_callback(void *priv, calldata_t *cd)
 {
 	struct lua_obs_callback *cb = priv;
@@ -1020,6 +1056,7 @@ static void add_hook_functions(lua_State *script)
 	add_func("obs_remove_main_render_callback", obs_lua_remove_main_render_callback);
 	add_func("obs_add_tick_callback", obs_lua_add_tick_callback);
 	add_func("obs_remove_tick_callback", obs_lua_remove_tick_callback);
+	add_func("run_on_graphics_thread", run_on_graphics_thread);
 	add_func("signal_handler_connect", obs_lua_signal_handler_connect);
 	add_func("signal_handler_disconnect", obs_lua_signal_handler_disconnect);
 	add_func("signal_handler_connect_global", obs_lua_signal_handler_connect_global);
@@ -1052,10 +1089,12 @@ static void lua_tick(void *param, float seconds)
 		current_lua_script = data;
 
 		pthread_mutex_lock(&data->mutex);
+		uint64_t start = script_exec_begin(&data->base);
 
 		lua_pushnumber(script, (double)seconds);
 		call_func_(script, data->tick, 1, 0, "tick", __FUNCTION__);
 
+		script_exec_end(&data->base, start);
 		pthread_mutex_unlock(&data->mutex);
 
 		data = data->next_tick;
@@ -1364,12 +1403,12 @@ void obs_lua_load(void)
 	dstr_free(&package_cpath);
 	startup_script = tmp.array;
 
-	obs_add_tick_callback(lua_tick, NULL);
+	script_add_tick_callback(lua_tick, NULL);
 }
 
 void obs_lua_unload(void)
 {
-	obs_remove_tick_callback(lua_tick, NULL);
+	script_remove_tick_callback(lua_tick, NULL);
 
 	bfree(startup_script);
 	pthread_mutex_destroy(&tick_mutex);
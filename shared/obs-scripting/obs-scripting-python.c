@@ -424,9 +424,11 @@ static void timer_call(struct script_callback *p_cb)
 		return;
 
 	lock_callback(cb);
+	uint64_t start = script_exec_begin(p_cb->script);
 	PyObject *py_ret = PyObject_CallObject(cb->func, NULL);
 	py_error();
 	Py_XDECREF(py_ret);
+	script_exec_end(p_cb->script, start);
 	unlock_callback();
 }
 
@@ -465,11 +467,12 @@ static void obs_python_tick_callback(void *priv, float seconds)
 	struct python_obs_callback *cb = priv;
 
 	if (script_callback_removed(&cb->base)) {
-		obs_remove_tick_callback(obs_python_tick_callback, cb);
+		script_remove_tick_callback(obs_python_tick_callback, cb);
 		return;
 	}
 
 	lock_callback(cb);
+	uint64_t start = script_exec_begin(cb->base.script);
 
 	PyObject *args = Py_BuildValue("(f)", seconds);
 	PyObject *py_ret = PyObject_CallObject(cb->func, args);
@@ -477,6 +480,7 @@ static void obs_python_tick_callback(void *priv, float seconds)
 	Py_XDECREF(py_ret);
 	Py_XDECREF(args);
 
+	script_exec_end(cb->base.script, start);
 	unlock_callback();
 }
 
@@ -503,6 +507,13 @@ static PyObject *obs_python_remove_tick_callback(PyObject *self, PyObject *args)
 	return python_none();
 }
 
+/* added from the defer thread, the script thread might be holding the tick
+ * callback list lock while waiting for the GIL */
+static void defer_add_tick(void *cb)
+{
+	script_add_tick_callback(obs_python_tick_callback, cb);
+}
+
 static PyObject *obs_python_add_tick_callback(PyObject *self, PyObject *args)
 {
 	struct obs_python_script *script = cur_python_script;
@@ -521,7 +532,52 @@ static PyObject *obs_python_add_tick_callback(PyObject *self, PyObject *args)
 		return python_none();
 
 	struct python_obs_callback *cb = add_python_obs_callback(script, py_cb);
-	obs_add_tick_callback(obs_python_tick_callback, cb);
+	defer_call_post(defer_add_tick, cb);
+	return python_none();
+}
+
+/* -------------------------------------------- */
+
+static void python_graphics_call(void *p_cb)
+{
+	struct python_obs_callback *cb = p_cb;
+
+	if (script_callback_removed(&cb->base))
+		return;
+
+	lock_callback(cb);
+	uint64_t start = script_exec_begin(cb->base.script);
+
+	PyObject *py_ret = PyObject_CallObject(cb->func, NULL);
+	py_error();
+	Py_XDECREF(py_ret);
+
+	script_exec_end(cb->base.script, start);
+	remove_python_obs_callback(cb);
+	unlock_callback();
+
+	free_python_obs_callback(cb);
+}
+
+static PyObject *run_on_graphics_thread(PyObject *self, PyObject *args)
+{
+	struct obs_python_script *script = cur_python_script;
+	PyObject *py_cb = NULL;
+
+	if (!script) {
+		PyErr_SetString(PyExc_RuntimeError, "No active script, report this to Lain");
+		return NULL;
+	}
+
+	UNUSED_PARAMETER(self);
+
+	if (!parse_args(args, "O", &py_cb))
+		return python_none();
+	if (!py_cb || !PyFunction_Check(py_cb))
+		return python_none();
+
+	struct python_obs_callback *cb = add_python_obs_callback(script, py_cb);
+	script_graphics_call_post(python_graphics_call, cb);
 	return python_none();
 }
 
@@ -1211,6 +1267,7 @@ static void add_hook_functions(PyObject *module)
 		DEF_FUNC("obs_sceneitem_group_enum_items", sceneitem_group_enum_items),
 		DEF_FUNC("obs_remove_tick_callback", obs_python_remove_tick_callback),
 		DEF_FUNC("obs_add_tick_callback", obs_python_add_tick_callback),
+		DEF_FUNC("run_on_graphics_thread", run_on_graphics_thread),
 		DEF_FUNC("signal_handler_disconnect", obs_python_signal_handler_disconnect),
 		DEF_FUNC("signal_handler_connect", obs_python_signal_handler_connect),
 		DEF_FUNC("signal_handler_disconnect_global", obs_python_signal_handler_disconnect_global),
@@ -1506,11 +1563,14 @@ static void python_tick(void *param, float seconds)
 
 		while (data) {
 			cur_python_script = data;
+			uint64_t start = script_exec_begin(&data->base);
 
 			PyObject *py_ret = PyObject_CallObject(data->tick, args);
 			Py_XDECREF(py_ret);
 			py_error();
 
+			script_exec_end(&data->base, start);
+
 			data = data->next_tick;
 		}
 
@@ -1733,13 +1793,16 @@ out:
 	python_loaded_at_all = success;
 
 	if (python_loaded)
-		obs_add_tick_callback(python_tick, NULL);
+		script_add_tick_callback(python_tick, NULL);
 
 	return python_loaded;
 }
 
 void obs_python_unload(void)
 {
+	/* make sure python_tick is no longer running before finalizing */
+	script_remove_tick_callback(python_tick, NULL);
+
 	if (mutexes_loaded) {
 		pthread_mutex_destroy(&tick_mutex);
 		pthread_mutex_destroy(&timer_mutex);
@@ -1757,8 +1820,6 @@ void obs_python_unload(void)
 
 	/* ---------------------- */
 
-	obs_remove_tick_callback(python_tick, NULL);
-
 	for (size_t i = 0; i < python_paths.num; i++)
 		bfree(python_paths.array[i]);
 	da_free(python_paths);
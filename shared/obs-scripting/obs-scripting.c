@@ -15,11 +15,15 @@
     along with this program.  If not, see <http://www.gnu.org/licenses/>.
 ******************************************************************************/
 
+#include <inttypes.h>
+
 #include <obs.h>
 #include <util/dstr.h>
 #include <util/platform.h>
+#include <util/profiler.h>
 #include <util/threading.h>
 #include <util/deque.h>
+#include <util/darray.h>
 
 #include "obs-scripting-internal.h"
 #include "obs-scripting-callback.h"
@@ -117,6 +121,217 @@ void defer_call_post(defer_call_cb call, void *cb)
 
 /* -------------------------------------------- */
 
+/* calls taking longer than this are logged, at most once per interval */
+#define SLOW_SCRIPT_CALL_NS 20000000ULL
+#define SLOW_SCRIPT_LOG_INTERVAL_NS 10000000000ULL
+
+struct script_tick_callback {
+	script_tick_cb tick;
+	void *param;
+};
+
+static const char *script_thread_name = "obs_scripting_tick";
+
+static pthread_mutex_t script_tick_mutex;
+static DARRAY(struct script_tick_callback) script_tick_callbacks;
+
+static pthread_mutex_t script_thread_mutex;
+static float script_thread_seconds = 0.0f;
+static DARRAY(struct defer_call) graphics_calls;
+static os_event_t *script_thread_event;
+static volatile bool script_thread_exit = false;
+static pthread_t script_thread;
+
+static pthread_mutex_t script_stats_mutex;
+
+static void *script_thread_loop(void *unused)
+{
+	UNUSED_PARAMETER(unused);
+	os_set_thread_name("scripting: tick");
+
+	while (os_event_wait(script_thread_event) == 0) {
+		if (os_atomic_load_bool(&script_thread_exit))
+			break;
+
+		/* ticks that arrived while the scripts were still busy are
+		 * merged into a single call */
+		pthread_mutex_lock(&script_thread_mutex);
+		float seconds = script_thread_seconds;
+		script_thread_seconds = 0.0f;
+		pthread_mutex_unlock(&script_thread_mutex);
+
+		profile_start(script_thread_name);
+
+		pthread_mutex_lock(&script_tick_mutex);
+		for (size_t i = script_tick_callbacks.num; i > 0; i--) {
+			if (i > script_tick_callbacks.num)
+				continue;
+
+			struct script_tick_callback callback = script_tick_callbacks.array[i - 1];
+			callback.tick(callback.param, seconds);
+		}
+		pthread_mutex_unlock(&script_tick_mutex);
+
+		profile_end(script_thread_name);
+		profile_reenable_thread();
+	}
+
+	return NULL;
+}
+
+/* paces the script thread and runs the calls queued for the graphics thread */
+static void script_graphics_tick(void *param, float seconds)
+{
+	DARRAY(struct defer_call) calls;
+
+	pthread_mutex_lock(&script_thread_mutex);
+	script_thread_seconds += seconds;
+	calls.da = graphics_calls.da;
+	da_init(graphics_calls);
+	pthread_mutex_unlock(&script_thread_mutex);
+
+	os_event_signal(script_thread_event);
+
+	for (size_t i = 0; i < calls.num; i++)
+		calls.array[i].call(calls.array[i].cb);
+	da_free(calls);
+
+	UNUSED_PARAMETER(param);
+}
+
+void script_add_tick_callback(script_tick_cb tick, void *param)
+{
+	struct script_tick_callback data = {tick, param};
+
+	pthread_mutex_lock(&script_tick_mutex);
+	da_insert(script_tick_callbacks, 0, &data);
+	pthread_mutex_unlock(&script_tick_mutex);
+}
+
+/* once this returns the callback is guaranteed to not be running */
+void script_remove_tick_callback(script_tick_cb tick, void *param)
+{
+	struct script_tick_callback data = {tick, param};
+
+	pthread_mutex_lock(&script_tick_mutex);
+	da_erase_item(script_tick_callbacks, &data);
+	pthread_mutex_unlock(&script_tick_mutex);
+}
+
+void script_graphics_call_post(defer_call_cb call, void *cb)
+{
+	struct defer_call info;
+	info.call = call;
+	info.cb = cb;
+
+	pthread_mutex_lock(&script_thread_mutex);
+	if (!os_atomic_load_bool(&script_thread_exit))
+		da_push_back(graphics_calls, &info);
+	pthread_mutex_unlock(&script_thread_mutex);
+}
+
+static bool script_thread_start(void)
+{
+	da_init(script_tick_callbacks);
+	da_init(graphics_calls);
+	os_atomic_set_bool(&script_thread_exit, false);
+
+	if (pthread_mutex_init_recursive(&script_tick_mutex) != 0)
+		return false;
+	if (pthread_mutex_init(&script_thread_mutex, NULL) != 0)
+		goto fail_thread_mutex;
+	if (pthread_mutex_init(&script_stats_mutex, NULL) != 0)
+		goto fail_stats_mutex;
+	if (os_event_init(&script_thread_event, OS_EVENT_TYPE_AUTO) != 0)
+		goto fail_event;
+	if (pthread_create(&script_thread, NULL, script_thread_loop, NULL) != 0)
+		goto fail_thread;
+
+	obs_add_tick_callback(script_graphics_tick, NULL);
+	return true;
+
+fail_thread:
+	os_event_destroy(script_thread_event);
+fail_event:
+	pthread_mutex_destroy(&script_stats_mutex);
+fail_stats_mutex:
+	pthread_mutex_destroy(&script_thread_mutex);
+fail_thread_mutex:
+	pthread_mutex_destroy(&script_tick_mutex);
+	return false;
+}
+
+static void script_thread_stop(void)
+{
+	obs_remove_tick_callback(script_graphics_tick, NULL);
+
+	pthread_mutex_lock(&script_thread_mutex);
+	os_atomic_set_bool(&script_thread_exit, true);
+	da_free(graphics_calls);
+	pthread_mutex_unlock(&script_thread_mutex);
+
+	os_event_signal(script_thread_event);
+	pthread_join(script_thread, NULL);
+
+	if (script_tick_callbacks.num)
+		blog(LOG_WARNING, "[Scripting] %zu script tick callbacks were never removed",
+		     script_tick_callbacks.num);
+	da_free(script_tick_callbacks);
+
+	os_event_destroy(script_thread_event);
+	pthread_mutex_destroy(&script_stats_mutex);
+	pthread_mutex_destroy(&script_thread_mutex);
+	pthread_mutex_destroy(&script_tick_mutex);
+}
+
+uint64_t script_exec_begin(obs_script_t *script)
+{
+	pthread_mutex_lock(&script_stats_mutex);
+	if (!script->profile_name)
+		script->profile_name =
+			profile_store_name(obs_get_profiler_name_store(), "script: %s", script->file.array);
+	pthread_mutex_unlock(&script_stats_mutex);
+
+	profile_start(script->profile_name);
+	return os_gettime_ns();
+}
+
+void script_exec_end(obs_script_t *script, uint64_t start)
+{
+	uint64_t end = os_gettime_ns();
+	uint64_t elapsed = end - start;
+	bool log_slow = false;
+
+	profile_end(script->profile_name);
+
+	pthread_mutex_lock(&script_stats_mutex);
+	script->exec_time_ns += elapsed;
+	script->exec_count++;
+
+	if (elapsed >= SLOW_SCRIPT_CALL_NS &&
+	    (!script->slow_log_ts || end - script->slow_log_ts >= SLOW_SCRIPT_LOG_INTERVAL_NS)) {
+		script->slow_log_ts = end;
+		log_slow = true;
+	}
+	pthread_mutex_unlock(&script_stats_mutex);
+
+	if (log_slow)
+		script_warn(script, "Callback took %.1f ms, this delays every other script",
+			    (double)elapsed / 1000000.0);
+}
+
+static void log_script_stats(obs_script_t *script)
+{
+	if (!script->exec_count)
+		return;
+
+	blog(LOG_INFO, "[obs-scripting]: %s: %" PRIu64 " callbacks, %.2f ms total, %.3f ms average",
+	     script->file.array, script->exec_count, (double)script->exec_time_ns / 1000000.0,
+	     (double)script->exec_time_ns / (double)script->exec_count / 1000000.0);
+}
+
+/* -------------------------------------------- */
+
 bool obs_scripting_load(void)
 {
 	deque_init(&defer_call_queue);
@@ -141,6 +356,21 @@ bool obs_scripting_load(void)
 		return false;
 	}
 
+	if (!script_thread_start()) {
+		pthread_mutex_lock(&defer_call_mutex);
+		defer_call_exit = true;
+		pthread_mutex_unlock(&defer_call_mutex);
+
+		os_sem_post(defer_call_semaphore);
+		pthread_join(defer_call_thread, NULL);
+
+		deque_free(&defer_call_queue);
+		os_sem_destroy(defer_call_semaphore);
+		pthread_mutex_destroy(&defer_call_mutex);
+		pthread_mutex_destroy(&detach_mutex);
+		return false;
+	}
+
 #if defined(LUAJIT_FOUND)
 	obs_lua_load();
 #endif
@@ -175,6 +405,12 @@ void obs_scripting_unload(void)
 
 	/* ---------------------- */
 
+	/* stop the script thread before the callbacks it might still be
+	 * referencing are freed */
+	script_thread_stop();
+
+	/* ---------------------- */
+
 	int total_detached = 0;
 
 	pthread_mutex_lock(&detach_mutex);
@@ -421,6 +657,7 @@ void obs_script_destroy(obs_script_t *script)
 #if defined(LUAJIT_FOUND)
 	if (script->type == OBS_SCRIPT_LANG_LUA) {
 		obs_lua_script_unload(script);
+		log_script_stats(script);
 		obs_lua_script_destroy(script);
 		return;
 	}
@@ -428,6 +665,7 @@ void obs_script_destroy(obs_script_t *script)
 #if defined(Python_FOUND)
 	if (script->type == OBS_SCRIPT_LANG_PYTHON) {
 		obs_python_script_unload(script);
+		log_script_stats(script);
 		obs_python_script_destroy(script);
 		return;
 	}
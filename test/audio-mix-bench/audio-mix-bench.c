@@ -0,0 +1,376 @@
+/******************************************************************************
+    Copyright (C) 2026 by OBS Project contributors
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+******************************************************************************/
+
+/* Audio mix benchmark.  Runs libobs without a frontend with a number of
+ * synthetic audio sources, connects raw audio callbacks to one more mix at a
+ * time and reports the time the audio thread spends per tick, so the cost of
+ * each mix that actually has a consumer can be seen.  Exits with a non-zero
+ * status when the audio thread stopped ticking or a connected mix received
+ * no audio. */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include <obs.h>
+#include <graphics/math-defs.h>
+#include <util/base.h>
+#include <util/bmem.h>
+#include <util/platform.h>
+#include <util/profiler.h>
+#include <util/threading.h>
+
+#if defined(__linux__) || defined(__FreeBSD__)
+#include <obs-nix-platform.h>
+#endif
+
+#define SAMPLE_RATE 48000
+
+struct bench_options {
+	int sources;
+	int duration_sec;
+	bool csv;
+};
+
+static struct bench_options opts = {
+	.sources = 16,
+	.duration_sec = 3,
+};
+
+static volatile long mix_calls[MAX_AUDIO_MIXES];
+
+/* ------------------------------------------------------------------------- */
+/* Synthetic audio source: outputs a sine wave in real time */
+
+struct bench_source {
+	obs_source_t *source;
+	os_event_t *stop_event;
+	pthread_t thread;
+	bool thread_active;
+	float frequency;
+};
+
+static const char *bench_source_getname(void *unused)
+{
+	UNUSED_PARAMETER(unused);
+	return "Audio Benchmark Source";
+}
+
+static void *bench_source_thread(void *data)
+{
+	struct bench_source *bs = data;
+	float *audio[2];
+
+	audio[0] = bmalloc(AUDIO_OUTPUT_FRAMES * sizeof(float) * 2);
+	audio[1] = audio[0] + AUDIO_OUTPUT_FRAMES;
+
+	struct obs_source_audio out_audio = {
+		.data = {(uint8_t *)audio[0], (uint8_t *)audio[1]},
+		.frames = AUDIO_OUTPUT_FRAMES,
+		.speakers = SPEAKERS_STEREO,
+		.format = AUDIO_FORMAT_FLOAT_PLANAR,
+		.samples_per_sec = SAMPLE_RATE,
+	};
+
+	os_set_thread_name("bench source");
+
+	uint64_t start = os_gettime_ns();
+
+	for (uint64_t i = 0; os_event_try(bs->stop_event) == EAGAIN; i++) {
+		uint64_t samples = i * AUDIO_OUTPUT_FRAMES;
+		uint64_t ts = start + audio_frames_to_ns(SAMPLE_RATE, samples);
+		os_sleepto_ns(ts);
+
+		for (uint32_t s = 0; s < AUDIO_OUTPUT_FRAMES; s++) {
+			float t = (float)(samples + s) / (float)SAMPLE_RATE;
+			float val = sinf(t * bs->frequency * 2.0f * (float)M_PI) * 0.1f;
+			audio[0][s] = val;
+			audio[1][s] = val;
+		}
+
+		out_audio.timestamp = ts;
+		obs_source_output_audio(bs->source, &out_audio);
+	}
+
+	bfree(audio[0]);
+	return NULL;
+}
+
+static void bench_source_destroy(void *data)
+{
+	struct bench_source *bs = data;
+
+	if (bs->thread_active) {
+		os_event_signal(bs->stop_event);
+		pthread_join(bs->thread, NULL);
+	}
+
+	os_event_destroy(bs->stop_event);
+	bfree(bs);
+}
+
+static void *bench_source_create(obs_data_t *settings, obs_source_t *source)
+{
+	struct bench_source *bs = bzalloc(sizeof(struct bench_source));
+	bs->source = source;
+	bs->frequency = (float)obs_data_get_double(settings, "frequency");
+
+	if (os_event_init(&bs->stop_event, OS_EVENT_TYPE_MANUAL) != 0 ||
+	    pthread_create(&bs->thread, NULL, bench_source_thread, bs) != 0) {
+		bench_source_destroy(bs);
+		return NULL;
+	}
+
+	bs->thread_active = true;
+	return bs;
+}
+
+static struct obs_source_info bench_source_info = {
+	.id = "audio_bench_source",
+	.type = OBS_SOURCE_TYPE_INPUT,
+	.output_flags = OBS_SOURCE_AUDIO,
+	.get_name = bench_source_getname,
+	.create = bench_source_create,
+	.destroy = bench_source_destroy,
+};
+
+/* ------------------------------------------------------------------------- */
+/* Audio thread timing, taken from the profiler entries of the audio thread */
+
+struct tick_stats {
+	uint64_t usec;
+	uint64_t count;
+};
+
+static bool sum_audio_thread(void *context, profiler_snapshot_entry_t *entry)
+{
+	struct tick_stats *stats = context;
+	const char *name = profiler_snapshot_entry_name(entry);
+
+	if (!name || strncmp(name, "audio_thread(", 13) != 0)
+		return true;
+
+	profiler_time_entries_t *times = profiler_snapshot_entry_times(entry);
+	for (size_t i = 0; i < times->num; i++) {
+		stats->usec += times->array[i].time_delta * times->array[i].count;
+		stats->count += times->array[i].count;
+	}
+
+	return true;
+}
+
+static void sample_ticks(struct tick_stats *stats)
+{
+	profiler_snapshot_t *snap = profile_snapshot_create();
+
+	memset(stats, 0, sizeof(*stats));
+	profiler_snapshot_enumerate_roots(snap, sum_audio_thread, stats);
+	profile_snapshot_free(snap);
+}
+
+/* ------------------------------------------------------------------------- */
+
+static void raw_audio(void *param, size_t mix_idx, struct audio_data *data)
+{
+	os_atomic_inc_long(&mix_calls[mix_idx]);
+
+	UNUSED_PARAMETER(param);
+	UNUSED_PARAMETER(data);
+}
+
+static bool reset_obs(void)
+{
+	struct obs_video_info ovi = {
+#ifdef _WIN32
+		.graphics_module = "libobs-d3d11",
+#else
+		.graphics_module = "libobs-opengl",
+#endif
+		.fps_num = 30,
+		.fps_den = 1,
+		.base_width = 640,
+		.base_height = 360,
+		.output_width = 640,
+		.output_height = 360,
+		.output_format = VIDEO_FORMAT_NV12,
+		.gpu_conversion = true,
+		.colorspace = VIDEO_CS_709,
+		.range = VIDEO_RANGE_PARTIAL,
+		.scale_type = OBS_SCALE_BICUBIC,
+	};
+	struct obs_audio_info oai = {
+		.samples_per_sec = SAMPLE_RATE,
+		.speakers = SPEAKERS_STEREO,
+	};
+
+	if (obs_reset_video(&ovi) != OBS_VIDEO_SUCCESS) {
+		blog(LOG_ERROR, "Couldn't initialize video");
+		return false;
+	}
+
+	return obs_reset_audio(&oai);
+}
+
+static bool create_sources(obs_source_t **sources)
+{
+	for (int i = 0; i < opts.sources; i++) {
+		obs_data_t *settings = obs_data_create();
+		obs_data_set_double(settings, "frequency", 220.0 + 55.0 * i);
+
+		sources[i] = obs_source_create_private("audio_bench_source", "audio bench", settings);
+		obs_data_release(settings);
+
+		if (!sources[i])
+			return false;
+
+		/* output channels are root nodes of the audio tree, so every
+		 * source gets mixed */
+		obs_set_output_source((uint32_t)i, sources[i]);
+	}
+
+	return true;
+}
+
+static void destroy_sources(obs_source_t **sources)
+{
+	for (int i = 0; i < opts.sources; i++) {
+		obs_set_output_source((uint32_t)i, NULL);
+		obs_source_release(sources[i]);
+	}
+}
+
+/* connects one more mix per step, from none up to every mix */
+static bool run_benchmark(void)
+{
+	double period_usec = (double)AUDIO_OUTPUT_FRAMES * 1000000.0 / (double)SAMPLE_RATE;
+	bool success = true;
+
+	printf(opts.csv ? "active_mixes,usec_per_tick,audio_thread_cpu\n" : "%-12s %14s %16s\n", "active mixes",
+	       "usec per tick", "audio thread cpu");
+
+	for (size_t active = 0; active <= MAX_AUDIO_MIXES; active++) {
+		struct tick_stats start;
+		struct tick_stats end;
+
+		if (active > 0)
+			obs_add_raw_audio_callback(active - 1, NULL, raw_audio, NULL);
+
+		/* let the new mix settle before measuring */
+		os_sleep_ms(500);
+		for (size_t i = 0; i < MAX_AUDIO_MIXES; i++)
+			os_atomic_set_long(&mix_calls[i], 0);
+
+		sample_ticks(&start);
+		os_sleep_ms((uint32_t)opts.duration_sec * 1000);
+		sample_ticks(&end);
+
+		uint64_t ticks = end.count - start.count;
+		if (!ticks) {
+			blog(LOG_ERROR, "The audio thread did not tick with %zu active mixes", active);
+			success = false;
+			break;
+		}
+
+		for (size_t i = 0; i < active; i++) {
+			if (!os_atomic_load_long(&mix_calls[i])) {
+				blog(LOG_ERROR, "Mix %zu did not receive any audio", i + 1);
+				success = false;
+			}
+		}
+
+		double usec = (double)(end.usec - start.usec) / (double)ticks;
+		printf(opts.csv ? "%zu,%.1f,%.2f\n" : "%-12zu %14.1f %15.2f%%\n", active, usec,
+		       usec * 100.0 / period_usec);
+	}
+
+	for (size_t i = 0; i < MAX_AUDIO_MIXES; i++)
+		obs_remove_raw_audio_callback(i, raw_audio, NULL);
+
+	return success;
+}
+
+static void usage(const char *name)
+{
+	fprintf(stderr,
+		"usage: %s [options]\n"
+		"  --sources <n>     audio sources to mix, up to %d (default 16)\n"
+		"  --duration <sec>  measurement time per step (default 3)\n"
+		"  --csv             print comma separated values\n",
+		name, MAX_CHANNELS);
+}
+
+static bool parse_args(int argc, char *argv[])
+{
+	for (int i = 1; i < argc; i++) {
+		const char *arg = argv[i];
+
+		if (strcmp(arg, "--csv") == 0) {
+			opts.csv = true;
+		} else if (strcmp(arg, "--sources") == 0 && i + 1 < argc) {
+			opts.sources = atoi(argv[++i]);
+		} else if (strcmp(arg, "--duration") == 0 && i + 1 < argc) {
+			opts.duration_sec = atoi(argv[++i]);
+		} else {
+			return false;
+		}
+	}
+
+	return opts.sources > 0 && opts.sources <= MAX_CHANNELS && opts.duration_sec > 0;
+}
+
+int main(int argc, char *argv[])
+{
+	obs_source_t *sources[MAX_CHANNELS] = {0};
+	int status = 1;
+
+	if (!parse_args(argc, argv)) {
+		usage(argv[0]);
+		return 2;
+	}
+
+	profiler_start();
+
+#if defined(__linux__) || defined(__FreeBSD__)
+	/* headless machines need a virtual X server such as xvfb-run */
+	obs_set_nix_platform(OBS_NIX_PLATFORM_X11_EGL);
+#endif
+
+	if (!obs_startup("en-US", NULL, NULL)) {
+		blog(LOG_ERROR, "Couldn't start libobs");
+		goto cleanup_profiler;
+	}
+
+	obs_register_source(&bench_source_info);
+
+	if (!reset_obs())
+		goto cleanup_obs;
+
+	if (create_sources(sources) && run_benchmark())
+		status = 0;
+
+	destroy_sources(sources);
+
+cleanup_obs:
+	obs_shutdown();
+	blog(LOG_INFO, "Number of memory leaks: %ld", bnum_allocs());
+
+cleanup_profiler:
+	profiler_stop();
+	profiler_free();
+	return status;
+}
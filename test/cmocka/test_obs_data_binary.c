@@ -0,0 +1,248 @@
+/******************************************************************************
+    Copyright (C) 2026 by OBS Project contributors
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+******************************************************************************/
+
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <stdio.h>
+#include <string.h>
+#include <cmocka.h>
+
+#include <obs-data.h>
+#include <util/bmem.h>
+#include <util/platform.h>
+
+#define BINARY_FILE "test_obs_data_binary.bin"
+#define JSON_FILE "test_obs_data_binary.json"
+
+static const char *sample_json = "{\"name\":\"sample\",\"int\":-9007199254740993,\"double\":0.1,\"bool\":true,"
+				 "\"str\":\"line\\nbreak \\u00e9\",\"empty\":\"\",\"obj\":{\"nested\":{\"x\":1.5}},"
+				 "\"sources\":[{\"name\":\"a\",\"v\":1},{\"name\":\"b\",\"v\":2},{}]}";
+
+static void binary_round_trip_test(void **state)
+{
+	UNUSED_PARAMETER(state);
+
+	obs_data_t *data = obs_data_create_from_json(sample_json);
+	size_t size;
+	void *buf = obs_data_get_binary(data, &size);
+
+	assert_non_null(buf);
+
+	obs_data_t *copy = obs_data_create_from_binary(buf, size);
+	assert_non_null(copy);
+
+	/* lossless in both directions through json */
+	assert_string_equal(obs_data_get_json(copy), obs_data_get_json(data));
+	assert_int_equal(obs_data_get_int(copy, "int"), -9007199254740993LL);
+	assert_true(obs_data_get_double(copy, "double") == 0.1);
+
+	obs_data_item_t *item = obs_data_item_byname(copy, "double");
+	assert_int_equal(obs_data_item_numtype(item), OBS_DATA_NUM_DOUBLE);
+	obs_data_item_release(&item);
+
+	/* truncated input must be rejected, not read past the end */
+	for (size_t i = 0; i < size; i++)
+		assert_null(obs_data_create_from_binary(buf, i));
+
+	obs_data_release(copy);
+	obs_data_release(data);
+	bfree(buf);
+}
+
+static void binary_snapshot_test(void **state)
+{
+	UNUSED_PARAMETER(state);
+
+	obs_data_t *data = obs_data_create_from_json(sample_json);
+	assert_true(obs_data_save_binary_safe(data, BINARY_FILE, "tmp", NULL));
+	obs_data_release(data);
+
+	obs_data_snapshot_t *snapshot = obs_data_snapshot_open(BINARY_FILE);
+	assert_non_null(snapshot);
+
+	assert_int_equal(obs_data_snapshot_array_count(snapshot, "sources"), 3);
+	assert_int_equal(obs_data_snapshot_array_count(snapshot, "missing"), 0);
+	assert_int_equal(obs_data_snapshot_array_count(snapshot, "obj"), 0);
+
+	obs_data_t *item = obs_data_snapshot_array_item(snapshot, "sources", 1);
+	assert_non_null(item);
+	assert_string_equal(obs_data_get_json(item), "{\"name\":\"b\",\"v\":2}");
+	obs_data_release(item);
+
+	assert_null(obs_data_snapshot_array_item(snapshot, "sources", 3));
+
+	item = obs_data_snapshot_array_find(snapshot, "sources", "name", "a");
+	assert_non_null(item);
+	assert_int_equal(obs_data_get_int(item, "v"), 1);
+	obs_data_release(item);
+
+	assert_null(obs_data_snapshot_array_find(snapshot, "sources", "name", "c"));
+
+	obs_data_t *obj = obs_data_snapshot_get_obj(snapshot, "obj");
+	assert_non_null(obj);
+	assert_string_equal(obs_data_get_json(obj), "{\"nested\":{\"x\":1.5}}");
+	obs_data_release(obj);
+
+	assert_null(obs_data_snapshot_get_obj(snapshot, "sources"));
+
+	obs_data_snapshot_close(snapshot);
+	os_unlink(BINARY_FILE);
+}
+
+/* the key table ends the file, so a file that exactly fills its last page
+ * faults on any read past the end of it */
+static void binary_page_aligned_test(void **state)
+{
+	UNUSED_PARAMETER(state);
+
+	const size_t target = 65536;
+	obs_data_t *data = obs_data_create();
+	size_t size;
+	void *buf;
+
+	obs_data_set_string(data, "pad", "");
+	obs_data_set_int(data, "last_key", 1);
+	buf = obs_data_get_binary(data, &size);
+	bfree(buf);
+	assert_true(size < target);
+
+	char *pad = bzalloc(target - size + 1);
+	memset(pad, 'x', target - size);
+	obs_data_set_string(data, "pad", pad);
+	bfree(pad);
+
+	buf = obs_data_get_binary(data, &size);
+	assert_int_equal(size, target);
+
+	/* exactly sized heap copy, so sanitizers catch an overread too */
+	obs_data_t *copy = obs_data_create_from_binary(buf, size);
+	assert_non_null(copy);
+	assert_int_equal(obs_data_get_int(copy, "last_key"), 1);
+	obs_data_release(copy);
+	bfree(buf);
+
+	assert_true(obs_data_save_binary_safe(data, BINARY_FILE, "tmp", NULL));
+	assert_int_equal(os_get_file_size(BINARY_FILE), (int64_t)target);
+
+	copy = obs_data_create_from_binary_file(BINARY_FILE);
+	assert_non_null(copy);
+	assert_int_equal(obs_data_get_int(copy, "last_key"), 1);
+	obs_data_release(copy);
+
+	obs_data_snapshot_t *snapshot = obs_data_snapshot_open(BINARY_FILE);
+	assert_non_null(snapshot);
+
+	/* the snapshot stays mapped while the file is saved over */
+	assert_true(obs_data_save_binary_safe(data, BINARY_FILE, "tmp", NULL));
+	obs_data_snapshot_close(snapshot);
+
+	obs_data_release(data);
+	os_unlink(BINARY_FILE);
+}
+
+static obs_data_t *generate_collection(size_t num_sources)
+{
+	obs_data_t *collection = obs_data_create();
+	obs_data_array_t *sources = obs_data_array_create();
+
+	for (size_t i = 0; i < num_sources; i++) {
+		obs_data_t *source = obs_data_create();
+		obs_data_t *settings = obs_data_create();
+		char name[64];
+
+		snprintf(name, sizeof(name), "Source %zu", i);
+		obs_data_set_string(source, "id", "image_source");
+		obs_data_set_string(source, "name", name);
+		obs_data_set_double(source, "volume", 1.0 / (double)(i + 1));
+		obs_data_set_int(source, "mixers", 255);
+		obs_data_set_bool(source, "enabled", (i & 1) != 0);
+		obs_data_set_string(settings, "file", "/home/user/images/background.png");
+		obs_data_set_obj(source, "settings", settings);
+		obs_data_array_push_back(sources, source);
+
+		obs_data_release(settings);
+		obs_data_release(source);
+	}
+
+	obs_data_set_string(collection, "name", "generated");
+	obs_data_set_array(collection, "sources", sources);
+	obs_data_array_release(sources);
+	return collection;
+}
+
+static void binary_benchmark_test(void **state)
+{
+	UNUSED_PARAMETER(state);
+
+	obs_data_t *collection = generate_collection(20000);
+	uint64_t start;
+
+	start = os_gettime_ns();
+	assert_true(obs_data_save_json_safe(collection, JSON_FILE, "tmp", NULL));
+	uint64_t json_save_ns = os_gettime_ns() - start;
+
+	start = os_gettime_ns();
+	assert_true(obs_data_save_binary_safe(collection, BINARY_FILE, "tmp", NULL));
+	uint64_t binary_save_ns = os_gettime_ns() - start;
+
+	start = os_gettime_ns();
+	obs_data_t *json_data = obs_data_create_from_json_file(JSON_FILE);
+	uint64_t json_load_ns = os_gettime_ns() - start;
+
+	start = os_gettime_ns();
+	obs_data_t *binary_data = obs_data_create_from_binary_file(BINARY_FILE);
+	uint64_t binary_load_ns = os_gettime_ns() - start;
+
+	start = os_gettime_ns();
+	obs_data_snapshot_t *snapshot = obs_data_snapshot_open(BINARY_FILE);
+	obs_data_t *source = obs_data_snapshot_array_find(snapshot, "sources", "name", "Source 19999");
+	uint64_t snapshot_ns = os_gettime_ns() - start;
+
+	assert_non_null(json_data);
+	assert_non_null(binary_data);
+	assert_non_null(source);
+	assert_string_equal(obs_data_get_json(binary_data), obs_data_get_json(json_data));
+
+	print_message("json: save %.2f ms, load %.2f ms (%lld bytes); "
+		      "binary: save %.2f ms, load %.2f ms (%lld bytes); "
+		      "snapshot open + find last source %.2f ms\n",
+		      (double)json_save_ns / 1e6, (double)json_load_ns / 1e6, (long long)os_get_file_size(JSON_FILE),
+		      (double)binary_save_ns / 1e6, (double)binary_load_ns / 1e6,
+		      (long long)os_get_file_size(BINARY_FILE), (double)snapshot_ns / 1e6);
+
+	obs_data_release(source);
+	obs_data_snapshot_close(snapshot);
+	obs_data_release(binary_data);
+	obs_data_release(json_data);
+	obs_data_release(collection);
+
+	os_unlink(BINARY_FILE);
+	os_unlink(JSON_FILE);
+}
+
+int main()
+{
+	const struct CMUnitTest tests[] = {
+		cmocka_unit_test(binary_round_trip_test),
+		cmocka_unit_test(binary_snapshot_test),
+		cmocka_unit_test(binary_page_aligned_test),
+		cmocka_unit_test(binary_benchmark_test),
+	};
+
+	return cmocka_run_group_tests(tests, NULL, NULL);
+}
@@ -0,0 +1,253 @@
+/******************************************************************************
+    Copyright (C) 2026 by OBS Project contributors
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+******************************************************************************/
+
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <cmocka.h>
+
+#include <obs-data.h>
+#include <util/bmem.h>
+#include <util/platform.h>
+
+struct json_case {
+	const char *input;
+	const char *compact;
+};
+
+/* inputs paired with the output jansson produced for them, so reading and
+ * writing stays compatible with scene collections saved by older versions */
+static const struct json_case representable[] = {
+	{"{}", "{}"},
+	{"{\"a\":1,\"b\":-2,\"c\":9007199254740993}", "{\"a\":1,\"b\":-2,\"c\":9007199254740993}"},
+	{"{\"d\":0.5,\"e\":-2.25,\"f\":1e20,\"h\":3.0,\"i\":0.1}",
+	 "{\"d\":0.5,\"e\":-2.25,\"f\":1e20,\"h\":3.0,\"i\":0.10000000000000001}"},
+	{"{\"t\":true,\"f\":false}", "{\"t\":true,\"f\":false}"},
+	{"{\"s\":\"quote \\\" backslash \\\\ slash \\/ tab \\t nl \\n ctl \\u0001\"}",
+	 "{\"s\":\"quote \\\" backslash \\\\ slash / tab \\t nl \\n ctl \\u0001\"}"},
+	{"{\"u\":\"\\u00e9 \\ud83d\\ude00 \xc3\xa9\",\"\xc3\xa9\":\"key\"}",
+	 "{\"u\":\"\xc3\xa9 \xf0\x9f\x98\x80 \xc3\xa9\",\"\xc3\xa9\":\"key\"}"},
+	{"{\"o\":{\"p\":{\"q\":{}}},\"arr\":[],\"arr2\":[{},{\"x\":1},{\"y\":[{\"z\":\"w\"}]}]}",
+	 "{\"o\":{\"p\":{\"q\":{}}},\"arr\":[],\"arr2\":[{},{\"x\":1},{\"y\":[{\"z\":\"w\"}]}]}"},
+	{"{ \"z\" : 1 ,\n\t\"y\":2,\r\n\"x\":3,\"w\":{\"b\":1,\"a\":2}}",
+	 "{\"z\":1,\"y\":2,\"x\":3,\"w\":{\"b\":1,\"a\":2}}"},
+	/* same key names in different objects are not duplicates */
+	{"{\"a\":{\"a\":1},\"b\":[{\"a\":2},{\"a\":3}]}", "{\"a\":{\"a\":1},\"b\":[{\"a\":2},{\"a\":3}]}"},
+};
+
+static void json_compat_test(void **state)
+{
+	UNUSED_PARAMETER(state);
+
+	for (size_t i = 0; i < sizeof(representable) / sizeof(representable[0]); i++) {
+		obs_data_t *data = obs_data_create_from_json(representable[i].input);
+
+		assert_non_null(data);
+		assert_string_equal(obs_data_get_json(data), representable[i].compact);
+		obs_data_release(data);
+	}
+}
+
+static void json_pretty_test(void **state)
+{
+	UNUSED_PARAMETER(state);
+
+	obs_data_t *data = obs_data_create_from_json("{\"a\":1,\"o\":{},\"arr\":[{\"b\":\"c\"},{}],\"e\":[]}");
+	assert_non_null(data);
+	assert_string_equal(obs_data_get_json_pretty(data), "{\n"
+							    "    \"a\": 1,\n"
+							    "    \"o\": {},\n"
+							    "    \"arr\": [\n"
+							    "        {\n"
+							    "            \"b\": \"c\"\n"
+							    "        },\n"
+							    "        {}\n"
+							    "    ],\n"
+							    "    \"e\": []\n"
+							    "}");
+	obs_data_release(data);
+}
+
+static void json_long_number_test(void **state)
+{
+	UNUSED_PARAMETER(state);
+
+	/* JSON puts no limit on the number of digits */
+	obs_data_t *data = obs_data_create_from_json(
+		"{\"a\":0.500000000000000000000000000000000000000000000000000000000000000000000000000000,"
+		"\"b\":-2.25000000000000000000000000000000000000000000000000000000000000000000000000001,"
+		"\"c\":1000000000000000000000000000000000000000000000000000000000000000000000.0,"
+		"\"d\":0.0000000000000000000000000000000000000000000000000000000000000000000001e70}");
+	assert_non_null(data);
+	assert_true(obs_data_get_double(data, "a") == 0.5);
+	assert_true(obs_data_get_double(data, "b") == -2.25);
+	assert_true(obs_data_get_double(data, "c") == 1e69);
+	assert_true(obs_data_get_double(data, "d") == 1.0);
+	obs_data_release(data);
+}
+
+static void json_dropped_values_test(void **state)
+{
+	UNUSED_PARAMETER(state);
+
+	/* nulls and non-object array members have no obs_data equivalent */
+	obs_data_t *data = obs_data_create_from_json("{\"a\":null,\"b\":[1,\"s\",{\"c\":1},[{\"d\":2}],null],\"e\":1}");
+	assert_non_null(data);
+	assert_string_equal(obs_data_get_json(data), "{\"b\":[{\"c\":1}],\"e\":1}");
+	obs_data_release(data);
+
+	/* root arrays are valid json but there is nothing to map them to */
+	data = obs_data_create_from_json("[{\"a\":1}]");
+	assert_non_null(data);
+	assert_string_equal(obs_data_get_json(data), "{}");
+	obs_data_release(data);
+}
+
+static void json_defaults_test(void **state)
+{
+	UNUSED_PARAMETER(state);
+
+	obs_data_t *data = obs_data_create();
+	obs_data_set_default_int(data, "def", 5);
+	obs_data_set_string(data, "user", "x");
+
+	assert_string_equal(obs_data_get_json(data), "{\"user\":\"x\"}");
+	assert_string_equal(obs_data_get_json_with_defaults(data), "{\"def\":5,\"user\":\"x\"}");
+
+	obs_data_release(data);
+}
+
+static void json_invalid_test(void **state)
+{
+	UNUSED_PARAMETER(state);
+
+	static const char *invalid[] = {
+		"",
+		"1",
+		"{\"a\":1,\"a\":2}",
+		"{\"k\":null,\"k\":1}",
+		"{\"k\":1,\"k\":null}",
+		"{\"a\":{\"b\":1},\"a\":2}",
+		"{\"a\":[{\"b\":1,\"b\":1}]}",
+		"[{\"b\":null,\"b\":null}]",
+		"{\"a\":1} x",
+		"{\"a\":01}",
+		"{\"a\":1,}",
+		"{\"a\":\"\\ud800\"}",
+		"{\"a\":\"\\u0000\"}",
+		"{\"a\":\"\xc3\"}",
+		"{\"a\":\"\t\"}",
+		"{\"a\":99999999999999999999}",
+		"{\"a\":1e999}",
+		"{\"a\":1.}",
+		"{\"a\":.5}",
+		"{\"a\":-}",
+		"{\"a\":tru}",
+		"{\"a\":\"unterminated",
+	};
+
+	for (size_t i = 0; i < sizeof(invalid) / sizeof(invalid[0]); i++)
+		assert_null(obs_data_create_from_json(invalid[i]));
+}
+
+static obs_data_t *generate_collection(size_t num_sources)
+{
+	obs_data_t *collection = obs_data_create();
+	obs_data_array_t *sources = obs_data_array_create();
+
+	for (size_t i = 0; i < num_sources; i++) {
+		obs_data_t *source = obs_data_create();
+		obs_data_t *settings = obs_data_create();
+		obs_data_array_t *items = obs_data_array_create();
+		char name[64];
+
+		snprintf(name, sizeof(name), "Source \"%zu\"", i);
+		obs_data_set_string(source, "id", "image_source");
+		obs_data_set_string(source, "name", name);
+		obs_data_set_double(source, "volume", 1.0 / (double)(i + 1));
+		obs_data_set_int(source, "mixers", 255);
+		obs_data_set_bool(source, "enabled", (i & 1) != 0);
+
+		for (size_t j = 0; j < 8; j++) {
+			obs_data_t *item = obs_data_create();
+			obs_data_set_int(item, "id", (long long)j);
+			obs_data_set_double(item, "x", (double)i * 0.25);
+			obs_data_set_double(item, "y", (double)j * 1e-3);
+			obs_data_set_string(item, "path", "C:\\scenes\\file.png");
+			obs_data_array_push_back(items, item);
+			obs_data_release(item);
+		}
+
+		obs_data_set_array(settings, "items", items);
+		obs_data_set_obj(source, "settings", settings);
+		obs_data_array_push_back(sources, source);
+
+		obs_data_array_release(items);
+		obs_data_release(settings);
+		obs_data_release(source);
+	}
+
+	obs_data_set_string(collection, "name", "generated");
+	obs_data_set_array(collection, "sources", sources);
+	obs_data_array_release(sources);
+	return collection;
+}
+
+static void json_large_collection_test(void **state)
+{
+	UNUSED_PARAMETER(state);
+
+	obs_data_t *collection = generate_collection(5000);
+	char *text = bstrdup(obs_data_get_json_pretty(collection));
+	size_t size = strlen(text);
+	uint64_t start;
+
+	start = os_gettime_ns();
+	obs_data_t *data = obs_data_create_from_json(text);
+	uint64_t read_ns = os_gettime_ns() - start;
+
+	start = os_gettime_ns();
+	const char *written = obs_data_get_json_pretty(data);
+	uint64_t write_ns = os_gettime_ns() - start;
+
+	assert_string_equal(written, text);
+
+	print_message("%zu bytes: read %.2f ms, write %.2f ms\n", size, (double)read_ns / 1e6,
+		      (double)write_ns / 1e6);
+
+	obs_data_release(data);
+	obs_data_release(collection);
+	bfree(text);
+}
+
+int main()
+{
+	const struct CMUnitTest tests[] = {
+		cmocka_unit_test(json_compat_test),
+		cmocka_unit_test(json_pretty_test),
+		cmocka_unit_test(json_long_number_test),
+		cmocka_unit_test(json_dropped_values_test),
+		cmocka_unit_test(json_defaults_test),
+		cmocka_unit_test(json_invalid_test),
+		cmocka_unit_test(json_large_collection_test),
+	};
+
+	return cmocka_run_group_tests(tests, NULL, NULL);
+}
@@ -0,0 +1,216 @@
+/******************************************************************************
+    Copyright (C) 2026 by OBS Project contributors
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+******************************************************************************/
+
+/* Compares the obs_data JSON reader and writer with jansson, which libobs
+ * used before, and benchmarks both on a large scene collection. */
+
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <cmocka.h>
+#include <jansson.h>
+
+#include <obs-data.h>
+#include <util/bmem.h>
+#include <util/platform.h>
+
+#define JANSSON_COMPACT (JSON_PRESERVE_ORDER | JSON_COMPACT)
+#define JANSSON_PRETTY (JSON_PRESERVE_ORDER | JSON_INDENT(4))
+
+/* documents whose values obs_data can all represent */
+static const char *corpus[] = {
+	"{}",
+	"{\"a\":1,\"b\":-2,\"c\":9007199254740993,\"d\":-9223372036854775808}",
+	"{\"d\":0.5,\"e\":-2.25,\"f\":1e20,\"g\":1e-7,\"h\":3.0,\"i\":0.1,\"j\":-0.0}",
+	"{\"t\":true,\"f\":false}",
+	"{\"s\":\"quote \\\" backslash \\\\ slash \\/ tab \\t nl \\n ctl \\u0001 del \\u007f\"}",
+	"{\"u\":\"\\u00e9 \\ud83d\\ude00 \xc3\xa9 \xe2\x82\xac\",\"\xc3\xa9\":\"key\"}",
+	"{\"o\":{\"p\":{\"q\":{}}},\"arr\":[],\"arr2\":[{},{\"x\":1},{\"y\":[{\"z\":\"w\"}]}]}",
+	"{ \"z\" : 1 ,\n\t\"y\":2,\r\n\"x\":3,\"w\":{\"b\":1,\"a\":2}}",
+	"{\"a\":{\"a\":1},\"b\":[{\"a\":2},{\"a\":3}]}",
+	"{\"long\":0.500000000000000000000000000000000000000000000000000000000000000000000001}",
+};
+
+/* documents both have to reject */
+static const char *invalid[] = {
+	"",
+	"1",
+	"{\"a\":1,\"a\":2}",
+	"{\"k\":null,\"k\":1}",
+	"{\"a\":{\"b\":1},\"a\":2}",
+	"{\"a\":[{\"b\":1,\"b\":1}]}",
+	"{\"a\":1} x",
+	"{\"a\":01}",
+	"{\"a\":1,}",
+	"{\"a\":\"\\ud800\"}",
+	"{\"a\":\"\\u0000\"}",
+	"{\"a\":\"\xc3\"}",
+	"{\"a\":\"\t\"}",
+	"{\"a\":99999999999999999999}",
+	"{\"a\":1e999}",
+	"{\"a\":1.}",
+	"{\"a\":.5}",
+	"{\"a\":tru}",
+	"{\"a\":\"unterminated",
+};
+
+static void check_against_jansson(const char *text)
+{
+	json_error_t error;
+	json_t *root = json_loads(text, JSON_REJECT_DUPLICATES, &error);
+	obs_data_t *data = obs_data_create_from_json(text);
+
+	assert_non_null(root);
+	assert_non_null(data);
+
+	char *compact = json_dumps(root, JANSSON_COMPACT);
+	char *pretty = json_dumps(root, JANSSON_PRETTY);
+
+	assert_string_equal(obs_data_get_json(data), compact);
+	assert_string_equal(obs_data_get_json_pretty(data), pretty);
+
+	/* and back: jansson has to read what obs_data wrote */
+	json_t *reread = json_loads(obs_data_get_json(data), JSON_REJECT_DUPLICATES, &error);
+	assert_non_null(reread);
+	assert_true(json_equal(root, reread));
+
+	json_decref(reread);
+	free(compact);
+	free(pretty);
+	json_decref(root);
+	obs_data_release(data);
+}
+
+static void jansson_corpus_test(void **state)
+{
+	UNUSED_PARAMETER(state);
+
+	for (size_t i = 0; i < sizeof(corpus) / sizeof(corpus[0]); i++)
+		check_against_jansson(corpus[i]);
+}
+
+static void jansson_invalid_test(void **state)
+{
+	UNUSED_PARAMETER(state);
+
+	for (size_t i = 0; i < sizeof(invalid) / sizeof(invalid[0]); i++) {
+		json_error_t error;
+		json_t *root = json_loads(invalid[i], JSON_REJECT_DUPLICATES, &error);
+
+		assert_null(root);
+		assert_null(obs_data_create_from_json(invalid[i]));
+	}
+}
+
+static obs_data_t *generate_collection(size_t num_sources)
+{
+	obs_data_t *collection = obs_data_create();
+	obs_data_array_t *sources = obs_data_array_create();
+
+	for (size_t i = 0; i < num_sources; i++) {
+		obs_data_t *source = obs_data_create();
+		obs_data_t *settings = obs_data_create();
+		obs_data_array_t *items = obs_data_array_create();
+		char name[64];
+
+		snprintf(name, sizeof(name), "Source \"%zu\" \xc3\xa9", i);
+		obs_data_set_string(source, "id", "image_source");
+		obs_data_set_string(source, "name", name);
+		obs_data_set_double(source, "volume", 1.0 / (double)(i + 1));
+		obs_data_set_int(source, "mixers", 255);
+		obs_data_set_bool(source, "enabled", (i & 1) != 0);
+
+		for (size_t j = 0; j < 8; j++) {
+			obs_data_t *item = obs_data_create();
+			obs_data_set_int(item, "id", (long long)j);
+			obs_data_set_double(item, "x", (double)i * 0.25);
+			obs_data_set_double(item, "y", (double)j * 1e-3);
+			obs_data_set_string(item, "path", "C:\\scenes\\file.png");
+			obs_data_array_push_back(items, item);
+			obs_data_release(item);
+		}
+
+		obs_data_set_array(settings, "items", items);
+		obs_data_set_obj(source, "settings", settings);
+		obs_data_array_push_back(sources, source);
+
+		obs_data_array_release(items);
+		obs_data_release(settings);
+		obs_data_release(source);
+	}
+
+	obs_data_set_string(collection, "name", "generated");
+	obs_data_set_array(collection, "sources", sources);
+	obs_data_array_release(sources);
+	return collection;
+}
+
+static void jansson_benchmark_test(void **state)
+{
+	UNUSED_PARAMETER(state);
+
+	obs_data_t *collection = generate_collection(5000);
+	char *text = bstrdup(obs_data_get_json_pretty(collection));
+	size_t size = strlen(text);
+	uint64_t start;
+
+	start = os_gettime_ns();
+	obs_data_t *data = obs_data_create_from_json(text);
+	uint64_t read_ns = os_gettime_ns() - start;
+
+	start = os_gettime_ns();
+	const char *written = obs_data_get_json_pretty(data);
+	uint64_t write_ns = os_gettime_ns() - start;
+
+	/* only the DOM is timed, the old path also copied it into obs_data */
+	json_error_t error;
+	start = os_gettime_ns();
+	json_t *root = json_loads(text, JSON_REJECT_DUPLICATES, &error);
+	uint64_t jansson_read_ns = os_gettime_ns() - start;
+
+	start = os_gettime_ns();
+	char *jansson_written = json_dumps(root, JANSSON_PRETTY);
+	uint64_t jansson_write_ns = os_gettime_ns() - start;
+
+	assert_string_equal(written, jansson_written);
+	assert_string_equal(written, text);
+
+	print_message("%zu bytes: obs_data read %.2f ms, write %.2f ms; "
+		      "jansson DOM only read %.2f ms, write %.2f ms\n",
+		      size, (double)read_ns / 1e6, (double)write_ns / 1e6, (double)jansson_read_ns / 1e6,
+		      (double)jansson_write_ns / 1e6);
+
+	free(jansson_written);
+	json_decref(root);
+	obs_data_release(data);
+	obs_data_release(collection);
+	bfree(text);
+}
+
+int main()
+{
+	const struct CMUnitTest tests[] = {
+		cmocka_unit_test(jansson_corpus_test),
+		cmocka_unit_test(jansson_invalid_test),
+		cmocka_unit_test(jansson_benchmark_test),
+	};
+
+	return cmocka_run_group_tests(tests, NULL, NULL);
+}
@@ -0,0 +1,184 @@
+/******************************************************************************
+    Copyright (C) 2026 by OBS Project contributors
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+******************************************************************************/
+
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <stdio.h>
+#include <cmocka.h>
+
+#include <util/c99defs.h>
+
+#include "rtmp-congestion.h"
+
+#define TICK_NS 10000000ULL
+#define SAMPLE_TICKS 10
+
+#define MAX_BITRATE 6000
+#define MIN_BITRATE 600
+#define AUDIO_BITRATE 160
+
+/* A bottleneck link with a fixed base round trip time and an unbounded queue
+ * in front of it, fed by an encoder producing whatever the controller asks
+ * for and paced by the controller. */
+struct shaped_link {
+	double capacity_kbps;
+	double base_rtt_usec;
+
+	uint64_t ts;
+	double app_queue;
+	double net_queue;
+	double pacing_credit;
+	uint64_t bytes_sent;
+	uint64_t bytes_acked;
+};
+
+static void link_tick(struct shaped_link *link, struct rtmp_cc *cc)
+{
+	double seconds = (double)TICK_NS / 1000000000.0;
+	long bitrate = rtmp_cc_get_bitrate(cc);
+	uint64_t pacing_rate = rtmp_cc_get_pacing_rate(cc);
+
+	link->ts += TICK_NS;
+	link->app_queue += (double)(bitrate + AUDIO_BITRATE) * 1000.0 / 8.0 * seconds;
+
+	/* output to socket, limited by pacing */
+	double send = link->app_queue;
+	if (pacing_rate) {
+		link->pacing_credit += (double)pacing_rate * seconds;
+		if (send > link->pacing_credit)
+			send = link->pacing_credit;
+		link->pacing_credit -= send;
+	}
+	link->app_queue -= send;
+	link->net_queue += send;
+	link->bytes_sent += (uint64_t)send;
+
+	/* socket to peer, limited by the link */
+	double delivered = link->capacity_kbps * 1000.0 / 8.0 * seconds;
+	if (delivered > link->net_queue)
+		delivered = link->net_queue;
+	link->net_queue -= delivered;
+	link->bytes_acked += (uint64_t)delivered;
+}
+
+static double link_queue_delay_usec(const struct shaped_link *link)
+{
+	return link->net_queue * 8.0 / (link->capacity_kbps * 1000.0) * 1000000.0;
+}
+
+static void link_sample(struct shaped_link *link, struct rtmp_cc *cc)
+{
+	struct rtmp_cc_sample sample = {0};
+	double bitrate_bytes = (double)(rtmp_cc_get_bitrate(cc) + AUDIO_BITRATE) * 1000.0 / 8.0;
+
+	sample.ts = link->ts;
+	sample.bytes_sent = link->bytes_sent;
+	sample.bytes_acked = link->bytes_acked;
+	sample.rtt_usec = (uint32_t)(link->base_rtt_usec + link_queue_delay_usec(link));
+	sample.queued_usec = (int64_t)(link->app_queue / bitrate_bytes * 1000000.0);
+
+	rtmp_cc_update(cc, &sample);
+}
+
+/* runs the link for the given number of seconds and returns the lowest and
+ * highest bitrate seen during the last half of it */
+static void link_run(struct shaped_link *link, struct rtmp_cc *cc, int seconds, long *low, long *high)
+{
+	size_t ticks = (size_t)seconds * 1000000000ULL / TICK_NS;
+
+	*low = MAX_BITRATE;
+	*high = 0;
+
+	for (size_t i = 0; i < ticks; i++) {
+		link_tick(link, cc);
+		if (i % SAMPLE_TICKS == 0)
+			link_sample(link, cc);
+
+		if (i >= ticks / 2) {
+			long bitrate = rtmp_cc_get_bitrate(cc);
+			if (bitrate < *low)
+				*low = bitrate;
+			if (bitrate > *high)
+				*high = bitrate;
+		}
+	}
+}
+
+static void congestion_unknown_test(void **state)
+{
+	UNUSED_PARAMETER(state);
+
+	struct rtmp_cc cc = {0};
+
+	assert_null(rtmp_cc_find("does_not_exist"));
+	assert_null(rtmp_cc_find(""));
+	assert_false(rtmp_cc_create(&cc, "does_not_exist", MAX_BITRATE, MIN_BITRATE, AUDIO_BITRATE));
+	assert_false(rtmp_cc_active(&cc));
+
+	assert_true(rtmp_cc_create(&cc, "delivery_rate", MAX_BITRATE, MIN_BITRATE, AUDIO_BITRATE));
+	assert_true(rtmp_cc_active(&cc));
+	assert_int_equal(rtmp_cc_get_bitrate(&cc), MAX_BITRATE);
+	rtmp_cc_destroy(&cc);
+	assert_false(rtmp_cc_active(&cc));
+}
+
+static void congestion_shaped_link_test(void **state)
+{
+	UNUSED_PARAMETER(state);
+
+	struct shaped_link link = {.capacity_kbps = 3500.0, .base_rtt_usec = 40000.0, .ts = 1000000000ULL};
+	struct rtmp_cc cc = {0};
+	long low, high;
+
+	assert_true(rtmp_cc_create(&cc, "delivery_rate", MAX_BITRATE, MIN_BITRATE, AUDIO_BITRATE));
+
+	/* a link slower than the configured bitrate, the bitrate has to come
+	 * down to what fits and then stay there instead of oscillating, only
+	 * briefly probing slightly above the capacity */
+	link_run(&link, &cc, 60, &low, &high);
+	print_message("3500 kbps link: bitrate %ld-%ld kbps, queue delay %.0f ms\n", low, high,
+		      link_queue_delay_usec(&link) / 1000.0);
+
+	assert_true(high + AUDIO_BITRATE <= 3500 * 21 / 20);
+	assert_true(low + AUDIO_BITRATE >= 3500 * 6 / 10);
+	assert_true(high - low <= 3500 / 4);
+	assert_true(link_queue_delay_usec(&link) < 500000.0);
+
+	/* capacity recovers, bitrate goes back up to the configured one */
+	link.capacity_kbps = 10000.0;
+	link_run(&link, &cc, 120, &low, &high);
+	print_message("10000 kbps link: bitrate %ld-%ld kbps\n", low, high);
+
+	assert_int_equal(high, MAX_BITRATE);
+	assert_int_equal(rtmp_cc_get_bitrate(&cc), MAX_BITRATE);
+
+	/* pacing never holds back the configured bitrate */
+	assert_true(rtmp_cc_get_pacing_rate(&cc) >= (MAX_BITRATE + AUDIO_BITRATE) * 1000 / 8);
+
+	rtmp_cc_destroy(&cc);
+}
+
+int main()
+{
+	const struct CMUnitTest tests[] = {
+		cmocka_unit_test(congestion_unknown_test),
+		cmocka_unit_test(congestion_shaped_link_test),
+	};
+
+	return cmocka_run_group_tests(tests, NULL, NULL);
+}
@@ -0,0 +1,227 @@
+/******************************************************************************
+    Copyright (C) 2026 by OBS Project contributors
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+******************************************************************************/
+
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <stdlib.h>
+#include <string.h>
+#include <cmocka.h>
+
+#include <media-io/video-frame.h>
+#include <media-io/video-scaler.h>
+
+/* large enough for the scaler to split frames into bands on multi-core
+ * machines, with a height that doesn't divide evenly into them */
+#define WIDTH 1920
+#define HEIGHT 1084
+
+static void fill_frame(struct video_frame *frame, enum video_format format, uint32_t height)
+{
+	uint32_t heights[MAX_AV_PLANES] = {height, height, height, height};
+
+	if (format == VIDEO_FORMAT_NV12 || format == VIDEO_FORMAT_I420)
+		heights[1] = heights[2] = height / 2;
+
+	srand(1);
+	for (size_t i = 0; i < MAX_AV_PLANES && frame->data[i]; i++) {
+		for (size_t j = 0; j < (size_t)frame->linesize[i] * heights[i]; j++)
+			frame->data[i][j] = (uint8_t)rand();
+	}
+}
+
+static video_scaler_t *create_scaler(enum video_format src_format, uint32_t src_width, uint32_t src_height,
+				     enum video_format dst_format, uint32_t dst_width, uint32_t dst_height)
+{
+	struct video_scale_info src = {src_format, src_width, src_height, VIDEO_RANGE_PARTIAL, VIDEO_CS_709};
+	struct video_scale_info dst = {dst_format, dst_width, dst_height, VIDEO_RANGE_PARTIAL, VIDEO_CS_709};
+	video_scaler_t *scaler = NULL;
+
+	assert_int_equal(video_scaler_create(&scaler, &dst, &src, VIDEO_SCALE_FAST_BILINEAR), VIDEO_SCALER_SUCCESS);
+	return scaler;
+}
+
+static void scale(video_scaler_t *scaler, struct video_frame *dst, const struct video_frame *src)
+{
+	assert_true(video_scaler_scale(scaler, dst->data, dst->linesize, (const uint8_t *const *)src->data,
+				       src->linesize));
+}
+
+static void nv12_i420_test(void **state)
+{
+	struct video_frame *nv12 = video_frame_create(VIDEO_FORMAT_NV12, WIDTH, HEIGHT);
+	struct video_frame *i420 = video_frame_create(VIDEO_FORMAT_I420, WIDTH, HEIGHT);
+	struct video_frame *result = video_frame_create(VIDEO_FORMAT_NV12, WIDTH, HEIGHT);
+	video_scaler_t *to_i420 = create_scaler(VIDEO_FORMAT_NV12, WIDTH, HEIGHT, VIDEO_FORMAT_I420, WIDTH, HEIGHT);
+	video_scaler_t *to_nv12 = create_scaler(VIDEO_FORMAT_I420, WIDTH, HEIGHT, VIDEO_FORMAT_NV12, WIDTH, HEIGHT);
+
+	fill_frame(nv12, VIDEO_FORMAT_NV12, HEIGHT);
+	scale(to_i420, i420, nv12);
+
+	for (uint32_t y = 0; y < HEIGHT / 2; y++) {
+		const uint8_t *uv = nv12->data[1] + y * nv12->linesize[1];
+		const uint8_t *u = i420->data[1] + y * i420->linesize[1];
+		const uint8_t *v = i420->data[2] + y * i420->linesize[2];
+
+		for (uint32_t x = 0; x < WIDTH / 2; x++) {
+			assert_int_equal(u[x], uv[x * 2]);
+			assert_int_equal(v[x], uv[x * 2 + 1]);
+		}
+	}
+
+	scale(to_nv12, result, i420);
+
+	for (uint32_t y = 0; y < HEIGHT; y++)
+		assert_memory_equal(result->data[0] + y * result->linesize[0], nv12->data[0] + y * nv12->linesize[0],
+				    WIDTH);
+	for (uint32_t y = 0; y < HEIGHT / 2; y++)
+		assert_memory_equal(result->data[1] + y * result->linesize[1], nv12->data[1] + y * nv12->linesize[1],
+				    WIDTH);
+
+	video_scaler_destroy(to_i420);
+	video_scaler_destroy(to_nv12);
+	video_frame_destroy(nv12);
+	video_frame_destroy(i420);
+	video_frame_destroy(result);
+}
+
+static void packed_swap_test(void **state)
+{
+	struct video_frame *rgba = video_frame_create(VIDEO_FORMAT_RGBA, WIDTH, HEIGHT);
+	struct video_frame *bgra = video_frame_create(VIDEO_FORMAT_BGRA, WIDTH, HEIGHT);
+	struct video_frame *yuy2 = video_frame_create(VIDEO_FORMAT_YUY2, WIDTH, HEIGHT);
+	struct video_frame *uyvy = video_frame_create(VIDEO_FORMAT_UYVY, WIDTH, HEIGHT);
+	video_scaler_t *to_bgra = create_scaler(VIDEO_FORMAT_RGBA, WIDTH, HEIGHT, VIDEO_FORMAT_BGRA, WIDTH, HEIGHT);
+	video_scaler_t *to_uyvy = create_scaler(VIDEO_FORMAT_YUY2, WIDTH, HEIGHT, VIDEO_FORMAT_UYVY, WIDTH, HEIGHT);
+
+	fill_frame(rgba, VIDEO_FORMAT_RGBA, HEIGHT);
+	fill_frame(yuy2, VIDEO_FORMAT_YUY2, HEIGHT);
+	scale(to_bgra, bgra, rgba);
+	scale(to_uyvy, uyvy, yuy2);
+
+	for (uint32_t y = 0; y < HEIGHT; y++) {
+		const uint8_t *in = rgba->data[0] + y * rgba->linesize[0];
+		const uint8_t *out = bgra->data[0] + y * bgra->linesize[0];
+
+		for (uint32_t x = 0; x < WIDTH * 4; x += 4) {
+			assert_int_equal(out[x], in[x + 2]);
+			assert_int_equal(out[x + 1], in[x + 1]);
+			assert_int_equal(out[x + 2], in[x]);
+			assert_int_equal(out[x + 3], in[x + 3]);
+		}
+
+		in = yuy2->data[0] + y * yuy2->linesize[0];
+		out = uyvy->data[0] + y * uyvy->linesize[0];
+
+		for (uint32_t x = 0; x < WIDTH * 2; x += 2) {
+			assert_int_equal(out[x], in[x + 1]);
+			assert_int_equal(out[x + 1], in[x]);
+		}
+	}
+
+	video_scaler_destroy(to_bgra);
+	video_scaler_destroy(to_uyvy);
+	video_frame_destroy(rgba);
+	video_frame_destroy(bgra);
+	video_frame_destroy(yuy2);
+	video_frame_destroy(uyvy);
+}
+
+static inline uint8_t box_average(const uint8_t *row0, const uint8_t *row1, size_t pos, size_t step)
+{
+	return (uint8_t)((row0[pos] + row0[pos + step] + row1[pos] + row1[pos + step] + 2) / 4);
+}
+
+static void nv12_half_test(void **state)
+{
+	const uint32_t width = WIDTH * 2;
+	const uint32_t height = 2160;
+	struct video_frame *src = video_frame_create(VIDEO_FORMAT_NV12, width, height);
+	struct video_frame *dst = video_frame_create(VIDEO_FORMAT_NV12, width / 2, height / 2);
+	video_scaler_t *scaler = create_scaler(VIDEO_FORMAT_NV12, width, height, VIDEO_FORMAT_NV12, width / 2,
+					       height / 2);
+
+	fill_frame(src, VIDEO_FORMAT_NV12, height);
+	scale(scaler, dst, src);
+
+	for (uint32_t y = 0; y < height / 2; y++) {
+		const uint8_t *row0 = src->data[0] + y * 2 * src->linesize[0];
+		const uint8_t *row1 = row0 + src->linesize[0];
+		const uint8_t *out = dst->data[0] + y * dst->linesize[0];
+
+		for (uint32_t x = 0; x < width / 2; x++)
+			assert_int_equal(out[x], box_average(row0, row1, x * 2, 1));
+	}
+
+	for (uint32_t y = 0; y < height / 4; y++) {
+		const uint8_t *row0 = src->data[1] + y * 2 * src->linesize[1];
+		const uint8_t *row1 = row0 + src->linesize[1];
+		const uint8_t *out = dst->data[1] + y * dst->linesize[1];
+
+		for (uint32_t x = 0; x < width / 2; x++)
+			assert_int_equal(out[x], box_average(row0, row1, (x / 2) * 4 + x % 2, 2));
+	}
+
+	video_scaler_destroy(scaler);
+	video_frame_destroy(src);
+	video_frame_destroy(dst);
+}
+
+/* conversions without vertical resampling are split into bands, which must
+ * give the same result as converting the whole frame at once */
+static void swscale_bands_test(void **state)
+{
+	struct video_frame *src = video_frame_create(VIDEO_FORMAT_BGRA, WIDTH, HEIGHT);
+	struct video_frame *full = video_frame_create(VIDEO_FORMAT_I444, WIDTH, HEIGHT);
+	struct video_frame *small = video_frame_create(VIDEO_FORMAT_I444, WIDTH, 4);
+	video_scaler_t *scaler = create_scaler(VIDEO_FORMAT_BGRA, WIDTH, HEIGHT, VIDEO_FORMAT_I444, WIDTH, HEIGHT);
+	video_scaler_t *reference = create_scaler(VIDEO_FORMAT_BGRA, WIDTH, 4, VIDEO_FORMAT_I444, WIDTH, 4);
+
+	fill_frame(src, VIDEO_FORMAT_BGRA, HEIGHT);
+	scale(scaler, full, src);
+
+	/* every group of 4 rows is converted independently of the others */
+	for (uint32_t y = 0; y < HEIGHT; y += 4) {
+		struct video_frame band = *src;
+		band.data[0] += y * src->linesize[0];
+		scale(reference, small, &band);
+
+		for (size_t i = 0; i < 3; i++) {
+			for (uint32_t row = 0; row < 4; row++)
+				assert_memory_equal(full->data[i] + (y + row) * full->linesize[i],
+						    small->data[i] + row * small->linesize[i], WIDTH);
+		}
+	}
+
+	video_scaler_destroy(scaler);
+	video_scaler_destroy(reference);
+	video_frame_destroy(src);
+	video_frame_destroy(full);
+	video_frame_destroy(small);
+}
+
+int main()
+{
+	const struct CMUnitTest tests[] = {
+		cmocka_unit_test(nv12_i420_test),
+		cmocka_unit_test(packed_swap_test),
+		cmocka_unit_test(nv12_half_test),
+		cmocka_unit_test(swscale_bands_test),
+	};
+
+	return cmocka_run_group_tests(tests, NULL, NULL);
+}
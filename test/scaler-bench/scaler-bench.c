@@ -0,0 +1,270 @@
+/******************************************************************************
+    Copyright (C) 2026 by OBS Project contributors
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+******************************************************************************/
+
+/* CPU video scaler benchmark.  Runs video_scaler_scale over a grid of
+ * formats and resolutions the way raw video outputs use it and reports the
+ * time per frame.  With --ladder, it instead compares scaling an encoder
+ * rendition ladder directly from the canvas against cascading each rung
+ * from the previous one. */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <media-io/video-frame.h>
+#include <media-io/video-scaler.h>
+#include <util/base.h>
+#include <util/platform.h>
+
+struct bench_size {
+	uint32_t src_width;
+	uint32_t src_height;
+	uint32_t dst_width;
+	uint32_t dst_height;
+};
+
+static const struct bench_size sizes[] = {
+	{1920, 1080, 1920, 1080},
+	{1920, 1080, 1280, 720},
+	{1920, 1080, 960, 540},
+	{3840, 2160, 1920, 1080},
+};
+
+static const enum video_format src_formats[] = {
+	VIDEO_FORMAT_NV12,
+	VIDEO_FORMAT_I420,
+	VIDEO_FORMAT_I444,
+	VIDEO_FORMAT_BGRA,
+};
+
+static const enum video_format dst_formats[] = {
+	VIDEO_FORMAT_NV12, VIDEO_FORMAT_I420, VIDEO_FORMAT_YUY2,
+	VIDEO_FORMAT_UYVY, VIDEO_FORMAT_RGBA, VIDEO_FORMAT_BGRA,
+};
+
+static const struct {
+	uint32_t width;
+	uint32_t height;
+} ladder[] = {
+	{1920, 1080},
+	{1280, 720},
+	{854, 480},
+	{640, 360},
+};
+
+#define LADDER_RUNGS (sizeof(ladder) / sizeof(ladder[0]))
+
+static int iterations = 100;
+static bool csv = false;
+static bool ladder_mode = false;
+
+static void fill_frame(struct video_frame *frame, uint32_t height)
+{
+	for (size_t i = 0; i < MAX_AV_PLANES && frame->data[i]; i++) {
+		for (size_t j = 0; j < (size_t)frame->linesize[i] * height; j++)
+			frame->data[i][j] = (uint8_t)(j * 7 + i * 31);
+	}
+}
+
+/* returns the average time per frame in milliseconds, or a negative value
+ * if the conversion is not supported */
+static double run_bench(enum video_format src_format, enum video_format dst_format, const struct bench_size *size)
+{
+	struct video_scale_info src = {src_format, size->src_width, size->src_height, VIDEO_RANGE_PARTIAL,
+				       VIDEO_CS_709};
+	struct video_scale_info dst = {dst_format, size->dst_width, size->dst_height, VIDEO_RANGE_PARTIAL,
+				       VIDEO_CS_709};
+	struct video_frame *in;
+	struct video_frame *out;
+	video_scaler_t *scaler;
+	uint64_t start;
+	uint64_t total;
+
+	if (video_scaler_create(&scaler, &dst, &src, VIDEO_SCALE_FAST_BILINEAR) != VIDEO_SCALER_SUCCESS)
+		return -1.0;
+
+	in = video_frame_create(src_format, size->src_width, size->src_height);
+	out = video_frame_create(dst_format, size->dst_width, size->dst_height);
+	fill_frame(in, size->src_height);
+
+	/* the first frames warm up caches and scaler threads */
+	for (int i = 0; i < 3; i++)
+		video_scaler_scale(scaler, out->data, out->linesize, (const uint8_t *const *)in->data, in->linesize);
+
+	start = os_gettime_ns();
+	for (int i = 0; i < iterations; i++)
+		video_scaler_scale(scaler, out->data, out->linesize, (const uint8_t *const *)in->data, in->linesize);
+	total = os_gettime_ns() - start;
+
+	video_frame_destroy(in);
+	video_frame_destroy(out);
+	video_scaler_destroy(scaler);
+
+	return (double)total / (double)iterations / 1000000.0;
+}
+
+static void set_ladder_info(struct video_scale_info *info, enum video_format format, size_t rung)
+{
+	info->format = format;
+	info->width = ladder[rung].width;
+	info->height = ladder[rung].height;
+	info->range = VIDEO_RANGE_PARTIAL;
+	info->colorspace = VIDEO_CS_709;
+}
+
+/* returns the total time per frame in milliseconds to produce every rung of
+ * the ladder below the first, or a negative value on failure */
+static double run_ladder(enum video_format format, bool cascade)
+{
+	video_scaler_t *scalers[LADDER_RUNGS] = {0};
+	struct video_frame *frames[LADDER_RUNGS] = {0};
+	double result = -1.0;
+	uint64_t start;
+	uint64_t total;
+
+	for (size_t i = 0; i < LADDER_RUNGS; i++)
+		frames[i] = video_frame_create(format, ladder[i].width, ladder[i].height);
+	fill_frame(frames[0], ladder[0].height);
+
+	for (size_t i = 1; i < LADDER_RUNGS; i++) {
+		struct video_scale_info src;
+		struct video_scale_info dst;
+
+		set_ladder_info(&src, format, cascade ? i - 1 : 0);
+		set_ladder_info(&dst, format, i);
+
+		if (video_scaler_create(&scalers[i], &dst, &src, VIDEO_SCALE_FAST_BILINEAR) != VIDEO_SCALER_SUCCESS)
+			goto fail;
+	}
+
+	start = 0;
+	for (int i = 0; i < iterations + 3; i++) {
+		/* the first frames warm up caches and scaler threads */
+		if (i == 3)
+			start = os_gettime_ns();
+
+		for (size_t j = 1; j < LADDER_RUNGS; j++) {
+			struct video_frame *in = frames[cascade ? j - 1 : 0];
+			struct video_frame *out = frames[j];
+
+			video_scaler_scale(scalers[j], out->data, out->linesize, (const uint8_t *const *)in->data,
+					   in->linesize);
+		}
+	}
+	total = os_gettime_ns() - start;
+
+	result = (double)total / (double)iterations / 1000000.0;
+
+fail:
+	for (size_t i = 0; i < LADDER_RUNGS; i++) {
+		video_scaler_destroy(scalers[i]);
+		video_frame_destroy(frames[i]);
+	}
+
+	return result;
+}
+
+static void bench_ladder(void)
+{
+	printf(csv ? "format,direct_ms_per_frame,cascade_ms_per_frame\n" : "%-6s %14s %14s\n", "format", "direct ms",
+	       "cascade ms");
+
+	for (size_t i = 0; i < sizeof(src_formats) / sizeof(src_formats[0]); i++) {
+		const char *name = get_video_format_name(src_formats[i]);
+		double direct = run_ladder(src_formats[i], false);
+		double cascade = run_ladder(src_formats[i], true);
+
+		if (direct < 0.0 || cascade < 0.0) {
+			blog(LOG_WARNING, "%s ladder is not supported", name);
+			continue;
+		}
+
+		printf(csv ? "%s,%.3f,%.3f\n" : "%-6s %14.3f %14.3f\n", name, direct, cascade);
+	}
+}
+
+static void usage(const char *name)
+{
+	fprintf(stderr,
+		"usage: %s [options]\n"
+		"  --iterations <n>  frames scaled per conversion (default 100)\n"
+		"  --csv             print comma separated values\n"
+		"  --ladder          compare direct and cascaded rendition ladder scaling\n",
+		name);
+}
+
+static bool parse_args(int argc, char *argv[])
+{
+	for (int i = 1; i < argc; i++) {
+		const char *arg = argv[i];
+
+		if (strcmp(arg, "--csv") == 0) {
+			csv = true;
+		} else if (strcmp(arg, "--ladder") == 0) {
+			ladder_mode = true;
+		} else if (strcmp(arg, "--iterations") == 0 && i + 1 < argc) {
+			iterations = atoi(argv[++i]);
+		} else {
+			return false;
+		}
+	}
+
+	return iterations > 0;
+}
+
+int main(int argc, char *argv[])
+{
+	if (!parse_args(argc, argv)) {
+		usage(argv[0]);
+		return 2;
+	}
+
+	if (ladder_mode) {
+		bench_ladder();
+		return 0;
+	}
+
+	printf(csv ? "src,dst,src_size,dst_size,ms_per_frame\n" : "%-6s %-6s %-11s %-11s %10s\n", "src", "dst",
+	       "src size", "dst size", "ms/frame");
+
+	for (size_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++) {
+		const struct bench_size *size = &sizes[s];
+		char src_size[32];
+		char dst_size[32];
+
+		snprintf(src_size, sizeof(src_size), "%ux%u", size->src_width, size->src_height);
+		snprintf(dst_size, sizeof(dst_size), "%ux%u", size->dst_width, size->dst_height);
+
+		for (size_t i = 0; i < sizeof(src_formats) / sizeof(src_formats[0]); i++) {
+			for (size_t j = 0; j < sizeof(dst_formats) / sizeof(dst_formats[0]); j++) {
+				const char *src_name = get_video_format_name(src_formats[i]);
+				const char *dst_name = get_video_format_name(dst_formats[j]);
+				double ms = run_bench(src_formats[i], dst_formats[j], size);
+
+				if (ms < 0.0) {
+					blog(LOG_WARNING, "%s -> %s is not supported", src_name, dst_name);
+					continue;
+				}
+
+				printf(csv ? "%s,%s,%s,%s,%.3f\n" : "%-6s %-6s %-11s %-11s %10.3f\n", src_name,
+				       dst_name, src_size, dst_size, ms);
+			}
+		}
+	}
+
+	return 0;
+}
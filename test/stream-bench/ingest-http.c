@@ -0,0 +1,452 @@
+/******************************************************************************
+    Copyright (C) 2026 by OBS Project contributors
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+******************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <errno.h>
+#include <poll.h>
+#include <unistd.h>
+#include <sys/socket.h>
+
+#include <util/base.h>
+#include <util/bmem.h>
+#include <util/platform.h>
+
+#include "ingest.h"
+
+/* Just enough HTTP/1.1 to accept the PUT and DELETE requests of the CMAF
+ * output on a keep-alive connection.  Media segments are parsed down to the
+ * sample level so arrival times can be compared to sample timestamps like
+ * the other receivers do. */
+
+#define MAX_HEADER_SIZE 8192
+#define MAX_TRACKS 8
+
+struct track_info {
+	uint32_t track_id;
+	uint32_t timescale;
+	bool video;
+};
+
+struct http_conn {
+	struct ingest *ingest;
+	int fd;
+
+	uint64_t start_ns;
+	uint64_t total_read;
+
+	DARRAY(uint8_t) buf;
+	DARRAY(uint8_t) body;
+
+	struct track_info tracks[MAX_TRACKS];
+	size_t num_tracks;
+
+	/* with partial segments enabled every sample arrives twice, once in
+	 * its part and once in the full segment */
+	bool seen_parts;
+};
+
+static bool wait_fd(struct http_conn *conn, short events)
+{
+	struct pollfd pfd = {.fd = conn->fd, .events = events};
+
+	while (!conn->ingest->stop) {
+		int ret = poll(&pfd, 1, 100);
+		if (ret > 0)
+			return true;
+		if (ret < 0 && errno != EINTR)
+			return false;
+	}
+
+	return false;
+}
+
+static bool fill(struct http_conn *conn, size_t max)
+{
+	uint8_t data[16384];
+
+	if (!wait_fd(conn, POLLIN))
+		return false;
+
+	ssize_t ret = recv(conn->fd, data, max < sizeof(data) ? max : sizeof(data), 0);
+	if (ret <= 0)
+		return false;
+
+	da_push_back_array(conn->buf, data, (size_t)ret);
+	conn->total_read += (uint64_t)ret;
+
+	ingest_throttle(conn->ingest, conn->start_ns, conn->total_read);
+	return true;
+}
+
+static bool write_str(struct http_conn *conn, const char *str)
+{
+	size_t size = strlen(str);
+
+	while (size) {
+		if (!wait_fd(conn, POLLOUT))
+			return false;
+
+		ssize_t ret = send(conn->fd, str, size, 0);
+		if (ret <= 0)
+			return false;
+
+		str += ret;
+		size -= (size_t)ret;
+	}
+
+	return true;
+}
+
+static inline uint32_t rb32(const uint8_t *p)
+{
+	return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8) | p[3];
+}
+
+static inline uint64_t rb64(const uint8_t *p)
+{
+	return ((uint64_t)rb32(p) << 32) | rb32(p + 4);
+}
+
+/* ------------------------------------------------------------------------- */
+/* ISO BMFF parsing                                                          */
+
+/* finds the next box in [*pos, end), returns its payload */
+static bool next_box(const uint8_t **pos, const uint8_t *end, char type[5], const uint8_t **payload,
+		     const uint8_t **payload_end)
+{
+	const uint8_t *p = *pos;
+
+	if (end - p < 8)
+		return false;
+
+	uint64_t size = rb32(p);
+	size_t header = 8;
+
+	if (size == 1) {
+		if (end - p < 16)
+			return false;
+		size = rb64(p + 8);
+		header = 16;
+	} else if (size == 0) {
+		size = (uint64_t)(end - p);
+	}
+
+	if (size < header || size > (uint64_t)(end - p))
+		return false;
+
+	memcpy(type, p + 4, 4);
+	type[4] = 0;
+	*payload = p + header;
+	*payload_end = p + size;
+	*pos = p + size;
+	return true;
+}
+
+static struct track_info *find_track(struct http_conn *conn, uint32_t track_id)
+{
+	for (size_t i = 0; i < conn->num_tracks; i++) {
+		if (conn->tracks[i].track_id == track_id)
+			return &conn->tracks[i];
+	}
+
+	return NULL;
+}
+
+static void parse_trak(struct http_conn *conn, const uint8_t *p, const uint8_t *end)
+{
+	struct track_info track = {0};
+	const uint8_t *payload;
+	const uint8_t *payload_end;
+	char type[5];
+
+	while (next_box(&p, end, type, &payload, &payload_end)) {
+		if (strcmp(type, "tkhd") == 0 && payload_end - payload >= 24) {
+			track.track_id = rb32(payload + (payload[0] == 1 ? 20 : 12));
+		} else if (strcmp(type, "mdia") == 0) {
+			const uint8_t *mp = payload;
+			const uint8_t *mpayload;
+			const uint8_t *mpayload_end;
+
+			while (next_box(&mp, payload_end, type, &mpayload, &mpayload_end)) {
+				if (strcmp(type, "mdhd") == 0 && mpayload_end - mpayload >= 24)
+					track.timescale = rb32(mpayload + (mpayload[0] == 1 ? 20 : 12));
+				else if (strcmp(type, "hdlr") == 0 && mpayload_end - mpayload >= 12)
+					track.video = memcmp(mpayload + 8, "vide", 4) == 0;
+			}
+		}
+	}
+
+	if (track.track_id && track.timescale && conn->num_tracks < MAX_TRACKS)
+		conn->tracks[conn->num_tracks++] = track;
+}
+
+static void parse_init(struct http_conn *conn, const uint8_t *p, const uint8_t *end)
+{
+	const uint8_t *payload;
+	const uint8_t *payload_end;
+	char type[5];
+
+	conn->num_tracks = 0;
+
+	while (next_box(&p, end, type, &payload, &payload_end)) {
+		if (strcmp(type, "moov") != 0)
+			continue;
+
+		const uint8_t *mp = payload;
+		const uint8_t *tpayload;
+		const uint8_t *tpayload_end;
+
+		while (next_box(&mp, payload_end, type, &tpayload, &tpayload_end)) {
+			if (strcmp(type, "trak") == 0)
+				parse_trak(conn, tpayload, tpayload_end);
+		}
+	}
+}
+
+static void parse_traf(struct http_conn *conn, uint64_t arrival, const uint8_t *p, const uint8_t *end)
+{
+	struct track_info *track = NULL;
+	uint32_t default_duration = 0;
+	uint32_t default_size = 0;
+	uint64_t base_time = 0;
+	const uint8_t *payload;
+	const uint8_t *payload_end;
+	char type[5];
+
+	while (next_box(&p, end, type, &payload, &payload_end)) {
+		size_t size = (size_t)(payload_end - payload);
+
+		if (strcmp(type, "tfhd") == 0 && size >= 8) {
+			uint32_t flags = rb32(payload) & 0xffffff;
+			const uint8_t *f = payload + 8;
+
+			track = find_track(conn, rb32(payload + 4));
+			if (flags & 0x01)
+				f += 8; // base_data_offset
+			if (flags & 0x02)
+				f += 4; // sample_description_index
+			if (flags & 0x08 && f + 4 <= payload_end) {
+				default_duration = rb32(f);
+				f += 4;
+			}
+			if (flags & 0x10 && f + 4 <= payload_end)
+				default_size = rb32(f);
+
+		} else if (strcmp(type, "tfdt") == 0 && size >= 8) {
+			base_time = payload[0] == 1 && size >= 12 ? rb64(payload + 4) : rb32(payload + 4);
+
+		} else if (strcmp(type, "trun") == 0 && size >= 8 && track) {
+			uint32_t flags = rb32(payload) & 0xffffff;
+			uint32_t count = rb32(payload + 4);
+			const uint8_t *s = payload + 8;
+			uint32_t first_flags = 0;
+			bool has_first_flags = false;
+
+			if (flags & 0x001)
+				s += 4; // data_offset
+			if (flags & 0x004 && s + 4 <= payload_end) {
+				first_flags = rb32(s);
+				has_first_flags = true;
+				s += 4;
+			}
+
+			uint64_t time = base_time;
+
+			for (uint32_t i = 0; i < count; i++) {
+				uint32_t duration = default_duration;
+				uint32_t sample_size = default_size;
+
+				if (flags & 0x100) {
+					if (s + 4 > payload_end)
+						break;
+					duration = rb32(s);
+					s += 4;
+				}
+				if (flags & 0x200) {
+					if (s + 4 > payload_end)
+						break;
+					sample_size = rb32(s);
+					s += 4;
+				}
+				if (flags & 0x400)
+					s += 4;
+				if (flags & 0x800)
+					s += 4;
+
+				if (track->video) {
+					int64_t pts_ns = (int64_t)(time * 1000000000ULL / track->timescale);
+					bool keyframe = i == 0 && has_first_flags && !(first_flags & 0x00010000);
+					ingest_add_video(conn->ingest, arrival, pts_ns, sample_size, keyframe);
+				} else {
+					ingest_add_audio(conn->ingest, arrival, sample_size);
+				}
+
+				time += duration;
+			}
+		}
+	}
+}
+
+static void parse_segment(struct http_conn *conn, uint64_t arrival, const uint8_t *p, const uint8_t *end)
+{
+	const uint8_t *payload;
+	const uint8_t *payload_end;
+	char type[5];
+
+	while (next_box(&p, end, type, &payload, &payload_end)) {
+		if (strcmp(type, "moof") != 0)
+			continue;
+
+		const uint8_t *mp = payload;
+		const uint8_t *tpayload;
+		const uint8_t *tpayload_end;
+
+		while (next_box(&mp, payload_end, type, &tpayload, &tpayload_end)) {
+			if (strcmp(type, "traf") == 0)
+				parse_traf(conn, arrival, tpayload, tpayload_end);
+		}
+	}
+}
+
+/* ------------------------------------------------------------------------- */
+/* HTTP                                                                      */
+
+static void handle_put(struct http_conn *conn, const char *path)
+{
+	const char *name = strrchr(path, '/');
+	const uint8_t *body = conn->body.array;
+	const uint8_t *end = body + conn->body.num;
+	uint64_t arrival = os_gettime_ns();
+	unsigned int number;
+	unsigned int part;
+	char c;
+
+	name = name ? name + 1 : path;
+
+	if (strcmp(name, "init.mp4") == 0) {
+		parse_init(conn, body, end);
+	} else if (sscanf(name, "seg%u.%u.m4%c", &number, &part, &c) == 3) {
+		conn->seen_parts = true;
+		parse_segment(conn, arrival, body, end);
+	} else if (sscanf(name, "seg%u.m4%c", &number, &c) == 2 && !conn->seen_parts) {
+		parse_segment(conn, arrival, body, end);
+	}
+}
+
+static bool read_request(struct http_conn *conn)
+{
+	char method[16];
+	char path[1024];
+	size_t header_end = 0;
+	size_t content_length = 0;
+	bool expect_continue = false;
+
+	/* read until the end of the headers */
+	for (;;) {
+		for (size_t i = 3; i < conn->buf.num; i++) {
+			if (memcmp(conn->buf.array + i - 3, "\r\n\r\n", 4) == 0) {
+				header_end = i + 1;
+				break;
+			}
+		}
+
+		if (header_end)
+			break;
+		if (conn->buf.num > MAX_HEADER_SIZE || !fill(conn, MAX_HEADER_SIZE))
+			return false;
+	}
+
+	char *headers = bstrdup_n((const char *)conn->buf.array, header_end);
+	da_erase_range(conn->buf, 0, header_end);
+
+	if (sscanf(headers, "%15s %1023s", method, path) != 2) {
+		bfree(headers);
+		return false;
+	}
+
+	for (char *line = strstr(headers, "\r\n"); line; line = strstr(line + 2, "\r\n")) {
+		if (strncasecmp(line + 2, "content-length:", 15) == 0)
+			content_length = (size_t)strtoull(line + 17, NULL, 10);
+		else if (strncasecmp(line + 2, "expect:", 7) == 0 && strstr(line + 9, "100-continue"))
+			expect_continue = true;
+	}
+	bfree(headers);
+
+	if (expect_continue && !write_str(conn, "HTTP/1.1 100 Continue\r\n\r\n"))
+		return false;
+
+	/* read the body */
+	while (conn->buf.num < content_length) {
+		if (!fill(conn, content_length - conn->buf.num))
+			return false;
+	}
+
+	da_resize(conn->body, 0);
+	da_push_back_array(conn->body, conn->buf.array, content_length);
+	da_erase_range(conn->buf, 0, content_length);
+
+	if (strcmp(method, "PUT") == 0) {
+		handle_put(conn, path);
+		return write_str(conn, "HTTP/1.1 201 Created\r\nContent-Length: 0\r\n\r\n");
+	}
+	if (strcmp(method, "DELETE") == 0)
+		return write_str(conn, "HTTP/1.1 204 No Content\r\n\r\n");
+
+	return write_str(conn, "HTTP/1.1 405 Method Not Allowed\r\nContent-Length: 0\r\n\r\n");
+}
+
+static void serve_connection(struct ingest *ingest, int fd, struct http_conn *conn)
+{
+	conn->ingest = ingest;
+	conn->fd = fd;
+	conn->start_ns = os_gettime_ns();
+	conn->total_read = 0;
+	da_resize(conn->buf, 0);
+
+	while (read_request(conn))
+		;
+}
+
+void *ingest_http_thread(void *data)
+{
+	struct ingest *ingest = data;
+	struct pollfd pfd = {.fd = ingest->listen_fd, .events = POLLIN};
+
+	/* track information from the init segment outlives reconnects */
+	struct http_conn conn = {0};
+
+	os_set_thread_name("ingest: http");
+
+	while (!ingest->stop) {
+		if (poll(&pfd, 1, 100) <= 0)
+			continue;
+
+		int fd = accept(ingest->listen_fd, NULL, NULL);
+		if (fd == -1)
+			continue;
+
+		serve_connection(ingest, fd, &conn);
+		close(fd);
+	}
+
+	da_free(conn.buf);
+	da_free(conn.body);
+	return NULL;
+}
@@ -0,0 +1,438 @@
+/******************************************************************************
+    Copyright (C) 2026 by OBS Project contributors
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+******************************************************************************/
+
+#include <string.h>
+#include <errno.h>
+#include <poll.h>
+#include <unistd.h>
+#include <sys/socket.h>
+
+#include <util/base.h>
+#include <util/bmem.h>
+#include <util/platform.h>
+#include <util/array-serializer.h>
+
+#include "ingest.h"
+
+/* Just enough of the RTMP chunk stream protocol to accept a publisher:
+ * the plain handshake, chunk reassembly, and blanket successful replies to
+ * every command so that connect/createStream/publish go through. */
+
+#define HANDSHAKE_SIZE 1536
+#define MAX_CHUNK_STREAMS 64
+
+#define MSG_SET_CHUNK_SIZE 1
+#define MSG_AUDIO 8
+#define MSG_VIDEO 9
+#define MSG_COMMAND_AMF0 20
+
+struct chunk_stream {
+	uint32_t timestamp;
+	uint32_t delta;
+	uint32_t length;
+	uint8_t type;
+	uint32_t stream_id;
+	bool extended;
+
+	DARRAY(uint8_t) body;
+};
+
+struct rtmp_conn {
+	struct ingest *ingest;
+	int fd;
+
+	uint64_t start_ns;
+	uint64_t total_read;
+	uint32_t chunk_size;
+
+	struct chunk_stream streams[MAX_CHUNK_STREAMS];
+};
+
+static bool wait_fd(struct rtmp_conn *conn, short events)
+{
+	struct pollfd pfd = {.fd = conn->fd, .events = events};
+
+	while (!conn->ingest->stop) {
+		int ret = poll(&pfd, 1, 100);
+		if (ret > 0)
+			return true;
+		if (ret < 0 && errno != EINTR)
+			return false;
+	}
+
+	return false;
+}
+
+static bool read_n(struct rtmp_conn *conn, void *data, size_t size)
+{
+	uint8_t *out = data;
+
+	while (size) {
+		if (!wait_fd(conn, POLLIN))
+			return false;
+
+		ssize_t ret = recv(conn->fd, out, size, 0);
+		if (ret <= 0)
+			return false;
+
+		out += ret;
+		size -= (size_t)ret;
+		conn->total_read += (uint64_t)ret;
+
+		ingest_throttle(conn->ingest, conn->start_ns, conn->total_read);
+	}
+
+	return true;
+}
+
+static bool write_n(struct rtmp_conn *conn, const void *data, size_t size)
+{
+	const uint8_t *in = data;
+
+	while (size) {
+		if (!wait_fd(conn, POLLOUT))
+			return false;
+
+		ssize_t ret = send(conn->fd, in, size, 0);
+		if (ret <= 0)
+			return false;
+
+		in += ret;
+		size -= (size_t)ret;
+	}
+
+	return true;
+}
+
+static inline uint32_t rb24(const uint8_t *p)
+{
+	return ((uint32_t)p[0] << 16) | ((uint32_t)p[1] << 8) | p[2];
+}
+
+static inline uint32_t rb32(const uint8_t *p)
+{
+	return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8) | p[3];
+}
+
+/* ------------------------------------------------------------------------- */
+
+static bool do_handshake(struct rtmp_conn *conn)
+{
+	uint8_t c0c1[HANDSHAKE_SIZE + 1];
+	uint8_t s0s1[HANDSHAKE_SIZE + 1] = {0};
+	uint8_t c2[HANDSHAKE_SIZE];
+
+	if (!read_n(conn, c0c1, sizeof(c0c1)))
+		return false;
+
+	/* version 3, zero server version so the client skips digest
+	 * verification */
+	s0s1[0] = 3;
+	for (size_t i = 9; i < sizeof(s0s1); i++)
+		s0s1[i] = (uint8_t)rand();
+
+	if (!write_n(conn, s0s1, sizeof(s0s1)) || !write_n(conn, c0c1 + 1, HANDSHAKE_SIZE))
+		return false;
+
+	return read_n(conn, c2, sizeof(c2));
+}
+
+/* ------------------------------------------------------------------------- */
+
+static void amf_write_string(struct serializer *s, const char *str)
+{
+	size_t len = strlen(str);
+	s_w8(s, 0x02);
+	s_wb16(s, (uint16_t)len);
+	s_write(s, str, len);
+}
+
+static void amf_write_number(struct serializer *s, double val)
+{
+	s_w8(s, 0x00);
+	s_wbd(s, val);
+}
+
+static void amf_write_prop(struct serializer *s, const char *name, const char *val)
+{
+	size_t len = strlen(name);
+	s_wb16(s, (uint16_t)len);
+	s_write(s, name, len);
+	amf_write_string(s, val);
+}
+
+static bool send_message(struct rtmp_conn *conn, uint8_t type, uint32_t stream_id, const uint8_t *body, size_t size)
+{
+	struct array_output_data data;
+	struct serializer s;
+
+	array_output_serializer_init(&s, &data);
+
+	/* chunk stream 3, type 0 header, then type 3 continuation headers
+	 * for every 128 bytes, the default chunk size */
+	s_w8(&s, 0x03);
+	s_wb24(&s, 0);
+	s_wb24(&s, (uint32_t)size);
+	s_w8(&s, type);
+	s_wl32(&s, stream_id);
+
+	for (size_t offset = 0; offset < size; offset += 128) {
+		if (offset)
+			s_w8(&s, 0xC3);
+		s_write(&s, body + offset, size - offset < 128 ? size - offset : 128);
+	}
+
+	bool success = write_n(conn, data.bytes.array, data.bytes.num);
+	array_output_serializer_free(&data);
+	return success;
+}
+
+static bool send_result(struct rtmp_conn *conn, double txn)
+{
+	struct array_output_data data;
+	struct serializer s;
+
+	array_output_serializer_init(&s, &data);
+	amf_write_string(&s, "_result");
+	amf_write_number(&s, txn);
+	s_w8(&s, 0x05);
+	/* stream id for createStream, ignored for everything else */
+	amf_write_number(&s, 1.0);
+
+	bool success = send_message(conn, MSG_COMMAND_AMF0, 0, data.bytes.array, data.bytes.num);
+	array_output_serializer_free(&data);
+	return success;
+}
+
+static bool send_publish_start(struct rtmp_conn *conn)
+{
+	struct array_output_data data;
+	struct serializer s;
+
+	array_output_serializer_init(&s, &data);
+	amf_write_string(&s, "onStatus");
+	amf_write_number(&s, 0.0);
+	s_w8(&s, 0x05);
+	s_w8(&s, 0x03);
+	amf_write_prop(&s, "level", "status");
+	amf_write_prop(&s, "code", "NetStream.Publish.Start");
+	amf_write_prop(&s, "description", "Publishing");
+	s_wb24(&s, 0x000009);
+
+	bool success = send_message(conn, MSG_COMMAND_AMF0, 1, data.bytes.array, data.bytes.num);
+	array_output_serializer_free(&data);
+	return success;
+}
+
+static bool handle_command(struct rtmp_conn *conn, const uint8_t *body, size_t size)
+{
+	char name[64];
+	uint64_t bits;
+	double txn;
+
+	if (size < 3 || body[0] != 0x02)
+		return true;
+
+	size_t len = ((size_t)body[1] << 8) | body[2];
+	if (len >= sizeof(name) || 3 + len + 9 > size || body[3 + len] != 0x00)
+		return true;
+
+	memcpy(name, body + 3, len);
+	name[len] = 0;
+
+	bits = ((uint64_t)rb32(body + 4 + len) << 32) | rb32(body + 8 + len);
+	memcpy(&txn, &bits, sizeof(txn));
+
+	if (txn != 0.0 && !send_result(conn, txn))
+		return false;
+	if (strcmp(name, "publish") == 0)
+		return send_publish_start(conn);
+
+	return true;
+}
+
+static void handle_media(struct rtmp_conn *conn, const struct chunk_stream *cs)
+{
+	const uint8_t *body = cs->body.array;
+	size_t size = cs->body.num;
+	uint64_t arrival = os_gettime_ns();
+
+	if (!size)
+		return;
+
+	if (cs->type == MSG_AUDIO) {
+		/* skip the AAC sequence header */
+		if ((body[0] >> 4) == 10 && size > 1 && body[1] == 0)
+			return;
+
+		ingest_add_audio(conn->ingest, arrival, size);
+		return;
+	}
+
+	bool enhanced = (body[0] & 0x80) != 0;
+	uint8_t frame_type = (body[0] >> 4) & 0x07;
+	bool header = enhanced ? (body[0] & 0x0f) == 0 : size > 1 && body[1] == 0;
+
+	if (!header)
+		ingest_add_video(conn->ingest, arrival, (int64_t)cs->timestamp * 1000000, size, frame_type == 1);
+}
+
+static bool handle_message(struct rtmp_conn *conn, const struct chunk_stream *cs)
+{
+	switch (cs->type) {
+	case MSG_SET_CHUNK_SIZE:
+		if (cs->body.num >= 4)
+			conn->chunk_size = rb32(cs->body.array) & 0x7fffffff;
+		return conn->chunk_size != 0;
+	case MSG_COMMAND_AMF0:
+		return handle_command(conn, cs->body.array, cs->body.num);
+	case MSG_AUDIO:
+	case MSG_VIDEO:
+		handle_media(conn, cs);
+		return true;
+	}
+
+	return true;
+}
+
+static bool read_chunk(struct rtmp_conn *conn)
+{
+	static const size_t header_sizes[] = {11, 7, 3, 0};
+	uint8_t header[11];
+	uint8_t basic[3];
+	uint32_t csid;
+
+	if (!read_n(conn, basic, 1))
+		return false;
+
+	uint8_t fmt = basic[0] >> 6;
+	csid = basic[0] & 0x3f;
+	if (csid == 0) {
+		if (!read_n(conn, basic + 1, 1))
+			return false;
+		csid = 64 + basic[1];
+	} else if (csid == 1) {
+		if (!read_n(conn, basic + 1, 2))
+			return false;
+		csid = 64 + basic[1] + ((uint32_t)basic[2] << 8);
+	}
+
+	if (csid >= MAX_CHUNK_STREAMS) {
+		blog(LOG_WARNING, "ingest: unsupported chunk stream id %u", csid);
+		return false;
+	}
+
+	struct chunk_stream *cs = &conn->streams[csid];
+	bool new_message = cs->body.num == 0;
+
+	if (!read_n(conn, header, header_sizes[fmt]))
+		return false;
+
+	if (fmt <= 2) {
+		uint32_t ts = rb24(header);
+		cs->extended = ts == 0xffffff;
+
+		if (fmt <= 1) {
+			cs->length = rb24(header + 3);
+			cs->type = header[6];
+		}
+		if (fmt == 0)
+			cs->stream_id = header[7] | (header[8] << 8) | (header[9] << 16) | ((uint32_t)header[10] << 24);
+
+		if (cs->extended) {
+			uint8_t ext[4];
+			if (!read_n(conn, ext, 4))
+				return false;
+			ts = rb32(ext);
+		}
+
+		if (fmt == 0) {
+			cs->timestamp = ts;
+			cs->delta = 0;
+		} else {
+			cs->delta = ts;
+			cs->timestamp += ts;
+		}
+
+	} else {
+		if (cs->extended) {
+			uint8_t ext[4];
+			if (!read_n(conn, ext, 4))
+				return false;
+		}
+		if (new_message)
+			cs->timestamp += cs->delta;
+	}
+
+	size_t remaining = cs->length - cs->body.num;
+	size_t size = remaining < conn->chunk_size ? remaining : conn->chunk_size;
+
+	size_t offset = cs->body.num;
+	da_resize(cs->body, offset + size);
+	if (!read_n(conn, cs->body.array + offset, size))
+		return false;
+
+	if (cs->body.num == cs->length) {
+		bool success = handle_message(conn, cs);
+		da_resize(cs->body, 0);
+		return success;
+	}
+
+	return true;
+}
+
+static void serve_connection(struct ingest *ingest, int fd)
+{
+	struct rtmp_conn conn = {0};
+
+	conn.ingest = ingest;
+	conn.fd = fd;
+	conn.start_ns = os_gettime_ns();
+	conn.chunk_size = 128;
+
+	if (!do_handshake(&conn)) {
+		blog(LOG_WARNING, "ingest: RTMP handshake failed");
+	} else {
+		while (read_chunk(&conn))
+			;
+	}
+
+	for (size_t i = 0; i < MAX_CHUNK_STREAMS; i++)
+		da_free(conn.streams[i].body);
+}
+
+void *ingest_rtmp_thread(void *data)
+{
+	struct ingest *ingest = data;
+	struct pollfd pfd = {.fd = ingest->listen_fd, .events = POLLIN};
+
+	os_set_thread_name("ingest: rtmp");
+
+	while (!ingest->stop) {
+		if (poll(&pfd, 1, 100) <= 0)
+			continue;
+
+		int fd = accept(ingest->listen_fd, NULL, NULL);
+		if (fd == -1)
+			continue;
+
+		serve_connection(ingest, fd);
+		close(fd);
+	}
+
+	return NULL;
+}
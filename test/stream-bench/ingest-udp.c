@@ -0,0 +1,171 @@
+/******************************************************************************
+    Copyright (C) 2026 by OBS Project contributors
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+******************************************************************************/
+
+#include <stdlib.h>
+#include <string.h>
+#include <poll.h>
+#include <sys/socket.h>
+
+#include <util/base.h>
+#include <util/bmem.h>
+#include <util/platform.h>
+
+#include "ingest.h"
+
+/* Receives MPEG-TS over UDP, the transport the mpegts output uses for
+ * udp:// URLs and carries inside SRT/RIST, and tracks continuity counters
+ * and PES timestamps. */
+
+#define TS_PACKET_SIZE 188
+#define MAX_DATAGRAM_SIZE 65536
+#define PID_COUNT 8192
+
+struct ts_receiver {
+	struct ingest *ingest;
+
+	int8_t continuity[PID_COUNT];
+
+	uint64_t last_ns;
+	double tokens;
+};
+
+static bool shape_datagram(struct ts_receiver *ts, uint64_t now, size_t size)
+{
+	const struct ingest_shaping *shaping = &ts->ingest->shaping;
+
+	if (shaping->loss_percent > 0.0 && (double)rand() * 100.0 / (double)RAND_MAX < shaping->loss_percent)
+		return false;
+
+	if (shaping->rate_kbps) {
+		/* token bucket holding up to 100 ms worth of data */
+		double rate = (double)shaping->rate_kbps * 1000.0 / 8.0;
+		double burst = rate / 10.0;
+
+		ts->tokens += (double)(now - ts->last_ns) * rate / 1000000000.0;
+		if (ts->tokens > burst)
+			ts->tokens = burst;
+		if (ts->tokens < (double)size)
+			return false;
+		ts->tokens -= (double)size;
+	}
+
+	return true;
+}
+
+static inline int64_t read_pts(const uint8_t *p)
+{
+	return ((int64_t)(p[0] & 0x0e) << 29) | ((int64_t)p[1] << 22) | ((int64_t)(p[2] & 0xfe) << 14) |
+	       ((int64_t)p[3] << 7) | (p[4] >> 1);
+}
+
+/* bytes are counted per datagram, PES packets only count as packets */
+static void handle_pes_start(struct ts_receiver *ts, uint64_t arrival, const uint8_t *pes, size_t size,
+			     bool random_access)
+{
+	if (size < 14 || pes[0] != 0 || pes[1] != 0 || pes[2] != 1)
+		return;
+
+	uint8_t stream_id = pes[3];
+
+	if ((stream_id & 0xe0) == 0xc0) {
+		ingest_add_audio(ts->ingest, arrival, 0);
+
+	} else if ((stream_id & 0xf0) == 0xe0 && (pes[7] & 0x80)) {
+		int64_t pts_ns = read_pts(pes + 9) * 100000 / 9;
+		ingest_add_video(ts->ingest, arrival, pts_ns, 0, random_access);
+	}
+}
+
+static void handle_ts_packet(struct ts_receiver *ts, uint64_t arrival, const uint8_t *pkt)
+{
+	if (pkt[0] != 0x47)
+		return;
+
+	bool unit_start = (pkt[1] & 0x40) != 0;
+	uint16_t pid = ((pkt[1] & 0x1f) << 8) | pkt[2];
+	uint8_t adaptation = (pkt[3] >> 4) & 0x03;
+	int8_t counter = pkt[3] & 0x0f;
+
+	if (pid == 0x1fff)
+		return;
+
+	/* the counter only advances on packets carrying a payload */
+	if (adaptation & 0x01) {
+		int8_t last = ts->continuity[pid];
+		if (last != -1 && ((last + 1) & 0x0f) != counter) {
+			pthread_mutex_lock(&ts->ingest->mutex);
+			ts->ingest->stats.continuity_errors++;
+			pthread_mutex_unlock(&ts->ingest->mutex);
+		}
+		ts->continuity[pid] = counter;
+	}
+
+	if (!unit_start || !(adaptation & 0x01))
+		return;
+
+	size_t offset = 4;
+	bool random_access = false;
+	if (adaptation & 0x02) {
+		random_access = pkt[4] && (pkt[5] & 0x40);
+		offset += 1 + (size_t)pkt[4];
+	}
+	if (offset >= TS_PACKET_SIZE)
+		return;
+
+	handle_pes_start(ts, arrival, pkt + offset, TS_PACKET_SIZE - offset, random_access);
+}
+
+void *ingest_udp_thread(void *data)
+{
+	struct ingest *ingest = data;
+	struct pollfd pfd = {.fd = ingest->listen_fd, .events = POLLIN};
+	struct ts_receiver ts = {.ingest = ingest, .last_ns = os_gettime_ns()};
+	uint8_t *buf = bmalloc(MAX_DATAGRAM_SIZE);
+
+	memset(ts.continuity, -1, sizeof(ts.continuity));
+
+	os_set_thread_name("ingest: udp");
+
+	while (!ingest->stop) {
+		if (poll(&pfd, 1, 100) <= 0)
+			continue;
+
+		ssize_t size = recv(ingest->listen_fd, buf, MAX_DATAGRAM_SIZE, 0);
+		if (size <= 0)
+			continue;
+
+		uint64_t now = os_gettime_ns();
+		bool accepted = shape_datagram(&ts, now, (size_t)size);
+		ts.last_ns = now;
+
+		pthread_mutex_lock(&ingest->mutex);
+		if (accepted)
+			ingest->stats.bytes += (uint64_t)size;
+		else
+			ingest->stats.shaped_drops++;
+		pthread_mutex_unlock(&ingest->mutex);
+
+		if (!accepted)
+			continue;
+
+		for (ssize_t i = 0; i + TS_PACKET_SIZE <= size; i += TS_PACKET_SIZE)
+			handle_ts_packet(&ts, now, buf + i);
+	}
+
+	bfree(buf);
+	return NULL;
+}
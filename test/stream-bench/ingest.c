@@ -0,0 +1,200 @@
+/******************************************************************************
+    Copyright (C) 2026 by OBS Project contributors
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+******************************************************************************/
+
+#include <string.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+
+#include <util/base.h>
+#include <util/bmem.h>
+#include <util/platform.h>
+
+#include "ingest.h"
+
+#define RTMP_RECV_BUFFER_SIZE (64 * 1024)
+
+static bool open_socket(struct ingest *ingest)
+{
+	struct sockaddr_in addr = {0};
+	socklen_t len = sizeof(addr);
+	bool tcp = ingest->type != INGEST_UDP;
+	int one = 1;
+
+	ingest->listen_fd = socket(AF_INET, tcp ? SOCK_STREAM : SOCK_DGRAM, 0);
+	if (ingest->listen_fd == -1) {
+		blog(LOG_ERROR, "ingest: failed to create socket");
+		return false;
+	}
+
+	setsockopt(ingest->listen_fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+
+	/* keep the kernel buffer small when shaping so that throttled reads
+	 * turn into backpressure on the sender quickly */
+	if (tcp && ingest->shaping.rate_kbps) {
+		int size = RTMP_RECV_BUFFER_SIZE;
+		setsockopt(ingest->listen_fd, SOL_SOCKET, SO_RCVBUF, &size, sizeof(size));
+	}
+
+	addr.sin_family = AF_INET;
+	addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+	addr.sin_port = 0;
+
+	if (bind(ingest->listen_fd, (struct sockaddr *)&addr, sizeof(addr)) != 0 ||
+	    getsockname(ingest->listen_fd, (struct sockaddr *)&addr, &len) != 0) {
+		blog(LOG_ERROR, "ingest: failed to bind socket");
+		return false;
+	}
+
+	if (tcp && listen(ingest->listen_fd, 1) != 0) {
+		blog(LOG_ERROR, "ingest: failed to listen");
+		return false;
+	}
+
+	ingest->port = ntohs(addr.sin_port);
+	return true;
+}
+
+typedef void *(*ingest_thread_func)(void *);
+
+static ingest_thread_func get_thread_func(enum ingest_type type)
+{
+	switch (type) {
+	case INGEST_RTMP:
+		return ingest_rtmp_thread;
+	case INGEST_UDP:
+		return ingest_udp_thread;
+	case INGEST_HTTP:
+		return ingest_http_thread;
+	}
+
+	return NULL;
+}
+
+static const char *get_type_name(enum ingest_type type)
+{
+	switch (type) {
+	case INGEST_RTMP:
+		return "RTMP";
+	case INGEST_UDP:
+		return "UDP";
+	case INGEST_HTTP:
+		return "HTTP";
+	}
+
+	return "unknown";
+}
+
+bool ingest_start(struct ingest *ingest, enum ingest_type type, const struct ingest_shaping *shaping)
+{
+	memset(ingest, 0, sizeof(*ingest));
+	ingest->type = type;
+	ingest->listen_fd = -1;
+	if (shaping)
+		ingest->shaping = *shaping;
+
+	if (pthread_mutex_init(&ingest->mutex, NULL) != 0)
+		return false;
+
+	if (!open_socket(ingest))
+		goto fail;
+
+	if (pthread_create(&ingest->thread, NULL, get_thread_func(type), ingest) != 0)
+		goto fail;
+
+	ingest->thread_active = true;
+	blog(LOG_INFO, "ingest: %s receiver listening on 127.0.0.1:%d", get_type_name(type), ingest->port);
+	return true;
+
+fail:
+	if (ingest->listen_fd != -1)
+		close(ingest->listen_fd);
+	ingest->listen_fd = -1;
+	pthread_mutex_destroy(&ingest->mutex);
+	return false;
+}
+
+void ingest_stop(struct ingest *ingest)
+{
+	if (ingest->thread_active) {
+		ingest->stop = true;
+		pthread_join(ingest->thread, NULL);
+		ingest->thread_active = false;
+	}
+
+	if (ingest->listen_fd != -1)
+		close(ingest->listen_fd);
+	ingest->listen_fd = -1;
+
+	da_free(ingest->stats.video_delays);
+	pthread_mutex_destroy(&ingest->mutex);
+}
+
+void ingest_get_stats(struct ingest *ingest, struct ingest_stats *stats)
+{
+	pthread_mutex_lock(&ingest->mutex);
+	*stats = ingest->stats;
+	memset(&stats->video_delays, 0, sizeof(stats->video_delays));
+	da_copy(stats->video_delays, ingest->stats.video_delays);
+	pthread_mutex_unlock(&ingest->mutex);
+}
+
+void ingest_stats_free(struct ingest_stats *stats)
+{
+	da_free(stats->video_delays);
+}
+
+void ingest_throttle(struct ingest *ingest, uint64_t start_ns, uint64_t total_bytes)
+{
+	uint64_t rate = ingest->shaping.rate_kbps;
+	if (!rate)
+		return;
+
+	uint64_t expected_ns = total_bytes * 8 * 1000000ULL / rate;
+	os_sleepto_ns(start_ns + expected_ns);
+}
+
+static inline void mark_packet(struct ingest *ingest, uint64_t arrival_ns, size_t size)
+{
+	if (!ingest->stats.first_packet_ns)
+		ingest->stats.first_packet_ns = arrival_ns;
+	ingest->stats.last_packet_ns = arrival_ns;
+	ingest->stats.bytes += size;
+	ingest->publishing = true;
+}
+
+void ingest_add_video(struct ingest *ingest, uint64_t arrival_ns, int64_t pts_ns, size_t size, bool keyframe)
+{
+	int64_t delay = (int64_t)arrival_ns - pts_ns;
+
+	pthread_mutex_lock(&ingest->mutex);
+	mark_packet(ingest, arrival_ns, size);
+	ingest->stats.video_packets++;
+	if (keyframe)
+		ingest->stats.keyframes++;
+	da_push_back(ingest->stats.video_delays, &delay);
+	pthread_mutex_unlock(&ingest->mutex);
+}
+
+void ingest_add_audio(struct ingest *ingest, uint64_t arrival_ns, size_t size)
+{
+	pthread_mutex_lock(&ingest->mutex);
+	mark_packet(ingest, arrival_ns, size);
+	ingest->stats.audio_packets++;
+	pthread_mutex_unlock(&ingest->mutex);
+}
@@ -0,0 +1,93 @@
+/******************************************************************************
+    Copyright (C) 2026 by OBS Project contributors
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+******************************************************************************/
+
+#pragma once
+
+#include <util/c99defs.h>
+#include <util/darray.h>
+#include <util/threading.h>
+
+/* Minimal loopback ingest servers used by the streaming benchmark.  They
+ * accept a single publisher on 127.0.0.1, optionally shape the connection and
+ * record the arrival of every media packet. */
+
+enum ingest_type {
+	INGEST_RTMP,
+	INGEST_UDP,
+	INGEST_HTTP,
+};
+
+struct ingest_shaping {
+	/* receive rate limit in kbps, 0 for unlimited.  RTMP and HTTP reads are
+	 * throttled so the sender sees TCP backpressure, UDP datagrams over
+	 * the rate are dropped. */
+	uint32_t rate_kbps;
+
+	/* percentage of datagrams dropped at random, UDP only */
+	double loss_percent;
+};
+
+struct ingest_stats {
+	uint64_t bytes;
+	uint64_t video_packets;
+	uint64_t audio_packets;
+	uint64_t keyframes;
+
+	/* UDP only: datagrams dropped by shaping and transport stream
+	 * continuity errors seen by the receiver */
+	uint64_t shaped_drops;
+	uint64_t continuity_errors;
+
+	uint64_t first_packet_ns;
+	uint64_t last_packet_ns;
+
+	/* per video packet, arrival time minus presentation time, in ns */
+	DARRAY(int64_t) video_delays;
+};
+
+struct ingest {
+	enum ingest_type type;
+	struct ingest_shaping shaping;
+
+	int listen_fd;
+	int port;
+
+	pthread_t thread;
+	bool thread_active;
+	volatile bool stop;
+
+	pthread_mutex_t mutex;
+	struct ingest_stats stats;
+
+	/* set once the publisher has started sending media */
+	volatile bool publishing;
+};
+
+extern bool ingest_start(struct ingest *ingest, enum ingest_type type, const struct ingest_shaping *shaping);
+extern void ingest_stop(struct ingest *ingest);
+
+/* copies the current statistics, free the copy with ingest_stats_free */
+extern void ingest_get_stats(struct ingest *ingest, struct ingest_stats *stats);
+extern void ingest_stats_free(struct ingest_stats *stats);
+
+/* shared by the RTMP, UDP and HTTP receivers */
+extern void *ingest_rtmp_thread(void *data);
+extern void *ingest_udp_thread(void *data);
+extern void *ingest_http_thread(void *data);
+extern void ingest_throttle(struct ingest *ingest, uint64_t start_ns, uint64_t total_bytes);
+extern void ingest_add_video(struct ingest *ingest, uint64_t arrival_ns, int64_t pts_ns, size_t size, bool keyframe);
+extern void ingest_add_audio(struct ingest *ingest, uint64_t arrival_ns, size_t size);
@@ -0,0 +1,1034 @@
+/******************************************************************************
+    Copyright (C) 2026 by OBS Project contributors
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+******************************************************************************/
+
+/* End to end streaming benchmark.  Runs libobs without a frontend, feeds a
+ * synthetic source through a video and audio encoder into a streaming output
+ * connected to a loopback ingest, and reports throughput, latency, drops and
+ * CPU usage of the output.  Exits with a non-zero status when the stream
+ * failed or exceeded the given limits so it can be used in CI. */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <errno.h>
+#include <dirent.h>
+#include <unistd.h>
+#include <sys/resource.h>
+
+#include <obs.h>
+#include <obs-nix-platform.h>
+#include <graphics/math-defs.h>
+#include <util/base.h>
+#include <util/bmem.h>
+#include <util/dstr.h>
+#include <util/platform.h>
+#include <util/threading.h>
+#include <util/util_uint64.h>
+
+#include "ingest.h"
+
+#define MAX_DESTINATIONS 16
+
+struct bench_options {
+	enum ingest_type protocol;
+	int destinations;
+	int duration_sec;
+	uint32_t width;
+	uint32_t height;
+	uint32_t fps;
+	const char *video_encoder;
+	const char *audio_encoder;
+	int bitrate;
+	int audio_bitrate;
+	const char *congestion_control;
+	struct ingest_shaping shaping;
+	double max_drop_percent;
+	double max_latency_ms;
+	const char *plugin_dir;
+	const char *plugin_data_dir;
+	const char *data_dir;
+	bool verbose;
+};
+
+static struct bench_options opts = {
+	.protocol = INGEST_RTMP,
+	.duration_sec = 10,
+	.width = 1280,
+	.height = 720,
+	.fps = 30,
+	.video_encoder = "bench_null_video",
+	.audio_encoder = "bench_null_audio",
+	.bitrate = 2500,
+	.audio_bitrate = 160,
+	.max_drop_percent = -1.0,
+	.max_latency_ms = -1.0,
+};
+
+static void do_log(int log_level, const char *msg, va_list args, void *param)
+{
+	if (log_level > LOG_WARNING && !opts.verbose)
+		return;
+
+	vfprintf(stderr, msg, args);
+	fputc('\n', stderr);
+
+	UNUSED_PARAMETER(param);
+}
+
+/* ------------------------------------------------------------------------- */
+/* Synthetic source: moving noise video and a sine tone */
+
+struct bench_source {
+	obs_source_t *source;
+	os_event_t *stop_event;
+	pthread_t thread;
+	bool thread_active;
+};
+
+static const char *bench_source_getname(void *unused)
+{
+	UNUSED_PARAMETER(unused);
+	return "Benchmark Source";
+}
+
+static void fill_video(struct obs_source_frame *frame, uint64_t idx, uint32_t *rng)
+{
+	uint8_t *luma = frame->data[0];
+
+	for (uint32_t y = 0; y < frame->height; y++) {
+		uint8_t *line = luma + y * frame->linesize[0];
+		for (uint32_t x = 0; x < frame->width; x++) {
+			*rng ^= *rng << 13;
+			*rng ^= *rng >> 17;
+			*rng ^= *rng << 5;
+			line[x] = (uint8_t)((x + y + idx * 4) & 0xff) ^ (uint8_t)(*rng & 0x1f);
+		}
+	}
+}
+
+static void *bench_source_thread(void *data)
+{
+	struct bench_source *bs = data;
+	uint32_t width = opts.width;
+	uint32_t height = opts.height;
+	uint32_t rng = 0x12345678;
+	float *audio[2];
+
+	struct obs_source_frame frame = {
+		.width = width,
+		.height = height,
+		.format = VIDEO_FORMAT_I420,
+		.linesize = {width, width / 2, width / 2},
+	};
+	frame.data[0] = bmalloc(width * height * 3 / 2);
+	frame.data[1] = frame.data[0] + width * height;
+	frame.data[2] = frame.data[1] + width * height / 4;
+	video_format_get_parameters_for_format(VIDEO_CS_DEFAULT, VIDEO_RANGE_DEFAULT, VIDEO_FORMAT_I420,
+					       frame.color_matrix, frame.color_range_min, frame.color_range_max);
+	memset(frame.data[1], 128, width * height / 2);
+
+	uint32_t max_samples = 48000 / opts.fps + 1;
+	audio[0] = bmalloc(max_samples * sizeof(float) * 2);
+	audio[1] = audio[0] + max_samples;
+
+	struct obs_source_audio out_audio = {
+		.data = {(uint8_t *)audio[0], (uint8_t *)audio[1]},
+		.speakers = SPEAKERS_STEREO,
+		.format = AUDIO_FORMAT_FLOAT_PLANAR,
+		.samples_per_sec = 48000,
+	};
+
+	os_set_thread_name("bench source");
+
+	uint64_t start = os_gettime_ns();
+	uint64_t samples = 0;
+
+	for (uint64_t i = 0; os_event_try(bs->stop_event) == EAGAIN; i++) {
+		uint64_t ts = start + util_mul_div64(i, 1000000000ULL, opts.fps);
+		os_sleepto_ns(ts);
+
+		fill_video(&frame, i, &rng);
+		frame.timestamp = ts;
+		obs_source_output_video(bs->source, &frame);
+
+		uint64_t next_samples = (i + 1) * 48000 / opts.fps;
+		uint32_t count = (uint32_t)(next_samples - samples);
+		for (uint32_t s = 0; s < count; s++) {
+			float val = sinf((float)(samples + s) * 440.0f * 2.0f * (float)M_PI / 48000.0f) * 0.25f;
+			audio[0][s] = val;
+			audio[1][s] = val;
+		}
+
+		out_audio.frames = count;
+		out_audio.timestamp = ts;
+		obs_source_output_audio(bs->source, &out_audio);
+		samples = next_samples;
+	}
+
+	bfree(frame.data[0]);
+	bfree(audio[0]);
+	return NULL;
+}
+
+static void bench_source_destroy(void *data)
+{
+	struct bench_source *bs = data;
+
+	if (bs->thread_active) {
+		os_event_signal(bs->stop_event);
+		pthread_join(bs->thread, NULL);
+	}
+
+	os_event_destroy(bs->stop_event);
+	bfree(bs);
+}
+
+static void *bench_source_create(obs_data_t *settings, obs_source_t *source)
+{
+	struct bench_source *bs = bzalloc(sizeof(struct bench_source));
+	bs->source = source;
+
+	if (os_event_init(&bs->stop_event, OS_EVENT_TYPE_MANUAL) != 0 ||
+	    pthread_create(&bs->thread, NULL, bench_source_thread, bs) != 0) {
+		bench_source_destroy(bs);
+		return NULL;
+	}
+
+	bs->thread_active = true;
+
+	UNUSED_PARAMETER(settings);
+	return bs;
+}
+
+static struct obs_source_info bench_source_info = {
+	.id = "bench_source",
+	.type = OBS_SOURCE_TYPE_INPUT,
+	.output_flags = OBS_SOURCE_ASYNC_VIDEO | OBS_SOURCE_AUDIO,
+	.get_name = bench_source_getname,
+	.create = bench_source_create,
+	.destroy = bench_source_destroy,
+};
+
+/* ------------------------------------------------------------------------- */
+/* Null encoders: produce packets of the configured bitrate without spending
+ * any time encoding, so only the output stack is measured */
+
+/* SPS/PPS of a 1280x720 H.264 stream, nothing decodes the benchmark stream
+ * so it does not need to match the actual resolution */
+static const uint8_t null_video_header[] = {
+	0x00, 0x00, 0x00, 0x01, 0x67, 0x64, 0x00, 0x1f, 0xac, 0xd9, 0x40, 0x50, 0x05, 0xbb, 0x01,
+	0x10, 0x00, 0x00, 0x03, 0x00, 0x10, 0x00, 0x00, 0x03, 0x03, 0xc0, 0xf1, 0x83, 0x19, 0x60,
+	0x00, 0x00, 0x00, 0x01, 0x68, 0xeb, 0xe3, 0xcb, 0x22, 0xc0,
+};
+
+/* AAC LC, 48 kHz, stereo */
+static const uint8_t null_audio_header[] = {0x11, 0x90};
+
+#define NULL_KEYFRAME_SIZE_FACTOR 4
+#define NULL_AUDIO_FRAME_SIZE 1024
+
+struct null_encoder {
+	obs_encoder_t *encoder;
+	bool video;
+
+	int bitrate;
+	uint32_t keyint;
+	uint32_t fps_num;
+	uint32_t fps_den;
+	uint64_t frames;
+
+	DARRAY(uint8_t) packet;
+};
+
+static const char *null_video_getname(void *unused)
+{
+	UNUSED_PARAMETER(unused);
+	return "Benchmark Null Video Encoder";
+}
+
+static const char *null_audio_getname(void *unused)
+{
+	UNUSED_PARAMETER(unused);
+	return "Benchmark Null Audio Encoder";
+}
+
+static bool null_update(void *data, obs_data_t *settings)
+{
+	struct null_encoder *ne = data;
+	ne->bitrate = (int)obs_data_get_int(settings, "bitrate");
+	return true;
+}
+
+static void *null_create(obs_data_t *settings, obs_encoder_t *encoder, bool video)
+{
+	struct null_encoder *ne = bzalloc(sizeof(struct null_encoder));
+	ne->encoder = encoder;
+	ne->video = video;
+	null_update(ne, settings);
+
+	if (video) {
+		const struct video_output_info *voi = video_output_get_info(obs_encoder_video(encoder));
+		ne->fps_num = voi->fps_num;
+		ne->fps_den = voi->fps_den;
+		ne->keyint = (uint32_t)(2 * voi->fps_num / voi->fps_den);
+		if (ne->keyint <= NULL_KEYFRAME_SIZE_FACTOR)
+			ne->keyint = NULL_KEYFRAME_SIZE_FACTOR + 1;
+	}
+
+	return ne;
+}
+
+static void *null_video_create(obs_data_t *settings, obs_encoder_t *encoder)
+{
+	return null_create(settings, encoder, true);
+}
+
+static void *null_audio_create(obs_data_t *settings, obs_encoder_t *encoder)
+{
+	return null_create(settings, encoder, false);
+}
+
+static void null_destroy(void *data)
+{
+	struct null_encoder *ne = data;
+	da_free(ne->packet);
+	bfree(ne);
+}
+
+static bool null_video_encode(void *data, struct encoder_frame *frame, struct encoder_packet *packet,
+			      bool *received_packet)
+{
+	struct null_encoder *ne = data;
+	bool keyframe = ne->frames++ % ne->keyint == 0;
+
+	/* keep the average at the bitrate with larger keyframes */
+	uint64_t avg = util_mul_div64((uint64_t)ne->bitrate * 125, ne->fps_den, ne->fps_num);
+	uint64_t size = keyframe ? avg * NULL_KEYFRAME_SIZE_FACTOR
+				 : avg * (ne->keyint - NULL_KEYFRAME_SIZE_FACTOR) / (ne->keyint - 1);
+	if (size < 16)
+		size = 16;
+
+	da_resize(ne->packet, (size_t)size);
+	memset(ne->packet.array, 0xaa, (size_t)size);
+	memcpy(ne->packet.array, "\x00\x00\x00\x01", 4);
+	ne->packet.array[4] = keyframe ? 0x65 : 0x41;
+
+	packet->data = ne->packet.array;
+	packet->size = ne->packet.num;
+	packet->type = OBS_ENCODER_VIDEO;
+	packet->pts = frame->pts;
+	packet->dts = frame->pts;
+	packet->keyframe = keyframe;
+	*received_packet = true;
+	return true;
+}
+
+static bool null_audio_encode(void *data, struct encoder_frame *frame, struct encoder_packet *packet,
+			      bool *received_packet)
+{
+	struct null_encoder *ne = data;
+	size_t size = (size_t)ne->bitrate * 125 * NULL_AUDIO_FRAME_SIZE / 48000;
+
+	da_resize(ne->packet, size);
+	memset(ne->packet.array, 0x55, size);
+
+	packet->data = ne->packet.array;
+	packet->size = size;
+	packet->type = OBS_ENCODER_AUDIO;
+	packet->pts = frame->pts;
+	packet->dts = frame->pts;
+	packet->timebase_num = 1;
+	packet->timebase_den = 48000;
+	*received_packet = true;
+	return true;
+}
+
+static size_t null_audio_frame_size(void *data)
+{
+	UNUSED_PARAMETER(data);
+	return NULL_AUDIO_FRAME_SIZE;
+}
+
+static bool null_video_extra_data(void *data, uint8_t **extra_data, size_t *size)
+{
+	*extra_data = (uint8_t *)null_video_header;
+	*size = sizeof(null_video_header);
+
+	UNUSED_PARAMETER(data);
+	return true;
+}
+
+static bool null_audio_extra_data(void *data, uint8_t **extra_data, size_t *size)
+{
+	*extra_data = (uint8_t *)null_audio_header;
+	*size = sizeof(null_audio_header);
+
+	UNUSED_PARAMETER(data);
+	return true;
+}
+
+static void null_audio_get_info(void *data, struct audio_convert_info *info)
+{
+	info->format = AUDIO_FORMAT_FLOAT_PLANAR;
+	info->samples_per_sec = 48000;
+	info->speakers = SPEAKERS_STEREO;
+
+	UNUSED_PARAMETER(data);
+}
+
+static struct obs_encoder_info null_video_encoder_info = {
+	.id = "bench_null_video",
+	.type = OBS_ENCODER_VIDEO,
+	.codec = "h264",
+	.get_name = null_video_getname,
+	.create = null_video_create,
+	.destroy = null_destroy,
+	.encode = null_video_encode,
+	.update = null_update,
+	.get_extra_data = null_video_extra_data,
+	.caps = OBS_ENCODER_CAP_DYN_BITRATE,
+};
+
+static struct obs_encoder_info null_audio_encoder_info = {
+	.id = "bench_null_audio",
+	.type = OBS_ENCODER_AUDIO,
+	.codec = "aac",
+	.get_name = null_audio_getname,
+	.create = null_audio_create,
+	.destroy = null_destroy,
+	.encode = null_audio_encode,
+	.update = null_update,
+	.get_frame_size = null_audio_frame_size,
+	.get_extra_data = null_audio_extra_data,
+	.get_audio_info = null_audio_get_info,
+};
+
+/* ------------------------------------------------------------------------- */
+/* CPU usage */
+
+struct cpu_sample {
+	uint64_t ts;
+	uint64_t process_usec;
+	uint64_t thread_ticks;
+	bool have_thread;
+};
+
+/* sums the CPU time of all threads whose name starts with the prefix,
+ * thread names are truncated to 15 characters on Linux */
+static bool get_thread_ticks(const char *prefix, uint64_t *ticks)
+{
+#ifdef __linux__
+	DIR *dir = opendir("/proc/self/task");
+	struct dirent *ent;
+	bool found = false;
+
+	*ticks = 0;
+	if (!dir)
+		return false;
+
+	while ((ent = readdir(dir)) != NULL) {
+		char path[64];
+		char buf[512];
+		FILE *f;
+
+		if (ent->d_name[0] == '.')
+			continue;
+
+		snprintf(path, sizeof(path), "/proc/self/task/%s/comm", ent->d_name);
+		f = fopen(path, "r");
+		if (!f)
+			continue;
+		bool match = fgets(buf, sizeof(buf), f) && strncmp(buf, prefix, strlen(prefix)) == 0;
+		fclose(f);
+		if (!match)
+			continue;
+
+		snprintf(path, sizeof(path), "/proc/self/task/%s/stat", ent->d_name);
+		f = fopen(path, "r");
+		if (!f)
+			continue;
+
+		/* utime and stime are fields 14 and 15, after the
+		 * parenthesized thread name */
+		unsigned long long utime, stime;
+		char *end = fgets(buf, sizeof(buf), f) ? strrchr(buf, ')') : NULL;
+		if (end && sscanf(end + 2, "%*c %*d %*d %*d %*d %*d %*u %*u %*u %*u %*u %llu %llu", &utime,
+				  &stime) == 2) {
+			*ticks += utime + stime;
+			found = true;
+		}
+		fclose(f);
+	}
+
+	closedir(dir);
+	return found;
+#else
+	UNUSED_PARAMETER(prefix);
+	*ticks = 0;
+	return false;
+#endif
+}
+
+static const char *send_thread_prefix(void)
+{
+	switch (opts.protocol) {
+	case INGEST_RTMP:
+		return opts.destinations ? "rtmp-multi: sen" : "rtmp-stream: se";
+	case INGEST_HTTP:
+		return "cmaf-output: wr";
+	default:
+		return NULL;
+	}
+}
+
+static void cpu_sample(struct cpu_sample *sample)
+{
+	struct rusage usage;
+	const char *prefix = send_thread_prefix();
+
+	getrusage(RUSAGE_SELF, &usage);
+	sample->ts = os_gettime_ns();
+	sample->process_usec = (uint64_t)usage.ru_utime.tv_sec * 1000000 + (uint64_t)usage.ru_utime.tv_usec +
+			       (uint64_t)usage.ru_stime.tv_sec * 1000000 + (uint64_t)usage.ru_stime.tv_usec;
+	sample->have_thread = prefix && get_thread_ticks(prefix, &sample->thread_ticks);
+}
+
+/* ------------------------------------------------------------------------- */
+/* Report */
+
+static const char *protocol_names[] = {
+	[INGEST_RTMP] = "rtmp",
+	[INGEST_UDP] = "udp (mpegts)",
+	[INGEST_HTTP] = "http (cmaf)",
+};
+
+static int compare_delays(const void *a, const void *b)
+{
+	int64_t val_a = *(const int64_t *)a;
+	int64_t val_b = *(const int64_t *)b;
+	return val_a < val_b ? -1 : (val_a > val_b ? 1 : 0);
+}
+
+static double percentile_ms(const struct ingest_stats *stats, double percentile)
+{
+	size_t num = stats->video_delays.num;
+	size_t idx = (size_t)((double)(num - 1) * percentile / 100.0 + 0.5);
+	return (double)(stats->video_delays.array[idx] - stats->video_delays.array[0]) / 1000000.0;
+}
+
+struct bench_result {
+	bool stream_failed;
+	int stop_code;
+
+	int total_frames;
+	int dropped_frames;
+	uint64_t total_bytes;
+	int connect_time_ms;
+
+	struct cpu_sample cpu_start;
+	struct cpu_sample cpu_end;
+};
+
+/* prints what one ingest received and returns its p99 latency */
+static double report_ingest(struct ingest_stats *stats, size_t idx, size_t num)
+{
+	char received[32] = "received";
+	char latency[32] = "latency";
+	double p99 = 0.0;
+
+	if (num > 1) {
+		snprintf(received, sizeof(received), "received #%zu", idx);
+		snprintf(latency, sizeof(latency), "latency #%zu", idx);
+	}
+
+	if (stats->first_packet_ns && stats->last_packet_ns > stats->first_packet_ns) {
+		double recv_duration = (double)(stats->last_packet_ns - stats->first_packet_ns) / 1000000000.0;
+		printf("%-18s%llu video (%llu key), %llu audio, %.1f packets/s, %.2f Mbps\n", received,
+		       (unsigned long long)stats->video_packets, (unsigned long long)stats->keyframes,
+		       (unsigned long long)stats->audio_packets,
+		       (double)(stats->video_packets + stats->audio_packets) / recv_duration,
+		       (double)stats->bytes * 8.0 / recv_duration / 1000000.0);
+	} else {
+		printf("%-18snothing\n", received);
+	}
+
+	if (opts.protocol == INGEST_UDP)
+		printf("transport         %llu datagrams shaped away, %llu continuity errors\n",
+		       (unsigned long long)stats->shaped_drops, (unsigned long long)stats->continuity_errors);
+
+	/* the clocks of the sender and the stream timestamps are unrelated,
+	 * so latency is relative to the fastest packet */
+	if (stats->video_delays.num) {
+		qsort(stats->video_delays.array, stats->video_delays.num, sizeof(int64_t), compare_delays);
+		p99 = percentile_ms(stats, 99.0);
+		printf("%-18sp50 %.1f ms, p95 %.1f ms, p99 %.1f ms, max %.1f ms\n", latency,
+		       percentile_ms(stats, 50.0), percentile_ms(stats, 95.0), p99, percentile_ms(stats, 100.0));
+	}
+
+	return p99;
+}
+
+static int report(struct bench_result *result, struct ingest_stats *stats, size_t num)
+{
+	double duration = (double)(result->cpu_end.ts - result->cpu_start.ts) / 1000000000.0;
+	double drop_percent = result->total_frames
+				      ? (double)result->dropped_frames * 100.0 / (double)result->total_frames
+				      : 0.0;
+	double p99 = 0.0;
+	int status = 0;
+
+	printf("protocol          %s\n", protocol_names[opts.protocol]);
+	if (opts.destinations)
+		printf("destinations      %d (rtmp_multi_output)\n", opts.destinations);
+	printf("encoders          %s, %s\n", opts.video_encoder, opts.audio_encoder);
+	printf("shaping           %u kbps, %.1f%% loss\n", opts.shaping.rate_kbps, opts.shaping.loss_percent);
+	printf("duration          %.1f s\n", duration);
+	printf("connect time      %d ms\n", result->connect_time_ms);
+	printf("sent              %d frames, %d dropped (%.2f%%), %.2f Mbps\n", result->total_frames,
+	       result->dropped_frames, drop_percent, (double)result->total_bytes * 8.0 / duration / 1000000.0);
+
+	for (size_t i = 0; i < num; i++) {
+		double val = report_ingest(&stats[i], i, num);
+		if (val > p99)
+			p99 = val;
+	}
+
+	printf("process cpu       %.1f%%\n",
+	       (double)(result->cpu_end.process_usec - result->cpu_start.process_usec) / 10000.0 / duration);
+
+	if (result->cpu_start.have_thread && result->cpu_end.have_thread) {
+		double ticks = (double)(result->cpu_end.thread_ticks - result->cpu_start.thread_ticks);
+		double cpu = ticks * 100.0 / (double)sysconf(_SC_CLK_TCK) / duration;
+
+		printf("send thread cpu   %.1f%%\n", cpu);
+
+		/* the tags are serialized once on the interleaving thread, so
+		 * this is only what every additional destination costs */
+		if (opts.destinations)
+			printf("per destination   %.2f%%\n", cpu / (double)num);
+	} else {
+		printf("send thread cpu   n/a\n");
+	}
+
+	if (result->stream_failed) {
+		fprintf(stderr, "stream stopped with code %d\n", result->stop_code);
+		status = 1;
+	}
+	for (size_t i = 0; i < num; i++) {
+		if (!stats[i].video_packets) {
+			fprintf(stderr, "no video received by ingest %zu\n", i);
+			status = 1;
+		}
+	}
+	if (opts.max_drop_percent >= 0.0 && drop_percent > opts.max_drop_percent) {
+		fprintf(stderr, "dropped %.2f%% of frames, limit is %.2f%%\n", drop_percent, opts.max_drop_percent);
+		status = 1;
+	}
+	if (opts.max_latency_ms >= 0.0 && p99 > opts.max_latency_ms) {
+		fprintf(stderr, "p99 latency %.1f ms, limit is %.1f ms\n", p99, opts.max_latency_ms);
+		status = 1;
+	}
+
+	return status;
+}
+
+/* ------------------------------------------------------------------------- */
+/* Pipeline */
+
+struct bench_context {
+	obs_source_t *source;
+	obs_encoder_t *venc;
+	obs_encoder_t *aenc;
+	obs_service_t *service;
+	obs_output_t *output;
+
+	os_event_t *stopped_event;
+	int stop_code;
+};
+
+static void output_stopped(void *data, calldata_t *cd)
+{
+	struct bench_context *ctx = data;
+	ctx->stop_code = (int)calldata_int(cd, "code");
+	os_event_signal(ctx->stopped_event);
+}
+
+static bool reset_obs(void)
+{
+	struct obs_video_info ovi = {
+		.graphics_module = "libobs-opengl",
+		.fps_num = opts.fps,
+		.fps_den = 1,
+		.base_width = opts.width,
+		.base_height = opts.height,
+		.output_width = opts.width,
+		.output_height = opts.height,
+		.output_format = VIDEO_FORMAT_NV12,
+		.gpu_conversion = true,
+		.colorspace = VIDEO_CS_709,
+		.range = VIDEO_RANGE_PARTIAL,
+		.scale_type = OBS_SCALE_BICUBIC,
+	};
+	struct obs_audio_info oai = {
+		.samples_per_sec = 48000,
+		.speakers = SPEAKERS_STEREO,
+	};
+
+	if (obs_reset_video(&ovi) != OBS_VIDEO_SUCCESS) {
+		blog(LOG_ERROR, "Couldn't initialize video");
+		return false;
+	}
+
+	return obs_reset_audio(&oai);
+}
+
+/* every ingest is one destination of the multi output */
+static void set_destinations(obs_data_t *settings, const struct ingest *ingests, size_t num)
+{
+	obs_data_array_t *array = obs_data_array_create();
+	struct dstr url = {0};
+
+	for (size_t i = 0; i < num; i++) {
+		obs_data_t *item = obs_data_create();
+
+		dstr_printf(&url, "rtmp://127.0.0.1:%d/live", ingests[i].port);
+		obs_data_set_string(item, "server", url.array);
+		obs_data_set_string(item, "key", "bench");
+		obs_data_array_push_back(array, item);
+		obs_data_release(item);
+	}
+
+	obs_data_set_array(settings, "destinations", array);
+	obs_data_array_release(array);
+	dstr_free(&url);
+}
+
+static bool create_pipeline(struct bench_context *ctx, const struct ingest *ingests, size_t num)
+{
+	const struct ingest *ingest = &ingests[0];
+	struct dstr url = {0};
+	bool multi = opts.destinations > 0;
+	bool rtmp = opts.protocol == INGEST_RTMP;
+	bool http = opts.protocol == INGEST_HTTP;
+	const char *output_id = "ffmpeg_mpegts_muxer";
+
+	ctx->source = obs_source_create("bench_source", "bench source", NULL, NULL);
+	if (!ctx->source)
+		return false;
+	obs_set_output_source(0, ctx->source);
+
+	obs_data_t *venc_settings = obs_data_create();
+	obs_data_set_int(venc_settings, "bitrate", opts.bitrate);
+	obs_data_set_string(venc_settings, "rate_control", "CBR");
+	obs_data_set_int(venc_settings, "keyint_sec", 2);
+	ctx->venc = obs_video_encoder_create(opts.video_encoder, "bench video", venc_settings, NULL);
+	obs_data_release(venc_settings);
+
+	obs_data_t *aenc_settings = obs_data_create();
+	obs_data_set_int(aenc_settings, "bitrate", opts.audio_bitrate);
+	ctx->aenc = obs_audio_encoder_create(opts.audio_encoder, "bench audio", aenc_settings, 0, NULL);
+	obs_data_release(aenc_settings);
+
+	if (!ctx->venc || !ctx->aenc) {
+		blog(LOG_ERROR, "Couldn't create encoders '%s' and '%s'", opts.video_encoder, opts.audio_encoder);
+		return false;
+	}
+
+	obs_encoder_set_video(ctx->venc, obs_get_video());
+	obs_encoder_set_audio(ctx->aenc, obs_get_audio());
+
+	if (multi) {
+		output_id = "rtmp_multi_output";
+	} else if (rtmp) {
+		dstr_printf(&url, "rtmp://127.0.0.1:%d/live", ingest->port);
+		output_id = "rtmp_output";
+	} else if (http) {
+		dstr_printf(&url, "http://127.0.0.1:%d/live", ingest->port);
+		output_id = "cmaf_output";
+	} else {
+		dstr_printf(&url, "udp://127.0.0.1:%d?pkt_size=1316", ingest->port);
+	}
+
+	/* the CMAF and multi outputs connect to their destinations directly */
+	bool need_service = !http && !multi;
+	if (need_service) {
+		obs_data_t *service_settings = obs_data_create();
+		obs_data_set_string(service_settings, "server", url.array);
+		obs_data_set_string(service_settings, "key", rtmp ? "bench" : "");
+		ctx->service = obs_service_create("rtmp_custom", "bench service", service_settings, NULL);
+		obs_data_release(service_settings);
+	}
+
+	obs_data_t *output_settings = obs_data_create();
+	if (opts.congestion_control) {
+		obs_data_set_bool(output_settings, "dyn_bitrate", true);
+		obs_data_set_string(output_settings, "congestion_control", opts.congestion_control);
+	}
+	if (http)
+		obs_data_set_string(output_settings, "path", url.array);
+	if (multi)
+		set_destinations(output_settings, ingests, num);
+	ctx->output = obs_output_create(output_id, "bench output", output_settings, NULL);
+	obs_data_release(output_settings);
+	dstr_free(&url);
+
+	if ((need_service && !ctx->service) || !ctx->output) {
+		blog(LOG_ERROR, "Couldn't create the %s output", output_id);
+		return false;
+	}
+
+	obs_output_set_video_encoder(ctx->output, ctx->venc);
+	obs_output_set_audio_encoder(ctx->output, ctx->aenc, 0);
+	if (ctx->service)
+		obs_output_set_service(ctx->output, ctx->service);
+
+	signal_handler_connect(obs_output_get_signal_handler(ctx->output), "stop", output_stopped, ctx);
+	return true;
+}
+
+static void destroy_pipeline(struct bench_context *ctx)
+{
+	if (ctx->output)
+		signal_handler_disconnect(obs_output_get_signal_handler(ctx->output), "stop", output_stopped, ctx);
+
+	obs_set_output_source(0, NULL);
+	obs_output_release(ctx->output);
+	obs_service_release(ctx->service);
+	obs_encoder_release(ctx->venc);
+	obs_encoder_release(ctx->aenc);
+	obs_source_release(ctx->source);
+}
+
+static bool all_publishing(struct ingest *ingests, size_t num)
+{
+	for (size_t i = 0; i < num; i++) {
+		if (!ingests[i].publishing)
+			return false;
+	}
+	return true;
+}
+
+static int run_benchmark(struct bench_context *ctx, struct ingest *ingests, size_t num)
+{
+	struct bench_result result = {0};
+	struct ingest_stats stats[MAX_DESTINATIONS];
+
+	if (!obs_output_start(ctx->output)) {
+		blog(LOG_ERROR, "Couldn't start output: %s", obs_output_get_last_error(ctx->output));
+		return 1;
+	}
+
+	/* wait for the first media to arrive before measuring */
+	for (int i = 0; i < 100 && !all_publishing(ingests, num); i++) {
+		if (os_event_timedwait(ctx->stopped_event, 100) == 0)
+			break;
+	}
+
+	cpu_sample(&result.cpu_start);
+
+	for (int i = 0; i < opts.duration_sec; i++) {
+		if (os_event_timedwait(ctx->stopped_event, 1000) == 0)
+			break;
+	}
+
+	cpu_sample(&result.cpu_end);
+	for (size_t i = 0; i < num; i++)
+		ingest_get_stats(&ingests[i], &stats[i]);
+
+	result.stream_failed = os_event_try(ctx->stopped_event) == 0;
+	result.stop_code = ctx->stop_code;
+	result.total_frames = obs_output_get_total_frames(ctx->output);
+	result.dropped_frames = obs_output_get_frames_dropped(ctx->output);
+	result.total_bytes = obs_output_get_total_bytes(ctx->output);
+	result.connect_time_ms = obs_output_get_connect_time_ms(ctx->output);
+
+	if (!result.stream_failed) {
+		obs_output_stop(ctx->output);
+		os_event_wait(ctx->stopped_event);
+	}
+
+	int status = report(&result, stats, num);
+	for (size_t i = 0; i < num; i++)
+		ingest_stats_free(&stats[i]);
+	return status;
+}
+
+/* ------------------------------------------------------------------------- */
+
+static void usage(const char *name)
+{
+	fprintf(stderr,
+		"usage: %s [options]\n"
+		"  --protocol rtmp|udp|http   output to benchmark (default rtmp)\n"
+		"  --destinations <count>     stream to this many rtmp ingests with one multi output\n"
+		"  --duration <sec>           measured duration (default 10)\n"
+		"  --size <w>x<h>             canvas size (default 1280x720)\n"
+		"  --fps <fps>                frame rate (default 30)\n"
+		"  --video-encoder <id>       video encoder (default bench_null_video)\n"
+		"  --audio-encoder <id>       audio encoder (default bench_null_audio)\n"
+		"  --bitrate <kbps>           video bitrate (default 2500)\n"
+		"  --audio-bitrate <kbps>     audio bitrate (default 160)\n"
+		"  --congestion-control <id>  enable dynamic bitrate with this controller\n"
+		"  --rate <kbps>              limit the ingest receive rate\n"
+		"  --loss <percent>           drop datagrams at random, udp only\n"
+		"  --max-drop <percent>       fail if more frames were dropped\n"
+		"  --max-latency <ms>         fail if the p99 latency is higher\n"
+		"  --plugin-dir <bin> <data>  additional plugin search path\n"
+		"  --data-dir <path>          libobs data path\n"
+		"  --verbose                  show all log messages\n",
+		name);
+}
+
+static bool parse_args(int argc, char *argv[])
+{
+	for (int i = 1; i < argc; i++) {
+		const char *arg = argv[i];
+		const char *val = i + 1 < argc ? argv[i + 1] : NULL;
+		bool has_val = true;
+
+		if (strcmp(arg, "--verbose") == 0) {
+			opts.verbose = true;
+			has_val = false;
+		} else if (!val) {
+			return false;
+		} else if (strcmp(arg, "--protocol") == 0) {
+			if (strcmp(val, "rtmp") == 0)
+				opts.protocol = INGEST_RTMP;
+			else if (strcmp(val, "udp") == 0)
+				opts.protocol = INGEST_UDP;
+			else if (strcmp(val, "http") == 0)
+				opts.protocol = INGEST_HTTP;
+			else
+				return false;
+		} else if (strcmp(arg, "--destinations") == 0) {
+			opts.destinations = atoi(val);
+		} else if (strcmp(arg, "--duration") == 0) {
+			opts.duration_sec = atoi(val);
+		} else if (strcmp(arg, "--size") == 0) {
+			if (sscanf(val, "%ux%u", &opts.width, &opts.height) != 2)
+				return false;
+		} else if (strcmp(arg, "--fps") == 0) {
+			opts.fps = (uint32_t)atoi(val);
+		} else if (strcmp(arg, "--video-encoder") == 0) {
+			opts.video_encoder = val;
+		} else if (strcmp(arg, "--audio-encoder") == 0) {
+			opts.audio_encoder = val;
+		} else if (strcmp(arg, "--bitrate") == 0) {
+			opts.bitrate = atoi(val);
+		} else if (strcmp(arg, "--audio-bitrate") == 0) {
+			opts.audio_bitrate = atoi(val);
+		} else if (strcmp(arg, "--congestion-control") == 0) {
+			opts.congestion_control = val;
+		} else if (strcmp(arg, "--rate") == 0) {
+			opts.shaping.rate_kbps = (uint32_t)atoi(val);
+		} else if (strcmp(arg, "--loss") == 0) {
+			opts.shaping.loss_percent = atof(val);
+		} else if (strcmp(arg, "--max-drop") == 0) {
+			opts.max_drop_percent = atof(val);
+		} else if (strcmp(arg, "--max-latency") == 0) {
+			opts.max_latency_ms = atof(val);
+		} else if (strcmp(arg, "--plugin-dir") == 0) {
+			if (i + 2 >= argc)
+				return false;
+			opts.plugin_dir = val;
+			opts.plugin_data_dir = argv[i + 2];
+			i++;
+		} else if (strcmp(arg, "--data-dir") == 0) {
+			opts.data_dir = val;
+		} else {
+			return false;
+		}
+
+		if (has_val)
+			i++;
+	}
+
+	if (opts.destinations < 0 || opts.destinations > MAX_DESTINATIONS)
+		return false;
+	if (opts.destinations && opts.protocol != INGEST_RTMP)
+		return false;
+
+	return opts.duration_sec > 0 && opts.fps > 0 && opts.width >= 2 && opts.height >= 2 && opts.bitrate > 0;
+}
+
+int main(int argc, char *argv[])
+{
+	struct bench_context ctx = {0};
+	struct ingest ingests[MAX_DESTINATIONS];
+	size_t num_ingests = 0;
+	int status = 1;
+
+	if (!parse_args(argc, argv)) {
+		usage(argv[0]);
+		return 2;
+	}
+
+	opts.width &= ~1;
+	opts.height &= ~1;
+
+	base_set_log_handler(do_log, NULL);
+
+	size_t count = opts.destinations ? (size_t)opts.destinations : 1;
+	for (; num_ingests < count; num_ingests++) {
+		if (!ingest_start(&ingests[num_ingests], opts.protocol, &opts.shaping))
+			goto cleanup_ingest;
+	}
+
+#if defined(__linux__) || defined(__FreeBSD__)
+	/* headless machines need a virtual X server such as xvfb-run */
+	obs_set_nix_platform(OBS_NIX_PLATFORM_X11_EGL);
+#endif
+
+	if (!obs_startup("en-US", NULL, NULL)) {
+		blog(LOG_ERROR, "Couldn't start libobs");
+		goto cleanup_ingest;
+	}
+
+	if (opts.data_dir)
+		obs_add_data_path(opts.data_dir);
+	if (opts.plugin_dir)
+		obs_add_module_path(opts.plugin_dir, opts.plugin_data_dir);
+
+	obs_register_source(&bench_source_info);
+	obs_register_encoder(&null_video_encoder_info);
+	obs_register_encoder(&null_audio_encoder_info);
+
+	if (!reset_obs())
+		goto cleanup_obs;
+
+	obs_load_all_modules();
+	obs_post_load_modules();
+
+	if (os_event_init(&ctx.stopped_event, OS_EVENT_TYPE_MANUAL) != 0)
+		goto cleanup_obs;
+
+	if (create_pipeline(&ctx, ingests, num_ingests))
+		status = run_benchmark(&ctx, ingests, num_ingests);
+
+	destroy_pipeline(&ctx);
+	os_event_destroy(ctx.stopped_event);
+
+cleanup_obs:
+	obs_shutdown();
+	blog(LOG_INFO, "Number of memory leaks: %ld", bnum_allocs());
+
+cleanup_ingest:
+	for (size_t i = 0; i < num_ingests; i++)
+		ingest_stop(&ingests[i]);
+	return status;
+}